@@ -23,24 +23,16 @@ class Floor {
         /* Bring to on top of zero*/
         geometry.translate(0, 0, -0.005 * scale);
 
-        this.mesh = undefined;
-
-        if (entity.floor_image) {
-            var that = this
-
-            new THREE.TextureLoader().load(entity.floor_image, function (texture) {
-                texture.minFilter = THREE.LinearFilter;
-                var material = new THREE.MeshPhongMaterial({
-                    map: texture
-                })
-                var floor = new THREE.Mesh(geometry, material);
-                that.mesh = floor;
-
-                EntityLoadingFinishedFn(that);
-            });
-        } else {
-            EntityLoadingFinishedFn(this);
-        }
+        /* Texture drawn from the patches of the "floor" topic */
+        Floor.texture = new THREE.CanvasTexture(Floor.canvas);
+        Floor.texture.minFilter = THREE.LinearFilter;
+
+        var material = new THREE.MeshPhongMaterial({
+            map: Floor.texture
+        })
+        this.mesh = new THREE.Mesh(geometry, material);
+
+        EntityLoadingFinishedFn(this);
     }
 
     getMesh() {
@@ -48,13 +40,48 @@ class Floor {
     }
 
     update(entity) {
-        if (entity.floor_image && this.mesh) {
-            var that = this
-            new THREE.TextureLoader().load(entity.floor_image, function (texture) {
-                texture.minFilter = THREE.LinearFilter;
-                // in this example we create the material when the texture is loaded
-                that.mesh.material.map = texture;
-            });
-        }
+        /* The texture is updated by Floor.applyPatch */
     }
-}
\ No newline at end of file
+}
+
+/* Whole floor, patches can arrive before the floor entity is created */
+Floor.canvas = document.createElement('canvas');
+Floor.canvas.width = 1;
+Floor.canvas.height = 1;
+Floor.texture = null;
+Floor.version = 0;
+
+/* Patches are decoded asynchronously, but drawn in order */
+Floor.pending = Promise.resolve();
+
+/*
+ * Draws a binary patch of the "floor" topic: a 16 bytes little-endian
+ * header (version, x, y, width, height, floor width, floor height)
+ * followed by a PNG of the region
+ */
+Floor.applyPatch = function (blob) {
+    Floor.pending = Floor.pending.then(function () {
+        return blob.slice(0, 16).arrayBuffer();
+    }).then(function (buffer) {
+        var header = new DataView(buffer);
+        var version = header.getUint32(0, true);
+        var x = header.getUint16(4, true);
+        var y = header.getUint16(6, true);
+        var floorWidth = header.getUint16(12, true);
+        var floorHeight = header.getUint16(14, true);
+
+        return createImageBitmap(blob.slice(16)).then(function (image) {
+            if (Floor.canvas.width != floorWidth ||
+                Floor.canvas.height != floorHeight) {
+                Floor.canvas.width = floorWidth;
+                Floor.canvas.height = floorHeight;
+            }
+            Floor.canvas.getContext('2d').drawImage(image, x, y);
+            Floor.version = version;
+
+            if (Floor.texture) {
+                Floor.texture.needsUpdate = true;
+            }
+        });
+    }).catch(e => console.error(e));
+}
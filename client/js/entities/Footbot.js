@@ -121,60 +121,50 @@ class Footbot {
 
             var pointMesh = this.mesh.children[13];
 
-            if (entity.points.length > 0) {
+            /* Points are flattened as [x, y, z, x, y, z, ...] */
+            var pointsCount = entity.points.length / 3;
+
+            if (pointsCount > 0) {
                 var points = pointMesh.geometry.getAttribute('position').array
 
                 for (let i = 0; i < entity.points.length; i++) {
-                    var pointVals = entity.points[i].split(",")
-                    points[3 * i] = pointVals[0] * scale
-                    points[3 * i + 1] = pointVals[1] * scale
-                    points[3 * i + 2] = pointVals[2] * scale
+                    points[i] = entity.points[i] * scale
                 }
                 pointMesh.geometry.getAttribute('position').needsUpdate = true;
             }
 
             /* Only draw given points, and hide all previous points */
-            pointMesh.geometry.setDrawRange(0, entity.points.length);
-
-            if (entity.rays.length > 0) {
-                for (let i = 0; i < entity.rays.length; i++) {
-                    /*
-                        For each ray as a string,
-                        format -> "BoolIsChecked:Vec3StartPoint:Vec3EndPoint"
-                        For example -> "true:1,2,3:1,2,4"
-                    */
-
-                    var rayArr = entity.rays[i].split(":")
-                    var start = rayArr[1].split(",")
-                    var end = rayArr[2].split(",")
-
-                    var line = this.mesh.children[14 + i];
-                    if (line) {
-                        if (rayArr[0] == "true") {
-                            line.material.color.setHex(0xff00ff);
-                        } else {
-                            line.material.color.setHex(0x00ffff);
-                        }
-
-                        var positions = line.geometry.getAttribute('position').array
-
-                        positions[0] = start[0] * scale
-                        positions[1] = start[1] * scale
-                        positions[2] = start[2] * scale
-
-                        positions[3] = end[0] * scale
-                        positions[4] = end[1] * scale
-                        positions[5] = end[2] * scale
-
-                        line.geometry.getAttribute('position').needsUpdate = true;
-                        line.geometry.setDrawRange(0, 2);
+            pointMesh.geometry.setDrawRange(0, pointsCount);
+
+            /*
+                Rays are flattened, 7 values per ray ->
+                [hit, start x, y, z, end x, y, z, ...], hit being 1 or 0
+            */
+            var raysCount = entity.rays.length / 7;
+
+            for (let i = 0; i < raysCount; i++) {
+                var line = this.mesh.children[14 + i];
+                if (line) {
+                    if (entity.rays[7 * i]) {
+                        line.material.color.setHex(0xff00ff);
+                    } else {
+                        line.material.color.setHex(0x00ffff);
                     }
+
+                    var positions = line.geometry.getAttribute('position').array
+
+                    for (let j = 0; j < 6; j++) {
+                        positions[j] = entity.rays[7 * i + 1 + j] * scale
+                    }
+
+                    line.geometry.getAttribute('position').needsUpdate = true;
+                    line.geometry.setDrawRange(0, 2);
                 }
             }
 
             /* Hide all the previous lines */
             /* 14 are the number of objects in meshParent before rays */
-            for (let i = 14 + entity.rays.length; i < this.mesh.children.length; i++) {
+            for (let i = 14 + raysCount; i < this.mesh.children.length; i++) {
                 this.mesh.children[i].geometry.setDrawRange(0, 0);
             }
         }
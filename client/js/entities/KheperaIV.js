@@ -178,35 +178,39 @@ class KheperaIV {
 
             var pointMesh = this.mesh.children[4];
 
-            if (entity.points.length > 0) {
-                var points = pointMesh.geometry.getAttribute('position').array
+            /* Points are flattened as [x, y, z, x, y, z, ...] */
+            var pointsCount = entity.points.length / 3;
 
+            if (pointsCount > 0) {
                 /* Dynamically add new points if more than 8 (for lidar, UltraSonic) */
-
-                /* Multipled by 3 as its a flattened array with each point having 3 components */
-                if (entity.points.length * 3 > points.length) {
+                if (entity.points.length > pointMesh.geometry.getAttribute('position').array.length) {
                     pointMesh.geometry.setAttribute('position', new THREE.BufferAttribute(
-                        new Float32Array(entity.points.length * 3), // * 3 axis per point
+                        new Float32Array(entity.points.length), // already * 3 axis per point
                         3
                     ));
                 }
 
+                var points = pointMesh.geometry.getAttribute('position').array
+
                 for (let i = 0; i < entity.points.length; i++) {
-                    var pointVals = entity.points[i].split(",")
-                    points[3 * i] = pointVals[0] * scale
-                    points[3 * i + 1] = pointVals[1] * scale
-                    points[3 * i + 2] = pointVals[2] * scale
+                    points[i] = entity.points[i] * scale
                 }
                 pointMesh.geometry.getAttribute('position').needsUpdate = true;
             }
 
             /* Only draw given points, and hide all previous points */
-            pointMesh.geometry.setDrawRange(0, entity.points.length);
+            pointMesh.geometry.setDrawRange(0, pointsCount);
+
+            /*
+                Rays are flattened, 7 values per ray ->
+                [hit, start x, y, z, end x, y, z, ...], hit being 1 or 0
+            */
+            var raysCount = entity.rays.length / 7;
 
             /* Draw rays */
-            if (entity.rays.length > 0) {
+            if (raysCount > 0) {
                 /* Dynamically add new lines if more than 8 (for lidar, UltraSonic) */
-                for (let i = this.lines.length; this.lines.length < entity.rays.length; i++) {
+                for (let i = this.lines.length; this.lines.length < raysCount; i++) {
                     var lineGeom = new THREE.BufferGeometry();
 
                     // attributes
@@ -219,21 +223,11 @@ class KheperaIV {
                     this.lines.push(line);
                 }
 
-                for (let i = 0; i < entity.rays.length; i++) {
-                    /*
-                        For each ray as a string,
-                        format -> "BoolIsChecked:Vec3StartPoint:Vec3EndPoint"
-                        For example -> "true:1,2,3:1,2,4"
-                    */
-
-                    var rayArr = entity.rays[i].split(":");
-                    var start = rayArr[1].split(",");
-                    var end = rayArr[2].split(",");
-
+                for (let i = 0; i < raysCount; i++) {
                     var line = this.lines[i]; //this.mesh.children[5 + i];
 
                     if (line) {
-                        if (rayArr[0] == "true") {
+                        if (entity.rays[7 * i]) {
                             line.material.color.setHex(0xff00ff);
                         } else {
                             line.material.color.setHex(0x00ffff);
@@ -241,13 +235,9 @@ class KheperaIV {
 
                         var positions = line.geometry.getAttribute('position').array;
 
-                        positions[0] = start[0] * scale;
-                        positions[1] = start[1] * scale;
-                        positions[2] = start[2] * scale;
-
-                        positions[3] = end[0] * scale;
-                        positions[4] = end[1] * scale;
-                        positions[5] = end[2] * scale;
+                        for (let j = 0; j < 6; j++) {
+                            positions[j] = entity.rays[7 * i + 1 + j] * scale;
+                        }
 
                         line.geometry.getAttribute('position').needsUpdate = true;
                         line.geometry.setDrawRange(0, 2);
@@ -256,7 +246,7 @@ class KheperaIV {
             }
             /* Hide all the previous lines */
             /* 5 is the number of objects in meshParent before rays */
-            for (let i = 5 + entity.rays.length; i < this.mesh.children.length; i++) {
+            for (let i = 5 + raysCount; i < this.mesh.children.length; i++) {
                 this.mesh.children[i].geometry.setDrawRange(0, 0);
             }
         }
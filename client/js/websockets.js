@@ -11,7 +11,7 @@
 
 (function (w) {
   var ConnectWebSockets = function () {
-    var sockets_api = server + "?broadcasts,logs";
+    var sockets_api = server + "?broadcasts,logs,floor";
 
     /* use wss:// for SSL supported */
     if (window.location.protocol == 'https:') {
@@ -33,9 +33,21 @@
 
     window.wsp = new window.WebSocketAsPromised(sockets_api, {
       packMessage: data => JSON.stringify(data),
-      unpackMessage: data => JSON.parse(data),
+      /* Binary messages are floor patches */
+      unpackMessage: data => (typeof data === 'string') ? JSON.parse(data) : data,
       createWebSocket: url => {
-        return new RobustWebSocket(url, null, {
+        /* Converted to a string at each (re)connection, to resume from the
+         * last broadcast received instead of a whole keyframe */
+        var resumingUrl = {
+          toString: function () {
+            if (!window.experiment.session) {
+              return url;
+            }
+            return url + ",resume:" + window.experiment.session + "." +
+              window.experiment.sequence;
+          }
+        };
+        return new RobustWebSocket(resumingUrl, null, {
           // The number of milliseconds to wait before a connection is considered to have timed out. Defaults to 4 seconds.
           timeout: 2000,
           // A function that given a CloseEvent or an online event (https://developer.mozilla.org/en-US/docs/Online_and_offline_events) and the `RobustWebSocket`,
@@ -56,9 +68,84 @@
     });
 
 
+    /* Rebuilds the full experiment state from keyframes and deltas */
+    var mergeBroadcast = function (frame) {
+      var state = window.experiment.data;
+
+      /* Keyframes (or servers without deltas) replace the whole state */
+      if (frame.keyframe !== false) {
+        window.experiment.session = frame.session;
+        window.experiment.sequence = frame.sequence;
+        window.experiment.keyframeRequested = false;
+        return frame;
+      }
+
+      /* Delta without a state to apply on, or some deltas were missed */
+      if (!state || frame.sequence != window.experiment.sequence + 1) {
+        if (!window.experiment.keyframeRequested) {
+          window.experiment.keyframeRequested = true;
+          window.wsp.sendPacked({ command: 'requestKeyframe' })
+        }
+        return null;
+      }
+      window.experiment.sequence = frame.sequence;
+
+      /* Frame level fields, null means removed */
+      for (var key in frame) {
+        if (key == "entities" || key == "removed") {
+          continue;
+        }
+        if (frame[key] === null) {
+          delete state[key];
+        } else {
+          state[key] = frame[key];
+        }
+      }
+
+      var index = {};
+      for (let i = 0; i < state.entities.length; i++) {
+        index[state.entities[i].id] = state.entities[i];
+      }
+
+      /* Changed fields of entities, or new entities */
+      for (let i = 0; i < frame.entities.length; i++) {
+        var changed = frame.entities[i];
+        var entity = index[changed.id];
+        if (!entity) {
+          state.entities.push(changed);
+          continue;
+        }
+        for (var field in changed) {
+          if (changed[field] === null) {
+            delete entity[field];
+          } else {
+            entity[field] = changed[field];
+          }
+        }
+      }
+
+      if (frame.removed) {
+        state.entities = state.entities.filter(function (entity) {
+          return frame.removed.indexOf(entity.id) < 0;
+        });
+      }
+
+      return state;
+    }
+
     wsp.onUnpackedMessage.addListener(data => {
+      if (data instanceof Blob) {
+        Floor.applyPatch(data);
+        return;
+      }
+
       /* Only if the message is a broadcast message */
       if (data.type == "broadcast") {
+        data = mergeBroadcast(data);
+        if (!data) {
+          return;
+        }
+
         /* Update experiment */
         window.experiment.data = data;
         window.experiment.state = data.state
@@ -0,0 +1,221 @@
+#include <argos3/core/control_interface/ci_controller.h>
+#include <argos3/core/simulator/entity/floor_entity.h>
+#include <argos3/core/simulator/loop_functions.h>
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
+
+#include <cmath>
+#include <map>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+using namespace argos;
+
+/* Does nothing, with any robot */
+class CBenchmarkController : public CCI_Controller {
+ public:
+  virtual void ControlStep() {}
+};
+
+REGISTER_CONTROLLER(CBenchmarkController, "benchmark_controller");
+
+/****************************************/
+/****************************************/
+
+/* Checkerboard floor, with one meter tiles */
+class CBenchmarkLoopFunctions : public CLoopFunctions {
+ public:
+  virtual CColor GetFloorColor(const CVector2& c_position) {
+    int nTile = static_cast<int>(std::floor(c_position.GetX())) +
+                static_cast<int>(std::floor(c_position.GetY()));
+    return nTile % 2 == 0 ? CColor::WHITE : CColor::GRAY50;
+  }
+};
+
+REGISTER_LOOP_FUNCTIONS(CBenchmarkLoopFunctions, "benchmark_loop_functions");
+
+/****************************************/
+/****************************************/
+
+/* Webviz which never starts its server, the benchmarks call the simulation
+ * thread side directly */
+class CBenchmarkWebviz : public CWebviz {
+ public:
+  virtual void Execute() {}
+
+  using CWebviz::BroadcastExperimentState;
+};
+
+REGISTER_VISUALIZATION(
+  CBenchmarkWebviz,
+  "webviz_benchmark",
+  "Prajankya [prajankya@gmail.com]",
+  ARGOS_WEBVIZ_VERSION,
+  "Webviz without its server, for the benchmarks\n",
+  "Only used by the benchmarks of Webviz.\n",
+  "Usable");
+
+/****************************************/
+/****************************************/
+
+/* Loaded once for all the benchmarks */
+static CBenchmarkWebviz& GetWebviz() {
+  static CBenchmarkWebviz* pcWebviz = []() {
+    CSimulator& cSimulator = CSimulator::GetInstance();
+    cSimulator.SetExperimentFileName(WEBVIZ_BENCHMARK_EXPERIMENT);
+    cSimulator.LoadExperiment();
+    return &dynamic_cast<CBenchmarkWebviz&>(cSimulator.GetVisualization());
+  }();
+  return *pcWebviz;
+}
+
+/****************************************/
+/****************************************/
+
+/* Grid slots of 0.5 m, each type has its own range of slots */
+static const std::map<std::string, size_t> MAP_FIRST_SLOT = {
+  {"foot-bot", 0}, {"kheperaiv", 10000}, {"box", 10100}};
+
+static std::string GetEntityId(const std::string& str_type, size_t un_index) {
+  return str_type + "_" + std::to_string(un_index);
+}
+
+/****************************************/
+/****************************************/
+
+/**
+ * Adds or removes entities of a type, to have exactly un_count of them
+ *
+ * @return false if the type is not available (plugin not installed)
+ */
+static bool SetPopulation(const std::string& str_type, size_t un_count) {
+  static std::map<std::string, size_t> mapPopulation;
+  size_t& unPopulation = mapPopulation[str_type];
+  CLoopFunctions& cLoopFunctions = CSimulator::GetInstance().GetLoopFunctions();
+
+  while (unPopulation > un_count) {
+    cLoopFunctions.RemoveEntity(GetEntityId(str_type, --unPopulation));
+  }
+
+  while (unPopulation < un_count) {
+    std::string strId = GetEntityId(str_type, unPopulation);
+    size_t unSlot = MAP_FIRST_SLOT.at(str_type) + unPopulation;
+    std::string strBody = "<body position=\"" +
+                          std::to_string(-26 + (unSlot % 105) * 0.5) + "," +
+                          std::to_string(-26 + (unSlot / 105) * 0.5) +
+                          ",0\" orientation=\"0,0,0\" />";
+
+    /* As in the .argos file */
+    std::string strXML;
+    if (str_type == "box") {
+      strXML = "<box id=\"" + strId +
+               "\" size=\"0.3,0.3,0.3\" movable=\"false\">" + strBody +
+               "</box>";
+    } else {
+      strXML = "<" + str_type + " id=\"" + strId + "\">" + strBody +
+               "<controller config=\"bc\" /></" + str_type + ">";
+    }
+
+    ticpp::Document tDocument;
+    tDocument.Parse(strXML);
+    TConfigurationNode& tNode = *tDocument.FirstChildElement();
+
+    CEntity* pcEntity;
+    try {
+      pcEntity = CFactory<CEntity>::New(tNode.Value());
+    } catch (CARGoSException& ex) {
+      return false;
+    }
+    pcEntity->Init(tNode);
+    cLoopFunctions.AddEntity(*pcEntity);
+    ++unPopulation;
+  }
+  return true;
+}
+
+/****************************************/
+/****************************************/
+
+/* CWebvizOperationGenerate*JSON of one entity */
+static void BM_GenerateJSON(
+  benchmark::State& c_state, const std::string& str_type) {
+  CBenchmarkWebviz& cWebviz = GetWebviz();
+  if (!SetPopulation(str_type, 1)) {
+    c_state.SkipWithError((str_type + " is not available").c_str());
+    return;
+  }
+  CEntity& cEntity =
+    CSimulator::GetInstance().GetSpace().GetEntity(GetEntityId(str_type, 0));
+
+  for (auto _ : c_state) {
+    nlohmann::json cJSON = CallEntityOperation<
+      CWebvizOperationGenerateJSON,
+      CWebviz,
+      nlohmann::json>(cWebviz, cEntity);
+    benchmark::DoNotOptimize(cJSON);
+  }
+}
+BENCHMARK_CAPTURE(BM_GenerateJSON, footbot, std::string("foot-bot"));
+BENCHMARK_CAPTURE(BM_GenerateJSON, kheperaiv, std::string("kheperaiv"));
+BENCHMARK_CAPTURE(BM_GenerateJSON, box, std::string("box"));
+
+/****************************************/
+/****************************************/
+
+/* The floor, rendered again (1) or not (0) */
+static void BM_GenerateFloorJSON(benchmark::State& c_state) {
+  CBenchmarkWebviz& cWebviz = GetWebviz();
+  CFloorEntity& cFloor = CSimulator::GetInstance().GetSpace().GetFloorEntity();
+  bool bChanged = c_state.range(0) != 0;
+
+  for (auto _ : c_state) {
+    if (bChanged) {
+      cFloor.SetChanged();
+    }
+    nlohmann::json cJSON = CallEntityOperation<
+      CWebvizOperationGenerateJSON,
+      CWebviz,
+      nlohmann::json>(cWebviz, cFloor);
+    benchmark::DoNotOptimize(cJSON);
+  }
+}
+BENCHMARK(BM_GenerateFloorJSON)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+/****************************************/
+/****************************************/
+
+/* Whole state of N foot-bots, handed over to the webserver */
+static void BM_BroadcastExperimentState(benchmark::State& c_state) {
+  CBenchmarkWebviz& cWebviz = GetWebviz();
+  SetPopulation("kheperaiv", 0);
+  SetPopulation("box", 0);
+  SetPopulation("foot-bot", c_state.range(0));
+
+  for (auto _ : c_state) {
+    cWebviz.BroadcastExperimentState();
+  }
+  c_state.SetItemsProcessed(c_state.iterations() * c_state.range(0));
+}
+BENCHMARK(BM_BroadcastExperimentState)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Arg(10000)
+  ->Unit(benchmark::kMillisecond);
+
+/****************************************/
+/****************************************/
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+
+  /* Only if some benchmark loaded it */
+  CSimulator::GetInstance().Destroy();
+  return 0;
+}
@@ -0,0 +1,50 @@
+#include "plugins/simulator/visualizations/webviz/utility/base64.h"
+
+#include <random>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+/* Noise is the worst case, as for a textured floor */
+static std::string MakeImage(size_t un_side) {
+  std::mt19937 cRandom(42);
+  std::uniform_int_distribution<int> cByte(0, 255);
+
+  std::string strImage(un_side * un_side * 3, '\0');
+  for (auto& chByte : strImage) {
+    chByte = static_cast<char>(cByte(cRandom));
+  }
+  return strImage;
+}
+
+/****************************************/
+/****************************************/
+
+/* RGB floor of side x side pixels */
+static void BM_Base64Encode(benchmark::State& c_state) {
+  std::string strImage = MakeImage(c_state.range(0));
+  std::string strOut;
+
+  for (auto _ : c_state) {
+    Base64::Encode(strImage, &strOut);
+    benchmark::DoNotOptimize(strOut.data());
+  }
+  c_state.SetBytesProcessed(c_state.iterations() * strImage.size());
+}
+BENCHMARK(BM_Base64Encode)->Arg(250)->Arg(500)->Arg(1000)->Arg(2000);
+
+/****************************************/
+/****************************************/
+
+static void BM_Base64Decode(benchmark::State& c_state) {
+  std::string strEncoded;
+  Base64::Encode(MakeImage(c_state.range(0)), &strEncoded);
+  std::string strOut;
+
+  for (auto _ : c_state) {
+    Base64::Decode(strEncoded, &strOut);
+    benchmark::DoNotOptimize(strOut.data());
+  }
+  c_state.SetBytesProcessed(c_state.iterations() * strEncoded.size());
+}
+BENCHMARK(BM_Base64Decode)->Arg(250)->Arg(1000);
@@ -0,0 +1,104 @@
+#include "plugins/simulator/visualizations/webviz/utility/Deflate.h"
+#include "plugins/simulator/visualizations/webviz/utility/DeltaEncoder.h"
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "benchmark/benchmark.h"
+
+using argos::Webviz::CDeflate;
+using argos::Webviz::CDeltaEncoder;
+
+/* State like the one of a swarm of foot-bots, moved by f_step */
+static nlohmann::json MakeState(size_t un_entities, double f_step) {
+  nlohmann::json cState;
+  cState["type"] = "broadcast";
+  cState["state"] = "EXPERIMENT_PLAYING";
+  cState["steps"] = static_cast<uint64_t>(f_step);
+  cState["arena"]["size"] = {{"x", 10}, {"y", 10}, {"z", 1}};
+
+  nlohmann::json& cEntities = cState["entities"];
+  for (size_t i = 0; i < un_entities; ++i) {
+    nlohmann::json cEntity;
+    cEntity["type"] = "foot-bot";
+    cEntity["id"] = "fb" + std::to_string(i);
+    /* Half of them move each step */
+    double fOffset = i % 2 == 0 ? f_step * 0.01 : 0;
+    cEntity["position"] = {
+      {"x", (i % 100) * 0.1 + fOffset}, {"y", (i / 100) * 0.1}, {"z", 0}};
+    cEntity["orientation"] = {{"x", 0}, {"y", 0}, {"z", 0.38}, {"w", 0.92}};
+    cEntity["leds"] = {"0x000000", "0xff0000", "0x000000", "0x00ff00"};
+    cEntities.push_back(std::move(cEntity));
+  }
+  return cState;
+}
+
+/****************************************/
+/****************************************/
+
+/* Delta against the previous state, half of the entities moved */
+static void BM_DeltaEncode(benchmark::State& c_state) {
+  CDeltaEncoder cEncoder(100);
+  nlohmann::json cStates[2] = {
+    MakeState(c_state.range(0), 0), MakeState(c_state.range(0), 1)};
+  cEncoder.Encode(cStates[1]);
+
+  size_t unFrame = 0;
+  for (auto _ : c_state) {
+    nlohmann::json cFrame = cEncoder.Encode(cStates[unFrame++ % 2]);
+    benchmark::DoNotOptimize(cFrame);
+  }
+  c_state.SetItemsProcessed(c_state.iterations() * c_state.range(0));
+}
+BENCHMARK(BM_DeltaEncode)->Arg(100)->Arg(1000)->Arg(10000);
+
+/****************************************/
+/****************************************/
+
+static void BM_Dump(benchmark::State& c_state) {
+  nlohmann::json cState = MakeState(c_state.range(0), 0);
+  size_t unBytes = 0;
+
+  for (auto _ : c_state) {
+    std::string strJSON = cState.dump();
+    unBytes = strJSON.size();
+    benchmark::DoNotOptimize(strJSON.data());
+  }
+  c_state.SetBytesProcessed(c_state.iterations() * unBytes);
+}
+BENCHMARK(BM_Dump)->Arg(100)->Arg(1000)->Arg(10000);
+
+/****************************************/
+/****************************************/
+
+static void BM_MsgPack(benchmark::State& c_state) {
+  nlohmann::json cState = MakeState(c_state.range(0), 0);
+  std::string strMsgPack;
+
+  for (auto _ : c_state) {
+    strMsgPack.clear();
+    nlohmann::json::to_msgpack(cState, strMsgPack);
+    benchmark::DoNotOptimize(strMsgPack.data());
+  }
+  c_state.SetBytesProcessed(c_state.iterations() * strMsgPack.size());
+}
+BENCHMARK(BM_MsgPack)->Arg(100)->Arg(1000)->Arg(10000);
+
+/****************************************/
+/****************************************/
+
+/* The frame of "broadcasts.deflate", compressed once for all the
+ * subscribers */
+static void BM_Deflate(benchmark::State& c_state) {
+  std::string strJSON = MakeState(c_state.range(0), 0).dump();
+  std::string strCompressed;
+
+  for (auto _ : c_state) {
+    CDeflate::Compress(strJSON, &strCompressed);
+    benchmark::DoNotOptimize(strCompressed.data());
+  }
+  c_state.SetBytesProcessed(c_state.iterations() * strJSON.size());
+  c_state.counters["ratio"] =
+    static_cast<double>(strJSON.size()) / strCompressed.size();
+}
+BENCHMARK(BM_Deflate)->Arg(100)->Arg(1000)->Arg(10000);
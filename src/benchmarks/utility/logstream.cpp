@@ -0,0 +1,86 @@
+#include "plugins/simulator/visualizations/webviz/utility/LogStream.h"
+
+#include <sstream>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "plugins/simulator/visualizations/webviz/utility/LogRing.h"
+
+using argos::Webviz::CLogRing;
+using argos::Webviz::CLogStream;
+
+/* Shared by the threads of a benchmark, drained by the first one */
+static CLogRing* g_pcRing = nullptr;
+
+/****************************************/
+/****************************************/
+
+/* A controller logging a line per step, into the ring of the webserver,
+ * escaped when written (1) or later by the broadcaster (0) */
+static void BM_LogStreamToRing(benchmark::State& c_state) {
+  bool bEscape = c_state.range(0) != 0;
+  CLogRing cRing(1024);
+  std::ostringstream cStream;
+  CLogStream cLogStream(
+    cStream,
+    [&](std::string str_line) {
+      CLogRing::SLine sLine;
+      sLine.m_bEscaped = bEscape;
+      sLine.m_strText = std::move(str_line);
+      cRing.Push(std::move(sLine));
+    },
+    bEscape);
+
+  CLogRing::SLine sLine;
+  size_t unLines = 0;
+  for (auto _ : c_state) {
+    cStream << "[INFO] Robot fb" << unLines << " <stuck> at step " << 1234
+            << ", turning " << 0.5 << " rad\n";
+
+    /* Drained as the broadcaster does, once per cycle */
+    if (++unLines % 512 == 0) {
+      while (cRing.Pop(sLine)) {
+        if (!sLine.m_bEscaped) {
+          CLogStream::Escape(sLine.m_strText);
+        }
+        benchmark::DoNotOptimize(sLine.m_strText.data());
+      }
+    }
+  }
+  c_state.SetItemsProcessed(c_state.iterations());
+  c_state.counters["dropped"] = cRing.GetDropped();
+}
+BENCHMARK(BM_LogStreamToRing)->Arg(0)->Arg(1);
+
+/****************************************/
+/****************************************/
+
+/* Many threads logging at the same time, like serialization workers or
+ * multi-threaded controllers. The ring is drained by the first thread */
+static void BM_LogRingContended(benchmark::State& c_state) {
+  if (c_state.thread_index() == 0) {
+    g_pcRing = new CLogRing(4096);
+  }
+
+  CLogRing::SLine sLine;
+  size_t unLines = 0;
+  for (auto _ : c_state) {
+    CLogRing::SLine sNew;
+    sNew.m_strText = "[INFO] Robot fb0 turning left";
+    g_pcRing->Push(std::move(sNew));
+
+    if (c_state.thread_index() == 0 && ++unLines % 256 == 0) {
+      while (g_pcRing->Pop(sLine)) {
+        benchmark::DoNotOptimize(sLine.m_strText.data());
+      }
+    }
+  }
+  c_state.SetItemsProcessed(c_state.iterations());
+
+  if (c_state.thread_index() == 0) {
+    c_state.counters["dropped"] = g_pcRing->GetDropped();
+    delete g_pcRing;
+    g_pcRing = nullptr;
+  }
+}
+BENCHMARK(BM_LogRingContended)->ThreadRange(1, 8)->UseRealTime();
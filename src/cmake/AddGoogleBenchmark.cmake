@@ -0,0 +1,52 @@
+#
+#
+# Downloads Google Benchmark and provides a helper macro to add benchmarks. Adds
+# make run_benchmarks as well, which runs all of them and writes their results
+# in JSON, to compare two builds.
+#
+#
+set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_GTEST_TESTS OFF CACHE BOOL "" FORCE)
+set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+if(CMAKE_VERSION VERSION_LESS 3.11)
+    include(DownloadProject)
+    download_project(PROJ                googlebenchmark
+		     GIT_REPOSITORY      https://github.com/google/benchmark.git
+		     GIT_TAG             v1.7.1
+		     UPDATE_DISCONNECTED 1
+		     QUIET
+    )
+
+    add_subdirectory(${googlebenchmark_SOURCE_DIR} ${googlebenchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+else()
+    include(FetchContent)
+    FetchContent_Declare(googlebenchmark
+        GIT_REPOSITORY      https://github.com/google/benchmark.git
+        GIT_TAG             v1.7.1)
+    FetchContent_GetProperties(googlebenchmark)
+    if(NOT googlebenchmark_POPULATED)
+        FetchContent_Populate(googlebenchmark)
+        add_subdirectory(${googlebenchmark_SOURCE_DIR} ${googlebenchmark_BINARY_DIR} EXCLUDE_FROM_ALL)
+    endif()
+endif()
+
+#
+# Adds a benchmark executable from the given sources, run by run_benchmarks
+#
+macro(package_add_benchmark BENCHMARKNAME_)
+    set(BENCHMARK_NAME "benchmarks.${BENCHMARKNAME_}")
+
+    add_executable(${BENCHMARK_NAME} ${ARGN})
+    # link Google Benchmark and its default main function
+    target_link_libraries(${BENCHMARK_NAME} benchmark benchmark_main argos3core_simulator)
+    set_target_properties(${BENCHMARK_NAME} PROPERTIES FOLDER benchmarks)
+
+    list(APPEND WEBVIZ_BENCHMARKS ${BENCHMARK_NAME})
+endmacro()
+
+mark_as_advanced(
+    BENCHMARK_ENABLE_TESTING
+    BENCHMARK_ENABLE_GTEST_TESTS
+    BENCHMARK_ENABLE_INSTALL
+)
@@ -11,12 +11,14 @@
  */
 
 #include <argos3/core/simulator/entity/floor_entity.h>
-#include <argos3/plugins/simulator/visualizations/webviz/utility/base64.h>
+#include <argos3/core/simulator/simulator.h>
+#include <argos3/core/simulator/space/space.h>
+#include <argos3/core/utility/logging/argos_log.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/FloorTexture.h>
 #include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
 
-#include <cstdio>
-#include <iomanip>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <nlohmann/json.hpp>
 
 namespace argos {
@@ -34,55 +36,106 @@ namespace argos {
         cJson["type"] = c_entity.GetTypeDescription();
         cJson["id"] = c_entity.GetId();
 
-        try {
-#ifdef ARGOS_WITH_FREEIMAGE
-
-          /* If floor is updated */
-          if (c_entity.HasChanged()) {
-            std::string strFilePath =
-              "/tmp/argos3_webviz_floor_" +
-              std::to_string(
-                std::chrono::duration_cast<std::chrono::milliseconds>(
-                  std::chrono::system_clock::now().time_since_epoch())
-                  .count()) +
-              ".png";
-
-            /* TODO: below code is not at all optimized ...  */
-            c_entity.SaveAsImage(strFilePath);
-
-            /* Read the file */
-
-            std::ifstream infile(
-              strFilePath, std::ifstream::binary | std::ios::ate);
-
-            std::streamsize size = infile.tellg();
-
-            infile.seekg(0, std::ios::beg);
+        /* If floor is updated (or was never rendered) */
+        if (c_entity.HasChanged() || !m_cTexture.GetImage()) {
+          UInt32 unWidth, unHeight;
+          std::vector<uint8_t> vecPixels =
+            Render(c_entity, GetPixelsPerMeter(c_webviz), unWidth, unHeight);
+          c_entity.ClearChanged();
+
+          /* Only the regions which changed are sent, on the "floor" topic */
+          std::vector<CFloorTexture::SRect> vecDirty =
+            m_cTexture.Update(unWidth, unHeight, std::move(vecPixels));
+          if (!vecDirty.empty()) {
+            c_webviz.UpdateFloorTexture(
+              m_cTexture.GetImage(), std::move(vecDirty));
+          }
+        }
 
-            /* Allocate a string, make it large enough to hold the input */
-            std::string buffer;
-            buffer.resize(size);
+        /* Lets clients know which texture goes with this state */
+        cJson["floor_version"] = m_cTexture.GetImage()->m_unVersion;
 
-            /* read the image into the string */
-            infile.read(&buffer[0], buffer.size());
-            infile.close();
+        return cJson;
+      }
 
-            /* delete the temp image file */
-            std::remove(strFilePath.c_str());
+     private:
+      /**
+       * @brief Configured resolution, lowered for arenas which would need a
+       * texture larger than CFloorTexture::MAX_SIZE
+       */
+      UInt32 GetPixelsPerMeter(CWebviz& c_webviz) {
+        const CVector3& cArenaSize =
+          CSimulator::GetInstance().GetSpace().GetArenaSize();
+        UInt32 unWanted = c_webviz.GetFloorPixelsPerMeter();
+        UInt32 unPixelsPerMeter = CFloorTexture::FitPixelsPerMeter(
+          cArenaSize.GetX(), cArenaSize.GetY(), unWanted);
+
+        if (unPixelsPerMeter < unWanted && !m_bWarned) {
+          LOGERR << "[WARNING] Floor texture would be larger than "
+                 << CFloorTexture::MAX_SIZE
+                 << " pixels, floor_pixels_per_meter lowered from "
+                 << unWanted << " to " << unPixelsPerMeter << '\n';
+          m_bWarned = true;
+        }
+        return unPixelsPerMeter;
+      }
 
-            std::string strFloorImage;
-            Base64::Encode(buffer, &strFloorImage);
-            cJson["floor_image"] = "data:image/png;base64," + strFloorImage;
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Renders the floor in memory, row by row from the top (max y)
+       */
+      static std::vector<uint8_t> Render(
+        CFloorEntity& c_entity,
+        UInt32 un_pixels_per_meter,
+        UInt32& un_width,
+        UInt32& un_height) {
+        const CSpace& cSpace = CSimulator::GetInstance().GetSpace();
+        const CVector3& cArenaSize = cSpace.GetArenaSize();
+        const CVector3& cArenaCenter = cSpace.GetArenaCenter();
+
+        /* Even at 1 pixel per meter, the buffer stays bounded */
+        un_width = std::max<UInt32>(
+          1,
+          std::min<UInt32>(
+            CFloorTexture::MAX_SIZE,
+            std::lround(cArenaSize.GetX() * un_pixels_per_meter)));
+        un_height = std::max<UInt32>(
+          1,
+          std::min<UInt32>(
+            CFloorTexture::MAX_SIZE,
+            std::lround(cArenaSize.GetY() * un_pixels_per_meter)));
+
+        const Real fPixelX = cArenaSize.GetX() / un_width;
+        const Real fPixelY = cArenaSize.GetY() / un_height;
+        const Real fLeft = cArenaCenter.GetX() - cArenaSize.GetX() / 2;
+        const Real fTop = cArenaCenter.GetY() + cArenaSize.GetY() / 2;
+
+        std::vector<uint8_t> vecPixels(
+          static_cast<size_t>(un_width) * un_height * 3);
+        uint8_t* punPixel = vecPixels.data();
+
+        /* Color at the center of each pixel */
+        for (UInt32 j = 0; j < un_height; ++j) {
+          Real fY = fTop - (j + 0.5) * fPixelY;
+          for (UInt32 i = 0; i < un_width; ++i) {
+            CColor cColor =
+              c_entity.GetColorAtPoint(fLeft + (i + 0.5) * fPixelX, fY);
+            *punPixel++ = cColor.GetRed();
+            *punPixel++ = cColor.GetGreen();
+            *punPixel++ = cColor.GetBlue();
           }
-#endif
-        } catch (const std::exception& e) {
-          std::cerr << "Error in Saving file, maybe ' Open file limit' "
-                       "exceeded or no space left."
-                    << '\n';
         }
-
-        return cJson;
+        return vecPixels;
       }
+
+     private:
+      /** Last rendered texture, to find what changed */
+      CFloorTexture m_cTexture;
+
+      /** The lowered resolution is only reported once */
+      bool m_bWarned = false;
     };
 
     REGISTER_WEBVIZ_ENTITY_OPERATION(
@@ -91,4 +144,4 @@ namespace argos {
       CFloorEntity);
 
   }  // namespace Webviz
-}  // namespace argos
\ No newline at end of file
+}  // namespace argos
@@ -12,9 +12,9 @@
 
 #include <argos3/plugins/robots/foot-bot/simulator/footbot_entity.h>
 #include <argos3/plugins/simulator/entities/led_equipped_entity.h>
+#include <argos3/plugins/simulator/visualizations/webviz/utility/EntityEncoding.h>
 #include <argos3/plugins/simulator/visualizations/webviz/webviz.h>
 
-#include <iomanip>
 #include <nlohmann/json.hpp>
 
 namespace argos {
@@ -53,85 +53,24 @@ namespace argos {
         CLEDEquippedEntity& cLEDEquippedEntity =
           c_entity.GetLEDEquippedEntity();
 
-        if (cLEDEquippedEntity.GetLEDs().size() > 0) {
-          /* Building a string of all led colors */
-          for (UInt32 i = 0; i < 12; i++) {
-            std::stringstream strLEDsStream;
-
-            const CColor& cColor = cLEDEquippedEntity.GetLED(i).GetColor();
-            /* Convert to hex color*/
-            strLEDsStream << "0x" << std::setfill('0') << std::setw(6)
-                          << std::hex
-                          << (cColor.GetRed() << 16 | cColor.GetGreen() << 8 |
-                              cColor.GetBlue());
-
-            cJson["leds"].push_back(strLEDsStream.str());
-          }
+        if (
+          cLEDEquippedEntity.GetLEDs().size() > 0 &&
+          c_webviz.IsFieldWanted("leds")) {
+          /* LED colors as 0xRRGGBB integers */
+          CEntityEncoding::EncodeLEDs(cLEDEquippedEntity, 12, cJson["leds"]);
         }
 
-        /* Rays */
-        std::vector<std::pair<bool, CRay3>>& vecRays =
-          c_entity.GetControllableEntity().GetCheckedRays();
-
-        cJson["rays"] = json::array();  // Empty array
-
-        /*
-         * To make rays relative, negate the rotation of body along Z axis
-         */
-        CQuaternion cInvZRotation = cOrientation;
-        cInvZRotation.SetZ(-cOrientation.GetZ());
-
-        /*
-          For each ray as a string,
-          Output format -> "BoolIsChecked:Vec3StartPoint:Vec3EndPoint"
-          For example -> "true:1,2,3:1,2,4"
-        */
-        for (UInt32 i = 0; i < vecRays.size(); ++i) {
-          std::stringstream strRayStream;
-          if (vecRays[i].first) {
-            strRayStream << "true";
-          } else {
-            strRayStream << "false";
-          }
-
-          /* Substract the body position, to get relative position of ray */
-          CVector3 cStartVec = vecRays[i].second.GetStart();
-          cStartVec -= cPosition;
-          CVector3 cEndVec = vecRays[i].second.GetEnd();
-          cEndVec -= cPosition;
-
-          cStartVec.Rotate(cInvZRotation);
-          cEndVec.Rotate(cInvZRotation);
-
-          /* append vectors to string */
-          strRayStream << ":";
-          strRayStream << cStartVec;
-          strRayStream << ":";
-          strRayStream << cEndVec;
-
-          cJson["rays"].push_back(strRayStream.str());
-        }
-
-        std::vector<argos::CVector3>& vecPoints =
-          c_entity.GetControllableEntity().GetIntersectionPoints();
-
-        cJson["points"] = json::array();  // Empty array
-
-        for (UInt32 i = 0; i < vecPoints.size(); ++i) {
-          // NO NOT TAKE IT BY REFERENCE HERE, we are updating them below
-          CVector3 cPoint = vecPoints[i];
-
-          cPoint -= cPosition;
-          cPoint.Rotate(cInvZRotation);
-
-          std::stringstream strPointStream;
-          strPointStream << cPoint.GetX();
-          strPointStream << ",";
-          strPointStream << cPoint.GetY();
-          strPointStream << ",";
-          strPointStream << cPoint.GetZ();
-
-          cJson["points"].push_back(strPointStream.str());
+        /* Rays and intersection points, relative to the robot, only if
+         * some client wants them */
+        if (c_webviz.AreRaysWanted(c_entity.GetId())) {
+          CEntityEncoding::EncodeRays(
+            c_entity.GetControllableEntity().GetCheckedRays(),
+            c_entity.GetControllableEntity().GetIntersectionPoints(),
+            cPosition,
+            cOrientation,
+            cJson["rays"],
+            cJson["points"],
+            c_webviz.GetRayStep());
         }
 
         return cJson;
@@ -0,0 +1,124 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/loadtest/main.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/core/utility/configuration/command_line_arg_parser.h>
+#include <argos3/core/utility/logging/argos_log.h>
+
+#include <string>
+
+#include "webviz_loadtest.h"
+
+using namespace argos;
+
+int main(int n_argc, char** ppch_argv) {
+  try {
+    bool bHelp = false;
+    Webviz::CLoadTest::SOptions sOptions;
+    std::string strExperiment;
+    unsigned int unRobots = 1000;
+
+    CCommandLineArgParser cParser;
+    cParser.AddFlag('h', "help", "shows this help", bHelp);
+    cParser.AddArgument<std::string>(
+      'u',
+      "url",
+      "webviz instance to load [ws://localhost:3000]",
+      sOptions.m_strURL);
+    cParser.AddArgument<std::string>(
+      'T',
+      "topics",
+      "topics of the clients [broadcasts,events,logs]",
+      sOptions.m_strTopics);
+    cParser.AddArgument<unsigned int>(
+      'c',
+      "clients",
+      "clients reading as fast as they can [100]",
+      sOptions.m_unClients);
+    cParser.AddArgument<unsigned int>(
+      's',
+      "slow-clients",
+      "clients reading at --slow-read-rate, in addition [0]",
+      sOptions.m_unSlowClients);
+    cParser.AddArgument<unsigned int>(
+      'r',
+      "slow-read-rate",
+      "bytes per second read by each slow client [65536]",
+      sOptions.m_unSlowReadRate);
+    cParser.AddArgument<unsigned int>(
+      'R',
+      "connect-rate",
+      "new connections per second [200]",
+      sOptions.m_unConnectRate);
+    cParser.AddArgument<unsigned int>(
+      'd',
+      "duration",
+      "seconds to run once all the clients are connected [60]",
+      sOptions.m_unDuration);
+    cParser.AddArgument<unsigned short>(
+      't',
+      "threads",
+      "event loops of the clients [1]",
+      sOptions.m_unThreads);
+    cParser.AddArgument<std::string>(
+      'g',
+      "generate-experiment",
+      "writes an experiment with --robots foot-bots to this file, and exits",
+      strExperiment);
+    cParser.AddArgument<unsigned int>(
+      'n', "robots", "foot-bots of the generated experiment [1000]", unRobots);
+    cParser.Parse(n_argc, ppch_argv);
+
+    if (bHelp) {
+      LOG << "Usage: argos3-webviz-loadtest [--url ws://host:port] "
+             "[options]\n\n";
+      cParser.PrintUsage(LOG);
+      LOG.Flush();
+      return 0;
+    }
+
+    if (!strExperiment.empty()) {
+      Webviz::CLoadTest::WriteExperiment(strExperiment, unRobots);
+      LOG << "[INFO] Wrote " << strExperiment << " with " << unRobots
+          << " foot-bots\n";
+      LOG.Flush();
+      return 0;
+    }
+
+    if (sOptions.m_unClients + sOptions.m_unSlowClients < 1) {
+      THROW_ARGOSEXCEPTION("At least one client is needed");
+    }
+
+    if (sOptions.m_unSlowReadRate < 1) {
+      THROW_ARGOSEXCEPTION("Slow read rate must be at least 1 byte/s");
+    }
+
+    if (sOptions.m_unConnectRate < 1) {
+      THROW_ARGOSEXCEPTION("Connect rate must be at least 1/s");
+    }
+
+    if (sOptions.m_unDuration < 1) {
+      THROW_ARGOSEXCEPTION("Duration must be at least 1s");
+    }
+
+    if (sOptions.m_unThreads < 1 || 64 < sOptions.m_unThreads) {
+      THROW_ARGOSEXCEPTION("Threads is out of range [1,64]");
+    }
+
+    Webviz::CLoadTest cLoadTest(std::move(sOptions));
+    cLoadTest.Execute();
+  } catch (CARGoSException& ex) {
+    LOGERR << "[FATAL] " << ex.what() << '\n';
+    LOGERR.Flush();
+    return 1;
+  }
+  return 0;
+}
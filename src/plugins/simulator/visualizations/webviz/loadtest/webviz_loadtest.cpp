@@ -0,0 +1,978 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/loadtest/webviz_loadtest.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#include "webviz_loadtest.h"
+
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/core/utility/logging/argos_log.h>
+#include <libusockets.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "../utility/Deflate.h"
+#include "../utility/WebSocketClient.h"
+
+namespace argos {
+  namespace Webviz {
+
+    namespace {
+      /** The server drops connections idle for 10s */
+      const std::chrono::seconds PING_EVERY(5);
+
+      /** Kernel receive buffer of the slow clients, small so the server
+       * sees them congested soon */
+      const int SLOW_RECEIVE_BUFFER = 16384;
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetUnixMilliseconds() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 std::chrono::system_clock::now().time_since_epoch())
+          .count();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Top level "timestamp" and "type" of a message in JSON text
+       *
+       * nlohmann::json sorts the keys and has no other key between these
+       * two, so they are found next to each other, without parsing the
+       * entities.
+       *
+       * @return false if they are not in the message
+       */
+      bool FindTimestampAndType(
+        const std::string& str_json,
+        uint64_t* un_timestamp,
+        std::string* str_type) {
+        static const std::string strTimestampKey = "\"timestamp\":";
+        static const std::string strTypeKey = ",\"type\":\"";
+
+        size_t unPos = str_json.rfind(strTimestampKey);
+        while (unPos != std::string::npos) {
+          const char* pchValue =
+            str_json.c_str() + unPos + strTimestampKey.size();
+          char* pchEnd;
+          uint64_t unTimestamp = std::strtoull(pchValue, &pchEnd, 10);
+          size_t unEnd = pchEnd - str_json.c_str();
+
+          if (
+            pchEnd != pchValue &&
+            str_json.compare(unEnd, strTypeKey.size(), strTypeKey) == 0) {
+            size_t unType = unEnd + strTypeKey.size();
+            size_t unQuote = str_json.find('"', unType);
+            if (unQuote == std::string::npos) {
+              return false;
+            }
+            *un_timestamp = unTimestamp;
+            *str_type = str_json.substr(unType, unQuote - unType);
+            return true;
+          }
+          /* Key of some user_data */
+          if (unPos == 0) {
+            break;
+          }
+          unPos = str_json.rfind(strTimestampKey, unPos - 1);
+        }
+        return false;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      std::string FormatBytes(double f_bytes) {
+        std::ostringstream cStream;
+        cStream << std::fixed << std::setprecision(1);
+        if (f_bytes >= 1024 * 1024 * 1024) {
+          cStream << f_bytes / (1024 * 1024 * 1024) << " GB";
+        } else if (f_bytes >= 1024 * 1024) {
+          cStream << f_bytes / (1024 * 1024) << " MB";
+        } else {
+          cStream << f_bytes / 1024 << " KB";
+        }
+        return cStream.str();
+      }
+    }  // namespace
+
+    /****************************************/
+    /****************************************/
+
+    /** Fast clients served by one event loop, only used from its thread */
+    struct CLoadTest::SLoop {
+      CLoadTest* m_pcLoadTest;
+
+      /** Clients of this loop which are not connected yet */
+      unsigned int m_unToConnect = 0;
+
+      /** Connections allowed by the ramp and not opened yet */
+      double m_fConnectBudget = 0;
+
+      std::chrono::steady_clock::time_point m_cLastPing;
+
+      struct us_socket_context_t* m_psContext = nullptr;
+
+      /** All the sockets, to close them at the end */
+      std::unordered_set<struct us_socket_t*> m_setSockets;
+
+      std::thread m_cThread;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /** State of a fast client, pointed to by the extension of its socket */
+    struct CLoadTest::SConnection {
+      SLoop* m_psLoop;
+
+      /** The server answered the upgrade request */
+      bool m_bUpgraded = false;
+
+      /** Received and not decoded yet */
+      std::string m_strBuffer;
+
+      /** Message being reassembled from fragments */
+      std::string m_strMessage;
+      bool m_bBinary = false;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    CLoadTest::CLoadTest(SOptions s_options)
+        : m_sOptions(std::move(s_options)),
+          m_unPort(0),
+          m_bRunning(false),
+          m_unFailed(0),
+          m_unClosed(0),
+          m_unLastDropped(0),
+          m_fPeakServerMemory(0) {
+      if (!CWebSocketClient::ParseURL(
+            m_sOptions.m_strURL, &m_strHost, &m_unPort, &m_strPath)) {
+        THROW_ARGOSEXCEPTION(
+          "Invalid URL \"" + m_sOptions.m_strURL +
+          "\", expected ws://host:port");
+      }
+      m_strPath =
+        m_strPath.substr(0, m_strPath.find('?')) + "?" + m_sOptions.m_strTopics;
+
+      /* Topics are split like the server does */
+      std::istringstream cTopics(m_sOptions.m_strTopics);
+      std::string strTopic;
+      while (std::getline(cTopics, strTopic, ',')) {
+        if (strTopic.compare(0, 11, "broadcasts.") == 0) {
+          m_strBinaryFormat = strTopic.substr(11);
+        }
+      }
+      if (
+        !m_strBinaryFormat.empty() && m_strBinaryFormat != "msgpack" &&
+        m_strBinaryFormat != "cbor" && m_strBinaryFormat != "deflate") {
+        THROW_ARGOSEXCEPTION(
+          "Unknown broadcast format \"" + m_strBinaryFormat + "\"");
+      }
+
+      for (unsigned short i = 0; i < m_sOptions.m_unThreads; ++i) {
+        m_vecLoops.push_back(std::make_unique<SLoop>());
+        m_vecLoops.back()->m_pcLoadTest = this;
+        m_vecLoops.back()->m_unToConnect =
+          m_sOptions.m_unClients / m_sOptions.m_unThreads +
+          (i < m_sOptions.m_unClients % m_sOptions.m_unThreads ? 1 : 0);
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CLoadTest::~CLoadTest() {
+      m_bRunning = false;
+      for (auto& pcLoop : m_vecLoops) {
+        if (pcLoop->m_cThread.joinable()) {
+          pcLoop->m_cThread.join();
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::Execute() {
+      m_bRunning = true;
+
+      LOG << "[INFO] Connecting " << m_sOptions.m_unClients << " clients";
+      if (m_sOptions.m_unSlowClients > 0) {
+        LOG << " and " << m_sOptions.m_unSlowClients << " slow ones ("
+            << FormatBytes(m_sOptions.m_unSlowReadRate) << "/s)";
+      }
+      LOG << " to " << m_strHost << ':' << m_unPort << m_strPath << '\n';
+      LOG.Flush();
+
+      for (auto& pcLoop : m_vecLoops) {
+        SLoop& sLoop = *pcLoop;
+        sLoop.m_cThread = std::thread([this, &sLoop]() {
+          LoopThreadFunction(sLoop);
+        });
+      }
+      std::thread tSlowThread([this]() { SlowThreadFunction(); });
+
+      /* The duration starts once all the clients had time to connect, fast
+       * and slow ones are connected at the same time */
+      unsigned int unClients =
+        std::max(m_sOptions.m_unClients, m_sOptions.m_unSlowClients);
+      auto cRamp = std::chrono::seconds(
+        (unClients + m_sOptions.m_unConnectRate - 1) /
+        m_sOptions.m_unConnectRate);
+      auto cStart = std::chrono::steady_clock::now();
+      auto cSteady = cStart + cRamp;
+      auto cEnd = cSteady + std::chrono::seconds(m_sOptions.m_unDuration);
+
+      SSnapshot sSteadyFast, sSteadySlow;
+      bool bSteady = false;
+      auto cLastReport = cStart;
+      while (std::chrono::steady_clock::now() < cEnd) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto cNow = std::chrono::steady_clock::now();
+        if (!bSteady && cNow >= cSteady) {
+          sSteadyFast = TakeSnapshot(m_sFast);
+          sSteadySlow = TakeSnapshot(m_sSlow);
+          cSteady = cNow;
+          bSteady = true;
+        }
+        Report(cNow - cStart, cNow - cLastReport);
+        cLastReport = cNow;
+      }
+
+      m_bRunning = false;
+      for (auto& pcLoop : m_vecLoops) {
+        pcLoop->m_cThread.join();
+      }
+      tSlowThread.join();
+
+      /* Summary of the steady part, without the ramp up */
+      SSnapshot sFast = TakeSnapshot(m_sFast);
+      SSnapshot sSlow = TakeSnapshot(m_sSlow);
+      double fSeconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                      cSteady)
+          .count();
+
+      std::ostringstream cStream;
+      cStream << std::fixed << std::setprecision(1);
+      cStream << "[INFO] Summary, over " << fSeconds << "s\n";
+      if (m_sOptions.m_unClients > 0) {
+        cStream << "  broadcasts/s per client "
+                << (sFast.m_unBroadcasts - sSteadyFast.m_unBroadcasts) /
+                     fSeconds / m_sOptions.m_unClients
+                << ", latency ms p50 " << GetQuantile(sSteadyFast, sFast, 0.5)
+                << " p90 " << GetQuantile(sSteadyFast, sFast, 0.9) << " p99 "
+                << GetQuantile(sSteadyFast, sFast, 0.99) << '\n';
+      }
+      if (m_sOptions.m_unSlowClients > 0) {
+        cStream << "  slow clients, broadcasts/s per client "
+                << (sSlow.m_unBroadcasts - sSteadySlow.m_unBroadcasts) /
+                     fSeconds / m_sOptions.m_unSlowClients
+                << ", latency ms p50 " << GetQuantile(sSteadySlow, sSlow, 0.5)
+                << " p99 " << GetQuantile(sSteadySlow, sSlow, 0.99) << '\n';
+      }
+      cStream << "  failed " << m_unFailed.load() << ", closed by the server "
+              << m_unClosed.load() << ", peak server memory "
+              << FormatBytes(m_fPeakServerMemory) << '\n';
+      LOG << cStream.str();
+      LOG.Flush();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::LoopThreadFunction(SLoop& s_loop) {
+      /* Set up thread-safe buffers for this new thread */
+      LOG.AddThreadSafeBuffer();
+      LOGERR.AddThreadSafeBuffer();
+
+      struct us_loop_t* psLoop = us_create_loop(
+        nullptr,
+        [](struct us_loop_t*) {},
+        [](struct us_loop_t*) {},
+        [](struct us_loop_t*) {},
+        0);
+
+      us_socket_context_options_t sOptions = {};
+      s_loop.m_psContext = us_create_socket_context(0, psLoop, 0, sOptions);
+      s_loop.m_cLastPing = std::chrono::steady_clock::now();
+
+      /* The extension of a socket holds a pointer to its state */
+      static auto fnGetState = [](struct us_socket_t* ps_socket) {
+        return *static_cast<SConnection**>(us_socket_ext(0, ps_socket));
+      };
+
+      us_socket_context_on_open(
+        0,
+        s_loop.m_psContext,
+        [](struct us_socket_t* ps_socket, int, char*, int) {
+          SConnection& sConnection = *fnGetState(ps_socket);
+          CLoadTest& cLoadTest = *sConnection.m_psLoop->m_pcLoadTest;
+
+          static thread_local std::mt19937 cRandom(std::random_device{}());
+          std::string strKey, strNonce(16, '\0');
+          for (auto& chByte : strNonce) {
+            chByte = static_cast<char>(cRandom());
+          }
+          Base64::Encode(strNonce, &strKey);
+          std::string strRequest = CWebSocketClient::EncodeUpgradeRequest(
+            cLoadTest.m_strHost,
+            cLoadTest.m_unPort,
+            cLoadTest.m_strPath,
+            strKey);
+          us_socket_write(
+            0, ps_socket, strRequest.data(), strRequest.size(), 0);
+          return ps_socket;
+        });
+
+      us_socket_context_on_data(
+        0,
+        s_loop.m_psContext,
+        [](struct us_socket_t* ps_socket, char* pch_data, int n_length) {
+          SConnection& sConnection = *fnGetState(ps_socket);
+          CLoadTest& cLoadTest = *sConnection.m_psLoop->m_pcLoadTest;
+          std::string& strBuffer = sConnection.m_strBuffer;
+          strBuffer.append(pch_data, n_length);
+
+          /* Answer headers, what follows is already websocket frames */
+          if (!sConnection.m_bUpgraded) {
+            size_t unEnd = strBuffer.find("\r\n\r\n");
+            if (unEnd == std::string::npos) {
+              return strBuffer.size() > 16384 ? us_socket_close(0, ps_socket)
+                                              : ps_socket;
+            }
+            if (strBuffer.compare(0, 12, "HTTP/1.1 101") != 0) {
+              return us_socket_close(0, ps_socket);
+            }
+            strBuffer.erase(0, unEnd + 4);
+            sConnection.m_bUpgraded = true;
+            ++cLoadTest.m_sFast.m_unConnected;
+          }
+
+          size_t unOffset = 0;
+          while (true) {
+            CWebSocketClient::SFrame sFrame;
+            size_t unUsed;
+            try {
+              unUsed = CWebSocketClient::DecodeFrame(
+                strBuffer.data() + unOffset,
+                strBuffer.size() - unOffset,
+                &sFrame);
+            } catch (const std::length_error&) {
+              return us_socket_close(0, ps_socket);
+            }
+            if (unUsed == 0) {
+              break;
+            }
+            unOffset += unUsed;
+
+            switch (sFrame.m_eOpCode) {
+              case CWebSocketClient::EOpCode::PING: {
+                std::string strPong = CWebSocketClient::EncodeFrame(
+                  CWebSocketClient::EOpCode::PONG, sFrame.m_strPayload);
+                us_socket_write(
+                  0, ps_socket, strPong.data(), strPong.size(), 0);
+                break;
+              }
+              case CWebSocketClient::EOpCode::PONG:
+                break;
+              case CWebSocketClient::EOpCode::CLOSE:
+                return us_socket_close(0, ps_socket);
+              case CWebSocketClient::EOpCode::CONTINUATION:
+                sConnection.m_strMessage += sFrame.m_strPayload;
+                break;
+              default:
+                sConnection.m_bBinary =
+                  sFrame.m_eOpCode == CWebSocketClient::EOpCode::BINARY;
+                sConnection.m_strMessage = std::move(sFrame.m_strPayload);
+                break;
+            }
+            if (
+              sFrame.m_bFin &&
+              (sFrame.m_eOpCode == CWebSocketClient::EOpCode::TEXT ||
+               sFrame.m_eOpCode == CWebSocketClient::EOpCode::BINARY ||
+               sFrame.m_eOpCode == CWebSocketClient::EOpCode::CONTINUATION)) {
+              cLoadTest.HandleMessage(
+                cLoadTest.m_sFast,
+                sConnection.m_strMessage,
+                sConnection.m_bBinary);
+              sConnection.m_strMessage.clear();
+            }
+          }
+          strBuffer.erase(0, unOffset);
+          return ps_socket;
+        });
+
+      us_socket_context_on_writable(
+        0, s_loop.m_psContext, [](struct us_socket_t* ps_socket) {
+          return ps_socket;
+        });
+
+      us_socket_context_on_timeout(
+        0, s_loop.m_psContext, [](struct us_socket_t* ps_socket) {
+          return ps_socket;
+        });
+
+      us_socket_context_on_end(
+        0, s_loop.m_psContext, [](struct us_socket_t* ps_socket) {
+          return us_socket_close(0, ps_socket);
+        });
+
+      /* Also called when connecting failed */
+      us_socket_context_on_close(
+        0, s_loop.m_psContext, [](struct us_socket_t* ps_socket) {
+          SConnection* psConnection = fnGetState(ps_socket);
+          SLoop& sLoop = *psConnection->m_psLoop;
+          CLoadTest& cLoadTest = *sLoop.m_pcLoadTest;
+          sLoop.m_setSockets.erase(ps_socket);
+
+          if (psConnection->m_bUpgraded) {
+            --cLoadTest.m_sFast.m_unConnected;
+          }
+          if (cLoadTest.m_bRunning) {
+            ++(psConnection->m_bUpgraded ? cLoadTest.m_unClosed
+                                         : cLoadTest.m_unFailed);
+          }
+          delete psConnection;
+          return ps_socket;
+        });
+
+      /* Ramps up, keeps the connections alive and stops the loop */
+      struct us_timer_t* psTimer = us_create_timer(psLoop, 0, sizeof(SLoop*));
+      *static_cast<SLoop**>(us_timer_ext(psTimer)) = &s_loop;
+      us_timer_set(
+        psTimer,
+        [](struct us_timer_t* ps_timer) {
+          SLoop& sLoop = **static_cast<SLoop**>(us_timer_ext(ps_timer));
+          CLoadTest& cLoadTest = *sLoop.m_pcLoadTest;
+
+          if (!cLoadTest.m_bRunning) {
+            /* Closing erases them from the set */
+            std::vector<struct us_socket_t*> vecSockets(
+              sLoop.m_setSockets.begin(), sLoop.m_setSockets.end());
+            for (auto* psSocket : vecSockets) {
+              us_socket_close(0, psSocket);
+            }
+            us_timer_close(ps_timer);
+            return;
+          }
+
+          sLoop.m_fConnectBudget = std::min<double>(
+            sLoop.m_fConnectBudget +
+              cLoadTest.m_sOptions.m_unConnectRate /
+                (10.0 * cLoadTest.m_vecLoops.size()),
+            sLoop.m_unToConnect);
+          while (sLoop.m_fConnectBudget >= 1) {
+            sLoop.m_fConnectBudget -= 1;
+            --sLoop.m_unToConnect;
+
+            struct us_socket_t* psSocket = us_socket_context_connect(
+              0,
+              sLoop.m_psContext,
+              cLoadTest.m_strHost.c_str(),
+              cLoadTest.m_unPort,
+              0,
+              sizeof(SConnection*));
+            if (psSocket == nullptr) {
+              ++cLoadTest.m_unFailed;
+              continue;
+            }
+            SConnection* psConnection = new SConnection();
+            psConnection->m_psLoop = &sLoop;
+            *static_cast<SConnection**>(us_socket_ext(0, psSocket)) =
+              psConnection;
+            sLoop.m_setSockets.insert(psSocket);
+          }
+
+          auto cNow = std::chrono::steady_clock::now();
+          if (cNow - sLoop.m_cLastPing >= PING_EVERY) {
+            static const std::string strPing = CWebSocketClient::EncodeFrame(
+              CWebSocketClient::EOpCode::PING, "");
+            for (auto* psSocket : sLoop.m_setSockets) {
+              if (fnGetState(psSocket)->m_bUpgraded) {
+                us_socket_write(0, psSocket, strPing.data(), strPing.size(), 0);
+              }
+            }
+            sLoop.m_cLastPing = cNow;
+          }
+        },
+        100,
+        100);
+
+      /* Returns once all the sockets and the timer are closed */
+      us_loop_run(psLoop);
+
+      us_socket_context_free(0, s_loop.m_psContext);
+      us_loop_free(psLoop);
+      LOG.Flush();
+      LOGERR.Flush();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::SlowThreadFunction() {
+      /* Set up thread-safe buffers for this new thread */
+      LOG.AddThreadSafeBuffer();
+      LOGERR.AddThreadSafeBuffer();
+
+      struct SSlowClient {
+        std::unique_ptr<CWebSocketClient> m_pcClient;
+
+        /** Bytes it can still read, refilled at m_unSlowReadRate */
+        double m_fBudget = 0;
+      };
+      std::vector<SSlowClient> vecClients;
+
+      unsigned int unToConnect = m_sOptions.m_unSlowClients;
+      double fConnectBudget = 0;
+      auto cLast = std::chrono::steady_clock::now();
+      auto cLastPing = cLast;
+      std::string strMessage;
+      bool bBinary;
+
+      while (m_bRunning) {
+        auto cNow = std::chrono::steady_clock::now();
+        double fElapsed = std::chrono::duration<double>(cNow - cLast).count();
+        cLast = cNow;
+
+        fConnectBudget = std::min<double>(
+          fConnectBudget + fElapsed * m_sOptions.m_unConnectRate, unToConnect);
+        while (fConnectBudget >= 1 && m_bRunning) {
+          fConnectBudget -= 1;
+          --unToConnect;
+
+          SSlowClient sClient;
+          sClient.m_pcClient = std::make_unique<CWebSocketClient>();
+          std::string strError;
+          if (!sClient.m_pcClient->Connect(
+                m_strHost,
+                m_unPort,
+                m_strPath,
+                &strError,
+                SLOW_RECEIVE_BUFFER)) {
+            ++m_unFailed;
+            continue;
+          }
+          ++m_sSlow.m_unConnected;
+          vecClients.push_back(std::move(sClient));
+        }
+
+        bool bPing = cNow - cLastPing >= PING_EVERY;
+        if (bPing) {
+          cLastPing = cNow;
+        }
+
+        auto itClient = vecClients.begin();
+        while (itClient != vecClients.end()) {
+          CWebSocketClient& cClient = *itClient->m_pcClient;
+          double& fBudget = itClient->m_fBudget;
+          fBudget = std::min<double>(
+            fBudget + fElapsed * m_sOptions.m_unSlowReadRate,
+            m_sOptions.m_unSlowReadRate);
+
+          CWebSocketClient::EReceived eReceived =
+            CWebSocketClient::EReceived::TIMEOUT;
+          while (fBudget > 0) {
+            eReceived = cClient.Receive(
+              &strMessage, &bBinary, std::chrono::milliseconds(0));
+            if (eReceived != CWebSocketClient::EReceived::MESSAGE) {
+              break;
+            }
+            fBudget -= strMessage.size();
+            HandleMessage(m_sSlow, strMessage, bBinary);
+          }
+          if (bPing) {
+            cClient.Send(CWebSocketClient::EOpCode::PING, "");
+          }
+
+          if (eReceived == CWebSocketClient::EReceived::CLOSED) {
+            --m_sSlow.m_unConnected;
+            ++m_unClosed;
+            itClient = vecClients.erase(itClient);
+          } else {
+            ++itClient;
+          }
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+
+      m_sSlow.m_unConnected = 0;
+      LOG.Flush();
+      LOGERR.Flush();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::HandleMessage(
+      SStats& s_stats, const std::string& str_message, bool b_binary) {
+      s_stats.m_unBytes += str_message.size();
+
+      uint64_t unTimestamp = 0;
+      std::string strType;
+      if (b_binary) {
+        try {
+          if (m_strBinaryFormat == "deflate") {
+            std::string strJSON;
+            if (!CDeflate::Inflate(str_message, &strJSON)) {
+              ++s_stats.m_unOthers;
+              return;
+            }
+            FindTimestampAndType(strJSON, &unTimestamp, &strType);
+          } else if (m_strBinaryFormat == "cbor") {
+            unTimestamp = nlohmann::json::from_cbor(str_message)
+                            .value("timestamp", uint64_t(0));
+          } else {
+            unTimestamp = nlohmann::json::from_msgpack(str_message)
+                            .value("timestamp", uint64_t(0));
+          }
+        } catch (const nlohmann::json::exception&) {
+          ++s_stats.m_unOthers;
+          return;
+        }
+        strType = "broadcast";
+      } else if (!FindTimestampAndType(str_message, &unTimestamp, &strType)) {
+        ++s_stats.m_unOthers;
+        return;
+      }
+
+      if (strType == "broadcast") {
+        ++s_stats.m_unBroadcasts;
+        uint64_t unNow = GetUnixMilliseconds();
+        s_stats.m_cLatency.Observe(
+          unNow > unTimestamp ? (unNow - unTimestamp) * 1000 : 0);
+      } else if (strType == "event") {
+        ++s_stats.m_unEvents;
+      } else if (strType == "log") {
+        ++s_stats.m_unLogs;
+      } else {
+        ++s_stats.m_unOthers;
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::Report(
+      std::chrono::steady_clock::duration c_elapsed,
+      std::chrono::steady_clock::duration c_interval) {
+      double fInterval = std::chrono::duration<double>(c_interval).count();
+      SSnapshot sFast = TakeSnapshot(m_sFast);
+      SSnapshot sSlow = TakeSnapshot(m_sSlow);
+
+      std::ostringstream cStream;
+      cStream << std::fixed << std::setprecision(1);
+      cStream << "[INFO] "
+              << std::chrono::duration_cast<std::chrono::seconds>(c_elapsed)
+                   .count()
+              << "s | clients " << m_sFast.m_unConnected.load() << " + "
+              << m_sSlow.m_unConnected.load() << " slow | failed "
+              << m_unFailed.load() << " | closed " << m_unClosed.load()
+              << " | "
+              << FormatBytes(
+                   (sFast.m_unBytes - m_sLastFast.m_unBytes +
+                    sSlow.m_unBytes - m_sLastSlow.m_unBytes) /
+                   fInterval)
+              << "/s\n";
+
+      uint64_t unFast = std::max<uint64_t>(m_sFast.m_unConnected, 1);
+      cStream << "  broadcasts/s per client "
+              << (sFast.m_unBroadcasts - m_sLastFast.m_unBroadcasts) /
+                   fInterval / unFast
+              << " | latency ms p50 " << GetQuantile(m_sLastFast, sFast, 0.5)
+              << " p90 " << GetQuantile(m_sLastFast, sFast, 0.9) << " p99 "
+              << GetQuantile(m_sLastFast, sFast, 0.99) << " | events/s "
+              << (sFast.m_unEvents - m_sLastFast.m_unEvents) / fInterval
+              << " | logs/s "
+              << (sFast.m_unLogs - m_sLastFast.m_unLogs) / fInterval << '\n';
+
+      if (m_sOptions.m_unSlowClients > 0) {
+        uint64_t unSlow = std::max<uint64_t>(m_sSlow.m_unConnected, 1);
+        cStream << "  slow, broadcasts/s per client "
+                << (sSlow.m_unBroadcasts - m_sLastSlow.m_unBroadcasts) /
+                     fInterval / unSlow
+                << " | latency ms p50 " << GetQuantile(m_sLastSlow, sSlow, 0.5)
+                << " p99 " << GetQuantile(m_sLastSlow, sSlow, 0.99) << '\n';
+      }
+
+      std::map<std::string, double> mapServer = FetchServerMetrics();
+      if (mapServer.empty()) {
+        cStream << "  server metrics not available\n";
+      } else {
+        double fMemory = mapServer["process_resident_memory_bytes"];
+        double fDropped = mapServer["webviz_dropped_frames_total"];
+        m_fPeakServerMemory = std::max(m_fPeakServerMemory, fMemory);
+        cStream << "  server memory " << FormatBytes(fMemory)
+                << " | buffered "
+                << FormatBytes(mapServer["webviz_client_buffered_bytes"])
+                << ", max "
+                << FormatBytes(mapServer["webviz_client_buffered_bytes_max"])
+                << " | dropped frames/s "
+                << (fDropped - m_unLastDropped) / fInterval << '\n';
+        m_unLastDropped = static_cast<uint64_t>(fDropped);
+      }
+
+      LOG << cStream.str();
+      LOG.Flush();
+      m_sLastFast = sFast;
+      m_sLastSlow = sSlow;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    std::map<std::string, double> CLoadTest::FetchServerMetrics() const {
+      std::map<std::string, double> mapMetrics;
+
+      struct addrinfo sHints = {};
+      sHints.ai_family = AF_UNSPEC;
+      sHints.ai_socktype = SOCK_STREAM;
+      struct addrinfo* psAddresses = nullptr;
+      if (
+        getaddrinfo(
+          m_strHost.c_str(),
+          std::to_string(m_unPort).c_str(),
+          &sHints,
+          &psAddresses) != 0) {
+        return mapMetrics;
+      }
+      int nSocket = -1;
+      for (auto* ps = psAddresses; ps != nullptr; ps = ps->ai_next) {
+        nSocket = socket(ps->ai_family, ps->ai_socktype, ps->ai_protocol);
+        if (nSocket < 0) {
+          continue;
+        }
+        if (connect(nSocket, ps->ai_addr, ps->ai_addrlen) == 0) {
+          break;
+        }
+        close(nSocket);
+        nSocket = -1;
+      }
+      freeaddrinfo(psAddresses);
+      if (nSocket < 0) {
+        return mapMetrics;
+      }
+
+      std::string strRequest = "GET /metrics HTTP/1.1\r\nHost: " + m_strHost +
+                               "\r\nConnection: close\r\n\r\n";
+      send(nSocket, strRequest.data(), strRequest.size(), MSG_NOSIGNAL);
+
+      /* Until the whole body, as the server may keep the connection */
+      std::string strAnswer;
+      size_t unBodyEnd = std::string::npos;
+      char pchBuffer[16384];
+      while (strAnswer.size() < unBodyEnd) {
+        struct pollfd sPoll = {nSocket, POLLIN, 0};
+        if (poll(&sPoll, 1, 1000) <= 0) {
+          break;
+        }
+        ssize_t nRead = recv(nSocket, pchBuffer, sizeof(pchBuffer), 0);
+        if (nRead <= 0) {
+          break;
+        }
+        strAnswer.append(pchBuffer, nRead);
+
+        size_t unHeaders = strAnswer.find("\r\n\r\n");
+        size_t unLength = strAnswer.find("Content-Length: ");
+        if (
+          unBodyEnd == std::string::npos && unHeaders != std::string::npos &&
+          unLength != std::string::npos && unLength < unHeaders) {
+          unBodyEnd =
+            unHeaders + 4 + std::strtoull(strAnswer.c_str() + unLength + 16,
+                                          nullptr,
+                                          10);
+        }
+      }
+      close(nSocket);
+
+      size_t unHeaders = strAnswer.find("\r\n\r\n");
+      if (
+        strAnswer.compare(0, 12, "HTTP/1.1 200") != 0 ||
+        unHeaders == std::string::npos) {
+        return mapMetrics;
+      }
+
+      /* "name value" lines, labels and comments are skipped */
+      std::istringstream cLines(strAnswer.substr(unHeaders + 4));
+      std::string strLine;
+      while (std::getline(cLines, strLine)) {
+        size_t unSpace = strLine.find(' ');
+        if (
+          strLine.empty() || strLine[0] == '#' ||
+          unSpace == std::string::npos ||
+          strLine.find('{') < unSpace) {
+          continue;
+        }
+        mapMetrics[strLine.substr(0, unSpace)] =
+          std::strtod(strLine.c_str() + unSpace + 1, nullptr);
+      }
+      return mapMetrics;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CLoadTest::SSnapshot CLoadTest::TakeSnapshot(const SStats& s_stats) {
+      SSnapshot sSnapshot;
+      sSnapshot.m_unBroadcasts = s_stats.m_unBroadcasts;
+      sSnapshot.m_unEvents = s_stats.m_unEvents;
+      sSnapshot.m_unLogs = s_stats.m_unLogs;
+      sSnapshot.m_unBytes = s_stats.m_unBytes;
+      for (size_t i = 0; i <= CHistogram::BUCKETS; ++i) {
+        sSnapshot.m_punLatency[i] = s_stats.m_cLatency.GetBucket(i);
+      }
+      return sSnapshot;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    double CLoadTest::GetQuantile(
+      const SSnapshot& s_from, const SSnapshot& s_to, double f_quantile) {
+      uint64_t unTotal = 0;
+      for (size_t i = 0; i <= CHistogram::BUCKETS; ++i) {
+        unTotal += s_to.m_punLatency[i] - s_from.m_punLatency[i];
+      }
+      if (unTotal == 0) {
+        return -1;
+      }
+
+      uint64_t unRank =
+        static_cast<uint64_t>(std::ceil(f_quantile * unTotal));
+      uint64_t unCumulative = 0;
+      for (size_t i = 0; i < CHistogram::BUCKETS; ++i) {
+        unCumulative += s_to.m_punLatency[i] - s_from.m_punLatency[i];
+        if (unCumulative >= unRank) {
+          return CHistogram::BOUNDS[i] / 1000.0;
+        }
+      }
+      /* Above the last bucket */
+      return INFINITY;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CLoadTest::WriteExperiment(
+      const std::string& str_file, unsigned int un_robots) {
+      std::ofstream cFile(str_file);
+      if (!cFile) {
+        THROW_ARGOSEXCEPTION("Can not write \"" + str_file + "\"");
+      }
+
+      /* About one foot-bot per square meter, inside the walls */
+      int nHalf = static_cast<int>(std::ceil(std::sqrt(un_robots) / 2)) + 1;
+      std::string strHalf = std::to_string(nHalf);
+      std::string strSide = std::to_string(2 * nHalf);
+      std::string strArena = std::to_string(2 * nHalf + 1);
+
+      cFile << "<?xml version=\"1.0\" ?>\n"
+               "<!-- Written by argos3-webviz-loadtest, with "
+            << un_robots
+            << " foot-bots -->\n"
+               "<argos-configuration>\n"
+               "  <framework>\n"
+               "    <system threads=\"0\" />\n"
+               "    <experiment length=\"0\" ticks_per_second=\"10\" "
+               "random_seed=\"124\" />\n"
+               "  </framework>\n\n"
+               "  <controllers>\n"
+               "    <footbot_diffusion_controller id=\"fdc\" "
+               "library=\"build/testing/controllers/libfootbot_diffusion\">\n"
+               "      <actuators>\n"
+               "        <differential_steering implementation=\"default\" "
+               "/>\n"
+               "      </actuators>\n"
+               "      <sensors>\n"
+               "        <footbot_proximity implementation=\"default\" "
+               "show_rays=\"true\" />\n"
+               "      </sensors>\n"
+               "      <params alpha=\"7.5\" delta=\"0.1\" velocity=\"5\" />\n"
+               "    </footbot_diffusion_controller>\n"
+               "  </controllers>\n\n"
+               "  <arena size=\""
+            << strArena << ", " << strArena
+            << ", 1\" center=\"0,0,0.5\">\n"
+               "    <box id=\"wall_north\" size=\""
+            << strSide
+            << ",0.1,0.5\" movable=\"false\">\n"
+               "      <body position=\"0,"
+            << strHalf
+            << ",0\" orientation=\"0,0,0\" />\n"
+               "    </box>\n"
+               "    <box id=\"wall_south\" size=\""
+            << strSide
+            << ",0.1,0.5\" movable=\"false\">\n"
+               "      <body position=\"0,-"
+            << strHalf
+            << ",0\" orientation=\"0,0,0\" />\n"
+               "    </box>\n"
+               "    <box id=\"wall_east\" size=\"0.1,"
+            << strSide
+            << ",0.5\" movable=\"false\">\n"
+               "      <body position=\""
+            << strHalf
+            << ",0,0\" orientation=\"0,0,0\" />\n"
+               "    </box>\n"
+               "    <box id=\"wall_west\" size=\"0.1,"
+            << strSide
+            << ",0.5\" movable=\"false\">\n"
+               "      <body position=\"-"
+            << strHalf
+            << ",0,0\" orientation=\"0,0,0\" />\n"
+               "    </box>\n\n"
+               "    <distribute>\n"
+               "      <position method=\"uniform\" min=\"-"
+            << strHalf << ",-" << strHalf << ",0\" max=\"" << strHalf << ","
+            << strHalf
+            << ",0\" />\n"
+               "      <orientation method=\"gaussian\" mean=\"0,0,0\" "
+               "std_dev=\"360,0,0\" />\n"
+               "      <entity quantity=\""
+            << un_robots
+            << "\" max_trials=\"100\">\n"
+               "        <foot-bot id=\"fb\">\n"
+               "          <controller config=\"fdc\" />\n"
+               "        </foot-bot>\n"
+               "      </entity>\n"
+               "    </distribute>\n"
+               "  </arena>\n\n"
+               "  <physics_engines>\n"
+               "    <dynamics2d id=\"dyn2d\" />\n"
+               "  </physics_engines>\n\n"
+               "  <media />\n\n"
+               "  <visualization>\n"
+               "    <webviz />\n"
+               "  </visualization>\n"
+               "</argos-configuration>\n";
+    }
+  }  // namespace Webviz
+}  // namespace argos
@@ -0,0 +1,203 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/loadtest/webviz_loadtest.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_LOADTEST_H
+#define ARGOS_WEBVIZ_LOADTEST_H
+
+namespace argos {
+  namespace Webviz {
+    class CLoadTest;
+  }  // namespace Webviz
+}  // namespace argos
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../utility/Metrics.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Opens many websocket connections to a webviz instance, and
+     * reports what they receive
+     *
+     * The clients are served by uSockets event loops, and read everything
+     * as soon as it arrives. Slow clients are plain sockets with a small
+     * receive buffer, read at a fixed rate from one thread, so the server
+     * sees them push back as congested browsers would.
+     *
+     * Every second, it reports the broadcasts delivered per client, the
+     * latency from their "timestamp" to their receipt, and what the server
+     * exposes on "GET /metrics" (memory, buffered bytes, dropped frames).
+     * Latencies are only meaningful when the clock of the server is the
+     * same (same machine) or synchronized.
+     */
+    class CLoadTest {
+     public:
+      struct SOptions {
+        /** Webviz instance to load, like "ws://localhost:3000" */
+        std::string m_strURL = "ws://localhost:3000";
+
+        /** Topics of all the clients, as in the query of the URL */
+        std::string m_strTopics = "broadcasts,events,logs";
+
+        /** Clients reading as fast as they can */
+        unsigned int m_unClients = 100;
+
+        /** Clients reading at m_unSlowReadRate, in addition */
+        unsigned int m_unSlowClients = 0;
+
+        /** Bytes per second read by each slow client */
+        unsigned int m_unSlowReadRate = 64 * 1024;
+
+        /** New connections per second, to ramp up */
+        unsigned int m_unConnectRate = 200;
+
+        /** Seconds to run, after all the clients connected */
+        unsigned int m_unDuration = 60;
+
+        /** Event loops of the fast clients */
+        unsigned short m_unThreads = 1;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Throws CARGoSException if the URL is not valid */
+      explicit CLoadTest(SOptions s_options);
+
+      ~CLoadTest();
+
+      CLoadTest(const CLoadTest&) = delete;
+      CLoadTest& operator=(const CLoadTest&) = delete;
+
+      /**
+       * @brief Connects the clients and reports, blocking for the
+       * duration of the test
+       */
+      void Execute();
+
+      /**
+       * @brief Writes an experiment with a swarm of foot-bots, to load the
+       * server with big broadcasts
+       *
+       * The foot-bots use the diffusion controller of src/testing, so the
+       * experiment must be run from the root of the repository, like
+       * testexperiment.argos.
+       */
+      static void WriteExperiment(
+        const std::string& str_file, unsigned int un_robots);
+
+     private:
+      /** What a kind of client (fast or slow) received */
+      struct SStats {
+        std::atomic<uint64_t> m_unConnected{0};
+        std::atomic<uint64_t> m_unBroadcasts{0};
+        std::atomic<uint64_t> m_unEvents{0};
+        std::atomic<uint64_t> m_unLogs{0};
+        std::atomic<uint64_t> m_unOthers{0};
+        std::atomic<uint64_t> m_unBytes{0};
+
+        /** From the "timestamp" of the broadcasts to their receipt */
+        CHistogram m_cLatency;
+      };
+
+      /** Values read from a histogram, to report what changed since */
+      struct SSnapshot {
+        uint64_t m_unBroadcasts = 0;
+        uint64_t m_unEvents = 0;
+        uint64_t m_unLogs = 0;
+        uint64_t m_unBytes = 0;
+        uint64_t m_punLatency[CHistogram::BUCKETS + 1] = {};
+      };
+
+      struct SLoop;
+      struct SConnection;
+
+      /****************************************/
+      /****************************************/
+
+      /** Runs one event loop of fast clients, until m_bRunning is false */
+      void LoopThreadFunction(SLoop& s_loop);
+
+      /** Connects and reads the slow clients, until m_bRunning is false */
+      void SlowThreadFunction();
+
+      /**
+       * @brief Counts a message received by a client
+       *
+       * Text messages are not parsed, as nlohmann::json sorts the keys and
+       * "timestamp" and "type" come last. Binary ones are always
+       * broadcasts, in the format of m_strTopics.
+       */
+      void HandleMessage(
+        SStats& s_stats, const std::string& str_message, bool b_binary);
+
+      /** Prints what changed since the last report */
+      void Report(
+        std::chrono::steady_clock::duration c_elapsed,
+        std::chrono::steady_clock::duration c_interval);
+
+      /** Values of the server, from "GET /metrics", empty if it failed */
+      std::map<std::string, double> FetchServerMetrics() const;
+
+      static SSnapshot TakeSnapshot(const SStats& s_stats);
+
+      /**
+       * @brief Latency under which a fraction of the broadcasts arrived,
+       * between two snapshots
+       *
+       * @return upper bound of the bucket, in milli-secs, -1 if nothing
+       * was observed
+       */
+      static double GetQuantile(
+        const SSnapshot& s_from, const SSnapshot& s_to, double f_quantile);
+
+     private:
+      SOptions m_sOptions;
+
+      /** Address, from m_strURL */
+      std::string m_strHost;
+      uint16_t m_unPort;
+      std::string m_strPath;
+
+      /** Format of the broadcasts, "" for JSON text */
+      std::string m_strBinaryFormat;
+
+      std::atomic<bool> m_bRunning;
+
+      std::vector<std::unique_ptr<SLoop>> m_vecLoops;
+
+      SStats m_sFast;
+      SStats m_sSlow;
+
+      /** Connections which failed, or were closed by the server */
+      std::atomic<uint64_t> m_unFailed;
+      std::atomic<uint64_t> m_unClosed;
+
+      /** Reported last */
+      SSnapshot m_sLastFast;
+      SSnapshot m_sLastSlow;
+      uint64_t m_unLastDropped;
+
+      /** Highest resident memory of the server which was reported */
+      double m_fPeakServerMemory;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/relay/main.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/core/utility/configuration/command_line_arg_parser.h>
+#include <argos3/core/utility/logging/argos_log.h>
+
+#include <string>
+
+#include "webviz_relay.h"
+
+using namespace argos;
+
+int main(int n_argc, char** ppch_argv) {
+  try {
+    bool bHelp = false;
+    Webviz::CRelay::SOptions sOptions;
+
+    CCommandLineArgParser cParser;
+    cParser.AddFlag('h', "help", "shows this help", bHelp);
+    cParser.AddArgument<std::string>(
+      'u',
+      "upstream",
+      "webviz instance to relay, like ws://sim-node:3000",
+      sOptions.m_strUpstream);
+    cParser.AddArgument<unsigned short>(
+      'p', "port", "port the clients connect to [3100]", sOptions.m_unPort);
+    cParser.AddArgument<unsigned short>(
+      'f',
+      "broadcast-frequency",
+      "broadcasts per second to the clients [10]",
+      sOptions.m_unBroadcastFrequency);
+    cParser.AddArgument<unsigned short>(
+      'k',
+      "keyframe-every",
+      "keyframe every N broadcasts to the clients, deltas in between [1]",
+      sOptions.m_unKeyframeEvery);
+    cParser.AddArgument<unsigned short>(
+      't',
+      "server-threads",
+      "threads serving the clients [1]",
+      sOptions.m_unServerThreads);
+    cParser.AddArgument<std::string>(
+      'K', "ssl-key", "SSL private key file", sOptions.m_strKeyFile);
+    cParser.AddArgument<std::string>(
+      'C', "ssl-cert", "SSL certificate file", sOptions.m_strCertFile);
+    cParser.AddArgument<std::string>(
+      'D', "ssl-dh-params", "SSL DH params file", sOptions.m_strDHParamsFile);
+    cParser.AddArgument<std::string>(
+      'A', "ssl-ca", "SSL CA file", sOptions.m_strCAFile);
+    cParser.AddArgument<std::string>(
+      'P',
+      "ssl-passphrase",
+      "SSL certificate passphrase",
+      sOptions.m_strCertPassphrase);
+    cParser.Parse(n_argc, ppch_argv);
+
+    if (bHelp || sOptions.m_strUpstream.empty()) {
+      LOG << "Usage: argos3-webviz-relay --upstream ws://host:port "
+             "[options]\n\n";
+      cParser.PrintUsage(LOG);
+      LOG.Flush();
+      return bHelp ? 0 : 1;
+    }
+
+    if (sOptions.m_unBroadcastFrequency < 1 ||
+        1000 < sOptions.m_unBroadcastFrequency) {
+      THROW_ARGOSEXCEPTION("Broadcast frequency is out of range [1,1000]");
+    }
+
+    if (sOptions.m_unKeyframeEvery < 1 || 1000 < sOptions.m_unKeyframeEvery) {
+      THROW_ARGOSEXCEPTION("Keyframe interval is out of range [1,1000]");
+    }
+
+    if (sOptions.m_unServerThreads < 1 || 64 < sOptions.m_unServerThreads) {
+      THROW_ARGOSEXCEPTION("Server threads is out of range [1,64]");
+    }
+
+    Webviz::CRelay cRelay(std::move(sOptions));
+    cRelay.Execute();
+  } catch (CARGoSException& ex) {
+    LOGERR << "[FATAL] " << ex.what() << '\n';
+    LOGERR.Flush();
+    return 1;
+  }
+  return 0;
+}
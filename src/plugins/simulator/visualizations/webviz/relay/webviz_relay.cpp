@@ -0,0 +1,409 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/relay/webviz_relay.cpp>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#include "webviz_relay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "../utility/DeltaEncoder.h"
+#include "../utility/PortCheck.h"
+
+namespace argos {
+  namespace Webviz {
+
+    /****************************************/
+    /****************************************/
+
+    CRelay::CRelay(SOptions s_options)
+        : m_sOptions(std::move(s_options)),
+          m_unUpstreamPort(0),
+          m_unSequence(0),
+          m_unVersion(0),
+          m_unBroadcastVersion(0),
+          m_bWaitingKeyframe(false),
+          m_unLastCommandId(0) {
+      if (!CWebSocketClient::ParseURL(
+            m_sOptions.m_strUpstream,
+            &m_strHost,
+            &m_unUpstreamPort,
+            &m_strPath)) {
+        THROW_ARGOSEXCEPTION(
+          "Invalid upstream \"" + m_sOptions.m_strUpstream +
+          "\", expected ws://host:port");
+      }
+
+      /* Full states in MessagePack, the smallest for the relay to decode */
+      m_strPath =
+        m_strPath.substr(0, m_strPath.find('?')) +
+        "?broadcasts.msgpack,events,logs";
+
+      if (!PortChecker::CheckPortTCPisAvailable(m_sOptions.m_unPort)) {
+        THROW_ARGOSEXCEPTION(
+          "Port " + std::to_string(m_sOptions.m_unPort) + " already in use");
+      }
+
+      m_pcWebServer = std::make_unique<CWebServer>(
+        [this](SClientCommand s_command) {
+          ForwardCommand(std::move(s_command));
+        },
+        m_sOptions.m_unPort,
+        m_sOptions.m_unBroadcastFrequency,
+        m_sOptions.m_unKeyframeEvery,
+        m_sOptions.m_strKeyFile,
+        m_sOptions.m_strCertFile,
+        m_sOptions.m_strDHParamsFile,
+        m_sOptions.m_strCAFile,
+        m_sOptions.m_strCertPassphrase);
+      m_pcWebServer->SetServerThreads(m_sOptions.m_unServerThreads);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CRelay::~CRelay() { m_cUpstream.Close(); }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::Execute() {
+      /* To manage all threads to exit gracefully */
+      std::atomic<bool> bIsServerRunning{true};
+
+      std::thread tUpstreamThread(
+        [&]() { UpstreamThreadFunction(bIsServerRunning); });
+
+      /* Start WebServer */
+      m_pcWebServer->Start(bIsServerRunning);  // blocking the thread
+
+      bIsServerRunning = false;
+      tUpstreamThread.join();
+
+      /* Cleanup */
+      LOG.Flush();
+      LOGERR.Flush();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::UpstreamThreadFunction(
+      const std::atomic<bool> &b_IsServerRunning) {
+      /* Set up thread-safe buffers for this new thread */
+      LOG.AddThreadSafeBuffer();
+      LOGERR.AddThreadSafeBuffer();
+
+      /* Doubles after each failed attempt, up to the maximum */
+      const std::chrono::milliseconds cMaxRetryDelay(8000);
+      std::chrono::milliseconds cRetryDelay(500);
+
+      /* The upstream drops connections idle for 10s */
+      const std::chrono::seconds cPingEvery(5);
+
+      while (b_IsServerRunning) {
+        std::string strError;
+        if (!m_cUpstream.Connect(
+              m_strHost, m_unUpstreamPort, m_strPath, &strError)) {
+          LOGERR << "[WARNING] Can not connect to upstream "
+                 << m_sOptions.m_strUpstream << ": " << strError << '\n';
+          LOGERR.Flush();
+          std::this_thread::sleep_for(cRetryDelay);
+          cRetryDelay = std::min(cRetryDelay * 2, cMaxRetryDelay);
+          continue;
+        }
+        cRetryDelay = std::chrono::milliseconds(500);
+        LOG << "[INFO] Relaying " << m_sOptions.m_strUpstream << '\n';
+        LOG.Flush();
+
+        /* New subscriber of the upstream, which starts with a keyframe */
+        m_unSequence = 0;
+        m_bWaitingKeyframe = false;
+        m_cForwardedMask = CBroadcastMask();
+        m_cForwardedRayLOD = CRayLOD();
+
+        auto cLastPing = std::chrono::steady_clock::now();
+        std::string strMessage;
+        bool bBinary = false;
+
+        while (b_IsServerRunning) {
+          CWebSocketClient::EReceived eReceived = m_cUpstream.Receive(
+            &strMessage, &bBinary, std::chrono::milliseconds(100));
+          if (eReceived == CWebSocketClient::EReceived::CLOSED) {
+            break;
+          }
+
+          if (eReceived == CWebSocketClient::EReceived::MESSAGE) {
+            try {
+              HandleUpstreamMessage(
+                bBinary ? nlohmann::json::from_msgpack(strMessage)
+                        : nlohmann::json::parse(strMessage));
+            } catch (const nlohmann::json::exception &e) {
+              LOGERR << "[ERROR] Invalid message from upstream: " << e.what()
+                     << '\n';
+            }
+          }
+
+          ForwardWantedMask();
+          BroadcastIfWanted();
+
+          auto cNow = std::chrono::steady_clock::now();
+          if (cNow - cLastPing >= cPingEvery) {
+            m_cUpstream.Send(CWebSocketClient::EOpCode::PING, "");
+            cLastPing = cNow;
+          }
+
+          LOG.Flush();
+          LOGERR.Flush();
+        }
+
+        m_cUpstream.Close();
+        FailPendingCommands("upstream disconnected");
+
+        if (b_IsServerRunning) {
+          LOGERR << "[WARNING] Upstream " << m_sOptions.m_strUpstream
+                 << " disconnected, reconnecting\n";
+          LOGERR.Flush();
+
+          nlohmann::json cEvent;
+          cEvent["event"] = "Upstream disconnected";
+          if (m_cState.is_object()) {
+            if (m_cState.contains("state")) {
+              cEvent["state"] = m_cState["state"];
+            }
+            cEvent["step"] = m_cState.value("steps", 0ull);
+          }
+          m_pcWebServer->EmitEvent(std::move(cEvent));
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::HandleUpstreamMessage(nlohmann::json c_message) {
+      if (!c_message.is_object()) {
+        return;
+      }
+      std::string strType = c_message.value("type", "");
+
+      if (strType == "broadcast") {
+        HandleUpstreamBroadcast(std::move(c_message));
+
+      } else if (strType == "event") {
+        /* Batched again by the webserver of the relay, keeping the steps
+         * of the upstream, and tagged with the sequences of the relay */
+        auto itEvents = c_message.find("events");
+        if (itEvents != c_message.end() && itEvents->is_array()) {
+          for (auto &cEvent : *itEvents) {
+            if (cEvent.is_object()) {
+              cEvent.erase("sequence");
+              m_pcWebServer->EmitEvent(std::move(cEvent));
+            }
+          }
+        }
+
+      } else if (strType == "log") {
+        /* Entries are batched again by the webserver of the relay */
+        auto itMessages = c_message.find("messages");
+        if (itMessages != c_message.end() && itMessages->is_array()) {
+          for (auto &cEntry : *itMessages) {
+            m_pcWebServer->EmitLog(std::move(cEntry));
+          }
+        }
+
+      } else if (strType == "ack") {
+        HandleUpstreamAck(std::move(c_message));
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::HandleUpstreamBroadcast(nlohmann::json c_frame) {
+      uint64_t unSequence = c_frame.value("sequence", 0ull);
+      bool bKeyframe = c_frame.value("keyframe", true);
+
+      /* A delta only applies on top of the frame just before it */
+      if (!bKeyframe && (m_unSequence == 0 || unSequence != m_unSequence + 1)) {
+        if (!m_bWaitingKeyframe) {
+          LOGERR << "[WARNING] Missed frames from upstream, resynchronizing\n";
+          SendUpstream({{"command", "requestKeyframe"}});
+          m_bWaitingKeyframe = true;
+        }
+        return;
+      }
+
+      CDeltaEncoder::Apply(m_cState, c_frame);
+      m_unSequence = unSequence;
+      m_bWaitingKeyframe = false;
+      ++m_unVersion;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::HandleUpstreamAck(nlohmann::json c_ack) {
+      auto itId = c_ack.find("id");
+      if (itId == c_ack.end() || !itId->is_number_unsigned()) {
+        return;
+      }
+
+      SPendingCommand sPending;
+      /* Mutex block for m_mutex4Pending */
+      {
+        std::lock_guard<std::mutex> guard(m_mutex4Pending);
+        auto itPending = m_mapPending.find(itId->get<uint64_t>());
+        if (itPending == m_mapPending.end()) {
+          /* A command of the relay itself */
+          return;
+        }
+        sPending = std::move(itPending->second);
+        m_mapPending.erase(itPending);
+      }  // End of mutex block: m_mutex4Pending
+
+      /* Back to the id the client chose, if any */
+      if (sPending.m_cId.is_null()) {
+        c_ack.erase("id");
+      } else {
+        c_ack["id"] = std::move(sPending.m_cId);
+      }
+      m_pcWebServer->SendToClient(sPending.m_unClientId, c_ack.dump());
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::ForwardCommand(SClientCommand s_command) {
+      nlohmann::json &cCommand = s_command.m_cCommand;
+      nlohmann::json cId;
+      if (cCommand.is_object() && cCommand.contains("id")) {
+        cId = cCommand["id"];
+      }
+
+      std::string strError;
+      uint64_t unId = ++m_unLastCommandId;
+      if (!cCommand.is_object()) {
+        strError = "command must be an object";
+      } else if (!m_cUpstream.IsConnected()) {
+        strError = "upstream not connected";
+      } else {
+        std::lock_guard<std::mutex> guard(m_mutex4Pending);
+        if (m_mapPending.size() >= MAX_PENDING_COMMANDS) {
+          strError = "too many commands waiting for upstream";
+        } else {
+          m_mapPending[unId] = SPendingCommand{s_command.m_unClientId, cId};
+        }
+      }
+
+      if (strError.empty()) {
+        cCommand["id"] = unId;
+        if (m_cUpstream.Send(
+              CWebSocketClient::EOpCode::TEXT, cCommand.dump())) {
+          return;
+        }
+        std::lock_guard<std::mutex> guard(m_mutex4Pending);
+        if (m_mapPending.erase(unId) == 0) {
+          /* Already failed by the upstream thread */
+          return;
+        }
+        strError = "upstream not connected";
+      }
+
+      m_pcWebServer->SendToClient(
+        s_command.m_unClientId, MakeFailedAck(cId, strError).dump());
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::FailPendingCommands(const std::string &str_error) {
+      std::unordered_map<uint64_t, SPendingCommand> mapPending;
+      /* Mutex block for m_mutex4Pending */
+      {
+        std::lock_guard<std::mutex> guard(m_mutex4Pending);
+        mapPending.swap(m_mapPending);
+      }  // End of mutex block: m_mutex4Pending
+
+      for (auto &cPair : mapPending) {
+        m_pcWebServer->SendToClient(
+          cPair.second.m_unClientId,
+          MakeFailedAck(cPair.second.m_cId, str_error).dump());
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::ForwardWantedMask() {
+      CBroadcastMask cMask = m_pcWebServer->GetWantedMask();
+      if (cMask != m_cForwardedMask) {
+        nlohmann::json cCommand = cMask.ToJSON();
+        cCommand["command"] = "setFilter";
+        SendUpstream(std::move(cCommand));
+        m_cForwardedMask = cMask;
+      }
+
+      CRayLOD cRayLOD = m_pcWebServer->GetWantedRayLOD();
+      if (cRayLOD != m_cForwardedRayLOD) {
+        nlohmann::json cCommand = cRayLOD.ToJSON();
+        cCommand["command"] = "setRays";
+        SendUpstream(std::move(cCommand));
+        m_cForwardedRayLOD = cRayLOD;
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::BroadcastIfWanted() {
+      /* The broadcaster did not consume the last state yet */
+      if (m_cState.is_null() || !m_pcWebServer->IsBroadcastWanted()) {
+        return;
+      }
+
+      /* Nothing changed since the last broadcast */
+      if (
+        m_unVersion == m_unBroadcastVersion &&
+        !m_pcWebServer->IsKeyframeRequested()) {
+        return;
+      }
+      m_unBroadcastVersion = m_unVersion;
+
+      /* Encoded again as keyframes and deltas of the relay */
+      nlohmann::json cState = m_cState;
+      cState.erase("sequence");
+      cState.erase("keyframe");
+      m_pcWebServer->Broadcast(std::move(cState));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CRelay::SendUpstream(nlohmann::json c_command) {
+      c_command["id"] = ++m_unLastCommandId;
+      m_cUpstream.Send(CWebSocketClient::EOpCode::TEXT, c_command.dump());
+    }
+
+    /****************************************/
+    /****************************************/
+
+    nlohmann::json CRelay::MakeFailedAck(
+      const nlohmann::json &c_id, const std::string &str_error) {
+      nlohmann::json cAck = {
+        {"type", "ack"}, {"ok", false}, {"error", str_error}};
+      if (!c_id.is_null()) {
+        cAck["id"] = c_id;
+      }
+      return cAck;
+    }
+  }  // namespace Webviz
+}  // namespace argos
@@ -0,0 +1,188 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/relay/webviz_relay.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RELAY_H
+#define ARGOS_WEBVIZ_RELAY_H
+
+namespace argos {
+  namespace Webviz {
+    class CRelay;
+  }  // namespace Webviz
+}  // namespace argos
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+
+#include "../utility/BroadcastMask.h"
+#include "../utility/ClientCommand.h"
+#include "../utility/RayLOD.h"
+#include "../utility/WebSocketClient.h"
+#include "../webviz_webserver.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Serves the broadcasts of another webviz instance to many clients
+     *
+     * The relay is one client of the upstream instance (a simulation, or
+     * another relay). It rebuilds the full experiment state from the
+     * keyframes and deltas it receives, and broadcasts it again with its own
+     * webserver, so encoding and sending to the clients happen on the relay
+     * machine. Events and logs are forwarded as they are, commands of the
+     * clients are sent upstream and their acknowledgements routed back.
+     */
+    class CRelay {
+     public:
+      struct SOptions {
+        /** Webviz instance to relay, like "ws://sim-node:3000" */
+        std::string m_strUpstream;
+
+        /** Port the clients connect to */
+        unsigned short m_unPort = 3100;
+
+        unsigned short m_unBroadcastFrequency = 10;
+        unsigned short m_unKeyframeEvery = 1;
+
+        /** Threads serving the clients */
+        unsigned short m_unServerThreads = 1;
+
+        /** SSL of the clients, the upstream is always plain "ws://" */
+        std::string m_strKeyFile;
+        std::string m_strCertFile;
+        std::string m_strDHParamsFile;
+        std::string m_strCAFile;
+        std::string m_strCertPassphrase;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Throws CARGoSException if the upstream URL is not valid */
+      explicit CRelay(SOptions s_options);
+
+      ~CRelay();
+
+      CRelay(const CRelay&) = delete;
+      CRelay& operator=(const CRelay&) = delete;
+
+      /**
+       * @brief Connects upstream and serves the clients, blocking
+       */
+      void Execute();
+
+     private:
+      /**
+       * @brief Keeps the upstream connection up, and relays what it
+       * receives
+       */
+      void UpstreamThreadFunction(const std::atomic<bool>&);
+
+      /** Handles one broadcast, event, log or acknowledgement */
+      void HandleUpstreamMessage(nlohmann::json c_message);
+
+      /** Applies a keyframe or a delta to the relayed state */
+      void HandleUpstreamBroadcast(nlohmann::json c_frame);
+
+      /** Routes an acknowledgement back to the client of the command */
+      void HandleUpstreamAck(nlohmann::json c_ack);
+
+      /**
+       * @brief Sends a command of a client upstream, from the server thread
+       *
+       * The id of the command is replaced by one of the relay, unique for
+       * all its clients, and put back in the acknowledgement.
+       */
+      void ForwardCommand(SClientCommand s_command);
+
+      /** Acknowledges with an error the commands still waiting for one */
+      void FailPendingCommands(const std::string& str_error);
+
+      /**
+       * @brief Asks upstream for only what the clients of the relay want,
+       * each time it changes
+       *
+       * Nothing is sent while the clients want everything, so the defaults
+       * of the upstream (like its ray settings) apply.
+       */
+      void ForwardWantedMask();
+
+      /** Hands the relayed state to the webserver, if it wants one */
+      void BroadcastIfWanted();
+
+      /** Sends a command of the relay itself, its acknowledgement is
+       * dropped */
+      void SendUpstream(nlohmann::json c_command);
+
+      /** Acknowledgement of a command which could not be sent upstream */
+      static nlohmann::json MakeFailedAck(
+        const nlohmann::json& c_id, const std::string& str_error);
+
+     private:
+      SOptions m_sOptions;
+
+      /** Upstream address, from m_strUpstream */
+      std::string m_strHost;
+      uint16_t m_unUpstreamPort;
+      std::string m_strPath;
+
+      /** Serves the clients of the relay */
+      std::unique_ptr<CWebServer> m_pcWebServer;
+
+      /** Connection to the upstream instance */
+      CWebSocketClient m_cUpstream;
+
+      /** Full state rebuilt from the upstream frames, upstream thread
+       * only */
+      nlohmann::json m_cState;
+
+      /** Sequence of the last upstream frame applied, 0 without state */
+      uint64_t m_unSequence;
+
+      /** Incremented each time m_cState changes */
+      uint64_t m_unVersion;
+
+      /** Version handed to the webserver last */
+      uint64_t m_unBroadcastVersion;
+
+      /** A keyframe was asked for after a missing delta */
+      bool m_bWaitingKeyframe;
+
+      /** What the upstream was asked to send */
+      CBroadcastMask m_cForwardedMask;
+      CRayLOD m_cForwardedRayLOD;
+
+      /** Client and id of a command waiting for its acknowledgement */
+      struct SPendingCommand {
+        uint64_t m_unClientId;
+        nlohmann::json m_cId;
+      };
+
+      /** Commands sent upstream by relay id, protected by
+       * m_mutex4Pending */
+      std::unordered_map<uint64_t, SPendingCommand> m_mapPending;
+      std::mutex m_mutex4Pending;
+
+      /** Last id given to a command sent upstream */
+      std::atomic<uint64_t> m_unLastCommandId;
+
+      /** Above this, new commands are refused, the upstream is probably
+       * not answering */
+      static constexpr size_t MAX_PENDING_COMMANDS = 1024;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
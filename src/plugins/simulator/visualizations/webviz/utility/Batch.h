@@ -0,0 +1,182 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Batch.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_BATCH_H
+#define ARGOS_WEBVIZ_BATCH_H
+
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Operations of a "batch" command, and what is needed to apply
+     * them all or none
+     *
+     * The simulation side applies the operations in order, records how to
+     * undo each of them, and rolls back on the first failure. Removals can
+     * not be undone, so they are only checked in order and done last, once
+     * everything else succeeded.
+     */
+    class CBatch {
+     public:
+      enum class EOp { MOVE, ADD, REMOVE };
+
+      /** One operation, as sent by the client */
+      struct SOperation {
+        EOp m_eOp = EOp::MOVE;
+
+        /** Entity to move or remove */
+        std::string m_strId;
+
+        /** Target of a move, x, y, z */
+        double m_pfPosition[3] = {0, 0, 0};
+
+        /** Whether a move changes the orientation, w, x, y, z */
+        bool m_bOrientation = false;
+        double m_pfOrientation[4] = {1, 0, 0, 0};
+
+        /** Entity to add, as in the .argos file */
+        std::string m_strXML;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads an operation, with "op" being "move" (default, with
+       * "id", "position" and optionally "orientation"), "add" (with "xml")
+       * or "remove" (with "id")
+       *
+       * @return false with str_error set if it is malformed
+       */
+      static bool Parse(
+        const nlohmann::json& c_operation,
+        SOperation* ps_operation,
+        std::string* str_error) {
+        try {
+          std::string strOp = c_operation.value("op", std::string("move"));
+
+          if (strOp == "move") {
+            ps_operation->m_eOp = EOp::MOVE;
+            ps_operation->m_strId = c_operation.at("id").get<std::string>();
+
+            const nlohmann::json& cPos = c_operation.at("position");
+            ps_operation->m_pfPosition[0] = cPos.at("x").get<double>();
+            ps_operation->m_pfPosition[1] = cPos.at("y").get<double>();
+            ps_operation->m_pfPosition[2] = cPos.at("z").get<double>();
+
+            ps_operation->m_bOrientation = c_operation.contains("orientation");
+            if (ps_operation->m_bOrientation) {
+              const nlohmann::json& cOrient = c_operation["orientation"];
+              ps_operation->m_pfOrientation[0] = cOrient.at("w").get<double>();
+              ps_operation->m_pfOrientation[1] = cOrient.at("x").get<double>();
+              ps_operation->m_pfOrientation[2] = cOrient.at("y").get<double>();
+              ps_operation->m_pfOrientation[3] = cOrient.at("z").get<double>();
+            }
+
+          } else if (strOp == "add") {
+            ps_operation->m_eOp = EOp::ADD;
+            ps_operation->m_strXML = c_operation.at("xml").get<std::string>();
+
+          } else if (strOp == "remove") {
+            ps_operation->m_eOp = EOp::REMOVE;
+            ps_operation->m_strId = c_operation.at("id").get<std::string>();
+
+          } else {
+            *str_error = "unknown op \"" + strOp + "\"";
+            return false;
+          }
+        } catch (const nlohmann::json::exception& e) {
+          *str_error = e.what();
+          return false;
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Ids of the entities as the operations before the current one
+       * leave them
+       *
+       * Removed entities are gone for the next operations, but their ids are
+       * still taken, as they are only removed at the end.
+       */
+      class CIds {
+       public:
+        /**
+         * @param fn_in_space true if an entity has this id before the batch
+         */
+        explicit CIds(std::function<bool(const std::string&)> fn_in_space)
+            : m_fnInSpace(std::move(fn_in_space)) {}
+
+        /** True if the next operations can move or remove it */
+        bool Exists(const std::string& str_id) const {
+          return m_setRemoved.count(str_id) == 0 &&
+                 (m_setAdded.count(str_id) > 0 || m_fnInSpace(str_id));
+        }
+
+        /** True if an entity added now can not have it */
+        bool IsTaken(const std::string& str_id) const {
+          return m_setAdded.count(str_id) > 0 || m_fnInSpace(str_id);
+        }
+
+        void Add(const std::string& str_id) { m_setAdded.insert(str_id); }
+
+        void Remove(const std::string& str_id) {
+          m_setRemoved.insert(str_id);
+        }
+
+       private:
+        std::function<bool(const std::string&)> m_fnInSpace;
+        std::unordered_set<std::string> m_setAdded;
+        std::unordered_set<std::string> m_setRemoved;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Undoes the applied operations, latest first, unless committed */
+      class CUndoLog {
+       public:
+        ~CUndoLog() { Rollback(); }
+
+        /** Records how to undo an operation which was just applied */
+        void Push(std::function<void()> fn_undo) {
+          m_vecUndo.push_back(std::move(fn_undo));
+        }
+
+        void Rollback() {
+          while (!m_vecUndo.empty()) {
+            std::function<void()> fnUndo = std::move(m_vecUndo.back());
+            m_vecUndo.pop_back();
+            fnUndo();
+          }
+        }
+
+        /** Keeps what was applied */
+        void Commit() { m_vecUndo.clear(); }
+
+        size_t GetSize() const { return m_vecUndo.size(); }
+
+       private:
+        std::vector<std::function<void()>> m_vecUndo;
+      };
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/BroadcastMask.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_BROADCAST_MASK_H
+#define ARGOS_WEBVIZ_BROADCAST_MASK_H
+
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Which entity types, and which fields of the entities, a client
+     * wants in its broadcasts
+     *
+     * A default constructed mask wants everything. "id" and "type" are
+     * always wanted.
+     */
+    class CBroadcastMask {
+     public:
+      CBroadcastMask() : m_bAllTypes(true), m_bAllFields(true) {}
+
+      /****************************************/
+      /****************************************/
+
+      /** Mask which wants nothing, to Merge() other masks into */
+      static CBroadcastMask None() {
+        CBroadcastMask cMask;
+        cMask.m_bAllTypes = false;
+        cMask.m_bAllFields = false;
+        return cMask;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads a mask from a command like
+       * {"types": ["foot-bot"], "fields": ["position", "orientation"]}
+       *
+       * A missing (or null) list means everything.
+       *
+       * @throws nlohmann::json::exception if a list is not an array of
+       * strings
+       */
+      static CBroadcastMask FromJSON(const nlohmann::json& c_json) {
+        CBroadcastMask cMask;
+        auto itTypes = c_json.find("types");
+        if (itTypes != c_json.end() && !itTypes->is_null()) {
+          cMask.m_bAllTypes = false;
+          for (const auto& cType : itTypes->get<std::set<std::string>>()) {
+            cMask.AddType(cType);
+          }
+        }
+        auto itFields = c_json.find("fields");
+        if (itFields != c_json.end() && !itFields->is_null()) {
+          cMask.m_bAllFields = false;
+          for (const auto& cField : itFields->get<std::set<std::string>>()) {
+            cMask.AddField(cField);
+          }
+        }
+        return cMask;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Inverse of FromJSON(), to send the mask to another webserver */
+      nlohmann::json ToJSON() const {
+        nlohmann::json cJson;
+        cJson["types"] = nullptr;
+        cJson["fields"] = nullptr;
+        if (!m_bAllTypes) {
+          cJson["types"] = m_setTypes;
+        }
+        if (!m_bAllFields) {
+          cJson["fields"] = m_setFields;
+        }
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Only the added types are wanted */
+      void AddType(const std::string& str_type) {
+        m_bAllTypes = false;
+        m_setTypes.insert(str_type);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Only the added fields are wanted */
+      void AddField(const std::string& str_field) {
+        m_bAllFields = false;
+        m_setFields.insert(str_field);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Wants everything the other mask wants, as well */
+      void Merge(const CBroadcastMask& c_other) {
+        m_bAllTypes = m_bAllTypes || c_other.m_bAllTypes;
+        if (m_bAllTypes) {
+          m_setTypes.clear();
+        } else {
+          m_setTypes.insert(
+            c_other.m_setTypes.begin(), c_other.m_setTypes.end());
+        }
+        m_bAllFields = m_bAllFields || c_other.m_bAllFields;
+        if (m_bAllFields) {
+          m_setFields.clear();
+        } else {
+          m_setFields.insert(
+            c_other.m_setFields.begin(), c_other.m_setFields.end());
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if nothing is filtered out */
+      bool IsEmpty() const { return m_bAllTypes && m_bAllFields; }
+
+      bool WantsAllTypes() const { return m_bAllTypes; }
+
+      bool WantsAllFields() const { return m_bAllFields; }
+
+      /****************************************/
+      /****************************************/
+
+      bool WantsType(const std::string& str_type) const {
+        return m_bAllTypes || m_setTypes.count(str_type) > 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool WantsField(const std::string& str_field) const {
+        return m_bAllFields || str_field == "id" || str_field == "type" ||
+               m_setFields.count(str_field) > 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Removes the fields of an entity which are not wanted */
+      void ApplyFields(nlohmann::json& c_entity) const {
+        if (m_bAllFields || !c_entity.is_object()) {
+          return;
+        }
+        for (auto it = c_entity.begin(); it != c_entity.end();) {
+          if (WantsField(it.key())) {
+            ++it;
+          } else {
+            it = c_entity.erase(it);
+          }
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool operator==(const CBroadcastMask& c_other) const {
+        return m_bAllTypes == c_other.m_bAllTypes &&
+               m_bAllFields == c_other.m_bAllFields &&
+               m_setTypes == c_other.m_setTypes &&
+               m_setFields == c_other.m_setFields;
+      }
+
+      bool operator!=(const CBroadcastMask& c_other) const {
+        return !(*this == c_other);
+      }
+
+     private:
+      /** True if no type is filtered out, then m_setTypes is not used */
+      bool m_bAllTypes;
+
+      /** True if no field is filtered out, then m_setFields is not used */
+      bool m_bAllFields;
+
+      std::set<std::string> m_setTypes;
+      std::set<std::string> m_setFields;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -25,6 +25,8 @@ namespace argos {
         std::chrono::steady_clock>::type TClockType;
 
       typedef std::chrono::milliseconds TMilliseconds;
+      typedef std::chrono::microseconds TMicroseconds;
+      typedef std::chrono::nanoseconds TNanoseconds;
 
      public:
       CTimer() { Reset(); }
@@ -59,15 +61,21 @@ namespace argos {
       /****************************************/
 
       TMilliseconds Elapsed() const {
-        TClockType::time_point endTime;
+        return std::chrono::duration_cast<TMilliseconds>(ElapsedDuration());
+      }
 
-        if (m_bRunning) {
-          endTime = TClockType::now();
-        } else {
-          endTime = m_EndTime;
-        }
+      /****************************************/
+      /****************************************/
 
-        return std::chrono::duration_cast<TMilliseconds>(endTime - m_StartTime);
+      TMicroseconds ElapsedMicroseconds() const {
+        return std::chrono::duration_cast<TMicroseconds>(ElapsedDuration());
+      }
+
+      /****************************************/
+      /****************************************/
+
+      TNanoseconds ElapsedNanoseconds() const {
+        return std::chrono::duration_cast<TNanoseconds>(ElapsedDuration());
       }
 
       /****************************************/
@@ -84,6 +92,15 @@ namespace argos {
         return out << timer.Elapsed().count();
       }
 
+     private:
+      TClockType::duration ElapsedDuration() const {
+        if (m_bRunning) {
+          return TClockType::now() - m_StartTime;
+        } else {
+          return m_EndTime - m_StartTime;
+        }
+      }
+
      private:
       TClockType::time_point m_StartTime;
       TClockType::time_point m_EndTime;
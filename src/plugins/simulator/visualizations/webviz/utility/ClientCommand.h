@@ -0,0 +1,32 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/ClientCommand.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_CLIENT_COMMAND_H
+#define ARGOS_WEBVIZ_CLIENT_COMMAND_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+    /** Command received from a client, run by the simulation thread */
+    struct SClientCommand {
+      /** Connection the command came from, to send the acknowledgement */
+      uint64_t m_unClientId = 0;
+      std::string m_strIP;
+      nlohmann::json m_cCommand;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
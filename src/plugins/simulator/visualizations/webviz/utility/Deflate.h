@@ -0,0 +1,161 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Deflate.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_DEFLATE_H
+#define ARGOS_WEBVIZ_DEFLATE_H
+
+#include <zlib.h>
+
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Thin wrapper over zlib, producing and reading zlib streams
+     * (RFC 1950), as understood by browsers' DecompressionStream("deflate"),
+     * and gzip streams (RFC 1952) for HTTP
+     */
+    class CDeflate {
+     public:
+      /**
+       * @brief Compresses a buffer
+       *
+       * @param str_in data to compress
+       * @param str_out compressed data
+       * @param n_level zlib compression level, 0 to 9
+       * @return true on success
+       */
+      static bool Compress(
+        const std::string& str_in,
+        std::string* str_out,
+        int n_level = Z_BEST_SPEED) {
+        uLongf unSize = compressBound(str_in.size());
+        str_out->resize(unSize);
+
+        int nResult = compress2(
+          reinterpret_cast<Bytef*>(&(*str_out)[0]),
+          &unSize,
+          reinterpret_cast<const Bytef*>(str_in.data()),
+          str_in.size(),
+          n_level);
+
+        if (nResult != Z_OK) {
+          str_out->clear();
+          return false;
+        }
+        str_out->resize(unSize);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Compresses a buffer as a gzip stream, for "Content-Encoding:
+       * gzip"
+       *
+       * @param str_in data to compress
+       * @param str_out compressed data
+       * @param n_level zlib compression level, 0 to 9
+       * @return true on success
+       */
+      static bool Gzip(
+        const std::string& str_in,
+        std::string* str_out,
+        int n_level = Z_BEST_COMPRESSION) {
+        z_stream sStream = {};
+        /* 16 more window bits for a gzip header and trailer */
+        if (
+          deflateInit2(
+            &sStream, n_level, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) !=
+          Z_OK) {
+          return false;
+        }
+
+        str_out->resize(deflateBound(&sStream, str_in.size()));
+        sStream.next_in =
+          reinterpret_cast<Bytef*>(const_cast<char*>(str_in.data()));
+        sStream.avail_in = str_in.size();
+        sStream.next_out = reinterpret_cast<Bytef*>(&(*str_out)[0]);
+        sStream.avail_out = str_out->size();
+
+        int nResult = deflate(&sStream, Z_FINISH);
+        deflateEnd(&sStream);
+        if (nResult != Z_STREAM_END) {
+          str_out->clear();
+          return false;
+        }
+        str_out->resize(sStream.total_out);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Decompresses a zlib (or gzip) stream
+       *
+       * @param str_in compressed data
+       * @param str_out decompressed data
+       * @return true on success
+       */
+      static bool Inflate(const std::string& str_in, std::string* str_out) {
+        return Inflate(str_in.data(), str_in.size(), str_out);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Decompresses a zlib (or gzip) stream from a buffer, like a
+       * memory-mapped file, without copying it first
+       *
+       * @param pch_in compressed data
+       * @param un_size size of the compressed data
+       * @param str_out decompressed data
+       * @return true on success
+       */
+      static bool Inflate(
+        const char* pch_in, size_t un_size, std::string* str_out) {
+        z_stream sStream = {};
+        /* 32 more window bits to detect the header */
+        if (inflateInit2(&sStream, 15 + 32) != Z_OK) {
+          return false;
+        }
+
+        sStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(pch_in));
+        sStream.avail_in = un_size;
+
+        str_out->clear();
+        char pchBuffer[16384];
+        int nResult;
+        do {
+          sStream.next_out = reinterpret_cast<Bytef*>(pchBuffer);
+          sStream.avail_out = sizeof(pchBuffer);
+
+          nResult = inflate(&sStream, Z_NO_FLUSH);
+          if (nResult != Z_OK && nResult != Z_STREAM_END) {
+            inflateEnd(&sStream);
+            str_out->clear();
+            return false;
+          }
+          str_out->append(pchBuffer, sizeof(pchBuffer) - sStream.avail_out);
+        } while (nResult != Z_STREAM_END &&
+                 (sStream.avail_in > 0 || sStream.avail_out == 0));
+
+        inflateEnd(&sStream);
+        return nResult == Z_STREAM_END;
+      }
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,389 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/DeltaEncoder.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_DELTA_ENCODER_H
+#define ARGOS_WEBVIZ_DELTA_ENCODER_H
+
+#include <atomic>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Converts full experiment states into keyframes and deltas
+     *
+     * A keyframe is the full state, as it was always sent. A delta only
+     * contains the entities (and the fields of those entities) which changed
+     * since the previous encoded frame, plus the ids of removed entities.
+     * Every frame is tagged with a monotonically increasing "sequence".
+     *
+     * The producer of the states can tell which "user_data" of the entities
+     * did not change with versions, so those are not compared again.
+     */
+    class CDeltaEncoder {
+     public:
+      /**
+       * @brief Construct a new CDeltaEncoder
+       *
+       * @param un_keyframe_every emit a keyframe every N frames, 1 disables
+       * deltas altogether
+       */
+      explicit CDeltaEncoder(uint32_t un_keyframe_every = 1)
+          : m_unKeyframeEvery(un_keyframe_every > 0 ? un_keyframe_every : 1),
+            m_unFramesSinceKeyframe(0),
+            m_unSequence(0),
+            m_bKeyframeRequested(true) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Forces the next encoded frame to be a keyframe
+       *
+       * Thread-safe, can be called from any thread
+       */
+      void RequestKeyframe() { m_bKeyframeRequested = true; }
+
+      /** True until the requested keyframe is encoded */
+      bool IsKeyframeRequested() const { return m_bKeyframeRequested; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes a full experiment state into a keyframe or a delta
+       *
+       * @param c_frame full state, with an "entities" array of objects
+       * having an "id" key
+       * @param vec_user_data_versions version of the "user_data" of each
+       * entity, in the order of c_frame["entities"]. An entity with the same
+       * non-zero version as in the previous frame keeps its "user_data"
+       * without comparing it. Empty if unknown
+       * @return nlohmann::json the frame to send
+       */
+      nlohmann::json Encode(
+        nlohmann::json c_frame,
+        const std::vector<uint64_t>& vec_user_data_versions = {}) {
+        bool bKeyframe = m_bKeyframeRequested.exchange(false) ||
+                         m_unFramesSinceKeyframe + 1 >= m_unKeyframeEvery;
+
+        c_frame["sequence"] = ++m_unSequence;
+
+        /* Plain full frames, nothing to remember */
+        if (m_unKeyframeEvery == 1) {
+          c_frame["keyframe"] = true;
+          return c_frame;
+        }
+
+        nlohmann::json cEntities = nlohmann::json::array();
+        if (c_frame.contains("entities")) {
+          cEntities = std::move(c_frame["entities"]);
+          c_frame.erase("entities");
+        }
+
+        /* Versions are ignored if they do not match the entities */
+        bool bVersioned = vec_user_data_versions.size() == cEntities.size();
+        std::vector<uint64_t> vecUnknown;
+        if (!bVersioned) {
+          vecUnknown.assign(cEntities.size(), 0);
+        }
+        const std::vector<uint64_t>& vecVersions =
+          bVersioned ? vec_user_data_versions : vecUnknown;
+
+        nlohmann::json cOut;
+        if (bKeyframe) {
+          m_unFramesSinceKeyframe = 0;
+          cOut = EncodeKeyframe(c_frame, cEntities, vecVersions);
+        } else {
+          ++m_unFramesSinceKeyframe;
+          cOut = EncodeDelta(c_frame, cEntities, vecVersions);
+        }
+        return cOut;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetSequence() const { return m_unSequence; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Rebuilds the last encoded frame as a keyframe
+       *
+       * Used to resynchronize a single client which missed some deltas,
+       * without forcing a keyframe on everybody else. The keyframe has the
+       * sequence number of the last encoded frame, so the next delta applies
+       * on top of it.
+       *
+       * @return nlohmann::json the keyframe, null if nothing was encoded yet
+       * or if deltas are disabled (every frame is a keyframe anyway)
+       */
+      nlohmann::json GetKeyframe() const {
+        if (m_unKeyframeEvery == 1 || m_unSequence == 0) {
+          return nullptr;
+        }
+        nlohmann::json cFrame = m_cLastFields;
+        cFrame["sequence"] = m_unSequence;
+        cFrame["keyframe"] = true;
+        cFrame["entities"] = nlohmann::json::array();
+        for (const std::string& strId : m_vecLastIds) {
+          cFrame["entities"].push_back(m_mapLastEntities.at(strId).m_cJSON);
+        }
+        return cFrame;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Merges a delta frame onto a (previously merged) full frame
+       *
+       * Inverse operation of Encode(), used by consumers which need to
+       * rebuild full frames from a stream of keyframes and deltas.
+       *
+       * @param c_state full frame to update in place
+       * @param c_delta keyframe or delta
+       */
+      static void Apply(
+        nlohmann::json& c_state, const nlohmann::json& c_delta) {
+        if (c_delta.value("keyframe", true)) {
+          c_state = c_delta;
+          return;
+        }
+
+        /* Index entities by id */
+        std::unordered_map<std::string, size_t> mapIndex;
+        nlohmann::json& cEntities = c_state["entities"];
+        if (!cEntities.is_array()) {
+          cEntities = nlohmann::json::array();
+        }
+        for (size_t i = 0; i < cEntities.size(); ++i) {
+          mapIndex[cEntities[i]["id"].get<std::string>()] = i;
+        }
+
+        for (auto& cItem : c_delta.items()) {
+          if (cItem.key() == "entities" || cItem.key() == "removed") {
+            continue;
+          }
+          if (cItem.value().is_null()) {
+            c_state.erase(cItem.key());
+          } else {
+            c_state[cItem.key()] = cItem.value();
+          }
+        }
+
+        if (c_delta.contains("entities")) {
+          for (const auto& cEntity : c_delta["entities"]) {
+            const std::string strId = cEntity["id"].get<std::string>();
+            auto itFound = mapIndex.find(strId);
+            if (itFound == mapIndex.end()) {
+              mapIndex[strId] = cEntities.size();
+              cEntities.push_back(cEntity);
+              continue;
+            }
+            nlohmann::json& cTarget = cEntities[itFound->second];
+            for (auto& cField : cEntity.items()) {
+              if (cField.value().is_null()) {
+                cTarget.erase(cField.key());
+              } else {
+                cTarget[cField.key()] = cField.value();
+              }
+            }
+          }
+        }
+
+        if (c_delta.contains("removed")) {
+          nlohmann::json cKept = nlohmann::json::array();
+          std::unordered_map<std::string, bool> mapRemoved;
+          for (const auto& cId : c_delta["removed"]) {
+            mapRemoved[cId.get<std::string>()] = true;
+          }
+          for (auto& cEntity : cEntities) {
+            if (mapRemoved.count(cEntity["id"].get<std::string>()) == 0) {
+              cKept.push_back(std::move(cEntity));
+            }
+          }
+          cEntities = std::move(cKept);
+        }
+        c_state["keyframe"] = true;
+      }
+
+     private:
+      /**
+       * @brief Remembers the whole state and returns it as it is
+       */
+      nlohmann::json EncodeKeyframe(
+        nlohmann::json& c_frame,
+        nlohmann::json& c_entities,
+        const std::vector<uint64_t>& vec_versions) {
+        m_mapLastEntities.clear();
+        m_vecLastIds.clear();
+        for (size_t i = 0; i < c_entities.size(); ++i) {
+          std::string strId = c_entities[i]["id"].get<std::string>();
+          auto cResult = m_mapLastEntities.insert_or_assign(
+            strId, SEntity{c_entities[i], vec_versions[i]});
+          if (cResult.second) {
+            m_vecLastIds.push_back(std::move(strId));
+          }
+        }
+        m_cLastFields = c_frame;
+
+        c_frame["keyframe"] = true;
+        c_frame["entities"] = std::move(c_entities);
+        return std::move(c_frame);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Builds a frame with only what changed since the last frame
+       */
+      nlohmann::json EncodeDelta(
+        const nlohmann::json& c_frame,
+        nlohmann::json& c_entities,
+        const std::vector<uint64_t>& vec_versions) {
+        nlohmann::json cDelta = nlohmann::json::object();
+        nlohmann::json cChanged = nlohmann::json::array();
+
+        /* Frame level fields (arena, user_data ...) */
+        for (auto& cItem : c_frame.items()) {
+          auto itOld = m_cLastFields.find(cItem.key());
+          if (
+            IsAlwaysSent(cItem.key()) || itOld == m_cLastFields.end() ||
+            *itOld != cItem.value()) {
+            cDelta[cItem.key()] = cItem.value();
+          }
+        }
+        for (auto& cItem : m_cLastFields.items()) {
+          if (!c_frame.contains(cItem.key())) {
+            cDelta[cItem.key()] = nullptr;
+          }
+        }
+        m_cLastFields = c_frame;
+
+        /* Entities */
+        std::unordered_map<std::string, SEntity> mapCurrent;
+        mapCurrent.reserve(c_entities.size());
+        std::vector<std::string> vecCurrentIds;
+        vecCurrentIds.reserve(c_entities.size());
+
+        for (size_t i = 0; i < c_entities.size(); ++i) {
+          nlohmann::json& cEntity = c_entities[i];
+          std::string strId = cEntity["id"].get<std::string>();
+          auto itOld = m_mapLastEntities.find(strId);
+
+          if (itOld == m_mapLastEntities.end()) {
+            /* New entity, send everything */
+            cChanged.push_back(cEntity);
+          } else {
+            const nlohmann::json& cOld = itOld->second.m_cJSON;
+            bool bSameUserData =
+              vec_versions[i] != 0 &&
+              vec_versions[i] == itOld->second.m_unUserDataVersion;
+
+            nlohmann::json cFields = nlohmann::json::object();
+            for (auto& cField : cEntity.items()) {
+              if (bSameUserData && cField.key() == "user_data") {
+                continue;
+              }
+              auto itField = cOld.find(cField.key());
+              if (itField == cOld.end() || *itField != cField.value()) {
+                cFields[cField.key()] = cField.value();
+              }
+            }
+            for (auto& cField : cOld.items()) {
+              if (!cEntity.contains(cField.key())) {
+                cFields[cField.key()] = nullptr;
+              }
+            }
+            if (!cFields.empty()) {
+              cFields["id"] = strId;
+              cChanged.push_back(std::move(cFields));
+            }
+            m_mapLastEntities.erase(itOld);
+          }
+          if (mapCurrent
+                .emplace(strId, SEntity{std::move(cEntity), vec_versions[i]})
+                .second) {
+            vecCurrentIds.push_back(std::move(strId));
+          }
+        }
+
+        /* Whatever is left was not in this frame anymore */
+        if (!m_mapLastEntities.empty()) {
+          nlohmann::json cRemoved = nlohmann::json::array();
+          for (const std::string& strId : m_vecLastIds) {
+            if (m_mapLastEntities.count(strId) > 0) {
+              cRemoved.push_back(strId);
+            }
+          }
+          cDelta["removed"] = std::move(cRemoved);
+        }
+        m_mapLastEntities = std::move(mapCurrent);
+        m_vecLastIds = std::move(vecCurrentIds);
+
+        cDelta["keyframe"] = false;
+        cDelta["entities"] = std::move(cChanged);
+        return cDelta;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Fields present in every frame, even if unchanged */
+      static bool IsAlwaysSent(const std::string& str_key) {
+        return str_key == "type" || str_key == "state" ||
+               str_key == "steps" || str_key == "timestamp" ||
+               str_key == "sequence";
+      }
+
+     private:
+      /** An entity as it was encoded */
+      struct SEntity {
+        nlohmann::json m_cJSON;
+
+        /** Version of its "user_data", 0 if unknown */
+        uint64_t m_unUserDataVersion;
+      };
+
+      /** Emit a keyframe every N frames */
+      uint32_t m_unKeyframeEvery;
+
+      /** Frames encoded since the last keyframe */
+      uint32_t m_unFramesSinceKeyframe;
+
+      /** Sequence number of the last encoded frame */
+      uint64_t m_unSequence;
+
+      /** Set when a client asks for a keyframe */
+      std::atomic<bool> m_bKeyframeRequested;
+
+      /** Entities as they were in the last encoded frame, by id */
+      std::unordered_map<std::string, SEntity> m_mapLastEntities;
+
+      /** Ids of m_mapLastEntities, in the order they were encoded */
+      std::vector<std::string> m_vecLastIds;
+
+      /** Frame level fields as they were in the last encoded frame */
+      nlohmann::json m_cLastFields;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/EntityEncoding.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_ENTITY_ENCODING_H
+#define ARGOS_WEBVIZ_ENTITY_ENCODING_H
+
+#include <argos3/core/utility/datatypes/color.h>
+#include <argos3/core/utility/math/quaternion.h>
+#include <argos3/core/utility/math/ray3.h>
+#include <argos3/core/utility/math/vector3.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Numeric encodings of robot LEDs, rays and intersection points
+     * shared by the robot entities
+     *
+     * Values are written as numbers straight into JSON arrays reserved to
+     * their final size, without any intermediate string.
+     */
+    class CEntityEncoding {
+     public:
+      /** Number of values per ray in the "rays" array */
+      static constexpr size_t RAY_STRIDE = 7;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Packs a color as 0xRRGGBB
+       */
+      static uint32_t PackColor(const CColor& c_color) {
+        return static_cast<uint32_t>(c_color.GetRed()) << 16 |
+               static_cast<uint32_t>(c_color.GetGreen()) << 8 |
+               static_cast<uint32_t>(c_color.GetBlue());
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes LED colors as an array of 0xRRGGBB integers
+       *
+       * @param c_leds anything with GetLED(UInt32).GetColor()
+       * @param un_count number of LEDs to encode
+       * @param c_json array to fill
+       */
+      template <class LEDS>
+      static void EncodeLEDs(
+        LEDS& c_leds, uint32_t un_count, nlohmann::json& c_json) {
+        c_json = nlohmann::json::array();
+        auto& vecLEDs = c_json.get_ref<nlohmann::json::array_t&>();
+        vecLEDs.reserve(un_count);
+
+        for (uint32_t i = 0; i < un_count; ++i) {
+          vecLEDs.emplace_back(PackColor(c_leds.GetLED(i).GetColor()));
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes checked rays and intersection points, relative to the
+       * robot
+       *
+       * Rays are flattened as [hit, start x, y, z, end x, y, z, ...] with hit
+       * being 1 or 0, points as [x, y, z, ...].
+       *
+       * @param vec_rays checked rays, in global coordinates
+       * @param vec_points intersection points, in global coordinates
+       * @param c_position position of the robot
+       * @param c_orientation orientation of the robot
+       * @param c_rays array to fill with rays
+       * @param c_points array to fill with points
+       * @param un_every_ray only encode every Nth ray and point
+       */
+      static void EncodeRays(
+        const std::vector<std::pair<bool, CRay3>>& vec_rays,
+        const std::vector<CVector3>& vec_points,
+        const CVector3& c_position,
+        const CQuaternion& c_orientation,
+        nlohmann::json& c_rays,
+        nlohmann::json& c_points,
+        size_t un_every_ray = 1) {
+        /*
+         * To make rays relative, negate the rotation of body along Z axis
+         */
+        CQuaternion cInvZRotation = c_orientation;
+        cInvZRotation.SetZ(-c_orientation.GetZ());
+
+        c_rays = nlohmann::json::array();
+        auto& vecRays = c_rays.get_ref<nlohmann::json::array_t&>();
+        un_every_ray = std::max<size_t>(un_every_ray, 1);
+        vecRays.reserve(
+          (vec_rays.size() + un_every_ray - 1) / un_every_ray * RAY_STRIDE);
+
+        for (size_t i = 0; i < vec_rays.size(); i += un_every_ray) {
+          const auto& cRay = vec_rays[i];
+          vecRays.emplace_back(cRay.first ? 1 : 0);
+          AppendRelative(
+            vecRays, cRay.second.GetStart(), c_position, cInvZRotation);
+          AppendRelative(
+            vecRays, cRay.second.GetEnd(), c_position, cInvZRotation);
+        }
+
+        c_points = nlohmann::json::array();
+        auto& vecPoints = c_points.get_ref<nlohmann::json::array_t&>();
+        vecPoints.reserve(
+          (vec_points.size() + un_every_ray - 1) / un_every_ray * 3);
+
+        for (size_t i = 0; i < vec_points.size(); i += un_every_ray) {
+          AppendRelative(vecPoints, vec_points[i], c_position, cInvZRotation);
+        }
+      }
+
+     private:
+      /**
+       * @brief Appends x, y, z of a point relative to the robot
+       */
+      static void AppendRelative(
+        nlohmann::json::array_t& vec_out,
+        CVector3 c_point,
+        const CVector3& c_position,
+        const CQuaternion& c_inv_rotation) {
+        c_point -= c_position;
+        c_point.Rotate(c_inv_rotation);
+
+        vec_out.emplace_back(c_point.GetX());
+        vec_out.emplace_back(c_point.GetY());
+        vec_out.emplace_back(c_point.GetZ());
+      }
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
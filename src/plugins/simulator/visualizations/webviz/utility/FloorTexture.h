@@ -0,0 +1,240 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/FloorTexture.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_FLOOR_TEXTURE_H
+#define ARGOS_WEBVIZ_FLOOR_TEXTURE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PNGEncoder.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Keeps the last rendered floor texture, and finds which regions
+     * changed between two renderings
+     *
+     * Regions are sent as patches, binary messages made of a 16 bytes
+     * little-endian header followed by a PNG of the region:
+     * version (uint32), x, y, width, height, floor width, floor height
+     * (uint16 each), all in pixels, (0, 0) being the top left corner.
+     */
+    class CFloorTexture {
+     public:
+      /** One rendering of the floor, 3 bytes (RGB) per pixel */
+      struct SImage {
+        uint32_t m_unVersion;
+        uint32_t m_unWidth;
+        uint32_t m_unHeight;
+        std::vector<uint8_t> m_vecPixels;
+      };
+
+      /** Region of the floor, in pixels */
+      struct SRect {
+        uint32_t m_unX;
+        uint32_t m_unY;
+        uint32_t m_unWidth;
+        uint32_t m_unHeight;
+      };
+
+      /** Size of the header of a patch */
+      static constexpr size_t HEADER_SIZE = 16;
+
+      /** Largest side of a texture, in pixels, to bound its memory */
+      static constexpr uint32_t MAX_SIZE = 4096;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Construct a new CFloorTexture
+       *
+       * @param un_tile_size changes are tracked by square tiles of this size
+       */
+      explicit CFloorTexture(uint32_t un_tile_size = 64)
+          : m_unTileSize(un_tile_size > 0 ? un_tile_size : 64) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Replaces the texture with a new rendering
+       *
+       * @param un_width width in pixels
+       * @param un_height height in pixels
+       * @param vec_pixels RGB pixels, row by row from the top
+       * @return std::vector<SRect> regions which changed, the whole texture
+       * if there was none before (or with another size), empty if nothing
+       * changed
+       */
+      std::vector<SRect> Update(
+        uint32_t un_width,
+        uint32_t un_height,
+        std::vector<uint8_t>&& vec_pixels) {
+        std::vector<SRect> vecDirty;
+
+        if (
+          !m_psImage || m_psImage->m_unWidth != un_width ||
+          m_psImage->m_unHeight != un_height) {
+          vecDirty.push_back({0, 0, un_width, un_height});
+        } else {
+          vecDirty = Diff(m_psImage->m_vecPixels, vec_pixels);
+          if (vecDirty.empty()) {
+            return vecDirty;
+          }
+        }
+
+        auto psImage = std::make_shared<SImage>();
+        psImage->m_unVersion = m_psImage ? m_psImage->m_unVersion + 1 : 1;
+        psImage->m_unWidth = un_width;
+        psImage->m_unHeight = un_height;
+        psImage->m_vecPixels = std::move(vec_pixels);
+        m_psImage = std::move(psImage);
+        return vecDirty;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Highest resolution, up to the wanted one, which keeps both
+       * sides of the texture within MAX_SIZE
+       *
+       * @param f_width width of the floor in meters
+       * @param f_height height of the floor in meters
+       * @param un_pixels_per_meter wanted resolution
+       * @return uint32_t resolution to render at, at least 1
+       */
+      static uint32_t FitPixelsPerMeter(
+        double f_width, double f_height, uint32_t un_pixels_per_meter) {
+        double fSide = std::max(f_width, f_height);
+        if (fSide * un_pixels_per_meter <= MAX_SIZE) {
+          return un_pixels_per_meter;
+        }
+        return std::max<uint32_t>(1, static_cast<uint32_t>(MAX_SIZE / fSide));
+      }
+      /****************************************/
+      /****************************************/
+
+      /** Last rendering, immutable so it can be shared with other threads */
+      const std::shared_ptr<const SImage>& GetImage() const {
+        return m_psImage;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes a region of an image as a patch
+       *
+       * @return true on success
+       */
+      static bool EncodePatch(
+        const SImage& s_image, const SRect& s_rect, std::string* str_out) {
+        std::string strPNG;
+        if (!CPNGEncoder::Encode(
+              s_image.m_vecPixels.data() +
+                (s_rect.m_unY * s_image.m_unWidth + s_rect.m_unX) * 3,
+              s_rect.m_unWidth,
+              s_rect.m_unHeight,
+              s_image.m_unWidth * 3,
+              &strPNG)) {
+          return false;
+        }
+
+        str_out->clear();
+        str_out->reserve(HEADER_SIZE + strPNG.size());
+        AppendLE(*str_out, s_image.m_unVersion, 4);
+        AppendLE(*str_out, s_rect.m_unX, 2);
+        AppendLE(*str_out, s_rect.m_unY, 2);
+        AppendLE(*str_out, s_rect.m_unWidth, 2);
+        AppendLE(*str_out, s_rect.m_unHeight, 2);
+        AppendLE(*str_out, s_image.m_unWidth, 2);
+        AppendLE(*str_out, s_image.m_unHeight, 2);
+        str_out->append(strPNG);
+        return true;
+      }
+
+     private:
+      /**
+       * @brief Compares two renderings tile by tile, and merges horizontal
+       * runs of changed tiles into rectangles
+       */
+      std::vector<SRect> Diff(
+        const std::vector<uint8_t>& vec_old,
+        const std::vector<uint8_t>& vec_new) const {
+        std::vector<SRect> vecDirty;
+        const uint32_t unWidth = m_psImage->m_unWidth;
+        const uint32_t unHeight = m_psImage->m_unHeight;
+        uint64_t unDirtyPixels = 0;
+
+        for (uint32_t unY = 0; unY < unHeight; unY += m_unTileSize) {
+          uint32_t unTileHeight = std::min(m_unTileSize, unHeight - unY);
+          bool bInRun = false;
+
+          for (uint32_t unX = 0; unX < unWidth; unX += m_unTileSize) {
+            uint32_t unTileWidth = std::min(m_unTileSize, unWidth - unX);
+            bool bChanged = false;
+
+            for (uint32_t i = unY; i < unY + unTileHeight && !bChanged; ++i) {
+              size_t unOffset = (static_cast<size_t>(i) * unWidth + unX) * 3;
+              bChanged = std::memcmp(
+                           vec_old.data() + unOffset,
+                           vec_new.data() + unOffset,
+                           unTileWidth * 3) != 0;
+            }
+
+            if (bChanged) {
+              unDirtyPixels += unTileWidth * unTileHeight;
+              if (bInRun) {
+                vecDirty.back().m_unWidth += unTileWidth;
+              } else {
+                vecDirty.push_back({unX, unY, unTileWidth, unTileHeight});
+              }
+            }
+            bInRun = bChanged;
+          }
+        }
+
+        /* Mostly changed, one patch is better than many */
+        if (unDirtyPixels * 2 > static_cast<uint64_t>(unWidth) * unHeight) {
+          vecDirty.assign(1, {0, 0, unWidth, unHeight});
+        }
+        return vecDirty;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static void AppendLE(
+        std::string& str_out, uint32_t un_value, size_t un_bytes) {
+        for (size_t i = 0; i < un_bytes; ++i) {
+          str_out.push_back(static_cast<char>((un_value >> (8 * i)) & 0xff));
+        }
+      }
+
+     private:
+      /** Size of the tiles to compare */
+      uint32_t m_unTileSize;
+
+      /** Last rendering */
+      std::shared_ptr<const SImage> m_psImage;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/LogRing.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_LOG_RING_H
+#define ARGOS_WEBVIZ_LOG_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Bounded multiple producers, single consumer ring of log lines
+     *
+     * Push() is lock-free and never allocates (besides the line itself), so
+     * controllers logging at every step do not wait for the webserver. When
+     * the ring is full, or above the rate limit, new lines are dropped and
+     * counted instead of piling up. Pop() must only be called from the
+     * consumer thread.
+     */
+    class CLogRing {
+     public:
+      struct SLine {
+        /** Written to LOGERR, otherwise to LOG */
+        bool m_bError = false;
+
+        /** Already escaped for HTML, like lines from another webserver */
+        bool m_bEscaped = false;
+
+        /** Simulation steps when it was written */
+        uint64_t m_unSteps = 0;
+
+        /** Raw text, without the newline */
+        std::string m_strText;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @param un_capacity lines kept until the consumer takes them, rounded
+       * up to a power of 2
+       * @param un_lines_per_second lines accepted per second, 0 for no limit
+       */
+      explicit CLogRing(
+        size_t un_capacity = 1024, uint32_t un_lines_per_second = 0)
+          : m_unMask(RoundUp(un_capacity) - 1),
+            m_psCells(new SCell[m_unMask + 1]),
+            m_unLinesPerSecond(un_lines_per_second),
+            m_unEnqueuePos(0),
+            m_unDequeuePos(0),
+            m_unWindow(0),
+            m_unWindowLines(0),
+            m_unDropped(0) {
+        for (size_t i = 0; i <= m_unMask; ++i) {
+          m_psCells[i].m_unSequence.store(i, std::memory_order_relaxed);
+        }
+      }
+
+      CLogRing(const CLogRing&) = delete;
+      CLogRing& operator=(const CLogRing&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a line, from any thread
+       *
+       * @return false if it was dropped
+       */
+      bool Push(SLine s_line) {
+        return Push(
+          std::move(s_line),
+          std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a line, rate limited with the given clock
+       *
+       * @param un_second current time in seconds, for the rate limit
+       */
+      bool Push(SLine s_line, uint64_t un_second) {
+        if (m_unLinesPerSecond > 0) {
+          /* First line of a new second resets the count, approximately when
+           * several threads log at that moment */
+          uint64_t unWindow = m_unWindow.load(std::memory_order_relaxed);
+          if (
+            unWindow != un_second &&
+            m_unWindow.compare_exchange_strong(unWindow, un_second)) {
+            m_unWindowLines = 0;
+          }
+          if (++m_unWindowLines > m_unLinesPerSecond) {
+            ++m_unDropped;
+            return false;
+          }
+        }
+
+        /* Claim a cell, the one at the enqueue position is free if the
+         * consumer released it */
+        size_t unPos = m_unEnqueuePos.load(std::memory_order_relaxed);
+        SCell* psCell;
+        while (true) {
+          psCell = &m_psCells[unPos & m_unMask];
+          size_t unSequence =
+            psCell->m_unSequence.load(std::memory_order_acquire);
+          intptr_t nDiff =
+            static_cast<intptr_t>(unSequence) - static_cast<intptr_t>(unPos);
+          if (nDiff == 0) {
+            if (m_unEnqueuePos.compare_exchange_weak(
+                  unPos, unPos + 1, std::memory_order_relaxed)) {
+              break;
+            }
+          } else if (nDiff < 0) {
+            /* Full */
+            ++m_unDropped;
+            return false;
+          } else {
+            unPos = m_unEnqueuePos.load(std::memory_order_relaxed);
+          }
+        }
+
+        psCell->m_sLine = std::move(s_line);
+        psCell->m_unSequence.store(unPos + 1, std::memory_order_release);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Takes the oldest line, from the consumer thread only
+       *
+       * @return false if there is none
+       */
+      bool Pop(SLine& s_line) {
+        size_t unPos = m_unDequeuePos.load(std::memory_order_relaxed);
+        SCell& sCell = m_psCells[unPos & m_unMask];
+        if (sCell.m_unSequence.load(std::memory_order_acquire) != unPos + 1) {
+          return false;
+        }
+        s_line = std::move(sCell.m_sLine);
+        sCell.m_sLine.m_strText.clear();
+        /* Free for the producers of the next round */
+        sCell.m_unSequence.store(
+          unPos + m_unMask + 1, std::memory_order_release);
+        m_unDequeuePos.store(unPos + 1, std::memory_order_relaxed);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetCapacity() const { return m_unMask + 1; }
+
+      /** Lines waiting for the consumer, approximately, from any thread */
+      size_t GetSize() const {
+        size_t unDequeuePos = m_unDequeuePos.load(std::memory_order_relaxed);
+        size_t unEnqueuePos = m_unEnqueuePos.load(std::memory_order_relaxed);
+        return unEnqueuePos > unDequeuePos ? unEnqueuePos - unDequeuePos : 0;
+      }
+
+      /** Number of lines dropped so far */
+      uint64_t GetDropped() const { return m_unDropped; }
+
+     private:
+      static size_t RoundUp(size_t un_capacity) {
+        size_t unSize = 2;
+        while (unSize < un_capacity) {
+          unSize <<= 1;
+        }
+        return unSize;
+      }
+
+     private:
+      struct SCell {
+        std::atomic<size_t> m_unSequence;
+        SLine m_sLine;
+      };
+
+      size_t m_unMask;
+      std::unique_ptr<SCell[]> m_psCells;
+      uint32_t m_unLinesPerSecond;
+
+      /** Producers and consumer on their own cache lines */
+      alignas(64) std::atomic<size_t> m_unEnqueuePos;
+      alignas(64) std::atomic<size_t> m_unDequeuePos;
+
+      /** Second of the rate limit, and lines accepted in it */
+      std::atomic<uint64_t> m_unWindow;
+      std::atomic<uint32_t> m_unWindowLines;
+
+      std::atomic<uint64_t> m_unDropped;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -14,16 +14,29 @@
 
 #include <argos3/core/utility/string_utilities.h> /* Replace */
 
+#include <algorithm>
 #include <functional>
+#include <string>
 
 namespace argos {
   namespace Webviz {
+    /**
+     * @brief Stream buffer passing each line written to a stream to a
+     * callback, instead of the stream
+     */
     class CLogStream : public std::basic_streambuf<char> {
      public:
+      /**
+       * @param b_escape escape the lines for HTML before the callback, false
+       * to get the raw text and escape it later with Escape()
+       */
       CLogStream(
         std::ostream& c_stream,
-        std::function<void(std::string)> f_callback_function)
-          : m_cStream(c_stream), m_fCallback(f_callback_function) {
+        std::function<void(std::string)> f_callback_function,
+        bool b_escape = true)
+          : m_cStream(c_stream),
+            m_fCallback(f_callback_function),
+            m_bEscape(b_escape) {
         /* Copy the original stream buffer */
         m_pcOldStream = m_cStream.rdbuf();
 
@@ -42,18 +55,23 @@ namespace argos {
       /****************************************/
       /****************************************/
 
-      virtual int_type overflow(int_type t_value) {
-        if (t_value == '\n') {
-          std::string strTmp(m_strBuffer);
-          Replace(strTmp, "<", "&lt;");
-          Replace(strTmp, ">", "&gt;");
+      /** Escapes a line for HTML */
+      static void Escape(std::string& str_line) {
+        if (str_line.find_first_of("<>") == std::string::npos) {
+          return;
+        }
+        Replace(str_line, "<", "&lt;");
+        Replace(str_line, ">", "&gt;");
+      }
 
-          /* Call the callback function to send log data */
-          m_fCallback(strTmp.c_str());
+      /****************************************/
+      /****************************************/
 
-          m_strBuffer.erase(m_strBuffer.begin(), m_strBuffer.end());
+      virtual int_type overflow(int_type t_value) {
+        if (t_value == '\n') {
+          EmitLine();
         } else {
-          m_strBuffer += t_value;
+          m_strBuffer += static_cast<char>(t_value);
         }
         return t_value;
       }
@@ -63,38 +81,37 @@ namespace argos {
 
       virtual std::streamsize xsputn(
         const char* pc_message, std::streamsize un_size) {
-        /* Add the message to text stream */
-        m_strBuffer.append(pc_message, pc_message + un_size);
-        size_t nPos = 0;
-        do {
-          /* Look for a newline */
-          nPos = m_strBuffer.find('\n');
-          if (nPos != std::string::npos) {
-            /* Newline found: display text from the beginning of the stream till
-             * the newline */
-            /* Get the portion to display */
-            std::string strTmp(m_strBuffer.begin(), m_strBuffer.begin() + nPos);
-            /* Format the text to display */
-            Replace(strTmp, "<", "&lt;");
-            Replace(strTmp, ">", "&gt;");
-
-            /* Call the callback function to send log data */
-            m_fCallback(strTmp.c_str());
-
-            /* Erase the displayed portion from the text stream */
-            m_strBuffer.erase(
-              m_strBuffer.begin(), m_strBuffer.begin() + nPos + 1);
-          }
-        } while (nPos != std::string::npos);
-        /* No more newlines found, return */
+        const char* pcEnd = pc_message + un_size;
+        const char* pcNewline;
+        /* Each newline ends a line, the rest waits for the next one */
+        while ((pcNewline = std::find(pc_message, pcEnd, '\n')) != pcEnd) {
+          m_strBuffer.append(pc_message, pcNewline);
+          EmitLine();
+          pc_message = pcNewline + 1;
+        }
+        m_strBuffer.append(pc_message, pcEnd);
         return un_size;
       }
 
+     private:
+      /** Hands the buffered line to the callback */
+      void EmitLine() {
+        std::string strLine;
+        strLine.swap(m_strBuffer);
+        if (m_bEscape) {
+          Escape(strLine);
+        }
+
+        /* Call the callback function to send log data */
+        m_fCallback(std::move(strLine));
+      }
+
      private:
       std::ostream& m_cStream;
       std::streambuf* m_pcOldStream;
       std::string m_strBuffer;
       std::function<void(std::string)> m_fCallback;
+      bool m_bEscape;
     };
   }  // namespace Webviz
 }  // namespace argos
@@ -0,0 +1,139 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/MPSCQueue.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_MPSC_QUEUE_H
+#define ARGOS_WEBVIZ_MPSC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Unbounded multiple producers, single consumer queue
+     *
+     * Push() is lock-free and can be called from any thread. Pop() and
+     * WaitFor() must only be called from the consumer thread. The consumer
+     * can sleep in WaitFor(), producers only touch the mutex to wake it up.
+     *
+     * @tparam T default constructible, movable type of the elements
+     */
+    template <class T>
+    class CMPSCQueue {
+      struct SNode {
+        std::atomic<SNode*> m_psNext;
+        T m_tValue;
+
+        SNode() : m_psNext(nullptr) {}
+        explicit SNode(T&& t_value)
+            : m_psNext(nullptr), m_tValue(std::move(t_value)) {}
+      };
+
+     public:
+      CMPSCQueue() : m_psHead(new SNode()), m_bWaiting(false) {
+        m_psTail = m_psHead.load();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      ~CMPSCQueue() {
+        while (m_psTail != nullptr) {
+          SNode* psNext = m_psTail->m_psNext.load();
+          delete m_psTail;
+          m_psTail = psNext;
+        }
+      }
+
+      CMPSCQueue(const CMPSCQueue&) = delete;
+      CMPSCQueue& operator=(const CMPSCQueue&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /** Adds an element, from any thread */
+      void Push(T t_value) {
+        SNode* psNode = new SNode(std::move(t_value));
+        SNode* psPrevious = m_psHead.exchange(psNode);
+        psPrevious->m_psNext.store(psNode);
+
+        /* Wake up the consumer only if it sleeps */
+        if (m_bWaiting.load()) {
+          std::lock_guard<std::mutex> guard(m_mutex);
+          m_cvNotEmpty.notify_one();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Takes the oldest element, from the consumer thread only
+       *
+       * @return false if the queue is empty
+       */
+      bool Pop(T& t_value) {
+        SNode* psNext = m_psTail->m_psNext.load();
+        if (psNext == nullptr) {
+          return false;
+        }
+        /* The next node becomes the empty one */
+        t_value = std::move(psNext->m_tValue);
+        delete m_psTail;
+        m_psTail = psNext;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if there is nothing to pop, from the consumer thread only */
+      bool IsEmpty() const { return m_psTail->m_psNext.load() == nullptr; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sleeps until an element is pushed or the timeout expires,
+       * from the consumer thread only
+       *
+       * @return true if the queue is not empty
+       */
+      template <class REP, class PERIOD>
+      bool WaitFor(const std::chrono::duration<REP, PERIOD>& c_timeout) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_bWaiting.store(true);
+        bool bNotEmpty = m_cvNotEmpty.wait_for(
+          lock, c_timeout, [this]() { return !IsEmpty(); });
+        m_bWaiting.store(false);
+        return bNotEmpty;
+      }
+
+     private:
+      /** Last pushed node, shared by the producers */
+      std::atomic<SNode*> m_psHead;
+
+      /** Node before the oldest element, consumer only */
+      SNode* m_psTail;
+
+      /** True while the consumer sleeps in WaitFor() */
+      std::atomic<bool> m_bWaiting;
+
+      std::mutex m_mutex;
+      std::condition_variable m_cvNotEmpty;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
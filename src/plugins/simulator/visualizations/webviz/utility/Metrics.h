@@ -0,0 +1,293 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Metrics.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_METRICS_H
+#define ARGOS_WEBVIZ_METRICS_H
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CTimer.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Distribution of durations, in fixed buckets from 1 micro-sec
+     * to 10 secs
+     *
+     * Observe() only increments atomics, so it can be called at every step
+     * and from any thread.
+     */
+    class CHistogram {
+     public:
+      /** Upper bounds of the buckets in micro-secs, +Inf comes after */
+      static constexpr uint64_t BOUNDS[] = {
+        1,      5,      10,     25,      50,      100,     250,
+        500,    1000,   2500,   5000,    10000,   25000,   50000,
+        100000, 250000, 500000, 1000000, 2500000, 10000000};
+
+      static constexpr size_t BUCKETS = sizeof(BOUNDS) / sizeof(BOUNDS[0]);
+
+      CHistogram() : m_unSum(0) {
+        for (auto& unCount : m_unCounts) {
+          unCount.store(0, std::memory_order_relaxed);
+        }
+      }
+
+      CHistogram(const CHistogram&) = delete;
+      CHistogram& operator=(const CHistogram&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      void Observe(uint64_t un_micros) {
+        size_t unBucket =
+          std::lower_bound(BOUNDS, BOUNDS + BUCKETS, un_micros) - BOUNDS;
+        m_unCounts[unBucket].fetch_add(1, std::memory_order_relaxed);
+        m_unSum.fetch_add(un_micros, std::memory_order_relaxed);
+      }
+
+      template <class REP, class PERIOD>
+      void Observe(const std::chrono::duration<REP, PERIOD>& c_duration) {
+        Observe(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(c_duration)
+            .count()));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Observations in the bucket, BUCKETS for the +Inf one */
+      uint64_t GetBucket(size_t un_bucket) const {
+        return m_unCounts[un_bucket].load(std::memory_order_relaxed);
+      }
+
+      /** Sum of the observations, in micro-secs */
+      uint64_t GetSum() const {
+        return m_unSum.load(std::memory_order_relaxed);
+      }
+
+      uint64_t GetCount() const {
+        uint64_t unCount = 0;
+        for (size_t i = 0; i <= BUCKETS; ++i) {
+          unCount += GetBucket(i);
+        }
+        return unCount;
+      }
+
+     private:
+      std::atomic<uint64_t> m_unCounts[BUCKETS + 1];
+      std::atomic<uint64_t> m_unSum;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Observes the time spent in a scope
+     */
+    class CScopedTimer {
+     public:
+      explicit CScopedTimer(CHistogram& c_histogram)
+          : m_cHistogram(c_histogram) {
+        m_cTimer.Start();
+      }
+
+      ~CScopedTimer() {
+        m_cHistogram.Observe(m_cTimer.ElapsedMicroseconds());
+      }
+
+      CScopedTimer(const CScopedTimer&) = delete;
+      CScopedTimer& operator=(const CScopedTimer&) = delete;
+
+     private:
+      CHistogram& m_cHistogram;
+      CTimer m_cTimer;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Histograms, gauges and counters, rendered in the Prometheus
+     * text format
+     *
+     * Histograms are owned by the registry, and stay valid as long as it
+     * lives. Gauges and counters are read from callbacks when rendering, so
+     * the values they expose need no copy on the hot path.
+     */
+    class CMetrics {
+     public:
+      /**
+       * @brief Adds a histogram of durations, rendered in seconds
+       *
+       * @return the existing one if the name is already taken
+       */
+      CHistogram& AddHistogram(
+        const std::string& str_name, const std::string& str_help) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto& sFamily : m_vecFamilies) {
+          if (sFamily.m_strName == str_name && sFamily.m_pcHistogram) {
+            return *sFamily.m_pcHistogram;
+          }
+        }
+        SFamily sFamily;
+        sFamily.m_strName = str_name;
+        sFamily.m_strHelp = str_help;
+        sFamily.m_strType = "histogram";
+        sFamily.m_pcHistogram = std::make_unique<CHistogram>();
+        m_vecFamilies.push_back(std::move(sFamily));
+        return *m_vecFamilies.back().m_pcHistogram;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Adds a value which goes up and down, replaced if the name is
+       * already taken */
+      void AddGauge(
+        const std::string& str_name,
+        const std::string& str_help,
+        std::function<double()> fn_value) {
+        AddValue(str_name, str_help, "gauge", std::move(fn_value));
+      }
+
+      /** Adds a value which only goes up, replaced if the name is already
+       * taken */
+      void AddCounter(
+        const std::string& str_name,
+        const std::string& str_help,
+        std::function<double()> fn_value) {
+        AddValue(str_name, str_help, "counter", std::move(fn_value));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Resident memory of the process, in bytes
+       *
+       * The peak instead of the current size where /proc is not available
+       * (macOS).
+       */
+      static uint64_t GetResidentMemory() {
+        std::ifstream cStatm("/proc/self/statm");
+        uint64_t unPages = 0, unResident = 0;
+        if (cStatm >> unPages >> unResident) {
+          return unResident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+        }
+        struct rusage sUsage;
+        if (getrusage(RUSAGE_SELF, &sUsage) != 0) {
+          return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<uint64_t>(sUsage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(sUsage.ru_maxrss) * 1024;
+#endif
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** All the metrics, in the Prometheus text format (version 0.0.4) */
+      std::string Render() const {
+        std::ostringstream cStream;
+        cStream.precision(15);
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (const auto& sFamily : m_vecFamilies) {
+          cStream << "# HELP " << sFamily.m_strName << ' ' << sFamily.m_strHelp
+                  << '\n';
+          cStream << "# TYPE " << sFamily.m_strName << ' ' << sFamily.m_strType
+                  << '\n';
+
+          if (!sFamily.m_pcHistogram) {
+            cStream << sFamily.m_strName << ' ' << sFamily.m_fnValue() << '\n';
+            continue;
+          }
+
+          /* Buckets are cumulative */
+          const CHistogram& cHistogram = *sFamily.m_pcHistogram;
+          uint64_t unCumulative = 0;
+          for (size_t i = 0; i <= CHistogram::BUCKETS; ++i) {
+            unCumulative += cHistogram.GetBucket(i);
+            cStream << sFamily.m_strName << "_bucket{le=\"";
+            if (i < CHistogram::BUCKETS) {
+              cStream << CHistogram::BOUNDS[i] / 1e6;
+            } else {
+              cStream << "+Inf";
+            }
+            cStream << "\"} " << unCumulative << '\n';
+          }
+          cStream << sFamily.m_strName << "_sum " << cHistogram.GetSum() / 1e6
+                  << '\n';
+          /* The +Inf bucket, even if observed while rendering */
+          cStream << sFamily.m_strName << "_count " << unCumulative << '\n';
+        }
+        return cStream.str();
+      }
+
+     private:
+      void AddValue(
+        const std::string& str_name,
+        const std::string& str_help,
+        const std::string& str_type,
+        std::function<double()> fn_value) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (auto& sFamily : m_vecFamilies) {
+          if (sFamily.m_strName == str_name && !sFamily.m_pcHistogram) {
+            sFamily.m_strHelp = str_help;
+            sFamily.m_strType = str_type;
+            sFamily.m_fnValue = std::move(fn_value);
+            return;
+          }
+        }
+        SFamily sFamily;
+        sFamily.m_strName = str_name;
+        sFamily.m_strHelp = str_help;
+        sFamily.m_strType = str_type;
+        sFamily.m_fnValue = std::move(fn_value);
+        m_vecFamilies.push_back(std::move(sFamily));
+      }
+
+     private:
+      struct SFamily {
+        std::string m_strName;
+        std::string m_strHelp;
+        std::string m_strType;
+
+        /** Set for histograms, m_fnValue for the others */
+        std::unique_ptr<CHistogram> m_pcHistogram;
+        std::function<double()> m_fnValue;
+      };
+
+      /** Protects the list, registration can happen while rendering */
+      mutable std::mutex m_mutex;
+
+      std::vector<SFamily> m_vecFamilies;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
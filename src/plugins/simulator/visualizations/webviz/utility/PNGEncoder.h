@@ -0,0 +1,112 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/PNGEncoder.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_PNG_ENCODER_H
+#define ARGOS_WEBVIZ_PNG_ENCODER_H
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <string>
+
+#include "Deflate.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Minimal in-memory PNG encoder for 8 bit RGB images
+     *
+     * No filtering, no interlacing, one IDAT chunk: enough for textures
+     * generated on the fly, without going through files or FreeImage.
+     */
+    class CPNGEncoder {
+     public:
+      /**
+       * @brief Encodes a region of an RGB image as PNG
+       *
+       * @param pun_pixels first pixel of the region, 3 bytes per pixel
+       * @param un_width width of the region in pixels
+       * @param un_height height of the region in pixels
+       * @param un_stride bytes between two rows of the source image
+       * @param str_out PNG file content
+       * @return true on success
+       */
+      static bool Encode(
+        const uint8_t* pun_pixels,
+        uint32_t un_width,
+        uint32_t un_height,
+        uint32_t un_stride,
+        std::string* str_out) {
+        /* Raw scanlines, each one starting with filter type 0 (None) */
+        std::string strRaw;
+        strRaw.reserve((un_width * 3 + 1) * un_height);
+        for (uint32_t i = 0; i < un_height; ++i) {
+          strRaw.push_back('\0');
+          strRaw.append(
+            reinterpret_cast<const char*>(pun_pixels + i * un_stride),
+            un_width * 3);
+        }
+
+        std::string strCompressed;
+        if (!CDeflate::Compress(strRaw, &strCompressed)) {
+          return false;
+        }
+
+        str_out->assign("\x89PNG\r\n\x1a\n", 8);
+
+        /* Width, height, bit depth 8, color type 2 (RGB), compression,
+         * filter and interlace methods 0 */
+        std::string strHeader;
+        AppendUInt32(strHeader, un_width);
+        AppendUInt32(strHeader, un_height);
+        strHeader.append("\x08\x02\x00\x00\x00", 5);
+
+        AppendChunk(*str_out, "IHDR", strHeader);
+        AppendChunk(*str_out, "IDAT", strCompressed);
+        AppendChunk(*str_out, "IEND", "");
+        return true;
+      }
+
+     private:
+      /** Appends a big-endian uint32 */
+      static void AppendUInt32(std::string& str_out, uint32_t un_value) {
+        str_out.push_back(static_cast<char>((un_value >> 24) & 0xff));
+        str_out.push_back(static_cast<char>((un_value >> 16) & 0xff));
+        str_out.push_back(static_cast<char>((un_value >> 8) & 0xff));
+        str_out.push_back(static_cast<char>(un_value & 0xff));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Appends length, type, data and CRC of a chunk */
+      static void AppendChunk(
+        std::string& str_out,
+        const char* pch_type,
+        const std::string& str_data) {
+        AppendUInt32(str_out, str_data.size());
+
+        size_t unStart = str_out.size();
+        str_out.append(pch_type, 4);
+        str_out.append(str_data);
+
+        uLong unCRC = crc32(0L, Z_NULL, 0);
+        unCRC = crc32(
+          unCRC,
+          reinterpret_cast<const Bytef*>(str_out.data() + unStart),
+          str_out.size() - unStart);
+        AppendUInt32(str_out, static_cast<uint32_t>(unCRC));
+      }
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,388 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/PoseSnapshot.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_POSE_SNAPSHOT_H
+#define ARGOS_WEBVIZ_POSE_SNAPSHOT_H
+
+#include <argos3/core/utility/math/quaternion.h>
+#include <argos3/core/utility/math/vector3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Poses of all the embodied entities of one step, as arrays of
+     * floats (one per coordinate), and their quantized binary encoding
+     *
+     * The encoding is a 52 bytes little-endian header:
+     * "POSE", index version (uint32), steps (uint64), count (uint32), flags
+     * (uint8, then 3 unused bytes), minimum x, y, z and range x, y, z of the
+     * arena (float32 each), z of all the entities if planar (float32),
+     * then one record per entity, in the order of the index:
+     * x, y (uint16 each), z (uint16, only if not planar), orientation
+     * (uint32, smallest three).
+     *
+     * A coordinate is min + q / 65535 * range. The orientation keeps the 2
+     * bits index (x, y, z, w) of its largest component, made positive, in
+     * its high bits, then the 3 others in order in 10 bits each, as
+     * (c * sqrt(2) + 1) / 2 * 1023.
+     */
+    class CPoseSnapshot {
+     public:
+      /** Size of the header of the encoding */
+      static constexpr size_t HEADER_SIZE = 52;
+
+      /** All the entities have the same z, sent once in the header */
+      static constexpr uint8_t FLAG_PLANAR = 1;
+
+      /** Ids of the entities of the snapshots, in order */
+      struct SIndex {
+        uint32_t m_unVersion;
+        std::vector<std::string> m_vecIds;
+      };
+
+      /** Pose decoded from the binary encoding */
+      struct SPose {
+        float m_fX, m_fY, m_fZ;
+        float m_fQX, m_fQY, m_fQZ, m_fQW;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /** Removes the poses, keeping the capacity of the arrays */
+      void Clear() {
+        m_vecX.clear();
+        m_vecY.clear();
+        m_vecZ.clear();
+        m_vecQX.clear();
+        m_vecQY.clear();
+        m_vecQZ.clear();
+        m_vecQW.clear();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Reserve(size_t un_count) {
+        m_vecX.reserve(un_count);
+        m_vecY.reserve(un_count);
+        m_vecZ.reserve(un_count);
+        m_vecQX.reserve(un_count);
+        m_vecQY.reserve(un_count);
+        m_vecQZ.reserve(un_count);
+        m_vecQW.reserve(un_count);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Adds the pose of the next entity of the index */
+      void Add(const CVector3& c_position, const CQuaternion& c_orientation) {
+        m_vecX.push_back(static_cast<float>(c_position.GetX()));
+        m_vecY.push_back(static_cast<float>(c_position.GetY()));
+        m_vecZ.push_back(static_cast<float>(c_position.GetZ()));
+        m_vecQX.push_back(static_cast<float>(c_orientation.GetX()));
+        m_vecQY.push_back(static_cast<float>(c_orientation.GetY()));
+        m_vecQZ.push_back(static_cast<float>(c_orientation.GetZ()));
+        m_vecQW.push_back(static_cast<float>(c_orientation.GetW()));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetSize() const { return m_vecX.size(); }
+
+      /** Sets the box the positions are quantized in */
+      void SetArena(const CVector3& c_center, const CVector3& c_size) {
+        m_cArenaCenter = c_center;
+        m_cArenaSize = c_size;
+      }
+
+      /** Ids of the entities, shared by the snapshots until they change */
+      void SetIndex(std::shared_ptr<const SIndex> ps_index) {
+        m_psIndex = std::move(ps_index);
+      }
+
+      const std::shared_ptr<const SIndex>& GetIndex() const {
+        return m_psIndex;
+      }
+
+      void SetSteps(uint64_t un_steps) { m_unSteps = un_steps; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Quantizes the poses into their binary encoding
+       *
+       * @param str_out replaced by the encoding
+       */
+      void Encode(std::string* str_out) const {
+        const size_t unCount = GetSize();
+
+        const float pfCenter[3] = {
+          static_cast<float>(m_cArenaCenter.GetX()),
+          static_cast<float>(m_cArenaCenter.GetY()),
+          static_cast<float>(m_cArenaCenter.GetZ())};
+        const float pfSize[3] = {
+          static_cast<float>(m_cArenaSize.GetX()),
+          static_cast<float>(m_cArenaSize.GetY()),
+          static_cast<float>(m_cArenaSize.GetZ())};
+
+        float pfMin[3], pfRange[3];
+        for (size_t i = 0; i < 3; ++i) {
+          pfRange[i] = std::max(pfSize[i], 1e-6f);
+          pfMin[i] = pfCenter[i] - pfRange[i] / 2;
+        }
+
+        /* One pass per coordinate, over contiguous arrays */
+        std::vector<uint16_t> vecQX(unCount), vecQY(unCount), vecQZ(unCount);
+        Quantize(m_vecX.data(), unCount, pfMin[0], pfRange[0], vecQX.data());
+        Quantize(m_vecY.data(), unCount, pfMin[1], pfRange[1], vecQY.data());
+        Quantize(m_vecZ.data(), unCount, pfMin[2], pfRange[2], vecQZ.data());
+
+        bool bPlanar = unCount > 0;
+        float fPlanarZ = unCount > 0 ? m_vecZ[0] : 0.0f;
+        for (size_t i = 1; i < unCount && bPlanar; ++i) {
+          bPlanar = m_vecZ[i] == fPlanarZ;
+        }
+
+        std::vector<uint32_t> vecOrientations(unCount);
+        for (size_t i = 0; i < unCount; ++i) {
+          vecOrientations[i] =
+            PackOrientation(m_vecQX[i], m_vecQY[i], m_vecQZ[i], m_vecQW[i]);
+        }
+
+        str_out->clear();
+        str_out->reserve(HEADER_SIZE + unCount * (bPlanar ? 8 : 10));
+        str_out->append("POSE", 4);
+        AppendLE(*str_out, m_psIndex ? m_psIndex->m_unVersion : 0, 4);
+        AppendLE(*str_out, m_unSteps, 8);
+        AppendLE(*str_out, unCount, 4);
+        AppendLE(*str_out, bPlanar ? FLAG_PLANAR : 0, 4);
+        for (size_t i = 0; i < 3; ++i) {
+          AppendFloat(*str_out, pfMin[i]);
+        }
+        for (size_t i = 0; i < 3; ++i) {
+          AppendFloat(*str_out, pfRange[i]);
+        }
+        AppendFloat(*str_out, bPlanar ? fPlanarZ : 0.0f);
+
+        for (size_t i = 0; i < unCount; ++i) {
+          AppendLE(*str_out, vecQX[i], 2);
+          AppendLE(*str_out, vecQY[i], 2);
+          if (!bPlanar) {
+            AppendLE(*str_out, vecQZ[i], 2);
+          }
+          AppendLE(*str_out, vecOrientations[i], 4);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads back an encoding, as a client would
+       *
+       * @return false if it is not a valid encoding
+       */
+      static bool Decode(
+        const std::string& str_data,
+        std::vector<SPose>* vec_poses,
+        uint32_t* un_index_version = nullptr,
+        uint64_t* un_steps = nullptr) {
+        if (
+          str_data.size() < HEADER_SIZE ||
+          str_data.compare(0, 4, "POSE") != 0) {
+          return false;
+        }
+        const uint8_t* pchData =
+          reinterpret_cast<const uint8_t*>(str_data.data());
+
+        uint32_t unCount = static_cast<uint32_t>(ReadLE(pchData + 16, 4));
+        bool bPlanar = (pchData[20] & FLAG_PLANAR) != 0;
+        size_t unRecordSize = bPlanar ? 8 : 10;
+        if (str_data.size() != HEADER_SIZE + unCount * unRecordSize) {
+          return false;
+        }
+
+        if (un_index_version != nullptr) {
+          *un_index_version = static_cast<uint32_t>(ReadLE(pchData + 4, 4));
+        }
+        if (un_steps != nullptr) {
+          *un_steps = ReadLE(pchData + 8, 8);
+        }
+
+        float pfMin[3], pfRange[3];
+        for (size_t i = 0; i < 3; ++i) {
+          pfMin[i] = ReadFloat(pchData + 24 + 4 * i);
+          pfRange[i] = ReadFloat(pchData + 36 + 4 * i);
+        }
+        float fPlanarZ = ReadFloat(pchData + 48);
+
+        vec_poses->resize(unCount);
+        const uint8_t* pchRecord = pchData + HEADER_SIZE;
+        for (uint32_t i = 0; i < unCount; ++i) {
+          SPose& sPose = (*vec_poses)[i];
+          sPose.m_fX = pfMin[0] + ReadLE(pchRecord, 2) / 65535.0f * pfRange[0];
+          sPose.m_fY =
+            pfMin[1] + ReadLE(pchRecord + 2, 2) / 65535.0f * pfRange[1];
+          pchRecord += 4;
+          if (bPlanar) {
+            sPose.m_fZ = fPlanarZ;
+          } else {
+            sPose.m_fZ =
+              pfMin[2] + ReadLE(pchRecord, 2) / 65535.0f * pfRange[2];
+            pchRecord += 2;
+          }
+          float pfQ[4];
+          UnpackOrientation(static_cast<uint32_t>(ReadLE(pchRecord, 4)), pfQ);
+          sPose.m_fQX = pfQ[0];
+          sPose.m_fQY = pfQ[1];
+          sPose.m_fQZ = pfQ[2];
+          sPose.m_fQW = pfQ[3];
+          pchRecord += 4;
+        }
+        return true;
+      }
+
+     private:
+      /**
+       * @brief Maps values from [f_min, f_min + f_range] to [0, 65535]
+       *
+       * Without branches or calls, so it can be vectorized.
+       */
+      static void Quantize(
+        const float* pf_in,
+        size_t un_count,
+        float f_min,
+        float f_range,
+        uint16_t* pun_out) {
+        const float fScale = 65535.0f / f_range;
+        for (size_t i = 0; i < un_count; ++i) {
+          float fValue = (pf_in[i] - f_min) * fScale;
+          fValue = fValue < 0.0f ? 0.0f : fValue;
+          fValue = fValue > 65535.0f ? 65535.0f : fValue;
+          pun_out[i] = static_cast<uint16_t>(fValue + 0.5f);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Smallest three compression of a unit quaternion */
+      static uint32_t PackOrientation(
+        float f_x, float f_y, float f_z, float f_w) {
+        float pfQ[4] = {f_x, f_y, f_z, f_w};
+
+        uint32_t unLargest = 0;
+        for (uint32_t i = 1; i < 4; ++i) {
+          if (std::fabs(pfQ[i]) > std::fabs(pfQ[unLargest])) {
+            unLargest = i;
+          }
+        }
+
+        /* q and -q are the same rotation, the largest one is implied
+         * positive */
+        float fSign = pfQ[unLargest] < 0.0f ? -1.0f : 1.0f;
+
+        uint32_t unPacked = unLargest << 30;
+        int nShift = 20;
+        for (uint32_t i = 0; i < 4; ++i) {
+          if (i == unLargest) {
+            continue;
+          }
+          float fValue = (pfQ[i] * fSign * SQRT_2 + 1.0f) / 2.0f * 1023.0f;
+          fValue = std::min(std::max(fValue, 0.0f), 1023.0f);
+          unPacked |= static_cast<uint32_t>(fValue + 0.5f) << nShift;
+          nShift -= 10;
+        }
+        return unPacked;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes x, y, z and w to pf_out */
+      static void UnpackOrientation(uint32_t un_packed, float* pf_out) {
+        uint32_t unLargest = un_packed >> 30;
+        float fSum = 0.0f;
+        int nShift = 20;
+        for (uint32_t i = 0; i < 4; ++i) {
+          if (i == unLargest) {
+            continue;
+          }
+          float fValue = ((un_packed >> nShift) & 0x3ff) / 1023.0f;
+          pf_out[i] = (fValue * 2.0f - 1.0f) / SQRT_2;
+          fSum += pf_out[i] * pf_out[i];
+          nShift -= 10;
+        }
+        pf_out[unLargest] = std::sqrt(std::max(0.0f, 1.0f - fSum));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static void AppendLE(
+        std::string& str_out, uint64_t un_value, size_t un_bytes) {
+        for (size_t i = 0; i < un_bytes; ++i) {
+          str_out.push_back(static_cast<char>((un_value >> (8 * i)) & 0xff));
+        }
+      }
+
+      static void AppendFloat(std::string& str_out, float f_value) {
+        uint32_t unBits;
+        std::memcpy(&unBits, &f_value, sizeof(unBits));
+        AppendLE(str_out, unBits, 4);
+      }
+
+      static uint64_t ReadLE(const uint8_t* pch_data, size_t un_bytes) {
+        uint64_t unValue = 0;
+        for (size_t i = 0; i < un_bytes; ++i) {
+          unValue |= static_cast<uint64_t>(pch_data[i]) << (8 * i);
+        }
+        return unValue;
+      }
+
+      static float ReadFloat(const uint8_t* pch_data) {
+        uint32_t unBits = static_cast<uint32_t>(ReadLE(pch_data, 4));
+        float fValue;
+        std::memcpy(&fValue, &unBits, sizeof(fValue));
+        return fValue;
+      }
+
+     private:
+      static constexpr float SQRT_2 = 1.41421356f;
+
+      /** One array per coordinate */
+      std::vector<float> m_vecX, m_vecY, m_vecZ;
+      std::vector<float> m_vecQX, m_vecQY, m_vecQZ, m_vecQW;
+
+      CVector3 m_cArenaCenter;
+      CVector3 m_cArenaSize;
+
+      std::shared_ptr<const SIndex> m_psIndex;
+
+      uint64_t m_unSteps = 0;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,233 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/RayLOD.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RAY_LOD_H
+#define ARGOS_WEBVIZ_RAY_LOD_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Level of detail of the sensor rays a client receives
+     *
+     * Rays can be turned off, restricted to some entities, sent only every
+     * Nth frame, and subsampled to every Nth ray (and intersection point).
+     * A default constructed LOD sends every ray of every entity.
+     */
+    class CRayLOD {
+     public:
+      CRayLOD() : m_bEnabled(true), m_unEveryFrame(1), m_unEveryRay(1) {}
+
+      /****************************************/
+      /****************************************/
+
+      /** LOD which wants no ray, to Merge() other LODs into */
+      static CRayLOD None() {
+        CRayLOD cLOD;
+        cLOD.m_bEnabled = false;
+        return cLOD;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Changes the settings given in a command like
+       * {"enabled": true, "ids": ["fb0"], "every_frame": 2, "every_ray": 4}
+       *
+       * Missing settings are kept, "ids" set to null means every entity.
+       *
+       * @throws nlohmann::json::exception if a setting has a wrong type
+       * @throws std::out_of_range if every_frame or every_ray is 0
+       */
+      void Update(const nlohmann::json& c_json) {
+        CRayLOD cLOD = *this;
+        auto itEnabled = c_json.find("enabled");
+        if (itEnabled != c_json.end()) {
+          cLOD.m_bEnabled = itEnabled->get<bool>();
+        }
+        auto itIds = c_json.find("ids");
+        if (itIds != c_json.end()) {
+          cLOD.m_setIds.clear();
+          if (!itIds->is_null()) {
+            cLOD.m_setIds = itIds->get<std::set<std::string>>();
+          }
+        }
+        auto itEveryFrame = c_json.find("every_frame");
+        if (itEveryFrame != c_json.end()) {
+          cLOD.SetEveryFrame(itEveryFrame->get<uint32_t>());
+        }
+        auto itEveryRay = c_json.find("every_ray");
+        if (itEveryRay != c_json.end()) {
+          cLOD.SetEveryRay(itEveryRay->get<uint32_t>());
+        }
+        *this = std::move(cLOD);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** All the settings, as read by Update() */
+      nlohmann::json ToJSON() const {
+        nlohmann::json cJson;
+        cJson["enabled"] = m_bEnabled;
+        cJson["ids"] = nullptr;
+        if (!m_setIds.empty()) {
+          cJson["ids"] = m_setIds;
+        }
+        cJson["every_frame"] = m_unEveryFrame;
+        cJson["every_ray"] = m_unEveryRay;
+        return cJson;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void SetEnabled(bool b_enabled) { m_bEnabled = b_enabled; }
+
+      /****************************************/
+      /****************************************/
+
+      void SetEveryFrame(uint32_t un_every_frame) {
+        if (un_every_frame == 0) {
+          throw std::out_of_range("every_frame must be at least 1");
+        }
+        m_unEveryFrame = un_every_frame;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void SetEveryRay(uint32_t un_every_ray) {
+        if (un_every_ray == 0) {
+          throw std::out_of_range("every_ray must be at least 1");
+        }
+        m_unEveryRay = un_every_ray;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsEnabled() const { return m_bEnabled; }
+
+      uint32_t GetEveryFrame() const { return m_unEveryFrame; }
+
+      uint32_t GetEveryRay() const { return m_unEveryRay; }
+
+      /** True if nothing is left out */
+      bool IsFull() const {
+        return m_bEnabled && m_setIds.empty() && m_unEveryFrame == 1 &&
+               m_unEveryRay == 1;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool WantsRaysOf(const std::string& str_id) const {
+        return m_bEnabled && (m_setIds.empty() || m_setIds.count(str_id) > 0);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if rays are sent in the broadcast with this sequence number */
+      bool IsRayFrame(uint64_t un_sequence) const {
+        return un_sequence % m_unEveryFrame == 0;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Wants the rays the other LOD wants, as well
+       *
+       * Used to find what the serializers have to generate: every frame, and
+       * every ray any of the LODs keeps (greatest common divisor).
+       */
+      void Merge(const CRayLOD& c_other) {
+        if (!c_other.m_bEnabled) {
+          return;
+        }
+        if (!m_bEnabled) {
+          *this = c_other;
+        } else {
+          if (m_setIds.empty() || c_other.m_setIds.empty()) {
+            m_setIds.clear();
+          } else {
+            m_setIds.insert(c_other.m_setIds.begin(), c_other.m_setIds.end());
+          }
+          m_unEveryRay = std::gcd(m_unEveryRay, c_other.m_unEveryRay);
+        }
+        m_unEveryFrame = 1;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Keeps one group of values out of un_every in a flat array
+       *
+       * @param c_array flat array, like "rays" or "points"
+       * @param un_stride number of values per group
+       * @param un_every keep groups 0, un_every, 2 * un_every...
+       */
+      static void Decimate(
+        nlohmann::json& c_array, size_t un_stride, uint32_t un_every) {
+        if (un_every <= 1 || !c_array.is_array()) {
+          return;
+        }
+        auto& vecValues = c_array.get_ref<nlohmann::json::array_t&>();
+        size_t unOut = 0;
+        for (size_t i = 0; i + un_stride <= vecValues.size();
+             i += un_stride * un_every) {
+          for (size_t j = 0; j < un_stride; ++j) {
+            vecValues[unOut++] = std::move(vecValues[i + j]);
+          }
+        }
+        vecValues.resize(unOut);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool operator==(const CRayLOD& c_other) const {
+        return m_bEnabled == c_other.m_bEnabled &&
+               m_unEveryFrame == c_other.m_unEveryFrame &&
+               m_unEveryRay == c_other.m_unEveryRay &&
+               m_setIds == c_other.m_setIds;
+      }
+
+      bool operator!=(const CRayLOD& c_other) const {
+        return !(*this == c_other);
+      }
+
+     private:
+      bool m_bEnabled;
+
+      /** Only send every Nth frame with rays */
+      uint32_t m_unEveryFrame;
+
+      /** Only send every Nth ray */
+      uint32_t m_unEveryRay;
+
+      /** Entities with rays, all of them if empty */
+      std::set<std::string> m_setIds;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Recorder.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RECORDER_H
+#define ARGOS_WEBVIZ_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+
+#include "DeltaEncoder.h"
+#include "MPSCQueue.h"
+#include "Recording.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Records experiment states to a file from a background thread
+     *
+     * Push() only queues the state, delta encoding, compression and writing
+     * are done by the I/O thread of the recorder. When the I/O thread is too
+     * far behind, new states are dropped (and counted) instead of piling up
+     * in memory.
+     */
+    class CRecorder {
+     public:
+      typedef std::shared_ptr<const nlohmann::json> TState;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @param un_keyframe_every keyframe every N recorded frames
+       * @param un_max_pending states waiting to be written before dropping
+       */
+      explicit CRecorder(
+        uint32_t un_keyframe_every = 100, uint32_t un_max_pending = 64)
+          : m_cEncoder(un_keyframe_every),
+            m_unMaxPending(un_max_pending),
+            m_unPending(0),
+            m_unDropped(0),
+            m_unWritten(0),
+            m_bRunning(false),
+            m_bFailed(false) {}
+
+      ~CRecorder() { Stop(); }
+
+      CRecorder(const CRecorder&) = delete;
+      CRecorder& operator=(const CRecorder&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Creates the file and starts the I/O thread
+       *
+       * @return false if the file can not be written
+       */
+      bool Start(const std::string& str_path) {
+        Stop();
+        if (!m_cWriter.Open(str_path)) {
+          return false;
+        }
+        m_bFailed = false;
+        m_bRunning = true;
+        m_cThread = std::thread([this]() { Run(); });
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes what is queued, the index, and closes the file */
+      void Stop() {
+        if (!m_cThread.joinable()) {
+          return;
+        }
+        m_bRunning = false;
+        /* Wakes the I/O thread up */
+        m_cQueue.Push(nullptr);
+        m_cThread.join();
+        if (!m_cWriter.Close()) {
+          m_bFailed = true;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Queues a full state, from any thread
+       *
+       * @return false if it was dropped
+       */
+      bool Push(TState ps_state) {
+        if (!m_bRunning || m_unPending >= m_unMaxPending) {
+          ++m_unDropped;
+          return false;
+        }
+        ++m_unPending;
+        m_cQueue.Push(std::move(ps_state));
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Number of states dropped so far */
+      uint64_t GetDropped() const { return m_unDropped; }
+
+      /** Number of frames written so far */
+      uint64_t GetWritten() const { return m_unWritten; }
+
+      /** True if a write failed, like a full disk */
+      bool HasFailed() const { return m_bFailed; }
+
+     private:
+      void Run() {
+        TState psState;
+        while (true) {
+          if (!m_cQueue.Pop(psState)) {
+            if (!m_bRunning) {
+              break;
+            }
+            m_cQueue.WaitFor(std::chrono::milliseconds(100));
+            continue;
+          }
+          if (!psState) {
+            /* Pushed by Stop(), the rest of the queue is still written */
+            continue;
+          }
+          --m_unPending;
+
+          /* The copy is made here, not by the thread which pushed */
+          nlohmann::json cFrame = m_cEncoder.Encode(*psState);
+          psState.reset();
+          if (m_cWriter.Append(cFrame)) {
+            ++m_unWritten;
+          } else {
+            m_bFailed = true;
+          }
+        }
+      }
+
+     private:
+      CDeltaEncoder m_cEncoder;
+      CRecordingWriter m_cWriter;
+      CMPSCQueue<TState> m_cQueue;
+
+      uint32_t m_unMaxPending;
+      std::atomic<uint32_t> m_unPending;
+      std::atomic<uint64_t> m_unDropped;
+      std::atomic<uint64_t> m_unWritten;
+      std::atomic<bool> m_bRunning;
+      std::atomic<bool> m_bFailed;
+
+      std::thread m_cThread;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
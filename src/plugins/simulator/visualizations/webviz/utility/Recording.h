@@ -0,0 +1,564 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Recording.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RECORDING_H
+#define ARGOS_WEBVIZ_RECORDING_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "Deflate.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief On-disk format of the recordings, all integers little-endian
+     *
+     * - File header (16 bytes): MAGIC, uint32 version, uint32 flags
+     * - Records, one per frame: a record header (32 bytes) followed by the
+     *   frame as MessagePack compressed with zlib
+     * - Index, written when the recording is closed: one entry (24 bytes)
+     *   per keyframe, then the trailer (24 bytes): uint64 number of
+     *   entries, uint64 offset of the index, INDEX_MAGIC
+     *
+     * Frames are the keyframes and deltas of CDeltaEncoder. A recording
+     * which was not closed (crash, killed job) has no index, it can still be
+     * read by going through the records.
+     */
+    class CRecordingFormat {
+     public:
+      static constexpr char MAGIC[9] = "WVZREC01";
+      static constexpr char INDEX_MAGIC[9] = "WVZRIDX1";
+      static constexpr uint32_t VERSION = 1;
+
+      static constexpr size_t FILE_HEADER_SIZE = 16;
+      static constexpr size_t RECORD_HEADER_SIZE = 32;
+      static constexpr size_t INDEX_ENTRY_SIZE = 24;
+      static constexpr size_t TRAILER_SIZE = 24;
+
+      /** Record flags */
+      static constexpr uint32_t FLAG_KEYFRAME = 1;
+
+      struct SRecordHeader {
+        /** Size of the compressed frame following the header */
+        uint32_t m_unSize;
+        /** Size of the MessagePack frame */
+        uint32_t m_unRawSize;
+        uint64_t m_unSequence;
+        /** Simulation steps of the frame */
+        uint64_t m_unSteps;
+        uint32_t m_unFlags;
+      };
+
+      struct SIndexEntry {
+        /** Offset of the record header in the file */
+        uint64_t m_unOffset;
+        uint64_t m_unSequence;
+        uint64_t m_unSteps;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      static void Put32(char* pch_out, uint32_t un_value) {
+        for (size_t i = 0; i < 4; ++i) {
+          pch_out[i] = static_cast<char>(un_value >> (8 * i));
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static void Put64(char* pch_out, uint64_t un_value) {
+        for (size_t i = 0; i < 8; ++i) {
+          pch_out[i] = static_cast<char>(un_value >> (8 * i));
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static uint32_t Get32(const char* pch_in) {
+        uint32_t unValue = 0;
+        for (size_t i = 0; i < 4; ++i) {
+          unValue |= static_cast<uint32_t>(static_cast<uint8_t>(pch_in[i]))
+                     << (8 * i);
+        }
+        return unValue;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static uint64_t Get64(const char* pch_in) {
+        uint64_t unValue = 0;
+        for (size_t i = 0; i < 8; ++i) {
+          unValue |= static_cast<uint64_t>(static_cast<uint8_t>(pch_in[i]))
+                     << (8 * i);
+        }
+        return unValue;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static void PutRecordHeader(
+        char* pch_out, const SRecordHeader& s_header) {
+        Put32(pch_out, s_header.m_unSize);
+        Put32(pch_out + 4, s_header.m_unRawSize);
+        Put64(pch_out + 8, s_header.m_unSequence);
+        Put64(pch_out + 16, s_header.m_unSteps);
+        Put32(pch_out + 24, s_header.m_unFlags);
+        Put32(pch_out + 28, 0);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static SRecordHeader GetRecordHeader(const char* pch_in) {
+        return {
+          Get32(pch_in),
+          Get32(pch_in + 4),
+          Get64(pch_in + 8),
+          Get64(pch_in + 16),
+          Get32(pch_in + 24)};
+      }
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Writes frames to a recording file, as they come
+     *
+     * Not thread-safe, see CRecorder to write from a background thread.
+     */
+    class CRecordingWriter {
+     public:
+      CRecordingWriter() : m_unOffset(0), m_unSteps(0) {}
+
+      ~CRecordingWriter() { Close(); }
+
+      CRecordingWriter(const CRecordingWriter&) = delete;
+      CRecordingWriter& operator=(const CRecordingWriter&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Creates (or truncates) a recording file
+       *
+       * @return false if the file can not be written
+       */
+      bool Open(const std::string& str_path) {
+        Close();
+        m_vecIndex.clear();
+        m_unSteps = 0;
+        m_cFile.open(str_path, std::ios::binary | std::ios::trunc);
+        if (!m_cFile) {
+          return false;
+        }
+
+        char pchHeader[CRecordingFormat::FILE_HEADER_SIZE];
+        std::memcpy(pchHeader, CRecordingFormat::MAGIC, 8);
+        CRecordingFormat::Put32(pchHeader + 8, CRecordingFormat::VERSION);
+        CRecordingFormat::Put32(pchHeader + 12, 0);
+        m_cFile.write(pchHeader, sizeof(pchHeader));
+        m_unOffset = sizeof(pchHeader);
+        return static_cast<bool>(m_cFile);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_cFile.is_open(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Appends a keyframe or a delta of CDeltaEncoder
+       *
+       * @return false if it could not be written
+       */
+      bool Append(const nlohmann::json& c_frame) {
+        if (!m_cFile.is_open()) {
+          return false;
+        }
+
+        std::string strRaw;
+        nlohmann::json::to_msgpack(c_frame, strRaw);
+        if (!CDeflate::Compress(strRaw, &m_strCompressed)) {
+          return false;
+        }
+
+        CRecordingFormat::SRecordHeader sHeader;
+        sHeader.m_unSize = m_strCompressed.size();
+        sHeader.m_unRawSize = strRaw.size();
+        sHeader.m_unSequence = c_frame.value("sequence", uint64_t(0));
+        /* Deltas only have the steps if they changed */
+        m_unSteps = c_frame.value("steps", m_unSteps);
+        sHeader.m_unSteps = m_unSteps;
+        sHeader.m_unFlags = c_frame.value("keyframe", true)
+                              ? CRecordingFormat::FLAG_KEYFRAME
+                              : 0;
+
+        if (sHeader.m_unFlags & CRecordingFormat::FLAG_KEYFRAME) {
+          m_vecIndex.push_back(
+            {m_unOffset, sHeader.m_unSequence, sHeader.m_unSteps});
+        }
+
+        char pchHeader[CRecordingFormat::RECORD_HEADER_SIZE];
+        CRecordingFormat::PutRecordHeader(pchHeader, sHeader);
+        m_cFile.write(pchHeader, sizeof(pchHeader));
+        m_cFile.write(m_strCompressed.data(), m_strCompressed.size());
+        m_unOffset += sizeof(pchHeader) + m_strCompressed.size();
+        return static_cast<bool>(m_cFile);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Writes the keyframe index and closes the file */
+      bool Close() {
+        if (!m_cFile.is_open()) {
+          return true;
+        }
+
+        char pchEntry[CRecordingFormat::INDEX_ENTRY_SIZE];
+        for (const auto& sEntry : m_vecIndex) {
+          CRecordingFormat::Put64(pchEntry, sEntry.m_unOffset);
+          CRecordingFormat::Put64(pchEntry + 8, sEntry.m_unSequence);
+          CRecordingFormat::Put64(pchEntry + 16, sEntry.m_unSteps);
+          m_cFile.write(pchEntry, sizeof(pchEntry));
+        }
+
+        char pchTrailer[CRecordingFormat::TRAILER_SIZE];
+        CRecordingFormat::Put64(pchTrailer, m_vecIndex.size());
+        CRecordingFormat::Put64(pchTrailer + 8, m_unOffset);
+        std::memcpy(pchTrailer + 16, CRecordingFormat::INDEX_MAGIC, 8);
+        m_cFile.write(pchTrailer, sizeof(pchTrailer));
+
+        bool bOk = static_cast<bool>(m_cFile);
+        m_cFile.close();
+        return bOk;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Keyframes written so far */
+      const std::vector<CRecordingFormat::SIndexEntry>& GetIndex() const {
+        return m_vecIndex;
+      }
+
+     private:
+      std::ofstream m_cFile;
+
+      /** Offset of the next record */
+      uint64_t m_unOffset;
+
+      /** Steps of the last frame */
+      uint64_t m_unSteps;
+
+      std::vector<CRecordingFormat::SIndexEntry> m_vecIndex;
+
+      /** Reused compression buffer */
+      std::string m_strCompressed;
+    };
+
+    /****************************************/
+    /****************************************/
+
+    /**
+     * @brief Reads a recording file through a read-only memory mapping
+     *
+     * Opening only reads the header and the index, records are paged in by
+     * the OS when they are read, so large recordings open right away. A
+     * recording without index (not closed) is indexed by going through the
+     * record headers, up to the last complete record.
+     */
+    class CRecordingReader {
+     public:
+      CRecordingReader()
+          : m_pchData(nullptr),
+            m_unSize(0),
+            m_unEnd(0),
+            m_unLastSteps(0),
+            m_bIndexed(false) {}
+
+      ~CRecordingReader() { Close(); }
+
+      CRecordingReader(const CRecordingReader&) = delete;
+      CRecordingReader& operator=(const CRecordingReader&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Maps a recording file
+       *
+       * @return false if the file can not be read or is not a recording
+       */
+      bool Open(const std::string& str_path) {
+        Close();
+        int nFile = open(str_path.c_str(), O_RDONLY);
+        if (nFile < 0) {
+          return false;
+        }
+        struct stat sStat;
+        if (
+          fstat(nFile, &sStat) != 0 ||
+          static_cast<size_t>(sStat.st_size) <
+            CRecordingFormat::FILE_HEADER_SIZE) {
+          close(nFile);
+          return false;
+        }
+        void* pData =
+          mmap(nullptr, sStat.st_size, PROT_READ, MAP_PRIVATE, nFile, 0);
+        /* The mapping stays valid once the file is closed */
+        close(nFile);
+        if (pData == MAP_FAILED) {
+          return false;
+        }
+        m_pchData = static_cast<const char*>(pData);
+        m_unSize = sStat.st_size;
+
+        if (
+          std::memcmp(m_pchData, CRecordingFormat::MAGIC, 8) != 0 ||
+          CRecordingFormat::Get32(m_pchData + 8) != CRecordingFormat::VERSION) {
+          Close();
+          return false;
+        }
+
+        m_bIndexed = ReadIndex();
+        if (!m_bIndexed) {
+          ScanRecords();
+        }
+        ReadLastSteps();
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Close() {
+        if (m_pchData != nullptr) {
+          munmap(const_cast<char*>(m_pchData), m_unSize);
+        }
+        m_pchData = nullptr;
+        m_unSize = 0;
+        m_unEnd = 0;
+        m_unLastSteps = 0;
+        m_bIndexed = false;
+        m_vecIndex.clear();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsOpen() const { return m_pchData != nullptr; }
+
+      /** True if the index was written, false if it was rebuilt */
+      bool HasIndex() const { return m_bIndexed; }
+
+      /** Offset of the first record */
+      uint64_t GetBegin() const { return CRecordingFormat::FILE_HEADER_SIZE; }
+
+      /** Offset right after the last record */
+      uint64_t GetEnd() const { return m_unEnd; }
+
+      /** Steps of the last record */
+      uint64_t GetLastSteps() const { return m_unLastSteps; }
+
+      /** Keyframes, in the order of the file */
+      const std::vector<CRecordingFormat::SIndexEntry>& GetIndex() const {
+        return m_vecIndex;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Last keyframe at or before the given steps, or the first
+       * keyframe if they are all after
+       *
+       * @return nullptr if there is no keyframe at all
+       */
+      const CRecordingFormat::SIndexEntry* FindKeyframe(
+        uint64_t un_steps) const {
+        if (m_vecIndex.empty()) {
+          return nullptr;
+        }
+        auto it = std::upper_bound(
+          m_vecIndex.begin(),
+          m_vecIndex.end(),
+          un_steps,
+          [](uint64_t un_value, const CRecordingFormat::SIndexEntry& s_entry) {
+            return un_value < s_entry.m_unSteps;
+          });
+        return it == m_vecIndex.begin() ? &m_vecIndex.front() : &*(it - 1);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads the header of the record at this offset
+       *
+       * @return false if there is no complete record there
+       */
+      bool ReadHeader(
+        uint64_t un_offset, CRecordingFormat::SRecordHeader* ps_header) const {
+        if (
+          m_pchData == nullptr ||
+          un_offset + CRecordingFormat::RECORD_HEADER_SIZE > m_unEnd) {
+          return false;
+        }
+        *ps_header = CRecordingFormat::GetRecordHeader(m_pchData + un_offset);
+        return un_offset + CRecordingFormat::RECORD_HEADER_SIZE +
+                 ps_header->m_unSize <=
+               m_unEnd;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Reads the record at this offset
+       *
+       * @param un_offset offset of the record, like in the index
+       * @param ps_header header of the record
+       * @param pc_frame decoded keyframe or delta
+       * @return offset of the next record, 0 if the record is not valid
+       */
+      uint64_t ReadRecord(
+        uint64_t un_offset,
+        CRecordingFormat::SRecordHeader* ps_header,
+        nlohmann::json* pc_frame) const {
+        if (!ReadHeader(un_offset, ps_header)) {
+          return 0;
+        }
+        if (!CDeflate::Inflate(
+              m_pchData + un_offset + CRecordingFormat::RECORD_HEADER_SIZE,
+              ps_header->m_unSize,
+              &m_strRaw)) {
+          return 0;
+        }
+        try {
+          *pc_frame = nlohmann::json::from_msgpack(m_strRaw);
+        } catch (const nlohmann::json::exception&) {
+          return 0;
+        }
+        return un_offset + CRecordingFormat::RECORD_HEADER_SIZE +
+               ps_header->m_unSize;
+      }
+
+     private:
+      /** Reads the index pointed to by the trailer, if it is valid */
+      bool ReadIndex() {
+        if (
+          m_unSize < CRecordingFormat::FILE_HEADER_SIZE +
+                       CRecordingFormat::TRAILER_SIZE) {
+          return false;
+        }
+        const char* pchTrailer =
+          m_pchData + m_unSize - CRecordingFormat::TRAILER_SIZE;
+        if (
+          std::memcmp(pchTrailer + 16, CRecordingFormat::INDEX_MAGIC, 8) !=
+          0) {
+          return false;
+        }
+        uint64_t unCount = CRecordingFormat::Get64(pchTrailer);
+        uint64_t unOffset = CRecordingFormat::Get64(pchTrailer + 8);
+        if (
+          unOffset < CRecordingFormat::FILE_HEADER_SIZE ||
+          unOffset > m_unSize ||
+          (m_unSize - CRecordingFormat::TRAILER_SIZE - unOffset) !=
+            unCount * CRecordingFormat::INDEX_ENTRY_SIZE) {
+          return false;
+        }
+
+        m_unEnd = unOffset;
+        m_vecIndex.resize(unCount);
+        for (uint64_t i = 0; i < unCount; ++i) {
+          const char* pchEntry =
+            m_pchData + unOffset + i * CRecordingFormat::INDEX_ENTRY_SIZE;
+          m_vecIndex[i].m_unOffset = CRecordingFormat::Get64(pchEntry);
+          m_vecIndex[i].m_unSequence = CRecordingFormat::Get64(pchEntry + 8);
+          m_vecIndex[i].m_unSteps = CRecordingFormat::Get64(pchEntry + 16);
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Rebuilds the index from the record headers */
+      void ScanRecords() {
+        m_vecIndex.clear();
+        m_unEnd = m_unSize;
+        uint64_t unOffset = GetBegin();
+        CRecordingFormat::SRecordHeader sHeader;
+        while (ReadHeader(unOffset, &sHeader)) {
+          if (sHeader.m_unFlags & CRecordingFormat::FLAG_KEYFRAME) {
+            m_vecIndex.push_back(
+              {unOffset, sHeader.m_unSequence, sHeader.m_unSteps});
+          }
+          unOffset += CRecordingFormat::RECORD_HEADER_SIZE + sHeader.m_unSize;
+        }
+        /* A truncated last record is ignored */
+        m_unEnd = unOffset;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Goes through the records after the last keyframe */
+      void ReadLastSteps() {
+        uint64_t unOffset =
+          m_vecIndex.empty() ? GetBegin() : m_vecIndex.back().m_unOffset;
+        CRecordingFormat::SRecordHeader sHeader;
+        while (ReadHeader(unOffset, &sHeader)) {
+          m_unLastSteps = sHeader.m_unSteps;
+          unOffset += CRecordingFormat::RECORD_HEADER_SIZE + sHeader.m_unSize;
+        }
+      }
+
+     private:
+      const char* m_pchData;
+      uint64_t m_unSize;
+
+      /** Offset right after the last record */
+      uint64_t m_unEnd;
+
+      uint64_t m_unLastSteps;
+      bool m_bIndexed;
+
+      std::vector<CRecordingFormat::SIndexEntry> m_vecIndex;
+
+      /** Reused decompression buffer */
+      mutable std::string m_strRaw;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
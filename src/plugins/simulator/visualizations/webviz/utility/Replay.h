@@ -0,0 +1,197 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/Replay.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_REPLAY_H
+#define ARGOS_WEBVIZ_REPLAY_H
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "DeltaEncoder.h"
+#include "Recording.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Plays a recording back, frame by frame or by simulation steps
+     *
+     * Keeps the full state at the current position, rebuilt from the
+     * keyframes and deltas of the recording. Seeking starts from the closest
+     * keyframe before the target, so it only decodes the frames in between.
+     */
+    class CReplay {
+     public:
+      CReplay() : m_unOffset(0), m_unClock(0), m_unFrameSteps(0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Opens a recording and goes to its first frame
+       *
+       * @return false if the file is not a recording, or is empty
+       */
+      bool Open(const std::string& str_path) {
+        return m_cReader.Open(str_path) && Rewind();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Goes back to the first frame */
+      bool Rewind() {
+        m_unOffset = m_cReader.GetBegin();
+        m_cState = nullptr;
+        return Step();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Goes to the next frame, and moves the clock to it
+       *
+       * @return false at the end of the recording, or if the next record
+       * can not be read, which ends the replay as well
+       */
+      bool Step() {
+        CRecordingFormat::SRecordHeader sHeader;
+        nlohmann::json cFrame;
+        uint64_t unNext = m_cReader.ReadRecord(m_unOffset, &sHeader, &cFrame);
+        if (unNext == 0) {
+          m_unOffset = m_cReader.GetEnd();
+          return false;
+        }
+        CDeltaEncoder::Apply(m_cState, cFrame);
+        m_unOffset = unNext;
+        m_unFrameSteps = sHeader.m_unSteps;
+        m_unClock = m_unFrameSteps;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Moves the clock forward, through the frames recorded until
+       * then
+       *
+       * @param un_steps simulation steps to move the clock by
+       * @return number of frames gone through
+       */
+      uint32_t Advance(uint64_t un_steps) {
+        uint64_t unTarget = m_unClock + un_steps;
+        uint32_t unFrames = 0;
+        CRecordingFormat::SRecordHeader sHeader;
+        while (m_cReader.ReadHeader(m_unOffset, &sHeader) &&
+               sHeader.m_unSteps <= unTarget && Step()) {
+          ++unFrames;
+        }
+        m_unClock = unTarget;
+        return unFrames;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Goes to the last frame at or before the given steps (the
+       * first frame if the recording starts after them)
+       *
+       * @return false if the recording has no keyframe to start from
+       */
+      bool Seek(uint64_t un_steps) {
+        const CRecordingFormat::SIndexEntry* psKeyframe =
+          m_cReader.FindKeyframe(un_steps);
+        if (psKeyframe == nullptr) {
+          return false;
+        }
+        m_unOffset = psKeyframe->m_unOffset;
+        m_cState = nullptr;
+        if (!Step()) {
+          return false;
+        }
+        if (un_steps > m_unClock) {
+          Advance(un_steps - m_unClock);
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Full state of the current frame */
+      const nlohmann::json& GetState() const { return m_cState; }
+
+      /** Steps of the current frame */
+      uint64_t GetFrameSteps() const { return m_unFrameSteps; }
+
+      /** Steps the replay is at, can be after the current frame */
+      uint64_t GetClock() const { return m_unClock; }
+
+      /** True once the last frame is reached */
+      bool IsAtEnd() const { return m_unOffset >= m_cReader.GetEnd(); }
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetFirstSteps() const {
+        return m_cReader.GetIndex().empty()
+                 ? 0
+                 : m_cReader.GetIndex().front().m_unSteps;
+      }
+
+      uint64_t GetLastSteps() const { return m_cReader.GetLastSteps(); }
+
+      const CRecordingReader& GetReader() const { return m_cReader; }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Refuses the commands which change the experiment, as there is
+       * nothing to change in a recording
+       *
+       * @param c_command command of a client
+       * @param c_ack its acknowledgement, set to failed if it is refused
+       * @return true if the command must not be run
+       */
+      static bool RefuseCommand(
+        const nlohmann::json& c_command, nlohmann::json& c_ack) {
+        if (
+          !c_command.contains("command") || !c_command["command"].is_string()) {
+          return false;
+        }
+        const std::string strCmd = c_command["command"].get<std::string>();
+        if (strCmd != "moveEntity" && strCmd != "batch") {
+          return false;
+        }
+        c_ack["ok"] = false;
+        c_ack["error"] = "not available while replaying";
+        return true;
+      }
+
+     private:
+      CRecordingReader m_cReader;
+
+      /** Offset of the next record */
+      uint64_t m_unOffset;
+
+      uint64_t m_unClock;
+      uint64_t m_unFrameSteps;
+
+      nlohmann::json m_cState;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
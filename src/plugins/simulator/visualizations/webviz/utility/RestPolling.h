@@ -0,0 +1,124 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/RestPolling.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_REST_POLLING_H
+#define ARGOS_WEBVIZ_REST_POLLING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "DeltaEncoder.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Decides when the REST routes need more than the websocket
+     * clients want
+     *
+     * The REST state is rebuilt from the broadcasted frames, which only have
+     * the types and fields the websocket clients asked for. When it misses
+     * some, the REST pollers require everything to be generated, for as long
+     * as they keep polling. It costs nothing while no client filters.
+     *
+     * Thread-safe, requests come from any loop and the masks are read by the
+     * simulation thread.
+     */
+    class CRestPolling {
+     public:
+      using TClock = std::chrono::steady_clock;
+
+      /**
+       * @brief Construct a new CRestPolling
+       *
+       * @param c_timeout everything stays required this long after the last
+       * request
+       */
+      explicit CRestPolling(
+        std::chrono::milliseconds c_timeout = std::chrono::seconds(10))
+          : m_cTimeout(c_timeout), m_nRequiredUntil(0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Called for each REST request
+       *
+       * @param b_complete if the latest state has all the types and fields
+       * @return true if the state can be served, false if the request has
+       * to be retried once everything is generated
+       */
+      bool OnRequest(
+        bool b_complete, TClock::time_point c_now = TClock::now()) {
+        /* Kept complete while polled, or made complete for the next ones */
+        if (!b_complete || IsRequired(c_now)) {
+          m_nRequiredUntil = ToMillis(c_now + m_cTimeout);
+        }
+        return b_complete;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** True if everything must be generated for the REST pollers */
+      bool IsRequired(TClock::time_point c_now = TClock::now()) const {
+        return ToMillis(c_now) < m_nRequiredUntil;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Rebuilds the state of the latest frame, from a keyframe and
+       * the deltas after it
+       *
+       * @param vec_frames FRAME has the frame before encoding in m_psJSON,
+       * and m_bComplete set if nothing was left out when generating it
+       * @param c_state full state, without "keyframe" and "session"
+       * @return true if it has all the types and fields
+       */
+      template <class FRAME>
+      static bool Rebuild(
+        const std::vector<std::shared_ptr<const FRAME>>& vec_frames,
+        nlohmann::json* c_state) {
+        *c_state = nullptr;
+        for (const auto& psFrame : vec_frames) {
+          CDeltaEncoder::Apply(*c_state, *psFrame->m_psJSON);
+        }
+        if (c_state->is_object()) {
+          c_state->erase("keyframe");
+          c_state->erase("session");
+        }
+        /* A delta has at least what the previous frames left out, if it
+         * was generated with it */
+        return !vec_frames.empty() && vec_frames.back()->m_bComplete;
+      }
+
+     private:
+      static int64_t ToMillis(TClock::time_point c_time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                 c_time.time_since_epoch())
+          .count();
+      }
+
+     private:
+      std::chrono::milliseconds m_cTimeout;
+
+      /** In milli-secs since the epoch of TClock */
+      std::atomic<int64_t> m_nRequiredUntil;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
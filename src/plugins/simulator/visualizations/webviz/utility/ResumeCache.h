@@ -0,0 +1,261 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/ResumeCache.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_RESUME_CACHE_H
+#define ARGOS_WEBVIZ_RESUME_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Latest keyframe and the last deltas, so a client gets the state
+     * as soon as it connects, and a reconnecting one only what it missed
+     *
+     * Frames are kept as they were encoded (FRAME has an uint64_t
+     * m_unSequence) and shared with the broadcasts. Add() is called by one
+     * thread, with the frames in order; the others from any thread.
+     *
+     * All the deltas after the keyframe are kept: when the oldest of them
+     * would be dropped, a newer keyframe is made first.
+     *
+     * Once invalidated (the frames miss what new clients want), clients
+     * wait for the next keyframe, but the frames are still kept for
+     * GetLatest().
+     */
+    template <class FRAME>
+    class CResumeCache {
+     public:
+      using TFrame = std::shared_ptr<const FRAME>;
+
+      /**
+       * @brief Construct a new CResumeCache
+       *
+       * @param un_deltas number of deltas kept
+       */
+      explicit CResumeCache(size_t un_deltas = 64)
+          : m_unDeltas(std::max<size_t>(un_deltas, 1)) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds the frame which was just broadcasted
+       *
+       * Deltas are ignored until the first keyframe is added.
+       *
+       * @param ps_frame keyframe or delta, its sequence follows the last one
+       * @param b_keyframe if ps_frame is a keyframe
+       * @param ps_keyframe keyframe of the same state, if one was encoded
+       * anyway (null otherwise), it replaces the cached one for free
+       * @param fn_make_keyframe makes a keyframe of the same state as
+       * ps_frame, when the cached one is about to be too old
+       */
+      void Add(
+        TFrame ps_frame,
+        bool b_keyframe,
+        TFrame ps_keyframe,
+        const std::function<TFrame()>& fn_make_keyframe) {
+        std::shared_ptr<const SState> psLast;
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4State);
+          psLast = m_psState;
+        }
+
+        /* Deltas are useless until the first keyframe */
+        if (!b_keyframe && !psLast) {
+          return;
+        }
+
+        auto psState = std::make_shared<SState>();
+        if (b_keyframe) {
+          psState->m_psKeyframe = std::move(ps_frame);
+        } else {
+          *psState = *psLast;
+          psState->m_deqDeltas.push_back(std::move(ps_frame));
+
+          if (
+            ps_keyframe && ps_keyframe->m_unSequence >
+                             psState->m_psKeyframe->m_unSequence) {
+            psState->m_psKeyframe = std::move(ps_keyframe);
+          }
+
+          if (psState->m_deqDeltas.size() > m_unDeltas) {
+            /* The oldest delta follows the keyframe */
+            if (
+              psState->m_deqDeltas.front()->m_unSequence >
+              psState->m_psKeyframe->m_unSequence) {
+              TFrame psKeyframe = fn_make_keyframe();
+              if (!psKeyframe) {
+                Clear(psLast);
+                return;
+              }
+              psState->m_psKeyframe = std::move(psKeyframe);
+            }
+            psState->m_deqDeltas.pop_front();
+          }
+        }
+
+        std::lock_guard<std::mutex> guard(m_mutex4State);
+        /* Invalidated meanwhile, still invalid until a keyframe */
+        if (!b_keyframe && m_psState != psLast) {
+          psState->m_bInvalid = true;
+        }
+        m_psState = std::move(psState);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** New clients wait for the next keyframe, Get() fails until then */
+      void Invalidate() {
+        std::lock_guard<std::mutex> guard(m_mutex4State);
+        if (m_psState && !m_psState->m_bInvalid) {
+          auto psState = std::make_shared<SState>(*m_psState);
+          psState->m_bInvalid = true;
+          m_psState = std::move(psState);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Frames bringing a client to the latest broadcast
+       *
+       * @param b_resume if un_sequence is the last frame the client applied,
+       * false for a new client
+       * @param un_sequence last frame the client applied
+       * @param vec_frames frames to send in order: only the deltas after
+       * un_sequence if they are all kept, the keyframe and the deltas after
+       * it otherwise. Empty if it is up to date
+       * @param un_last_sequence sequence the client is at after them
+       * @param pb_resumed true if only deltas were needed, can be null
+       * @return false if there is no keyframe, or if it was invalidated
+       */
+      bool Get(
+        bool b_resume,
+        uint64_t un_sequence,
+        std::vector<TFrame>* vec_frames,
+        uint64_t* un_last_sequence,
+        bool* pb_resumed = nullptr) const {
+        std::shared_ptr<const SState> psState;
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4State);
+          psState = m_psState;
+        }
+        if (!psState || psState->m_bInvalid) {
+          return false;
+        }
+        const auto& deqDeltas = psState->m_deqDeltas;
+        uint64_t unLast = psState->GetLastSequence();
+
+        uint64_t unFrom = psState->m_psKeyframe->m_unSequence;
+        bool bResumed =
+          b_resume && un_sequence <= unLast &&
+          (unFrom <= un_sequence ||
+           (!deqDeltas.empty() &&
+            deqDeltas.front()->m_unSequence <= un_sequence + 1));
+        if (bResumed) {
+          unFrom = un_sequence;
+        }
+
+        vec_frames->clear();
+        if (!bResumed) {
+          vec_frames->push_back(psState->m_psKeyframe);
+        }
+        for (const auto& psDelta : deqDeltas) {
+          if (psDelta->m_unSequence > unFrom) {
+            vec_frames->push_back(psDelta);
+          }
+        }
+
+        *un_last_sequence = unLast;
+        if (pb_resumed != nullptr) {
+          *pb_resumed = bResumed;
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Keyframe and the deltas after it, up to the latest frame,
+       * even once invalidated
+       *
+       * @return false if no keyframe was added yet
+       */
+      bool GetLatest(
+        std::vector<TFrame>* vec_frames, uint64_t* un_last_sequence) const {
+        std::shared_ptr<const SState> psState;
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4State);
+          psState = m_psState;
+        }
+        if (!psState) {
+          return false;
+        }
+
+        vec_frames->assign(1, psState->m_psKeyframe);
+        for (const auto& psDelta : psState->m_deqDeltas) {
+          if (psDelta->m_unSequence > psState->m_psKeyframe->m_unSequence) {
+            vec_frames->push_back(psDelta);
+          }
+        }
+        *un_last_sequence = psState->GetLastSequence();
+        return true;
+      }
+
+     private:
+      /** Never modified once shared, Add() and Invalidate() replace it */
+      struct SState {
+        TFrame m_psKeyframe;
+
+        /** Misses what new clients want, until the next keyframe */
+        bool m_bInvalid = false;
+
+        /** Consecutive sequences, up to the latest frame */
+        std::deque<TFrame> m_deqDeltas;
+
+        uint64_t GetLastSequence() const {
+          if (m_deqDeltas.empty()) {
+            return m_psKeyframe->m_unSequence;
+          }
+          return std::max(
+            m_psKeyframe->m_unSequence, m_deqDeltas.back()->m_unSequence);
+        }
+      };
+
+      /** Clears, unless it changed since ps_last */
+      void Clear(const std::shared_ptr<const SState>& ps_last) {
+        std::lock_guard<std::mutex> guard(m_mutex4State);
+        if (m_psState == ps_last) {
+          m_psState.reset();
+        }
+      }
+
+     private:
+      size_t m_unDeltas;
+
+      std::shared_ptr<const SState> m_psState;
+      mutable std::mutex m_mutex4State;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
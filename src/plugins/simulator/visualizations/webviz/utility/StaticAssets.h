@@ -0,0 +1,201 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/StaticAssets.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_STATIC_ASSETS_H
+#define ARGOS_WEBVIZ_STATIC_ASSETS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Deflate.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Files of the web client, held in memory to be served over HTTP
+     *
+     * Everything is read and compressed once, when loading, so serving a
+     * file is a lookup. The gzip version of a file is only kept when it is
+     * smaller, which leaves out images and fonts.
+     *
+     * It is not modified once given to the server, so it can be read from
+     * any thread.
+     */
+    class CStaticAssets {
+     public:
+      struct SAsset {
+        std::string m_strContentType;
+
+        std::string m_strBody;
+
+        /** Body with "Content-Encoding: gzip", empty if not smaller */
+        std::string m_strGzip;
+
+        /** Quoted, as in the "ETag" header */
+        std::string m_strETag;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds all the files under a directory, with their path
+       * relative to it
+       *
+       * @param str_dir directory of the client, like "client"
+       * @return false if it is not a directory, or a file can't be read
+       */
+      bool Load(const std::string& str_dir) {
+        std::error_code cError;
+        std::filesystem::path cRoot(str_dir);
+        if (!std::filesystem::is_directory(cRoot, cError)) {
+          return false;
+        }
+
+        for (std::filesystem::recursive_directory_iterator
+               it(cRoot, cError),
+             itEnd;
+             it != itEnd;
+             it.increment(cError)) {
+          if (cError) {
+            return false;
+          }
+          if (!it->is_regular_file(cError)) {
+            continue;
+          }
+
+          std::ifstream cFile(it->path(), std::ios::binary);
+          if (!cFile) {
+            return false;
+          }
+          std::ostringstream cBody;
+          cBody << cFile.rdbuf();
+
+          Add(
+            "/" + it->path().lexically_relative(cRoot).generic_string(),
+            cBody.str());
+        }
+        return !cError;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Adds a file, replacing the one at the same path
+       *
+       * @param str_path absolute path in the URL, like "/js/main.js"
+       * @param str_body content of the file
+       */
+      void Add(const std::string& str_path, std::string str_body) {
+        SAsset& sAsset = m_mapAssets[str_path];
+        sAsset.m_strContentType = GetContentType(str_path);
+        sAsset.m_strETag = GetETag(str_body);
+        sAsset.m_strBody = std::move(str_body);
+
+        sAsset.m_strGzip.clear();
+        if (
+          !CDeflate::Gzip(sAsset.m_strBody, &sAsset.m_strGzip) ||
+          sAsset.m_strBody.size() <= sAsset.m_strGzip.size()) {
+          sAsset.m_strGzip.clear();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Finds the file of a path, "index.html" for directories
+       *
+       * @param str_path path in the URL, without the query
+       * @return nullptr if there is no such file
+       */
+      const SAsset* Find(std::string_view str_path) const {
+        std::string strPath(str_path);
+        if (strPath.empty() || strPath.back() == '/') {
+          strPath += "index.html";
+        }
+        auto it = m_mapAssets.find(strPath);
+        if (it == m_mapAssets.end()) {
+          return nullptr;
+        }
+        return &it->second;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetCount() const {
+        return m_mapAssets.size();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static std::string GetContentType(const std::string& str_path) {
+        static const std::unordered_map<std::string, std::string> mapTypes = {
+          {".html", "text/html; charset=utf-8"},
+          {".js", "application/javascript; charset=utf-8"},
+          {".css", "text/css; charset=utf-8"},
+          {".json", "application/json"},
+          {".svg", "image/svg+xml"},
+          {".png", "image/png"},
+          {".jpg", "image/jpeg"},
+          {".jpeg", "image/jpeg"},
+          {".gif", "image/gif"},
+          {".ico", "image/x-icon"},
+          {".woff", "font/woff"},
+          {".woff2", "font/woff2"},
+          {".ttf", "font/ttf"},
+          {".eot", "application/vnd.ms-fontobject"},
+          {".txt", "text/plain; charset=utf-8"},
+          {".py", "text/plain; charset=utf-8"},
+        };
+
+        size_t unDot = str_path.find_last_of("./");
+        if (unDot != std::string::npos && str_path[unDot] == '.') {
+          auto it = mapTypes.find(str_path.substr(unDot));
+          if (it != mapTypes.end()) {
+            return it->second;
+          }
+        }
+        return "application/octet-stream";
+      }
+
+     private:
+      /** FNV-1a of the content, so it only changes with it */
+      static std::string GetETag(const std::string& str_body) {
+        uint64_t unHash = 14695981039346656037ULL;
+        for (unsigned char unByte : str_body) {
+          unHash = (unHash ^ unByte) * 1099511628211ULL;
+        }
+        char pchETag[19];
+        std::snprintf(
+          pchETag,
+          sizeof(pchETag),
+          "\"%016llx\"",
+          static_cast<unsigned long long>(unHash));
+        return pchETag;
+      }
+
+     private:
+      std::unordered_map<std::string, SAsset> m_mapAssets;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/ThreadPool.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_THREAD_POOL_H
+#define ARGOS_WEBVIZ_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Persistent pool of worker threads running indexed tasks
+     *
+     * Threads are started once and sleep between two calls to
+     * ParallelFor(), so there is no thread creation in the hot path.
+     */
+    class CThreadPool {
+     public:
+      /**
+       * @brief Construct a new CThreadPool
+       *
+       * @param un_threads number of worker threads, the calling thread
+       * works as well during ParallelFor()
+       * @param fn_thread_init optional function run once in each worker
+       * thread when it starts
+       */
+      explicit CThreadPool(
+        size_t un_threads, std::function<void()> fn_thread_init = nullptr)
+          : m_unGeneration(0), m_bStop(false) {
+        for (size_t i = 0; i < un_threads; ++i) {
+          m_vecThreads.emplace_back([this, fn_thread_init]() {
+            if (fn_thread_init) {
+              fn_thread_init();
+            }
+            WorkerFunction();
+          });
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      ~CThreadPool() {
+        {
+          std::lock_guard<std::mutex> guard(m_mutex);
+          m_bStop = true;
+        }
+        m_cvWork.notify_all();
+        for (auto& tThread : m_vecThreads) {
+          tThread.join();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Number of worker threads */
+      size_t GetSize() const { return m_vecThreads.size(); }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Runs fn_task(i) for every i in [0, un_tasks) and blocks
+       * until all of them are done
+       *
+       * Tasks are picked in increasing order by the workers and the calling
+       * thread. The first exception thrown by a task is rethrown here, once
+       * all the tasks are done. Not reentrant: only one thread should call
+       * ParallelFor() at a time.
+       */
+      void ParallelFor(
+        size_t un_tasks, const std::function<void(size_t)>& fn_task) {
+        if (un_tasks == 0) {
+          return;
+        }
+
+        auto psJob = std::make_shared<SJob>(fn_task, un_tasks);
+        {
+          std::lock_guard<std::mutex> guard(m_mutex);
+          m_psJob = psJob;
+          ++m_unGeneration;
+        }
+        m_cvWork.notify_all();
+
+        RunTasks(*psJob);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cvDone.wait(
+          lock, [&psJob]() { return psJob->m_unDone == psJob->m_unTasks; });
+        /* Late workers find nothing left in it, and do not run fn_task */
+        m_psJob.reset();
+
+        if (psJob->m_pcException) {
+          std::rethrow_exception(psJob->m_pcException);
+        }
+      }
+
+     private:
+      /** Tasks of one ParallelFor() call, with their own counters */
+      struct SJob {
+        SJob(const std::function<void(size_t)>& fn_task, size_t un_tasks)
+            : m_fnTask(fn_task), m_unTasks(un_tasks), m_unNext(0),
+              m_unDone(0) {}
+
+        const std::function<void(size_t)>& m_fnTask;
+
+        const size_t m_unTasks;
+
+        /** Next task to pick */
+        std::atomic<size_t> m_unNext;
+
+        /** Number of tasks done */
+        std::atomic<size_t> m_unDone;
+
+        /** First exception thrown by a task, protected by m_mutex */
+        std::exception_ptr m_pcException;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      void WorkerFunction() {
+        size_t unSeenGeneration = 0;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+          m_cvWork.wait(lock, [&]() {
+            return m_bStop || m_unGeneration != unSeenGeneration;
+          });
+          if (m_bStop) {
+            return;
+          }
+          /* The job of this generation, read with it */
+          unSeenGeneration = m_unGeneration;
+          std::shared_ptr<SJob> psJob = m_psJob;
+          lock.unlock();
+
+          if (psJob) {
+            RunTasks(*psJob);
+          }
+
+          lock.lock();
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void RunTasks(SJob& s_job) {
+        size_t unIndex;
+        while ((unIndex = s_job.m_unNext++) < s_job.m_unTasks) {
+          try {
+            s_job.m_fnTask(unIndex);
+          } catch (...) {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (!s_job.m_pcException) {
+              s_job.m_pcException = std::current_exception();
+            }
+          }
+          if (++s_job.m_unDone == s_job.m_unTasks) {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_cvDone.notify_all();
+          }
+        }
+      }
+
+     private:
+      /** Worker threads */
+      std::vector<std::thread> m_vecThreads;
+
+      /** Job of the current ParallelFor() call, null between two calls */
+      std::shared_ptr<SJob> m_psJob;
+
+      /** Incremented on each call, wakes up the workers */
+      size_t m_unGeneration;
+
+      /** Set to stop the workers */
+      bool m_bStop;
+
+      /** Mutex protecting the members above, and the condition variables */
+      std::mutex m_mutex;
+      std::condition_variable m_cvWork;
+      std::condition_variable m_cvDone;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
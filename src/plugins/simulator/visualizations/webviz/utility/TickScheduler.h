@@ -0,0 +1,111 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/TickScheduler.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_TICK_SCHEDULER_H
+#define ARGOS_WEBVIZ_TICK_SCHEDULER_H
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Paces a loop at a fixed period, with microsecond resolution
+     *
+     * Ticks are scheduled on absolute deadlines (start + n * period), so
+     * the time spent in the loop and the sleep inaccuracies do not add up
+     * over time. When the loop falls more than one period behind, the
+     * missed ticks are dropped instead of being run in a burst.
+     */
+    class CTickScheduler {
+      typedef std::chrono::steady_clock TClockType;
+
+     public:
+      typedef std::chrono::microseconds TMicroseconds;
+
+      /****************************************/
+      /****************************************/
+
+      explicit CTickScheduler(TMicroseconds c_period = TMicroseconds(0))
+          : m_cPeriod(c_period), m_cLag(0) {
+        Start();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sets the period from a duration in seconds
+       *
+       * Takes effect from the next tick.
+       */
+      void SetPeriod(double f_seconds) {
+        m_cPeriod = TMicroseconds(std::llround(f_seconds * 1e6));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      TMicroseconds GetPeriod() const { return m_cPeriod; }
+
+      /****************************************/
+      /****************************************/
+
+      /** Schedules the first tick one period from now */
+      void Start() {
+        m_tNextTick = TClockType::now() + m_cPeriod;
+        m_cLag = TMicroseconds(0);
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Sleeps until the next tick
+       *
+       * @return false if the next tick was already missed by more than one
+       * period, then the schedule is restarted from now without sleeping
+       */
+      bool WaitNextTick() {
+        TClockType::time_point tNow = TClockType::now();
+
+        if (tNow > m_tNextTick + m_cPeriod) {
+          m_cLag =
+            std::chrono::duration_cast<TMicroseconds>(tNow - m_tNextTick);
+          m_tNextTick = tNow + m_cPeriod;
+          return false;
+        }
+
+        m_cLag = TMicroseconds(0);
+        if (tNow < m_tNextTick) {
+          std::this_thread::sleep_until(m_tNextTick);
+        }
+        m_tNextTick += m_cPeriod;
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** How late the last missed tick was */
+      TMicroseconds GetLag() const { return m_cLag; }
+
+     private:
+      TMicroseconds m_cPeriod;
+      TMicroseconds m_cLag;
+      TClockType::time_point m_tNextTick;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,191 @@
+/**
+ * @file <argos3/plugins/simulator/visualizations/webviz/utility/UniformGrid.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_UNIFORM_GRID_H
+#define ARGOS_WEBVIZ_UNIFORM_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Uniform grid over 2D points, to find the points in a rectangle
+     * without going through all of them
+     *
+     * Built once for a set of points, and then only read, so it can be
+     * queried from many threads. Points are stored cell by cell in one
+     * array (counting sort), there is no allocation per cell.
+     */
+    class CUniformGrid {
+     public:
+      struct SPoint {
+        double m_fX;
+        double m_fY;
+      };
+
+      /****************************************/
+      /****************************************/
+
+      CUniformGrid()
+          : m_fMinX(0),
+            m_fMinY(0),
+            m_fCellWidth(1),
+            m_fCellHeight(1),
+            m_unCellsX(1),
+            m_unCellsY(1),
+            m_vecCellStart(2, 0) {}
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Indexes points, replacing the previous ones
+       *
+       * Points outside the bounds are kept in the cells on the border.
+       *
+       * @param vec_points points, queries return indices in this vector
+       * @param f_min_x lower x bound of the grid
+       * @param f_min_y lower y bound of the grid
+       * @param f_max_x upper x bound of the grid
+       * @param f_max_y upper y bound of the grid
+       * @param un_cells_per_side cells along x and y, chosen from the number
+       * of points if 0
+       */
+      void Build(
+        const std::vector<SPoint>& vec_points,
+        double f_min_x,
+        double f_min_y,
+        double f_max_x,
+        double f_max_y,
+        size_t un_cells_per_side = 0) {
+        m_vecPoints = vec_points;
+
+        if (un_cells_per_side == 0) {
+          /* About 4 points per cell */
+          un_cells_per_side = static_cast<size_t>(
+            std::sqrt(static_cast<double>(vec_points.size()) / 4));
+          un_cells_per_side =
+            std::min<size_t>(std::max<size_t>(un_cells_per_side, 1), 256);
+        }
+
+        m_fMinX = f_min_x;
+        m_fMinY = f_min_y;
+        m_unCellsX = un_cells_per_side;
+        m_unCellsY = un_cells_per_side;
+        m_fCellWidth = std::max(f_max_x - f_min_x, 1e-9) / m_unCellsX;
+        m_fCellHeight = std::max(f_max_y - f_min_y, 1e-9) / m_unCellsY;
+
+        /* Count the points of each cell, then place them */
+        m_vecCellStart.assign(m_unCellsX * m_unCellsY + 1, 0);
+        std::vector<size_t> vecCells(vec_points.size());
+        for (size_t i = 0; i < vec_points.size(); ++i) {
+          vecCells[i] = CellOf(vec_points[i].m_fX, vec_points[i].m_fY);
+          ++m_vecCellStart[vecCells[i] + 1];
+        }
+        for (size_t c = 1; c < m_vecCellStart.size(); ++c) {
+          m_vecCellStart[c] += m_vecCellStart[c - 1];
+        }
+
+        m_vecIndices.resize(vec_points.size());
+        std::vector<size_t> vecNext(
+          m_vecCellStart.begin(), m_vecCellStart.end() - 1);
+        for (size_t i = 0; i < vec_points.size(); ++i) {
+          m_vecIndices[vecNext[vecCells[i]]++] = i;
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Appends the indices of the points inside a rectangle (bounds
+       * included)
+       */
+      void Query(
+        double f_min_x,
+        double f_min_y,
+        double f_max_x,
+        double f_max_y,
+        std::vector<size_t>& vec_out) const {
+        if (f_max_x < f_min_x || f_max_y < f_min_y) {
+          return;
+        }
+
+        size_t unX0 = ColumnOf(f_min_x), unX1 = ColumnOf(f_max_x);
+        size_t unY0 = RowOf(f_min_y), unY1 = RowOf(f_max_y);
+
+        for (size_t y = unY0; y <= unY1; ++y) {
+          for (size_t x = unX0; x <= unX1; ++x) {
+            size_t unCell = y * m_unCellsX + x;
+            for (size_t i = m_vecCellStart[unCell];
+                 i < m_vecCellStart[unCell + 1];
+                 ++i) {
+              const SPoint& sPoint = m_vecPoints[m_vecIndices[i]];
+              if (
+                f_min_x <= sPoint.m_fX && sPoint.m_fX <= f_max_x &&
+                f_min_y <= sPoint.m_fY && sPoint.m_fY <= f_max_y) {
+                vec_out.push_back(m_vecIndices[i]);
+              }
+            }
+          }
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t GetNumCells() const { return m_unCellsX * m_unCellsY; }
+
+     private:
+      size_t ColumnOf(double f_x) const {
+        double fColumn = std::floor((f_x - m_fMinX) / m_fCellWidth);
+        return static_cast<size_t>(
+          std::min(std::max(fColumn, 0.0), double(m_unCellsX - 1)));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t RowOf(double f_y) const {
+        double fRow = std::floor((f_y - m_fMinY) / m_fCellHeight);
+        return static_cast<size_t>(
+          std::min(std::max(fRow, 0.0), double(m_unCellsY - 1)));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      size_t CellOf(double f_x, double f_y) const {
+        return RowOf(f_y) * m_unCellsX + ColumnOf(f_x);
+      }
+
+     private:
+      double m_fMinX;
+      double m_fMinY;
+      double m_fCellWidth;
+      double m_fCellHeight;
+      size_t m_unCellsX;
+      size_t m_unCellsY;
+
+      /** Indexed points */
+      std::vector<SPoint> m_vecPoints;
+
+      /** Points of cell c are m_vecIndices[m_vecCellStart[c]..[c + 1]] */
+      std::vector<size_t> m_vecCellStart;
+      std::vector<size_t> m_vecIndices;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/ViewportFilter.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_VIEWPORT_FILTER_H
+#define ARGOS_WEBVIZ_VIEWPORT_FILTER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "UniformGrid.h"
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Filters broadcasts down to the entities inside a rectangle of
+     * the arena (the viewport of a client)
+     *
+     * Built once per experiment state, with a uniform grid over the entity
+     * positions, and then only read, one query per client. Entities without
+     * a position (like the floor) are always visible.
+     */
+    class CViewportFilter {
+     public:
+      /** Rectangle of the arena, in meters */
+      struct SRect {
+        double m_fMinX;
+        double m_fMinY;
+        double m_fMaxX;
+        double m_fMaxY;
+      };
+
+      typedef std::unordered_set<std::string> TVisibleSet;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Indexes a full experiment state
+       *
+       * @param c_state full state, as given to the delta encoder
+       * @param un_sequence sequence number of the broadcast of this state
+       */
+      CViewportFilter(nlohmann::json c_state, uint64_t un_sequence)
+          : m_cState(std::move(c_state)), m_unSequence(un_sequence) {
+        std::vector<CUniformGrid::SPoint> vecPoints;
+        double fMinX = std::numeric_limits<double>::max();
+        double fMinY = std::numeric_limits<double>::max();
+        double fMaxX = std::numeric_limits<double>::lowest();
+        double fMaxY = std::numeric_limits<double>::lowest();
+
+        const nlohmann::json& cEntities = Entities();
+        for (size_t i = 0; i < cEntities.size(); ++i) {
+          const nlohmann::json& cEntity = cEntities[i];
+          if (!cEntity.contains("id")) {
+            continue;
+          }
+          m_mapIndices[cEntity["id"].get<std::string>()] = i;
+
+          auto itPosition = cEntity.find("position");
+          if (itPosition == cEntity.end() || !itPosition->is_object()) {
+            m_vecAlwaysVisible.push_back(i);
+            continue;
+          }
+          double fX = itPosition->value("x", 0.0);
+          double fY = itPosition->value("y", 0.0);
+          vecPoints.push_back({fX, fY});
+          m_vecPointEntities.push_back(i);
+
+          fMinX = std::min(fMinX, fX);
+          fMinY = std::min(fMinY, fY);
+          fMaxX = std::max(fMaxX, fX);
+          fMaxY = std::max(fMaxY, fY);
+        }
+
+        if (!vecPoints.empty()) {
+          m_cGrid.Build(vecPoints, fMinX, fMinY, fMaxX, fMaxY);
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Ids of the entities inside a rectangle */
+      TVisibleSet Query(const SRect& s_rect) const {
+        std::vector<size_t> vecPoints;
+        m_cGrid.Query(
+          s_rect.m_fMinX,
+          s_rect.m_fMinY,
+          s_rect.m_fMaxX,
+          s_rect.m_fMaxY,
+          vecPoints);
+
+        const nlohmann::json& cEntities = Entities();
+        TVisibleSet setVisible;
+        setVisible.reserve(vecPoints.size() + m_vecAlwaysVisible.size());
+        for (size_t unPoint : vecPoints) {
+          setVisible.insert(
+            cEntities[m_vecPointEntities[unPoint]]["id"].get<std::string>());
+        }
+        for (size_t unEntity : m_vecAlwaysVisible) {
+          setVisible.insert(cEntities[unEntity]["id"].get<std::string>());
+        }
+        return setVisible;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Ids of all the entities */
+      TVisibleSet GetAll() const {
+        TVisibleSet setAll;
+        setAll.reserve(m_mapIndices.size());
+        for (const auto& cIndex : m_mapIndices) {
+          setAll.insert(cIndex.first);
+        }
+        return setAll;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Entity of the full state, nullptr if there is none with this id */
+      const nlohmann::json* Find(const std::string& str_id) const {
+        auto itIndex = m_mapIndices.find(str_id);
+        if (itIndex == m_mapIndices.end()) {
+          return nullptr;
+        }
+        return &Entities()[itIndex->second];
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Keyframe with only the visible entities
+       */
+      nlohmann::json MakeKeyframe(const TVisibleSet& set_visible) const {
+        nlohmann::json cFrame = CopyHeader(m_cState);
+        cFrame["keyframe"] = true;
+        cFrame["sequence"] = m_unSequence;
+
+        nlohmann::json& cEntities = cFrame["entities"];
+        cEntities = nlohmann::json::array();
+        for (const auto& cEntity : Entities()) {
+          if (IsVisible(cEntity, set_visible)) {
+            cEntities.push_back(cEntity);
+          }
+        }
+        return cFrame;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Delta for a client which had set_previous visible
+       *
+       * Entities entering the viewport are sent whole, entities leaving it
+       * are sent as removed.
+       *
+       * @param c_frame broadcast of this state (keyframe or delta)
+       * @param set_visible entities visible now
+       * @param set_previous entities the client has
+       */
+      nlohmann::json MakeDelta(
+        const nlohmann::json& c_frame,
+        const TVisibleSet& set_visible,
+        const TVisibleSet& set_previous) const {
+        nlohmann::json cFrame = CopyHeader(c_frame);
+        cFrame["keyframe"] = false;
+
+        nlohmann::json& cEntities = cFrame["entities"];
+        cEntities = nlohmann::json::array();
+        nlohmann::json& cRemoved = cFrame["removed"];
+        cRemoved = nlohmann::json::array();
+
+        /* Changes of the entities the client already has */
+        bool bIsKeyframe = c_frame.value("keyframe", true);
+        auto itEntities = c_frame.find("entities");
+        if (!bIsKeyframe && itEntities != c_frame.end()) {
+          for (const auto& cEntity : *itEntities) {
+            if (
+              IsVisible(cEntity, set_visible) &&
+              IsVisible(cEntity, set_previous)) {
+              cEntities.push_back(cEntity);
+            }
+          }
+        }
+
+        /* Entities entering the viewport, everything if c_frame is a
+         * keyframe */
+        for (const auto& strId : set_visible) {
+          if (bIsKeyframe || set_previous.count(strId) == 0) {
+            auto itIndex = m_mapIndices.find(strId);
+            if (itIndex != m_mapIndices.end()) {
+              cEntities.push_back(Entities()[itIndex->second]);
+            }
+          }
+        }
+
+        /* Entities leaving the viewport, or the experiment */
+        for (const auto& strId : set_previous) {
+          if (set_visible.count(strId) == 0) {
+            cRemoved.push_back(strId);
+          }
+        }
+        return cFrame;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      uint64_t GetSequence() const { return m_unSequence; }
+
+     private:
+      const nlohmann::json& Entities() const {
+        static const nlohmann::json cEmpty = nlohmann::json::array();
+        auto itEntities = m_cState.find("entities");
+        if (itEntities == m_cState.end() || !itEntities->is_array()) {
+          return cEmpty;
+        }
+        return *itEntities;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Every top level field except the entities */
+      static nlohmann::json CopyHeader(const nlohmann::json& c_frame) {
+        nlohmann::json cHeader = nlohmann::json::object();
+        for (auto it = c_frame.begin(); it != c_frame.end(); ++it) {
+          if (it.key() != "entities" && it.key() != "removed") {
+            cHeader[it.key()] = it.value();
+          }
+        }
+        return cHeader;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      static bool IsVisible(
+        const nlohmann::json& c_entity, const TVisibleSet& set_visible) {
+        auto itId = c_entity.find("id");
+        return itId != c_entity.end() && itId->is_string() &&
+               set_visible.count(itId->get<std::string>()) > 0;
+      }
+
+     private:
+      /** Full state */
+      nlohmann::json m_cState;
+
+      /** Sequence number of the broadcast of m_cState */
+      uint64_t m_unSequence;
+
+      /** Index of each entity in the "entities" array, by id */
+      std::unordered_map<std::string, size_t> m_mapIndices;
+
+      /** Entity index of each point of the grid */
+      std::vector<size_t> m_vecPointEntities;
+
+      /** Entities without a position */
+      std::vector<size_t> m_vecAlwaysVisible;
+
+      CUniformGrid m_cGrid;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
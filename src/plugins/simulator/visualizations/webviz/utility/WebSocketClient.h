@@ -0,0 +1,514 @@
+/**
+ * @file
+ * <argos3/plugins/simulator/visualizations/webviz/utility/WebSocketClient.h>
+ *
+ * @author Prajankya Sonar - <prajankya@gmail.com>
+ *
+ * @project ARGoS3-Webviz <https://github.com/NESTlab/argos3-webviz>
+ *
+ * MIT License
+ * Copyright (c) 2020 NEST Lab
+ */
+
+#ifndef ARGOS_WEBVIZ_WEBSOCKET_CLIENT_H
+#define ARGOS_WEBVIZ_WEBSOCKET_CLIENT_H
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "base64.h"
+
+/* macOS has SO_NOSIGPIPE instead */
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace argos {
+  namespace Webviz {
+    /**
+     * @brief Minimal blocking websocket client, over plain TCP (ws://)
+     *
+     * Used by the relay to connect to an upstream webserver. Sending is
+     * thread-safe, receiving must be done from a single thread. Messages
+     * are never compressed (no extension is negotiated).
+     */
+    class CWebSocketClient {
+     public:
+      enum class EOpCode : uint8_t {
+        CONTINUATION = 0x0,
+        TEXT = 0x1,
+        BINARY = 0x2,
+        CLOSE = 0x8,
+        PING = 0x9,
+        PONG = 0xA
+      };
+
+      /** Result of Receive() */
+      enum class EReceived { MESSAGE, TIMEOUT, CLOSED };
+
+      /** One frame, as decoded by DecodeFrame() */
+      struct SFrame {
+        bool m_bFin = true;
+        EOpCode m_eOpCode = EOpCode::TEXT;
+        std::string m_strPayload;
+      };
+
+      /** Biggest message accepted, like the webserver */
+      static constexpr uint64_t MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
+      /****************************************/
+      /****************************************/
+
+      CWebSocketClient() : m_nSocket(-1), m_cRandom(std::random_device()()) {}
+
+      ~CWebSocketClient() { Close(); }
+
+      CWebSocketClient(const CWebSocketClient&) = delete;
+      CWebSocketClient& operator=(const CWebSocketClient&) = delete;
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Splits a "ws://host:port/path?query" URL
+       *
+       * The port defaults to 80 and the path to "/".
+       *
+       * @return false if it is not a ws:// URL
+       */
+      static bool ParseURL(
+        const std::string& str_url,
+        std::string* str_host,
+        uint16_t* un_port,
+        std::string* str_path) {
+        const std::string strScheme = "ws://";
+        if (str_url.compare(0, strScheme.size(), strScheme) != 0) {
+          return false;
+        }
+        std::string strRest = str_url.substr(strScheme.size());
+        size_t unSlash = strRest.find_first_of("/?");
+        std::string strAuthority = strRest.substr(0, unSlash);
+        *str_path =
+          unSlash == std::string::npos ? "/" : strRest.substr(unSlash);
+        if (str_path->front() == '?') {
+          str_path->insert(0, "/");
+        }
+
+        size_t unColon = strAuthority.rfind(':');
+        *un_port = 80;
+        if (unColon != std::string::npos) {
+          try {
+            unsigned long unPort = std::stoul(strAuthority.substr(unColon + 1));
+            if (unPort < 1 || 65535 < unPort) {
+              return false;
+            }
+            *un_port = static_cast<uint16_t>(unPort);
+          } catch (const std::exception&) {
+            return false;
+          }
+          strAuthority.resize(unColon);
+        }
+        *str_host = strAuthority;
+        return !str_host->empty();
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Encodes a frame, masked as the clients must
+       *
+       * @param b_masked false for frames of a server
+       */
+      static std::string EncodeFrame(
+        EOpCode e_opcode,
+        const std::string& str_payload,
+        bool b_masked = true,
+        uint32_t un_mask_key = 0) {
+        std::string strFrame;
+        strFrame.reserve(str_payload.size() + 14);
+        strFrame.push_back(static_cast<char>(0x80 | uint8_t(e_opcode)));
+
+        uint8_t unMaskBit = b_masked ? 0x80 : 0x00;
+        uint64_t unSize = str_payload.size();
+        if (unSize < 126) {
+          strFrame.push_back(static_cast<char>(unMaskBit | unSize));
+        } else if (unSize <= 0xFFFF) {
+          strFrame.push_back(static_cast<char>(unMaskBit | 126));
+          strFrame.push_back(static_cast<char>(unSize >> 8));
+          strFrame.push_back(static_cast<char>(unSize));
+        } else {
+          strFrame.push_back(static_cast<char>(unMaskBit | 127));
+          for (int i = 7; i >= 0; --i) {
+            strFrame.push_back(static_cast<char>(unSize >> (8 * i)));
+          }
+        }
+
+        if (!b_masked) {
+          strFrame += str_payload;
+          return strFrame;
+        }
+        char pchMask[4];
+        for (int i = 0; i < 4; ++i) {
+          pchMask[i] = static_cast<char>(un_mask_key >> (8 * (3 - i)));
+        }
+        strFrame.append(pchMask, 4);
+        for (size_t i = 0; i < str_payload.size(); ++i) {
+          strFrame.push_back(str_payload[i] ^ pchMask[i % 4]);
+        }
+        return strFrame;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Decodes a frame at the beginning of a buffer, masked or not
+       *
+       * @return size of the frame, 0 if the buffer does not hold a whole
+       * frame yet
+       * @throws std::length_error if the frame is bigger than
+       * MAX_MESSAGE_SIZE
+       */
+      static size_t DecodeFrame(
+        const char* pch_data, size_t un_size, SFrame* ps_frame) {
+        if (un_size < 2) {
+          return 0;
+        }
+        const uint8_t* punData = reinterpret_cast<const uint8_t*>(pch_data);
+        bool bMasked = (punData[1] & 0x80) != 0;
+        uint64_t unPayload = punData[1] & 0x7F;
+        size_t unHeader = 2;
+        if (unPayload == 126) {
+          unHeader += 2;
+        } else if (unPayload == 127) {
+          unHeader += 8;
+        }
+        if (un_size < unHeader) {
+          return 0;
+        }
+        if (unPayload >= 126) {
+          unPayload = 0;
+          for (size_t i = 2; i < unHeader; ++i) {
+            unPayload = (unPayload << 8) | punData[i];
+          }
+        }
+        if (unPayload > MAX_MESSAGE_SIZE) {
+          throw std::length_error("websocket frame too big");
+        }
+        size_t unMask = unHeader;
+        if (bMasked) {
+          unHeader += 4;
+        }
+        if (un_size < unHeader + unPayload) {
+          return 0;
+        }
+
+        ps_frame->m_bFin = (punData[0] & 0x80) != 0;
+        ps_frame->m_eOpCode = static_cast<EOpCode>(punData[0] & 0x0F);
+        ps_frame->m_strPayload.assign(pch_data + unHeader, unPayload);
+        if (bMasked) {
+          for (size_t i = 0; i < unPayload; ++i) {
+            ps_frame->m_strPayload[i] ^= pch_data[unMask + i % 4];
+          }
+        }
+        return unHeader + unPayload;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Request upgrading an HTTP connection to a websocket
+       *
+       * @param str_key base64 of 16 random bytes
+       */
+      static std::string EncodeUpgradeRequest(
+        const std::string& str_host,
+        uint16_t un_port,
+        const std::string& str_path,
+        const std::string& str_key) {
+        return "GET " + str_path +
+               " HTTP/1.1\r\n"
+               "Host: " +
+               str_host + ":" + std::to_string(un_port) +
+               "\r\n"
+               "Upgrade: websocket\r\n"
+               "Connection: Upgrade\r\n"
+               "Sec-WebSocket-Key: " +
+               str_key +
+               "\r\n"
+               "Sec-WebSocket-Version: 13\r\n\r\n";
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Connects and upgrades the connection to a websocket
+       *
+       * @param str_path path and query, like "/?broadcasts,events"
+       * @param str_error why it failed
+       * @param n_receive_buffer size of the kernel receive buffer, 0 for
+       * the default. A small one makes a slow reader push back on the
+       * server sooner
+       * @return false if it failed
+       */
+      bool Connect(
+        const std::string& str_host,
+        uint16_t un_port,
+        const std::string& str_path,
+        std::string* str_error,
+        int n_receive_buffer = 0) {
+        Close();
+
+        struct addrinfo sHints = {};
+        sHints.ai_family = AF_UNSPEC;
+        sHints.ai_socktype = SOCK_STREAM;
+        struct addrinfo* psAddresses = nullptr;
+        int nResult = getaddrinfo(
+          str_host.c_str(),
+          std::to_string(un_port).c_str(),
+          &sHints,
+          &psAddresses);
+        if (nResult != 0) {
+          *str_error = gai_strerror(nResult);
+          return false;
+        }
+        int nSocket = -1;
+        for (auto* ps = psAddresses; ps != nullptr; ps = ps->ai_next) {
+          nSocket = socket(ps->ai_family, ps->ai_socktype, ps->ai_protocol);
+          if (nSocket < 0) {
+            continue;
+          }
+          /* Before connecting, as it sets the TCP window scale */
+          if (n_receive_buffer > 0) {
+            setsockopt(
+              nSocket,
+              SOL_SOCKET,
+              SO_RCVBUF,
+              &n_receive_buffer,
+              sizeof(int));
+          }
+          if (connect(nSocket, ps->ai_addr, ps->ai_addrlen) == 0) {
+            break;
+          }
+          close(nSocket);
+          nSocket = -1;
+        }
+        freeaddrinfo(psAddresses);
+        if (nSocket < 0) {
+          *str_error = std::strerror(errno);
+          return false;
+        }
+
+        /* Frames are small and latency matters more than packets */
+        int nEnable = 1;
+        setsockopt(nSocket, IPPROTO_TCP, TCP_NODELAY, &nEnable, sizeof(int));
+#ifdef SO_NOSIGPIPE
+        setsockopt(nSocket, SOL_SOCKET, SO_NOSIGPIPE, &nEnable, sizeof(int));
+#endif
+        m_nSocket = nSocket;
+        m_strBuffer.clear();
+
+        /* Upgrade request, the accept key of the answer is not checked */
+        std::string strKey, strNonce(16, '\0');
+        for (auto& chByte : strNonce) {
+          chByte = static_cast<char>(m_cRandom());
+        }
+        Base64::Encode(strNonce, &strKey);
+        if (!WriteAll(
+              EncodeUpgradeRequest(str_host, un_port, str_path, strKey))) {
+          *str_error = "can not send the upgrade request";
+          Close();
+          return false;
+        }
+
+        /* Answer headers, what follows is already websocket frames */
+        size_t unEnd;
+        while ((unEnd = m_strBuffer.find("\r\n\r\n")) == std::string::npos) {
+          if (m_strBuffer.size() > 16384 || !ReadSome(5000)) {
+            *str_error = "no upgrade answer";
+            Close();
+            return false;
+          }
+        }
+        if (m_strBuffer.compare(0, 12, "HTTP/1.1 101") != 0) {
+          *str_error = "upgrade refused: " +
+                       m_strBuffer.substr(0, m_strBuffer.find("\r\n"));
+          Close();
+          return false;
+        }
+        m_strBuffer.erase(0, unEnd + 4);
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      bool IsConnected() const { return m_nSocket >= 0; }
+
+      /****************************************/
+      /****************************************/
+
+      /** Sends a message, from any thread */
+      bool Send(EOpCode e_opcode, const std::string& str_payload) {
+        std::lock_guard<std::mutex> guard(m_mutex4Send);
+        if (m_nSocket < 0) {
+          return false;
+        }
+        return WriteAll(EncodeFrame(
+          e_opcode, str_payload, true, static_cast<uint32_t>(m_cRandom())));
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /**
+       * @brief Waits for the next message, answering pings on the way
+       *
+       * @param str_message the message, reassembled if fragmented
+       * @param b_binary true for binary messages
+       * @param c_timeout longest time to wait for data
+       */
+      EReceived Receive(
+        std::string* str_message,
+        bool* b_binary,
+        std::chrono::milliseconds c_timeout) {
+        if (m_nSocket < 0) {
+          return EReceived::CLOSED;
+        }
+        while (true) {
+          SFrame sFrame;
+          size_t unUsed;
+          try {
+            unUsed =
+              DecodeFrame(m_strBuffer.data(), m_strBuffer.size(), &sFrame);
+          } catch (const std::length_error&) {
+            Close();
+            return EReceived::CLOSED;
+          }
+
+          if (unUsed == 0) {
+            if (!ReadSome(c_timeout.count())) {
+              return m_nSocket < 0 ? EReceived::CLOSED : EReceived::TIMEOUT;
+            }
+            continue;
+          }
+          m_strBuffer.erase(0, unUsed);
+
+          switch (sFrame.m_eOpCode) {
+            case EOpCode::PING:
+              Send(EOpCode::PONG, sFrame.m_strPayload);
+              break;
+            case EOpCode::PONG:
+              break;
+            case EOpCode::CLOSE:
+              Send(EOpCode::CLOSE, "");
+              Close();
+              return EReceived::CLOSED;
+            case EOpCode::CONTINUATION:
+              m_strMessage += sFrame.m_strPayload;
+              if (m_strMessage.size() > MAX_MESSAGE_SIZE) {
+                Close();
+                return EReceived::CLOSED;
+              }
+              break;
+            default:
+              m_bBinary = sFrame.m_eOpCode == EOpCode::BINARY;
+              m_strMessage = std::move(sFrame.m_strPayload);
+              break;
+          }
+          if (
+            sFrame.m_bFin && (sFrame.m_eOpCode == EOpCode::TEXT ||
+                              sFrame.m_eOpCode == EOpCode::BINARY ||
+                              sFrame.m_eOpCode == EOpCode::CONTINUATION)) {
+            *str_message = std::move(m_strMessage);
+            *b_binary = m_bBinary;
+            m_strMessage.clear();
+            return EReceived::MESSAGE;
+          }
+        }
+      }
+
+      /****************************************/
+      /****************************************/
+
+      void Close() {
+        std::lock_guard<std::mutex> guard(m_mutex4Send);
+        if (m_nSocket >= 0) {
+          close(m_nSocket);
+          m_nSocket = -1;
+        }
+      }
+
+     private:
+      /** Writes everything, the lock must be held unless connecting */
+      bool WriteAll(const std::string& str_data) {
+        size_t unSent = 0;
+        while (unSent < str_data.size()) {
+          ssize_t nSent = send(
+            m_nSocket,
+            str_data.data() + unSent,
+            str_data.size() - unSent,
+            MSG_NOSIGNAL);
+          if (nSent <= 0) {
+            return false;
+          }
+          unSent += nSent;
+        }
+        return true;
+      }
+
+      /****************************************/
+      /****************************************/
+
+      /** Appends what arrives to the buffer, false on timeout or close */
+      bool ReadSome(int n_timeout_ms) {
+        struct pollfd sPoll = {m_nSocket, POLLIN, 0};
+        if (poll(&sPoll, 1, n_timeout_ms) <= 0) {
+          return false;
+        }
+        char pchBuffer[65536];
+        ssize_t nRead = recv(m_nSocket, pchBuffer, sizeof(pchBuffer), 0);
+        if (nRead <= 0) {
+          Close();
+          return false;
+        }
+        m_strBuffer.append(pchBuffer, nRead);
+        return true;
+      }
+
+     private:
+      std::atomic<int> m_nSocket;
+
+      /** Received and not decoded yet */
+      std::string m_strBuffer;
+
+      /** Message being reassembled from fragments */
+      std::string m_strMessage;
+      bool m_bBinary = false;
+
+      /** Masks and handshake nonces */
+      std::mt19937 m_cRandom;
+
+      std::mutex m_mutex4Send;
+    };
+  }  // namespace Webviz
+}  // namespace argos
+
+#endif
@@ -18,9 +18,13 @@ namespace argos {
 
   CWebviz::CWebviz()
       : m_eExperimentState(Webviz::EExperimentState::EXPERIMENT_INITIALIZED),
-        m_cTimer(),
+        m_cTickScheduler(),
         m_cSpace(m_cSimulator.GetSpace()),
-        m_bFastForwarding(false) {}
+        m_bFastForwarding(false),
+        m_bMaxSpeed(false),
+        m_unStateVersion(0),
+        m_unBroadcastVersion(0),
+        m_eBroadcastState(Webviz::EExperimentState::EXPERIMENT_INITIALIZED) {}
 
   /****************************************/
   /****************************************/
@@ -29,6 +33,9 @@ namespace argos {
   void CWebviz::Init(TConfigurationNode& t_tree) {
     unsigned short unPort;
     unsigned short unBroadcastFrequency;
+    unsigned short unKeyframeEvery;
+    unsigned short unSerializationThreads;
+    unsigned short unServerThreads;
 
     std::string strKeyFilePath;
     std::string strCertFilePath;
@@ -42,6 +49,61 @@ namespace argos {
       t_tree, "broadcast_frequency", unBroadcastFrequency, UInt16(10));
     GetNodeAttributeOrDefault(
       t_tree, "ff_draw_frames_every", m_unDrawFrameEvery, UInt16(2));
+    GetNodeAttributeOrDefault(
+      t_tree, "keyframe_every", unKeyframeEvery, UInt16(1));
+    bool bMaxSpeed = false;
+    GetNodeAttributeOrDefault(t_tree, "ff_max_speed", bMaxSpeed, bMaxSpeed);
+    m_bMaxSpeed = bMaxSpeed;
+    GetNodeAttributeOrDefault(
+      t_tree,
+      "floor_pixels_per_meter",
+      m_unFloorPixelsPerMeter,
+      m_unFloorPixelsPerMeter);
+    GetNodeAttributeOrDefault(
+      t_tree, "serialization_threads", unSerializationThreads, UInt16(0));
+    GetNodeAttributeOrDefault(
+      t_tree, "server_threads", unServerThreads, UInt16(1));
+
+    /* Log lines kept between two broadcasts, and accepted per second */
+    UInt32 unLogBufferSize, unLogRateLimit;
+    GetNodeAttributeOrDefault(
+      t_tree, "log_buffer_size", unLogBufferSize, UInt32(1024));
+    GetNodeAttributeOrDefault(
+      t_tree, "log_rate_limit", unLogRateLimit, UInt32(0));
+    GetNodeAttributeOrDefault(
+      t_tree,
+      "thread_safe_user_functions",
+      m_bThreadSafeUserFunctions,
+      m_bThreadSafeUserFunctions);
+
+    /* Rays of the clients which do not choose */
+    bool bRays = true;
+    UInt32 unRayEveryFrame, unRayEveryRay;
+    GetNodeAttributeOrDefault(t_tree, "rays", bRays, bRays);
+    GetNodeAttributeOrDefault(
+      t_tree, "ray_every_frame", unRayEveryFrame, UInt32(1));
+    GetNodeAttributeOrDefault(
+      t_tree, "ray_every_ray", unRayEveryRay, UInt32(1));
+
+    /* Recording of the broadcasted states */
+    std::string strRecordFile;
+    unsigned short unRecordKeyframeEvery;
+    GetNodeAttributeOrDefault(
+      t_tree, "record_file", strRecordFile, std::string(""));
+    GetNodeAttributeOrDefault(
+      t_tree, "record_every", m_unRecordEvery, m_unRecordEvery);
+    GetNodeAttributeOrDefault(
+      t_tree, "record_keyframe_every", unRecordKeyframeEvery, UInt16(100));
+
+    /* Recording played back instead of the simulation */
+    std::string strReplayFile;
+    GetNodeAttributeOrDefault(
+      t_tree, "replay_file", strReplayFile, std::string(""));
+
+    /* Web client served on the same port */
+    std::string strClientDir;
+    GetNodeAttributeOrDefault(
+      t_tree, "client_dir", strClientDir, std::string(""));
 
     /* Get options for ssl certificate from XML */
     GetNodeAttributeOrDefault(
@@ -71,6 +133,58 @@ namespace argos {
         "Broadcast frequency set in configuration is invalid ( < 1 )");
     }
 
+    if (unKeyframeEvery < 1 || 1000 < unKeyframeEvery) {
+      throw CARGoSException(
+        "Keyframe interval set in configuration is out of range [1,1000]");
+    }
+
+    if (m_unFloorPixelsPerMeter < 1 || 1000 < m_unFloorPixelsPerMeter) {
+      throw CARGoSException(
+        "Floor pixels per meter set in configuration is out of range "
+        "[1,1000]");
+    }
+
+    if (256 < unSerializationThreads) {
+      throw CARGoSException(
+        "Serialization threads set in configuration is out of range [0,256]");
+    }
+
+    if (unServerThreads < 1 || 64 < unServerThreads) {
+      throw CARGoSException(
+        "Server threads set in configuration is out of range [1,64]");
+    }
+
+    if (unLogBufferSize < 16 || 1048576 < unLogBufferSize) {
+      throw CARGoSException(
+        "Log buffer size set in configuration is out of range [16,1048576]");
+    }
+
+    if (unRayEveryFrame < 1 || 1000 < unRayEveryFrame) {
+      throw CARGoSException(
+        "Ray every frame set in configuration is out of range [1,1000]");
+    }
+
+    if (unRayEveryRay < 1 || 1000 < unRayEveryRay) {
+      throw CARGoSException(
+        "Ray every ray set in configuration is out of range [1,1000]");
+    }
+
+    if (m_unRecordEvery < 1 || 1000 < m_unRecordEvery) {
+      throw CARGoSException(
+        "Record every set in configuration is out of range [1,1000]");
+    }
+
+    if (unRecordKeyframeEvery < 1 || 10000 < unRecordKeyframeEvery) {
+      throw CARGoSException(
+        "Record keyframe every set in configuration is out of range "
+        "[1,10000]");
+    }
+
+    if (!strReplayFile.empty() && !strRecordFile.empty()) {
+      throw CARGoSException(
+        "A recording can not be recorded again while replaying it");
+    }
+
     /* Parse XML for user functions */
     if (NodeExists(t_tree, "user_functions")) {
       /* Use the passed user functions */
@@ -107,15 +221,100 @@ namespace argos {
 
     /* Initialize Webserver */
     m_cWebServer = new Webviz::CWebServer(
-      this,
+      [this](Webviz::SClientCommand s_command) {
+        EnqueueCommand(std::move(s_command));
+      },
       unPort,
       unBroadcastFrequency,
+      unKeyframeEvery,
       strKeyFilePath,
       strCertFilePath,
       strDHParamsFilePath,
       strCAFilePath,
       strCertPassphrase);
 
+    /* Logs and events go to the clients, tagged with the step they were
+     * written at (the one of the frame shown, when replaying) */
+    m_cWebServer->SetLogLimits(unLogBufferSize, unLogRateLimit);
+    m_cWebServer->CaptureLogs([this]() -> uint64_t {
+      return m_pcReplay != nullptr ? m_pcReplay->GetFrameSteps()
+                                   : m_cSpace.GetSimulationClock();
+    });
+
+    Webviz::CRayLOD cRayLOD;
+    cRayLOD.SetEnabled(bRays);
+    cRayLOD.SetEveryFrame(unRayEveryFrame);
+    cRayLOD.SetEveryRay(unRayEveryRay);
+    m_cWebServer->SetDefaultRayLOD(cRayLOD);
+    m_cWebServer->SetServerThreads(unServerThreads);
+
+    /* Files of the client, compressed once for all the page loads */
+    if (!strClientDir.empty()) {
+      auto psAssets = std::make_shared<Webviz::CStaticAssets>();
+      if (!psAssets->Load(strClientDir)) {
+        THROW_ARGOSEXCEPTION("Can not read client directory " + strClientDir);
+      }
+      if (psAssets->Find("/") == nullptr) {
+        THROW_ARGOSEXCEPTION(
+          "No index.html in client directory " + strClientDir);
+      }
+      /* The client connects back to where it was loaded from */
+      psAssets->Add("/webviz_server.js", "server = window.location.host;\n");
+      LOG << "[INFO] Serving " << psAssets->GetCount() << " client files from "
+          << strClientDir << '\n';
+      m_cWebServer->SetStaticAssets(std::move(psAssets));
+    }
+
+    /* Served with the stages of the webserver on "GET /metrics" */
+    Webviz::CMetrics& cMetrics = m_cWebServer->GetMetrics();
+    m_pcStepHistogram = &cMetrics.AddHistogram(
+      "webviz_step_seconds",
+      "Time spent in one simulation step (UpdateSpace)");
+    m_pcSerializeHistogram = &cMetrics.AddHistogram(
+      "webviz_serialize_entities_seconds",
+      "Time spent converting the entities to JSON, with the user functions");
+    m_pcUserFunctionsHistogram = &cMetrics.AddHistogram(
+      "webviz_user_functions_seconds",
+      "Time spent in the user functions for one broadcast");
+
+    /* Workers to serialize entities, started once for the whole run */
+    if (unSerializationThreads > 0) {
+      m_pcSerializationPool =
+        new Webviz::CThreadPool(unSerializationThreads, []() {
+          /* Set up thread-safe buffers for this new thread */
+          LOG.AddThreadSafeBuffer();
+          LOGERR.AddThreadSafeBuffer();
+        });
+    }
+
+    /* Recorder, with its own I/O thread */
+    if (!strRecordFile.empty()) {
+      m_pcRecorder = new Webviz::CRecorder(unRecordKeyframeEvery);
+      if (!m_pcRecorder->Start(strRecordFile)) {
+        delete m_pcRecorder;
+        m_pcRecorder = nullptr;
+        THROW_ARGOSEXCEPTION("Can not write recording file " + strRecordFile);
+      }
+      LOG << "[INFO] Recording to " << strRecordFile << '\n';
+    }
+
+    /* Replay, the experiment itself is never stepped */
+    if (!strReplayFile.empty()) {
+      m_pcReplay = new Webviz::CReplay;
+      if (!m_pcReplay->Open(strReplayFile)) {
+        delete m_pcReplay;
+        m_pcReplay = nullptr;
+        THROW_ARGOSEXCEPTION("Can not read recording file " + strReplayFile);
+      }
+      LOG << "[INFO] Replaying " << strReplayFile << " (steps "
+          << m_pcReplay->GetFirstSteps() << " to "
+          << m_pcReplay->GetLastSteps() << ")";
+      if (!m_pcReplay->GetReader().HasIndex()) {
+        LOG << ", it was not closed properly";
+      }
+      LOG << '\n';
+    }
+
     /* Should we play instantly? */
     bool bAutoPlay = false;
     GetNodeAttributeOrDefault(t_tree, "autoplay", bAutoPlay, bAutoPlay);
@@ -133,8 +332,13 @@ namespace argos {
     std::atomic<bool> bIsServerRunning{true};
 
     /* Start this->Simulation Thread */
-    std::thread tSimulationTread(
-      [&]() { this->SimulationThreadFunction(std::ref(bIsServerRunning)); });
+    std::thread tSimulationTread([&]() {
+      if (m_pcReplay != nullptr) {
+        this->ReplayThreadFunction(std::ref(bIsServerRunning));
+      } else {
+        this->SimulationThreadFunction(std::ref(bIsServerRunning));
+      }
+    });
 
     /* Start WebServer */
     m_cWebServer->Start(std::ref(bIsServerRunning));  // blocking the thread
@@ -155,6 +359,9 @@ namespace argos {
     LOGERR.AddThreadSafeBuffer();
 
     while (b_IsServerRunning) {
+      /* Commands from the clients run here, between two steps */
+      ProcessCommands();
+
       if (
         m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_PLAYING ||
         m_eExperimentState ==
@@ -162,7 +369,13 @@ namespace argos {
         /* Fast forward steps counter used inside */
         int unFFStepCounter;
 
-        if (m_bFastForwarding) {
+        /* Max speed: no wait at all, the webserver pulls the states at its
+         * own rate, so the steps are checked one by one */
+        bool bMaxSpeed = m_bFastForwarding && m_bMaxSpeed;
+
+        if (bMaxSpeed) {
+          unFFStepCounter = 1;
+        } else if (m_bFastForwarding) {
           /* Number of frames to drop in fast-forward */
           unFFStepCounter = m_unDrawFrameEvery;
         } else {
@@ -180,14 +393,18 @@ namespace argos {
                 m_eExperimentState ==
                   Webviz::EExperimentState::EXPERIMENT_FAST_FORWARDING)) {
           /* Run one step */
-          m_cSimulator.UpdateSpace();
+          {
+            Webviz::CScopedTimer cTimer(*m_pcStepHistogram);
+            m_cSimulator.UpdateSpace();
+          }
+          ++m_unStateVersion;
 
           /* Steps counter in this while loop */
           --unFFStepCounter;
         }
 
-        /* Broadcast current experiment state */
-        BroadcastExperimentState();
+        /* Broadcast current experiment state, if the webserver needs one */
+        BroadcastExperimentStateIfWanted();
 
         /* Experiment done while in while loop */
         if (m_cSimulator.IsExperimentFinished()) {
@@ -206,31 +423,25 @@ namespace argos {
           m_cWebServer->EmitEvent("Experiment done", m_eExperimentState);
         }
 
-        /* Take the time now */
-        m_cTimer.Stop();
-
-        /* If the elapsed time is lower than the tick length, wait */
-        if (m_cTimer.Elapsed() < m_cSimulatorTickMillis) {
-          /* Sleep for the difference duration */
-          std::this_thread::sleep_for(
-            m_cSimulatorTickMillis - m_cTimer.Elapsed());
-        } else {
-          LOGERR << "[WARNING] Clock tick took " << m_cTimer
-                 << " milli-secs, more than the expected "
-                 << m_cSimulatorTickMillis.count() << " milli-secs. "
-                 << "Recovering in next cycle." << '\n';
+        /* Wait for the next tick, on an absolute schedule so the time of
+         * the steps is compensated */
+        if (!bMaxSpeed && !m_cTickScheduler.WaitNextTick()) {
+          LOGERR << "[WARNING] Simulation is "
+                 << m_cTickScheduler.GetLag().count()
+                 << " micro-secs late on a clock tick of "
+                 << m_cTickScheduler.GetPeriod().count() << " micro-secs. "
+                 << "Skipping the missed ticks." << '\n';
         }
-
-        /* Restart Timer */
-        m_cTimer.Start();
       } else {
         /*
-         * Update the experiment state variable and sleep for some time,
-         * we sleep to reduce the number of updates done in
-         * "PAUSED"/"INITIALIZED"/"DONE" state
+         * Broadcast the experiment state if it changed (step, reset, moved
+         * entities...) and sleep for some time. Nothing is serialized while
+         * the experiment stays untouched in "PAUSED"/"INITIALIZED"/"DONE"
+         * state, so the sleep can be short to keep the changes responsive.
+         * A new command wakes the thread up right away
          */
-        BroadcastExperimentState();
-        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        BroadcastExperimentStateIfWanted();
+        m_cCommandQueue.WaitFor(std::chrono::milliseconds(20));
       }
     }
     /* do any cleanups */
@@ -239,11 +450,108 @@ namespace argos {
   /****************************************/
   /****************************************/
 
-  void CWebviz::HandleCommandFromClient(
+  void CWebviz::ReplayThreadFunction(
+    const std::atomic<bool>& b_IsServerRunning) {
+    /* Set up thread-safe buffers for this new thread */
+    LOG.AddThreadSafeBuffer();
+    LOGERR.AddThreadSafeBuffer();
+
+    while (b_IsServerRunning) {
+      /* Commands from the clients run here, between two frames */
+      ProcessCommands();
+
+      if (
+        m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_PLAYING ||
+        m_eExperimentState ==
+          Webviz::EExperimentState::EXPERIMENT_FAST_FORWARDING) {
+        /* Max speed: frames back to back, like steps when simulating */
+        bool bMaxSpeed = m_bFastForwarding && m_bMaxSpeed;
+
+        /* The clock moves as the simulation one did, frames are shown
+         * as the clock reaches their steps */
+        UInt64 unSteps = m_bFastForwarding ? m_unDrawFrameEvery : 1;
+        bool bChanged =
+          bMaxSpeed ? m_pcReplay->Step() : m_pcReplay->Advance(unSteps) > 0;
+        if (bChanged) {
+          ++m_unStateVersion;
+        }
+
+        BroadcastExperimentStateIfWanted();
+
+        if (m_pcReplay->IsAtEnd()) {
+          LOG << "[INFO] Replay done" << '\n';
+
+          m_bFastForwarding = false;
+          m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_DONE;
+          m_cWebServer->EmitEvent("Experiment done", m_eExperimentState);
+        }
+
+        if (!bMaxSpeed && !m_cTickScheduler.WaitNextTick()) {
+          LOGERR << "[WARNING] Replay is "
+                 << m_cTickScheduler.GetLag().count()
+                 << " micro-secs late on a clock tick of "
+                 << m_cTickScheduler.GetPeriod().count() << " micro-secs. "
+                 << "Skipping the missed ticks." << '\n';
+        }
+      } else {
+        BroadcastExperimentStateIfWanted();
+        m_cCommandQueue.WaitFor(std::chrono::milliseconds(20));
+      }
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::EnqueueCommand(Webviz::SClientCommand s_command) {
+    m_cCommandQueue.Push(std::move(s_command));
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::ProcessCommands() {
+    Webviz::SClientCommand sCommand;
+
+    while (m_cCommandQueue.Pop(sCommand)) {
+      nlohmann::json cAck;
+      try {
+        cAck = HandleCommandFromClient(
+          sCommand.m_strIP, std::move(sCommand.m_cCommand));
+      } catch (const std::exception& e) {
+        /* Like a "command" which is not a string */
+        LOGERR << "[ERROR] " << e.what() << '\n';
+        cAck = {{"type", "ack"}, {"ok", false}, {"error", e.what()}};
+      }
+      m_cWebServer->SendToClient(sCommand.m_unClientId, cAck.dump());
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  nlohmann::json CWebviz::HandleCommandFromClient(
     const std::string& str_ip, nlohmann::json c_json_command) {
+    nlohmann::json cAck;
+    cAck["type"] = "ack";
+    cAck["ok"] = true;
+
+    /* Lets the client match the acknowledgement with its command */
+    if (c_json_command.contains("id")) {
+      cAck["id"] = c_json_command["id"];
+    }
+
     if (c_json_command.contains("command")) {
       /* Try to get Command key from the JSON */
       std::string strCmd = c_json_command["command"].get<std::string>();
+      cAck["command"] = strCmd;
+
+      /* Before any command which changes the experiment */
+      if (
+        m_pcReplay != nullptr &&
+        Webviz::CReplay::RefuseCommand(c_json_command, cAck)) {
+        return cAck;
+      }
 
       /* Dispatch commands */
       if (strCmd.compare("play") == 0) {
@@ -261,7 +569,18 @@ namespace argos {
       } else if (strCmd.compare("terminate") == 0) {
         TerminateExperiment();
 
+      } else if (strCmd.compare("requestKeyframe") == 0) {
+        /* Client lost track of the deltas, send the full state next */
+        m_cWebServer->RequestKeyframe();
+
       } else if (strCmd.compare("fastforward") == 0) {
+        /* Optionally switch between max speed and steps per tick */
+        if (
+          c_json_command.contains("max_speed") &&
+          c_json_command["max_speed"].is_boolean()) {
+          m_bMaxSpeed = c_json_command["max_speed"].get<bool>();
+        }
+
         try {
           /* number of Steps defined */
           int16_t unSteps = c_json_command["steps"].get<int16_t>();
@@ -299,24 +618,56 @@ namespace argos {
           cNewOrientation.SetW(
             c_json_command["orientation"]["w"].get<float_t>());
 
-          MoveEntity(
-            c_json_command["entity_id"].get<std::string>(),
-            cNewPos,
-            cNewOrientation);
+          if (!MoveEntity(
+                c_json_command["entity_id"].get<std::string>(),
+                cNewPos,
+                cNewOrientation)) {
+            cAck["ok"] = false;
+            cAck["error"] = "collision";
+          }
 
         } catch (const std::exception& e) {
           LOGERR << "[ERROR] In function MoveEntity: " << e.what() << '\n';
+          cAck["ok"] = false;
+          cAck["error"] = e.what();
+        }
+
+      } else if (strCmd.compare("seek") == 0) {
+        try {
+          if (!SeekExperiment(c_json_command.at("steps").get<UInt64>())) {
+            cAck["ok"] = false;
+            cAck["error"] = "recording can not be read there";
+          }
+          cAck["steps"] = m_pcReplay->GetFrameSteps();
+        } catch (const std::exception& e) {
+          LOGERR << "[ERROR] In seek command: " << e.what() << '\n';
+          cAck["ok"] = false;
+          cAck["error"] = e.what();
+        }
+
+      } else if (strCmd.compare("batch") == 0) {
+        try {
+          cAck["result"] = ApplyBatch(c_json_command.at("operations"));
+          cAck["ok"] = cAck["result"]["failed"].empty();
+        } catch (const std::exception& e) {
+          LOGERR << "[ERROR] In batch command: " << e.what() << '\n';
+          cAck["ok"] = false;
+          cAck["error"] = e.what();
         }
 
       } else {
         /* "command" key has unknown value */
         try {
           m_pcUserFunctions->HandleCommandFromClient(str_ip, c_json_command);
+          /* User data might have changed */
+          ++m_unStateVersion;
         } catch (const std::exception& e) {
           LOGERR
             << "[ERROR] Error in overridden function HandleCommandFromClient "
                "in UserFunction subclass implementation by user\n\t"
             << e.what() << '\n';
+          cAck["ok"] = false;
+          cAck["error"] = e.what();
         }
       }
 
@@ -324,13 +675,19 @@ namespace argos {
       /* "command" key in the JSON doesn't exists */
       try {
         m_pcUserFunctions->HandleCommandFromClient(str_ip, c_json_command);
+        /* User data might have changed */
+        ++m_unStateVersion;
       } catch (const std::exception& e) {
         LOGERR
           << "[ERROR] Error in overridden function HandleCommandFromClient "
              "in UserFunction subclass implementation by user\n\t"
           << e.what() << '\n';
+        cAck["ok"] = false;
+        cAck["error"] = e.what();
       }
     }
+
+    return cAck;
   }
 
   /****************************************/
@@ -350,8 +707,7 @@ namespace argos {
     /* Disable fast-forward */
     m_bFastForwarding = false;
 
-    m_cSimulatorTickMillis = std::chrono::milliseconds(
-      (long int)(CPhysicsEngine::GetSimulationClockTick() * 1000.0f));
+    m_cTickScheduler.SetPeriod(CPhysicsEngine::GetSimulationClockTick());
 
     /* Change state and emit signals */
     m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PLAYING;
@@ -359,7 +715,7 @@ namespace argos {
 
     LOG << "[INFO] Experiment playing" << '\n';
 
-    m_cTimer.Start();
+    m_cTickScheduler.Start();
   }
 
   /****************************************/
@@ -388,8 +744,7 @@ namespace argos {
 
     m_bFastForwarding = true;
 
-    m_cSimulatorTickMillis = std::chrono::milliseconds(
-      (long int)(CPhysicsEngine::GetSimulationClockTick() * 1000.0f));
+    m_cTickScheduler.SetPeriod(CPhysicsEngine::GetSimulationClockTick());
 
     /* Change state and emit signals */
     m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_FAST_FORWARDING;
@@ -397,7 +752,7 @@ namespace argos {
 
     LOG << "[INFO] Experiment fast-forwarding" << '\n';
 
-    m_cTimer.Start();
+    m_cTickScheduler.Start();
   }
 
   /****************************************/
@@ -448,9 +803,27 @@ namespace argos {
     /* Disable fast-forward */
     m_bFastForwarding = false;
 
+    if (m_pcReplay != nullptr) {
+      /* One step of a replay is one recorded frame */
+      if (m_pcReplay->Step()) {
+        ++m_unStateVersion;
+        m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PAUSED;
+        m_cWebServer->EmitEvent("Experiment step done", m_eExperimentState);
+      } else {
+        LOG << "[INFO] Replay done" << '\n';
+        m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_DONE;
+        m_cWebServer->EmitEvent("Experiment done", m_eExperimentState);
+      }
+      return;
+    }
+
     if (!m_cSimulator.IsExperimentFinished()) {
       /* Run one step */
-      m_cSimulator.UpdateSpace();
+      {
+        Webviz::CScopedTimer cTimer(*m_pcStepHistogram);
+        m_cSimulator.UpdateSpace();
+      }
+      ++m_unStateVersion;
 
       /* Make experiment pause */
       m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PAUSED;
@@ -469,35 +842,38 @@ namespace argos {
       /* Change state and emit signals */
       m_cWebServer->EmitEvent("Experiment done", m_eExperimentState);
     }
-
-    /* Broadcast current experiment state */
-    BroadcastExperimentState();
   }
 
   /****************************************/
   /****************************************/
 
   void CWebviz::ResetExperiment() {
-    /* Reset Simulator */
-    m_cSimulator.Reset();
-
     /* Disable fast-forward */
     m_bFastForwarding = false;
 
+    if (m_pcReplay != nullptr) {
+      /* Back to the first recorded frame */
+      m_pcReplay->Rewind();
+    } else {
+      /* Reset Simulator */
+      m_cSimulator.Reset();
+      m_bEntityTableDirty = true;
+    }
+
     /* Reset the simulator if Reset was called after experiment was done */
-    if (m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_DONE) {
+    if (
+      m_pcReplay == nullptr &&
+      m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_DONE) {
       /* Reset simulator */
       m_cSimulator.Reset();
     }
 
     m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_INITIALIZED;
+    ++m_unStateVersion;
 
     /* Change state and emit signals */
     m_cWebServer->EmitEvent("Experiment reset", m_eExperimentState);
 
-    /* Broadcast current experiment state */
-    BroadcastExperimentState();
-
     LOG << "[INFO] Experiment reset" << '\n';
   }
 
@@ -519,9 +895,12 @@ namespace argos {
     /* Disable fast-forward */
     m_bFastForwarding = false;
 
-    /* Call ARGoS to terminate the experiment */
-    CSimulator::GetInstance().Terminate();
-    CSimulator::GetInstance().GetLoopFunctions().PostExperiment();
+    /* Call ARGoS to terminate the experiment, which did not run if
+     * replaying */
+    if (m_pcReplay == nullptr) {
+      CSimulator::GetInstance().Terminate();
+      CSimulator::GetInstance().GetLoopFunctions().PostExperiment();
+    }
 
     /* Set Experiment state to Done */
     m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_DONE;
@@ -535,48 +914,301 @@ namespace argos {
   /****************************************/
   /****************************************/
 
-  void CWebviz::BroadcastExperimentState() {
-    /************* Build a JSON object to be sent to all clients *************/
-    nlohmann::json cStateJson;
+  void CWebviz::BroadcastExperimentStateIfWanted() {
+    /* The broadcaster did not consume the last state yet */
+    if (!m_cWebServer->IsBroadcastWanted()) {
+      return;
+    }
 
-    /************* Convert Entities info to JSON *************/
+    /* Nothing changed since the last broadcast, do not serialize again */
+    if (
+      m_unStateVersion == m_unBroadcastVersion &&
+      m_eExperimentState == m_eBroadcastState &&
+      !m_cWebServer->IsKeyframeRequested()) {
+      return;
+    }
+
+    m_unBroadcastVersion = m_unStateVersion;
+    m_eBroadcastState = m_eExperimentState;
+
+    BroadcastExperimentState();
+  }
+
+  /****************************************/
+  /****************************************/
 
+  void CWebviz::UpdateEntityTable() {
+    CEntity::TVector& vecEntities = m_cSpace.GetRootEntityVector();
+
+    /* Added entities go last, so a loop function adding (or removing and
+     * adding) changes the number of entities or the last one */
+    bool bSame =
+      !m_bEntityTableDirty && m_psPoseIndex &&
+      m_vecEntityTable.size() == vecEntities.size() &&
+      (vecEntities.empty() ||
+       (m_vecEntityTable.back().m_pcEntity == vecEntities.back() &&
+        m_vecEntityTable.back().m_strId == vecEntities.back()->GetId()));
+    if (bSame) {
+      return;
+    }
+    m_bEntityTableDirty = false;
+
+    auto psPoseIndex = std::make_shared<Webviz::CPoseSnapshot::SIndex>();
+    psPoseIndex->m_unVersion =
+      m_psPoseIndex ? m_psPoseIndex->m_unVersion + 1 : 1;
+
+    m_vecEntityTable.resize(vecEntities.size());
+    for (size_t i = 0; i < vecEntities.size(); ++i) {
+      SEntityRecord& sRecord = m_vecEntityTable[i];
+      if (
+        sRecord.m_pcEntity != vecEntities[i] ||
+        sRecord.m_strId != vecEntities[i]->GetId()) {
+        sRecord.m_pcEntity = vecEntities[i];
+        sRecord.m_strId = vecEntities[i]->GetId();
+        sRecord.m_strType = vecEntities[i]->GetTypeDescription();
+        sRecord.m_bSerializable =
+          m_setUnknownTypes.count(sRecord.m_strType) == 0;
+
+        /* Same as GetEmbodiedEntity(), without the lookup by id */
+        CEmbodiedEntity* pcBody =
+          dynamic_cast<CEmbodiedEntity*>(vecEntities[i]);
+        CComposableEntity* pcComposable =
+          dynamic_cast<CComposableEntity*>(vecEntities[i]);
+        if (
+          pcBody == nullptr && pcComposable != nullptr &&
+          pcComposable->HasComponent("body")) {
+          pcBody = &pcComposable->GetComponent<CEmbodiedEntity>("body");
+        }
+        sRecord.m_psOriginAnchor =
+          pcBody != nullptr ? &pcBody->GetOriginAnchor() : nullptr;
+      }
+
+      if (sRecord.m_psOriginAnchor != nullptr) {
+        psPoseIndex->m_vecIds.push_back(sRecord.m_strId);
+      }
+    }
+    m_psPoseIndex = std::move(psPoseIndex);
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::BroadcastPoses() {
+    if (!m_cWebServer->HasPoseClients()) {
+      return;
+    }
+
+    m_cPoseSnapshot.Clear();
+    m_cPoseSnapshot.Reserve(m_psPoseIndex->m_vecIds.size());
+    for (const SEntityRecord& sRecord : m_vecEntityTable) {
+      if (sRecord.m_psOriginAnchor != nullptr) {
+        m_cPoseSnapshot.Add(
+          sRecord.m_psOriginAnchor->Position,
+          sRecord.m_psOriginAnchor->Orientation);
+      }
+    }
+    m_cPoseSnapshot.SetArena(
+      m_cSpace.GetArenaCenter(), m_cSpace.GetArenaSize());
+    m_cPoseSnapshot.SetIndex(m_psPoseIndex);
+    m_cPoseSnapshot.SetSteps(m_cSpace.GetSimulationClock());
+
+    m_cWebServer->BroadcastPoses(m_cPoseSnapshot);
+  }
+
+  /****************************************/
+  /****************************************/
+
+  const CWebviz::SUserDataCache& CWebviz::CallUserFunction(
+    size_t un_index, CEntity& c_entity) {
+    SUserDataCache& sCache = m_vecUserDataCache[un_index];
+
+    /* Another entity took this index, its data is not the previous one */
+    if (sCache.m_pcEntity != &c_entity || sCache.m_strId != c_entity.GetId()) {
+      sCache.m_pcEntity = &c_entity;
+      sCache.m_strId = c_entity.GetId();
+      sCache.m_cData = nullptr;
+      sCache.m_unVersion = 0;
+    }
+
+    if (m_pcUserFunctions->Call(c_entity, sCache.m_cData)) {
+      sCache.m_unVersion = ++m_unLastUserDataVersion;
+    }
+    return sCache;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::SerializeEntities(
+    nlohmann::json& c_entities,
+    std::chrono::nanoseconds& c_user_functions_time,
+    std::vector<uint64_t>& vec_user_data_versions) {
     /* Get all entities in the experiment */
     CEntity::TVector& vecEntities = m_cSpace.GetRootEntityVector();
+    UpdateEntityTable();
+
+    /* Entities are split in contiguous chunks, each serialized in its own
+     * buffer, then concatenated in order */
+    size_t unChunks = 1;
+    if (m_pcSerializationPool != nullptr) {
+      unChunks = std::min(
+        vecEntities.size(), (m_pcSerializationPool->GetSize() + 1) * 4);
+    }
+    size_t unChunkSize =
+      unChunks > 0 ? (vecEntities.size() + unChunks - 1) / unChunks : 0;
+
+    std::vector<nlohmann::json> vecChunks(unChunks, nlohmann::json::array());
+    /* Indices of the serialized entities in vecEntities */
+    std::vector<std::vector<size_t>> vecSerialized(unChunks);
+    std::vector<std::vector<CEntity*>> vecUnknown(unChunks);
+    bool bUserFunctionsInChunks =
+      m_pcSerializationPool == nullptr || m_bThreadSafeUserFunctions;
+    bool bUserDataWanted = m_cGenerationMask.WantsField("user_data");
+
+    /* Resized here, the workers only write to their own entities */
+    if (bUserDataWanted) {
+      m_vecUserDataCache.resize(vecEntities.size());
+    }
 
-    for (auto itEntities = vecEntities.begin();  //
-         itEntities != vecEntities.end();        //
-         ++itEntities) {
-      /************* Generate JSON from Entities *************/
+    /* Time in the user functions of each chunk, summed at the end */
+    std::vector<std::chrono::nanoseconds> vecUserFunctionsTimes(
+      unChunks, std::chrono::nanoseconds(0));
 
-      auto cEntityJSON = CallEntityOperation<
-        CWebvizOperationGenerateJSON,
-        CWebviz,
-        nlohmann::json>(*this, **itEntities);
+    auto fnSerializeChunk = [&](size_t un_chunk) {
+      size_t unEnd =
+        std::min(vecEntities.size(), (un_chunk + 1) * unChunkSize);
+      Webviz::CTimer cTimer;
 
-      if (cEntityJSON != nullptr) {
-        /************* get data from User functions for entity *************/
-        const nlohmann::json& user_data = m_pcUserFunctions->Call(**itEntities);
+      for (size_t i = un_chunk * unChunkSize; i < unEnd; ++i) {
+        SEntityRecord& sRecord = m_vecEntityTable[i];
 
-        if (!user_data.is_null()) {
-          cEntityJSON["user_data"] = user_data;
+        /* No serializer, or no client wants this type */
+        if (
+          !sRecord.m_bSerializable ||
+          !m_cGenerationMask.WantsType(sRecord.m_strType)) {
+          continue;
         }
 
-        cStateJson["entities"].push_back(cEntityJSON);
-      } else {
-        LOGERR << "[ERROR] Unknown Entity:"
-               << (**itEntities).GetTypeDescription() << "\n"
-               << "Please register a class to convert Entity to JSON, "
-               << "Check documentation for how to implement custom entity";
+        /************* Generate JSON from Entities *************/
+
+        auto cEntityJSON = CallEntityOperation<
+          CWebvizOperationGenerateJSON,
+          CWebviz,
+          nlohmann::json>(*this, *vecEntities[i]);
+
+        if (cEntityJSON != nullptr) {
+          if (bUserFunctionsInChunks && bUserDataWanted) {
+            /*********** get data from User functions for entity ***********/
+            cTimer.Start();
+            const SUserDataCache& sUserData =
+              CallUserFunction(i, *vecEntities[i]);
+            cTimer.Stop();
+            vecUserFunctionsTimes[un_chunk] += cTimer.ElapsedNanoseconds();
+
+            if (!sUserData.m_cData.is_null()) {
+              cEntityJSON["user_data"] = sUserData.m_cData;
+            }
+          }
+
+          vecChunks[un_chunk].push_back(std::move(cEntityJSON));
+          vecSerialized[un_chunk].push_back(i);
+        } else {
+          sRecord.m_bSerializable = false;
+          vecUnknown[un_chunk].push_back(vecEntities[i]);
+        }
+      }
+    };
+
+    if (m_pcSerializationPool != nullptr) {
+      m_pcSerializationPool->ParallelFor(unChunks, fnSerializeChunk);
+    } else if (unChunks > 0) {
+      fnSerializeChunk(0);
+    }
+
+    /* Concatenate in order */
+    Webviz::CTimer cTimer;
+    for (size_t i = 0; i < unChunks; ++i) {
+      for (size_t j = 0; j < vecChunks[i].size(); ++j) {
+        size_t unIndex = vecSerialized[i][j];
+        if (!bUserFunctionsInChunks && bUserDataWanted) {
+          /* User functions are not thread-safe, call them from here */
+          cTimer.Start();
+          const SUserDataCache& sUserData =
+            CallUserFunction(unIndex, *vecEntities[unIndex]);
+          cTimer.Stop();
+          vecUserFunctionsTimes[i] += cTimer.ElapsedNanoseconds();
+
+          if (!sUserData.m_cData.is_null()) {
+            vecChunks[i][j]["user_data"] = sUserData.m_cData;
+          }
+        }
+        if (bUserDataWanted) {
+          vec_user_data_versions.push_back(
+            m_vecUserDataCache[unIndex].m_unVersion);
+        }
+        c_entities.push_back(std::move(vecChunks[i][j]));
       }
+
+      /* Logged from this thread, not from the workers, once per type */
+      for (CEntity* pcEntity : vecUnknown[i]) {
+        const std::string& strType = pcEntity->GetTypeDescription();
+        if (m_setUnknownTypes.insert(strType).second) {
+          LOGERR << "[WARNING] Unknown Entity:" << strType << "\n"
+                 << "Please register a class to convert Entity to JSON, "
+                 << "Check documentation for how to implement custom entity"
+                 << "\n";
+        }
+      }
+
+      c_user_functions_time += vecUserFunctionsTimes[i];
     }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::BroadcastExperimentState() {
+    if (m_pcReplay != nullptr) {
+      BroadcastReplayState();
+      return;
+    }
+
+    /************* Build a JSON object to be sent to all clients *************/
+    nlohmann::json cStateJson;
+
+    /* Only what some client wants is generated, everything if recorded */
+    if (m_pcRecorder != nullptr) {
+      m_cGenerationMask = Webviz::CBroadcastMask();
+      m_cGenerationRayLOD = Webviz::CRayLOD();
+    } else {
+      m_cGenerationMask = m_cWebServer->GetWantedMask();
+      m_cGenerationRayLOD = m_cWebServer->GetWantedRayLOD();
+    }
+
+    /************* Convert Entities info to JSON *************/
+
+    std::chrono::nanoseconds cUserFunctionsTime(0);
+    std::vector<uint64_t> vecUserDataVersions;
+    {
+      Webviz::CScopedTimer cTimer(*m_pcSerializeHistogram);
+      SerializeEntities(
+        cStateJson["entities"], cUserFunctionsTime, vecUserDataVersions);
+    }
+
+    /* From the table SerializeEntities() just updated */
+    BroadcastPoses();
 
     /************* get data from User functions for experiment *************/
 
-    const nlohmann::json& user_data = m_pcUserFunctions->sendUserData();
+    Webviz::CTimer cUserDataTimer;
+    cUserDataTimer.Start();
+    m_pcUserFunctions->sendUserDataIfChanged(m_cUserData);
+    cUserDataTimer.Stop();
+    m_pcUserFunctionsHistogram->Observe(
+      cUserFunctionsTime + cUserDataTimer.ElapsedNanoseconds());
 
-    if (!user_data.is_null()) {
-      cStateJson["user_data"] = user_data;
+    if (!m_cUserData.is_null()) {
+      cStateJson["user_data"] = m_cUserData;
     }
 
     /************* Add other information about experiment *************/
@@ -610,16 +1242,104 @@ namespace argos {
     /* Type of message */
     cStateJson["type"] = "broadcast";
 
+    /* Recorded by the I/O thread of the recorder, the state is shared
+     * with the webserver instead of being copied here */
+    if (
+      m_pcRecorder != nullptr &&
+      ++m_unStatesSinceRecorded >= m_unRecordEvery) {
+      m_unStatesSinceRecorded = 0;
+      auto psState = std::make_shared<nlohmann::json>(std::move(cStateJson));
+      m_pcRecorder->Push(psState);
+      m_cWebServer->Broadcast(
+        std::move(psState), std::move(vecUserDataVersions));
+      return;
+    }
+
     /* Send to webserver to broadcast */
-    m_cWebServer->Broadcast(cStateJson);
+    m_cWebServer->Broadcast(
+      std::move(cStateJson),
+      std::move(vecUserDataVersions),
+      m_cGenerationMask.IsEmpty() && m_cGenerationRayLOD.IsFull());
   }
 
   /****************************************/
   /****************************************/
 
-  void CWebviz::MoveEntity(
+  void CWebviz::BroadcastReplayState() {
+    /* Already everything the clients can ask for, the webserver filters it
+     * for each of them */
+    nlohmann::json cStateJson = m_pcReplay->GetState();
+
+    /* Sequence and keyframes are the ones of the webserver */
+    cStateJson.erase("sequence");
+    cStateJson.erase("keyframe");
+
+    cStateJson["timestamp"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+        .count();
+    cStateJson["state"] = Webviz::EExperimentStateToStr(m_eExperimentState);
+
+    /* Lets the clients show where the replay is in the recording */
+    cStateJson["replay"]["first_steps"] = m_pcReplay->GetFirstSteps();
+    cStateJson["replay"]["last_steps"] = m_pcReplay->GetLastSteps();
+
+    cStateJson["type"] = "broadcast";
+
+    m_cWebServer->Broadcast(std::move(cStateJson));
+  }
+
+  /****************************************/
+  /****************************************/
+
+  bool CWebviz::SeekExperiment(UInt64 un_steps) {
+    if (m_pcReplay == nullptr) {
+      THROW_ARGOSEXCEPTION("[ERROR] Not replaying a recording");
+    }
+
+    bool bOk = m_pcReplay->Seek(un_steps);
+    ++m_unStateVersion;
+
+    /* Nothing in common with the previous frames, drop the deltas */
+    m_cWebServer->RequestKeyframe();
+
+    /* Can be played again from there */
+    if (
+      m_eExperimentState == Webviz::EExperimentState::EXPERIMENT_DONE &&
+      !m_pcReplay->IsAtEnd()) {
+      m_eExperimentState = Webviz::EExperimentState::EXPERIMENT_PAUSED;
+      m_cWebServer->EmitEvent("Experiment paused", m_eExperimentState);
+    }
+
+    LOG << "[INFO] Replay at step " << m_pcReplay->GetFrameSteps() << '\n';
+    return bOk;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  bool CWebviz::MoveEntity(
     std::string str_entity_id, CVector3 c_pos, CQuaternion c_orientation) {
     /* throws CARGoSException if entity doesn't exist */
+    CEmbodiedEntity& cEntity = GetEmbodiedEntity(str_entity_id);
+
+    if (cEntity.MoveTo(c_pos, c_orientation)) {
+      ++m_unStateVersion;
+      LOG << "[INFO] Entity Moved (" + str_entity_id + ")" << '\n';
+      return true;
+    } else {
+      LOGERR << "[WARNING] Entity cannot be moved, collision detected. (" +
+                  str_entity_id + ")"
+             << '\n';
+      return false;
+    }
+  }
+
+  /****************************************/
+  /****************************************/
+
+  CEmbodiedEntity& CWebviz::GetEmbodiedEntity(
+    const std::string& str_entity_id) {
     try {
       CEntity* cEntity = &m_cSpace.GetEntity(str_entity_id);
       CEmbodiedEntity* pcEntity = dynamic_cast<CEmbodiedEntity*>(cEntity);
@@ -633,20 +1353,11 @@ namespace argos {
           pcEntity = &pcCompEntity->GetComponent<CEmbodiedEntity>("body");
         } else {
           /* All conversions failed, get out */
-          // s
           THROW_ARGOSEXCEPTION(
             "[ERROR] No entity found with id:" + str_entity_id);
-          return;
         }
       }
-
-      if (pcEntity->MoveTo(c_pos, c_orientation)) {
-        LOG << "[INFO] Entity Moved (" + str_entity_id + ")" << '\n';
-      } else {
-        LOGERR << "[WARNING] Entity cannot be moved, collision detected. (" +
-                    str_entity_id + ")"
-               << '\n';
-      }
+      return *pcEntity;
     } catch (CARGoSException& ex) {
       THROW_ARGOSEXCEPTION_NESTED(
         "[ERROR] No entity found with id:" + str_entity_id, ex);
@@ -656,7 +1367,192 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  nlohmann::json CWebviz::ApplyBatch(const nlohmann::json& c_operations) {
+    if (!c_operations.is_array()) {
+      THROW_ARGOSEXCEPTION("[ERROR] \"operations\" must be an array");
+    }
+
+    nlohmann::json cResult;
+    cResult["applied"] = 0;
+    cResult["failed"] = nlohmann::json::array();
+
+    Webviz::CBatch::CIds cIds([this](const std::string& str_id) {
+      try {
+        m_cSpace.GetEntity(str_id);
+        return true;
+      } catch (CARGoSException&) {
+        return false;
+      }
+    });
+    /* Undoes the moves and adds if anything fails */
+    Webviz::CBatch::CUndoLog cUndo;
+    std::vector<std::string> vecRemoved;
+
+    /* Everything runs in this pass, no step can happen in between */
+    for (size_t i = 0; i < c_operations.size(); ++i) {
+      const nlohmann::json& cOperation = c_operations[i];
+      Webviz::CBatch::SOperation sOperation;
+      std::string strError;
+
+      try {
+        if (!Webviz::CBatch::Parse(cOperation, &sOperation, &strError)) {
+          THROW_ARGOSEXCEPTION(strError);
+        }
+
+        if (sOperation.m_eOp == Webviz::CBatch::EOp::MOVE) {
+          if (!cIds.Exists(sOperation.m_strId)) {
+            THROW_ARGOSEXCEPTION(
+              "[ERROR] No entity found with id:" + sOperation.m_strId);
+          }
+          CEmbodiedEntity& cEntity = GetEmbodiedEntity(sOperation.m_strId);
+          const SAnchor& sAnchor = cEntity.GetOriginAnchor();
+          CVector3 cOldPos = sAnchor.Position;
+          CQuaternion cOldOrientation = sAnchor.Orientation;
+
+          /* Orientation is kept if missing */
+          CVector3 cNewPos(
+            sOperation.m_pfPosition[0],
+            sOperation.m_pfPosition[1],
+            sOperation.m_pfPosition[2]);
+          CQuaternion cNewOrientation = cOldOrientation;
+          if (sOperation.m_bOrientation) {
+            cNewOrientation = CQuaternion(
+              sOperation.m_pfOrientation[0],
+              sOperation.m_pfOrientation[1],
+              sOperation.m_pfOrientation[2],
+              sOperation.m_pfOrientation[3]);
+          }
+
+          /* Against the arena as the previous operations left it */
+          if (cEntity.MoveTo(cNewPos, cNewOrientation)) {
+            cUndo.Push([&cEntity, cOldPos, cOldOrientation]() {
+              cEntity.MoveTo(cOldPos, cOldOrientation, false, true);
+            });
+          } else {
+            strError = "collision";
+          }
+
+        } else if (sOperation.m_eOp == Webviz::CBatch::EOp::ADD) {
+          /* The entity is described like in the .argos file */
+          ticpp::Document tDocument;
+          tDocument.Parse(sOperation.m_strXML);
+          TConfigurationNode& tNode = *tDocument.FirstChildElement();
+
+          /* Checked before Init(), which can not be undone cheaply */
+          std::string strId;
+          GetNodeAttribute(tNode, "id", strId);
+          if (cIds.IsTaken(strId)) {
+            THROW_ARGOSEXCEPTION("[ERROR] Id already exists: " + strId);
+          }
+
+          /* Not in the space yet, ours to delete */
+          std::unique_ptr<CEntity> pcEntity(
+            CFactory<CEntity>::New(tNode.Value()));
+          pcEntity->Init(tNode);
+          m_cSimulator.GetLoopFunctions().AddEntity(*pcEntity.release());
+          m_bEntityTableDirty = true;
+          cIds.Add(strId);
+          cUndo.Push([this, strId]() {
+            m_cSimulator.GetLoopFunctions().RemoveEntity(strId);
+          });
+
+          /* Placed without checks, like the entities of the .argos file */
+          CEmbodiedEntity* pcBody = nullptr;
+          try {
+            pcBody = &GetEmbodiedEntity(strId);
+          } catch (CARGoSException&) {
+            /* Not embodied, can not collide */
+          }
+          if (pcBody != nullptr && pcBody->IsCollidingWithSomething()) {
+            strError = "collision";
+          }
+
+        } else {
+          /* Done last, they can not be undone */
+          if (!cIds.Exists(sOperation.m_strId)) {
+            THROW_ARGOSEXCEPTION(
+              "[ERROR] No entity found with id:" + sOperation.m_strId);
+          }
+          cIds.Remove(sOperation.m_strId);
+          vecRemoved.push_back(sOperation.m_strId);
+        }
+      } catch (const std::exception& e) {
+        /* CARGoSException, ticpp::Exception or JSON errors */
+        strError = e.what();
+      }
+
+      if (!strError.empty()) {
+        cUndo.Rollback();
+
+        nlohmann::json cFailure;
+        cFailure["index"] = i;
+        if (cOperation.is_object() && cOperation.contains("id")) {
+          cFailure["id"] = cOperation["id"];
+        }
+        cFailure["error"] = strError;
+        cResult["failed"].push_back(std::move(cFailure));
+
+        LOGERR << "[WARNING] Batch rolled back, operation " << i
+               << " failed: " << strError << '\n';
+        return cResult;
+      }
+    }
+
+    cUndo.Commit();
+    for (const std::string& strId : vecRemoved) {
+      m_cSimulator.GetLoopFunctions().RemoveEntity(strId);
+      m_bEntityTableDirty = true;
+    }
+    cResult["applied"] = c_operations.size();
+
+    /* One new state for the whole batch */
+    if (!c_operations.empty()) {
+      ++m_unStateVersion;
+    }
+
+    LOG << "[INFO] Batch applied: " << c_operations.size() << " operations"
+        << '\n';
+
+    return cResult;
+  }
+
+  /****************************************/
+  /****************************************/
+
+  void CWebviz::UpdateFloorTexture(
+    std::shared_ptr<const Webviz::CFloorTexture::SImage> ps_image,
+    std::vector<Webviz::CFloorTexture::SRect> vec_dirty) {
+    m_cWebServer->UpdateFloor(std::move(ps_image), std::move(vec_dirty));
+  }
+
+  /****************************************/
+  /****************************************/
+
   void CWebviz::Destroy() {
+    /* Stop the serialization workers */
+    delete m_pcSerializationPool;
+    m_pcSerializationPool = nullptr;
+
+    /* Write what is left of the recording, and its index */
+    if (m_pcRecorder != nullptr) {
+      m_pcRecorder->Stop();
+      LOG << "[INFO] Recorded " << m_pcRecorder->GetWritten() << " frames";
+      if (m_pcRecorder->GetDropped() > 0) {
+        LOG << ", dropped " << m_pcRecorder->GetDropped()
+            << " (the disk is too slow)";
+      }
+      LOG << '\n';
+      if (m_pcRecorder->HasFailed()) {
+        LOGERR << "[ERROR] Failed writing the recording" << '\n';
+      }
+      delete m_pcRecorder;
+      m_pcRecorder = nullptr;
+    }
+
+    /* Unmap the replayed recording */
+    delete m_pcReplay;
+    m_pcReplay = nullptr;
+
     /* Get rid of the factory */
 
     CFactory<CWebvizUserFunctions>::Destroy();
@@ -681,6 +1577,22 @@ namespace argos {
     "    <webviz port=3000\n"
     "         broadcast_frequency=10\n"
     "         ff_draw_frames_every=2\n"
+    "         ff_max_speed=\"false\"\n"
+    "         keyframe_every=1\n"
+    "         floor_pixels_per_meter=100\n"
+    "         serialization_threads=0\n"
+    "         server_threads=1\n"
+    "         log_buffer_size=1024\n"
+    "         log_rate_limit=0\n"
+    "         thread_safe_user_functions=\"false\"\n"
+    "         rays=\"true\"\n"
+    "         ray_every_frame=1\n"
+    "         ray_every_ray=1\n"
+    "         record_file=\"\"\n"
+    "         record_every=1\n"
+    "         record_keyframe_every=100\n"
+    "         replay_file=\"\"\n"
+    "         client_dir=\"\"\n"
     "         autoplay=\"true\"\n"
     "         ssl_key_file=\"NULL\"\n"
     "         ssl_cert_file=\"NULL\"\n"
@@ -706,6 +1618,90 @@ namespace argos {
     "\twhen in fast forward mode\n"
     "    Default: 2\n\n"
 
+    "ff_max_speed(bool): Fast forward runs the steps back to back as fast\n"
+    "\tas possible, instead of ff_draw_frames_every steps per clock tick.\n"
+    "\tStates are still broadcasted at broadcast_frequency\n"
+    "    Default: false\n\n"
+
+    "keyframe_every(unsigned short): Number of broadcasts between two\n"
+    "\tfull states (keyframes). Broadcasts in between only contain what\n"
+    "\tchanged since the previous broadcast (deltas). 1 disables deltas\n"
+    "    Default: 1\n"
+    "    Range: [1,1000]\n\n"
+
+    "floor_pixels_per_meter(unsigned short): Resolution of the floor\n"
+    "\ttexture. It is rendered in memory each time the floor changes, and\n"
+    "\tonly the regions which changed are sent to the clients. It is\n"
+    "\tlowered (with a warning) to keep the texture within 4096 pixels\n"
+    "\tper side\n"
+    "    Default: 100\n"
+    "    Range: [1,1000]\n\n"
+
+    "serialization_threads(unsigned short): Number of worker threads used\n"
+    "\tto convert entities to JSON in parallel, useful with thousands of\n"
+    "\tentities. 0 converts them in the simulation thread only\n"
+    "    Default: 0\n"
+    "    Range: [0,256]\n\n"
+
+    "server_threads(unsigned short): Number of threads serving the\n"
+    "\tclients, each with its own connections on the same port. States\n"
+    "\tare still encoded once per broadcast\n"
+    "    Default: 1\n"
+    "    Range: [1,64]\n\n"
+
+    "log_buffer_size(unsigned int): Number of log lines kept between two\n"
+    "\tbroadcasts. Lines above it are dropped, and the clients are told\n"
+    "\thow many\n"
+    "    Default: 1024\n"
+    "    Range: [16,1048576]\n\n"
+
+    "log_rate_limit(unsigned int): Number of log lines sent per second,\n"
+    "\tthe others are dropped. 0 for no limit\n"
+    "    Default: 0\n\n"
+
+    "thread_safe_user_functions(bool): Set to true if the entity functions\n"
+    "\tof the user functions can run in parallel, from the serialization\n"
+    "\tthreads. Otherwise they are called one after the other\n"
+    "    Default: false\n\n"
+
+    "rays(bool): Sends the sensor rays of the robots, for the clients\n"
+    "\twhich do not choose for themselves\n"
+    "    Default: true\n\n"
+
+    "ray_every_frame(unsigned int): Sends the rays in one broadcast out\n"
+    "\tof ray_every_frame\n"
+    "    Default: 1\n"
+    "    Range: [1,1000]\n\n"
+
+    "ray_every_ray(unsigned int): Sends one ray out of ray_every_ray\n"
+    "    Default: 1\n"
+    "    Range: [1,1000]\n\n"
+
+    "record_file(string): Records the broadcasted states to this file,\n"
+    "\tfrom a background thread. Empty disables recording\n"
+    "    Default: \"\"\n\n"
+
+    "record_every(unsigned short): Records one broadcasted state out of\n"
+    "\trecord_every\n"
+    "    Default: 1\n"
+    "    Range: [1,1000]\n\n"
+
+    "record_keyframe_every(unsigned short): Number of recorded frames\n"
+    "\tbetween two keyframes of the recording, the points it can be seeked\n"
+    "\tto\n"
+    "    Default: 100\n"
+    "    Range: [1,10000]\n\n"
+
+    "replay_file(string): Plays a recording back instead of running the\n"
+    "\texperiment, with the same commands plus \"seek\". The arena of the\n"
+    "\texperiment file is not used. Empty runs the experiment\n"
+    "    Default: \"\"\n\n"
+
+    "client_dir(string): Directory of the web client (like \"client\"),\n"
+    "\tserved over HTTP on the same port, gzipped when it is smaller.\n"
+    "\tEmpty only serves the websockets\n"
+    "    Default: \"\"\n\n"
+
     "autoplay(bool): Allows user to auto-play the simulation at startup\n"
     "    Default: false\n\n"
     "--\n\n"
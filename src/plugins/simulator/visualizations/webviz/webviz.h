@@ -20,13 +20,18 @@ namespace argos {
     class CWebServer;
     class CTimer;
     class CLogStream;
+    class CThreadPool;
     enum class EExperimentState;
   }  // namespace Webviz
 }  // namespace argos
 
 #include <argos3/core/simulator/entity/entity.h>
 
+#include <cstdint>
 #include <nlohmann/json.hpp>
+#include <string>
+
+#include "utility/ClientCommand.h"
 
 namespace argos {
   typedef nlohmann::json json;
@@ -46,6 +51,7 @@ namespace argos {
 }  // namespace argos
 
 #include <argos3/core/simulator/entity/composable_entity.h>
+#include <argos3/core/simulator/entity/embodied_entity.h>
 #include <argos3/core/simulator/loop_functions.h>
 #include <argos3/core/simulator/space/space.h>
 #include <argos3/core/simulator/visualization/visualization.h>
@@ -54,12 +60,26 @@ namespace argos {
 #include <argos3/core/utility/plugins/dynamic_loading.h>
 
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <thread>
+#include <unordered_set>
+#include <vector>
 
+#include "utility/Batch.h"
+#include "utility/BroadcastMask.h"
 #include "utility/CTimer.h"
 #include "utility/EExperimentState.h"
+#include "utility/FloorTexture.h"
 #include "utility/LogStream.h"
+#include "utility/MPSCQueue.h"
 #include "utility/PortCheck.h"
+#include "utility/PoseSnapshot.h"
+#include "utility/RayLOD.h"
+#include "utility/Recorder.h"
+#include "utility/Replay.h"
+#include "utility/ThreadPool.h"
+#include "utility/TickScheduler.h"
 #include "webviz_user_functions.h"
 #include "webviz_webserver.h"
 
@@ -82,14 +102,63 @@ namespace argos {
     virtual void Destroy();
 
     /**
-     * @brief Function to handle commands sent from web client
+     * @brief Queues a command sent from a web client, it is run by the
+     * simulation thread between two steps
+     *
+     * Can be called from any thread, never blocks.
+     */
+    void EnqueueCommand(Webviz::SClientCommand s_command);
+
+    /**
+     * @brief Function to handle commands sent from web client, from the
+     * simulation thread
      *
      * @param str_ip Client IP address
      * @param c_json_command JSON object from client
+     * @return nlohmann::json acknowledgement to send back to the client
      */
-    void HandleCommandFromClient(
+    nlohmann::json HandleCommandFromClient(
       const std::string& str_ip, nlohmann::json c_json_command);
 
+    /**
+     * @brief True if some client wants this field of the entities in the
+     * broadcast being generated
+     *
+     * Lets entity serializers skip the fields which are costly to generate.
+     */
+    bool IsFieldWanted(const std::string& str_field) const {
+      return m_cGenerationMask.WantsField(str_field);
+    }
+
+    /**
+     * @brief True if some client wants the rays (and intersection points)
+     * of this entity in the broadcast being generated
+     *
+     * When false, the serializer should not go through the rays at all.
+     */
+    bool AreRaysWanted(const std::string& str_id) const {
+      return (IsFieldWanted("rays") || IsFieldWanted("points")) &&
+             m_cGenerationRayLOD.WantsRaysOf(str_id);
+    }
+
+    /** Rays to skip between two encoded rays, 1 to encode all of them */
+    uint32_t GetRayStep() const { return m_cGenerationRayLOD.GetEveryRay(); }
+
+    /** Resolution of the floor texture sent to the clients */
+    unsigned short GetFloorPixelsPerMeter() const {
+      return m_unFloorPixelsPerMeter;
+    }
+
+    /**
+     * @brief Hands a new rendering of the floor over to the webserver
+     *
+     * @param ps_image new rendering of the floor
+     * @param vec_dirty regions which changed since the previous rendering
+     */
+    void UpdateFloorTexture(
+      std::shared_ptr<const Webviz::CFloorTexture::SImage> ps_image,
+      std::vector<Webviz::CFloorTexture::SRect> vec_dirty);
+
    protected:
     /**
      * @brief Plays the experiment.
@@ -138,19 +207,60 @@ namespace argos {
      * @param str_entity_id
      * @param c_pos
      * @param c_orientation
+     * @return false if the entity cannot be moved there (collision)
      *
      * @throw CARGoSException if entity doesn't exist
      *
      */
-    void MoveEntity(
+    bool MoveEntity(
       std::string str_entity_id, CVector3 c_pos, CQuaternion c_orientation);
 
+    /**
+     * @brief Applies a batch of operations in one pass, between two steps
+     *
+     * Each operation is an object with "op" being "move" (default, with
+     * "id", "position" and optionally "orientation"), "add" (with "xml",
+     * the entity as in the .argos file) or "remove" (with "id").
+     *
+     * Operations are applied in order, each one checked against what the
+     * previous ones did (ids, XML, collisions). On the first failure, the
+     * moves and adds already applied are undone and nothing is kept.
+     * Removals can not be undone, so they are done last, once everything
+     * else succeeded: removed entities keep their place and their id until
+     * the end of the batch.
+     *
+     * @param c_operations JSON array of operations
+     * @return nlohmann::json number of "applied" operations, and the
+     * "failed" ones with their index, id and error
+     *
+     * @throw CARGoSException if c_operations is not an array
+     */
+    nlohmann::json ApplyBatch(const nlohmann::json& c_operations);
+
+    /**
+     * @brief Jumps to a simulation step of the replayed recording
+     *
+     * @param un_steps steps to go to, the last frame recorded at or before
+     * them is shown
+     * @return false if the recording can not be read there
+     *
+     * @throw CARGoSException if not replaying a recording
+     */
+    bool SeekExperiment(UInt64 un_steps);
+
+    /**
+     * @brief Function which broadcast experiment state
+     *
+     * Called from the simulation thread, the benchmarks call it directly.
+     */
+    void BroadcastExperimentState();
+
    private:
     /** Experiment State, declared atomic as it is used by many threads */
     std::atomic<Webviz::EExperimentState> m_eExperimentState;
 
-    /** Timer used for the loop */
-    Webviz::CTimer m_cTimer;
+    /** Paces the play loop at the simulation clock tick */
+    Webviz::CTickScheduler m_cTickScheduler;
 
     /** Reference to the space state */
     CSpace& m_cSpace;
@@ -158,8 +268,16 @@ namespace argos {
     /** Boolean for fastForwarding */
     std::atomic<bool> m_bFastForwarding;
 
-    /** Milliseconds required for one tick of simulator */
-    std::chrono::milliseconds m_cSimulatorTickMillis;
+    /** Fast-forward runs steps back to back, without any wait */
+    std::atomic<bool> m_bMaxSpeed;
+
+    /** Bumped each time the experiment changes outside of the play loop */
+    std::atomic<UInt64> m_unStateVersion;
+
+    /** Version and state of the last broadcast state, simulation thread only
+     */
+    UInt64 m_unBroadcastVersion;
+    Webviz::EExperimentState m_eBroadcastState;
 
     /** Webserver */
     Webviz::CWebServer* m_cWebServer = nullptr;
@@ -167,9 +285,91 @@ namespace argos {
     /** number of frames to drop in Fast-forwarding */
     unsigned short m_unDrawFrameEvery = 2;
 
+    /** Resolution of the floor texture */
+    unsigned short m_unFloorPixelsPerMeter = 100;
+
     /** User functions */
     CWebvizUserFunctions* m_pcUserFunctions = nullptr;
 
+    /** Records the broadcasted states, null if not recording */
+    Webviz::CRecorder* m_pcRecorder = nullptr;
+
+    /** Records one state out of m_unRecordEvery */
+    unsigned short m_unRecordEvery = 1;
+    unsigned short m_unStatesSinceRecorded = 0;
+
+    /** Recording played back instead of the simulation, null if simulating
+     */
+    Webviz::CReplay* m_pcReplay = nullptr;
+
+    /** What the clients want in the broadcast being generated */
+    Webviz::CBroadcastMask m_cGenerationMask;
+    Webviz::CRayLOD m_cGenerationRayLOD;
+
+    /** Workers serializing entities in parallel, null if serial */
+    Webviz::CThreadPool* m_pcSerializationPool = nullptr;
+
+    /** User functions can be called from the serialization workers */
+    bool m_bThreadSafeUserFunctions = false;
+
+    /** What is resolved once about a root entity, to serialize it */
+    struct SEntityRecord {
+      /** With its id, as a new entity can be allocated at the same address */
+      CEntity* m_pcEntity = nullptr;
+      std::string m_strId;
+      /** GetTypeDescription(), returned by value by the entities */
+      std::string m_strType;
+      /** False once no serializer was found for its type */
+      bool m_bSerializable = true;
+      /** Origin anchor of its body, null if it has none */
+      const SAnchor* m_psOriginAnchor = nullptr;
+    };
+
+    /** By index of the root entities, rebuilt when they are added or
+     * removed */
+    std::vector<SEntityRecord> m_vecEntityTable;
+
+    /** Set when Webviz adds, removes or resets entities */
+    bool m_bEntityTableDirty = true;
+
+    /** Types without serializer, already reported */
+    std::unordered_set<std::string> m_setUnknownTypes;
+
+    /** Ids of the entities with a body, in the order of m_vecEntityTable,
+     * rebuilt with it */
+    std::shared_ptr<const Webviz::CPoseSnapshot::SIndex> m_psPoseIndex;
+
+    /** Poses for the "poses" topic, its arrays are reused */
+    Webviz::CPoseSnapshot m_cPoseSnapshot;
+
+    /** "user_data" of a root entity in the previous broadcast */
+    struct SUserDataCache {
+      CEntity* m_pcEntity = nullptr;
+      std::string m_strId;
+      nlohmann::json m_cData;
+      /** Changes with m_cData, 0 when unknown */
+      uint64_t m_unVersion = 0;
+    };
+
+    /** By index of the root entities, each written by only one worker */
+    std::vector<SUserDataCache> m_vecUserDataCache;
+
+    /** Last version given to the "user_data" of an entity */
+    std::atomic<uint64_t> m_unLastUserDataVersion{0};
+
+    /** "user_data" of the experiment in the previous broadcast */
+    nlohmann::json m_cUserData;
+
+    /** Time spent in the stages of the simulation thread, owned by the
+     * metrics of the webserver */
+    Webviz::CHistogram* m_pcStepHistogram = nullptr;
+    Webviz::CHistogram* m_pcSerializeHistogram = nullptr;
+    Webviz::CHistogram* m_pcUserFunctionsHistogram = nullptr;
+
+    /** Commands from the clients, pushed by the webserver and run by the
+     * simulation thread */
+    Webviz::CMPSCQueue<Webviz::SClientCommand> m_cCommandQueue;
+
     /**
      * @brief Function which run in Simulation thread
      *
@@ -178,10 +378,76 @@ namespace argos {
     void SimulationThreadFunction(const std::atomic<bool>& b_IsServerRunning);
 
     /**
-     * @brief Function which broadcast experiment state
+     * @brief Function which run in Simulation thread when replaying, plays
+     * the recording back instead of stepping the simulation
      *
+     * @param b_IsServerRunning used to stop the thread gracefully
      */
-    void BroadcastExperimentState();
+    void ReplayThreadFunction(const std::atomic<bool>& b_IsServerRunning);
+
+    /**
+     * @brief Returns the embodied entity (or "body" component) of an entity
+     *
+     * @throw CARGoSException if entity doesn't exist or is not embodied
+     */
+    CEmbodiedEntity& GetEmbodiedEntity(const std::string& str_entity_id);
+
+    /**
+     * @brief Runs the queued commands, and sends their acknowledgements,
+     * from the simulation thread
+     */
+    void ProcessCommands();
+
+    /**
+     * @brief Broadcasts the state of the replayed recording
+     *
+     */
+    void BroadcastReplayState();
+
+    /**
+     * @brief Broadcasts the experiment state only if the webserver asked for
+     * one and the experiment changed since the last broadcast (or a client
+     * needs a keyframe)
+     *
+     */
+    void BroadcastExperimentStateIfWanted();
+
+    /**
+     * @brief Converts root entities to JSON, in parallel if
+     * serialization_threads is set
+     *
+     * @param c_entities JSON array to fill, in the order of the entities
+     * @param c_user_functions_time time spent in the user functions, summed
+     * over the workers
+     * @param vec_user_data_versions versions of the "user_data" of
+     * c_entities, in their order, left empty if not generated
+     */
+    void SerializeEntities(
+      nlohmann::json& c_entities,
+      std::chrono::nanoseconds& c_user_functions_time,
+      std::vector<uint64_t>& vec_user_data_versions);
+
+    /**
+     * @brief Rebuilds m_vecEntityTable if it is dirty, or if the root
+     * entities changed without Webviz (loop functions), as seen from their
+     * number and the last of them
+     */
+    void UpdateEntityTable();
+
+    /**
+     * @brief Sends the poses of the entities with a body to the webserver,
+     * if some clients want them
+     */
+    void BroadcastPoses();
+
+    /**
+     * @brief Calls the user function of a root entity, with its "user_data"
+     * of the previous broadcast
+     *
+     * @param un_index index of the entity in the root entities
+     * @return the cached "user_data", with a new version if it changed
+     */
+    const SUserDataCache& CallUserFunction(size_t un_index, CEntity& c_entity);
   };
 
 };  // namespace argos
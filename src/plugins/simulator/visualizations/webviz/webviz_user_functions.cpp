@@ -14,8 +14,10 @@
 
 namespace argos {
 
-  CWebvizUserFunctions::CWebvizUserFunctions() : m_vecFunctionHolders(1) {
+  CWebvizUserFunctions::CWebvizUserFunctions()
+      : m_vecFunctionHolders(1), m_vecUpdateFunctionHolders(1) {
     m_cThunks.Add<CEntity>((TThunk)NULL);
+    m_cUpdateThunks.Add<CEntity>((TUpdateThunk)NULL);
   }
 
   /****************************************/
@@ -26,6 +28,10 @@ namespace argos {
       delete m_vecFunctionHolders.back();
       m_vecFunctionHolders.pop_back();
     }
+    while (!m_vecUpdateFunctionHolders.empty()) {
+      delete m_vecUpdateFunctionHolders.back();
+      m_vecUpdateFunctionHolders.pop_back();
+    }
   }
 
   /****************************************/
@@ -40,4 +46,19 @@ namespace argos {
     }
   }
 
+  /****************************************/
+  /****************************************/
+
+  bool CWebvizUserFunctions::Call(
+    CEntity& c_entity, nlohmann::json& c_user_data) {
+    size_t unTag = c_entity.GetTag();
+    if (
+      unTag < m_vecUpdateFunctionHolders.size() &&
+      m_vecUpdateFunctionHolders[unTag] != NULL) {
+      return (this->*m_cUpdateThunks[unTag])(c_entity, c_user_data);
+    }
+    c_user_data = Call(c_entity);
+    return true;
+  }
+
 }  // namespace argos
\ No newline at end of file
@@ -59,6 +59,22 @@ namespace argos {
      */
     virtual const nlohmann::json sendUserData() { return nullptr; }
 
+    /**
+     * @brief Variant of sendUserData() which updates the "user_data" of the
+     * previous broadcast in place, and tells if it changed
+     *
+     * Unchanged data is not built, copied from a return value nor compared
+     * again for the deltas. By default it calls sendUserData().
+     *
+     * @param c_user_data "user_data" of the previous broadcast, null at
+     * first
+     * @return false if c_user_data was left as it was
+     */
+    virtual bool sendUserDataIfChanged(nlohmann::json& c_user_data) {
+      c_user_data = sendUserData();
+      return true;
+    }
+
     /**
      * Registers a user method.
      * @param USER_IMPL A user-defined subclass of CWebvizUserFunctions.
@@ -70,12 +86,34 @@ namespace argos {
     void RegisterWebvizUserFunction(
       const nlohmann::json (USER_IMPL::*pt_function)(ENTITY&));
 
+    /**
+     * Registers a user method which updates the "user_data" of an entity in
+     * place, and returns false if it left it as it was.
+     * @param USER_IMPL A user-defined subclass of CWebvizUserFunctions.
+     * @param ENTITY The entity type to pass as a parameter to the user-defined
+     * method.
+     * @param pt_function The actual user-defined pointer-to-method.
+     */
+    template <typename USER_IMPL, typename ENTITY>
+    void RegisterWebvizUserFunction(
+      bool (USER_IMPL::*pt_function)(ENTITY&, nlohmann::json&));
+
     /**
      * Calls a user method for the given entity.
      * @param c_entity The method to pass as parameter.
      */
     virtual const nlohmann::json Call(CEntity& c_entity);
 
+    /**
+     * Calls a user method for the given entity, with the "user_data" it
+     * had in the previous broadcast.
+     * Methods returning their JSON are called as Call(c_entity).
+     * @param c_entity The method to pass as parameter.
+     * @param c_user_data The "user_data" to update, null at first.
+     * @return false if c_user_data was left as it was.
+     */
+    virtual bool Call(CEntity& c_entity, nlohmann::json& c_user_data);
+
    protected:
     /**
      * Pointer-to-thunk type definition.
@@ -96,6 +134,22 @@ namespace argos {
     template <typename USER_IMPL, typename ENTITY>
     const nlohmann::json Thunk(CEntity& c_entity);
 
+    /**
+     * Pointer-to-thunk type definition, for the methods updating their
+     * "user_data" in place.
+     * @see UpdateThunk
+     */
+    typedef bool (CWebvizUserFunctions::*TUpdateThunk)(
+      CEntity&, nlohmann::json&);
+
+    /**
+     * A templetized thunk, for the methods updating their "user_data" in
+     * place.
+     * @see Thunk
+     */
+    template <typename USER_IMPL, typename ENTITY>
+    bool UpdateThunk(CEntity& c_entity, nlohmann::json& c_user_data);
+
     /**
      * The base function holder.
      * @see CFunctionHolderImpl
@@ -118,6 +172,19 @@ namespace argos {
       CFunctionHolderImpl(TFunction t_function) : Function(t_function) {}
     };
 
+    /**
+     * The function holder of the methods updating their "user_data" in
+     * place.
+     * @see CFunctionHolderImpl
+     */
+    template <typename USER_IMPL, typename ENTITY>
+    class CUpdateFunctionHolderImpl : public CFunctionHolder {
+     public:
+      typedef bool (USER_IMPL::*TFunction)(ENTITY&, nlohmann::json&);
+      TFunction Function;
+      CUpdateFunctionHolderImpl(TFunction t_function) : Function(t_function) {}
+    };
+
     /**
      * The vtable storing the thunks.
      * @see TThunk
@@ -130,6 +197,19 @@ namespace argos {
      * @see CFunctionHolder
      */
     std::vector<CFunctionHolder*> m_vecFunctionHolders;
+
+    /**
+     * The vtable storing the thunks updating "user_data" in place.
+     * @see TUpdateThunk
+     */
+    CVTable<CWebvizUserFunctions, CEntity, TUpdateThunk> m_cUpdateThunks;
+
+    /**
+     * A vector of function holders updating "user_data" in place, by tag,
+     * NULL for the types without one.
+     * @see CUpdateFunctionHolderImpl
+     */
+    std::vector<CFunctionHolder*> m_vecUpdateFunctionHolders;
   };
 
   /****************************************/
@@ -164,6 +244,25 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  template <typename USER_IMPL, typename ENTITY>
+  bool CWebvizUserFunctions::UpdateThunk(
+    CEntity& c_entity, nlohmann::json& c_user_data) {
+    /* Same as Thunk() */
+    static USER_IMPL& cImpl = static_cast<USER_IMPL&>(*this);
+
+    // cppcheck-suppress constVariable
+    ENTITY& cEntity = static_cast<ENTITY&>(c_entity);
+
+    CUpdateFunctionHolderImpl<USER_IMPL, ENTITY>& cFunctionHolder =
+      static_cast<CUpdateFunctionHolderImpl<USER_IMPL, ENTITY>&>(
+        *m_vecUpdateFunctionHolders[GetTag<ENTITY, CEntity>()]);
+
+    return (cImpl.*(cFunctionHolder.Function))(cEntity, c_user_data);
+  }
+
+  /****************************************/
+  /****************************************/
+
   template <typename USER_IMPL, typename ENTITY>
   void CWebvizUserFunctions::RegisterWebvizUserFunction(
     const nlohmann::json (USER_IMPL::*pt_function)(ENTITY&)) {
@@ -181,6 +280,23 @@ namespace argos {
   /****************************************/
   /****************************************/
 
+  template <typename USER_IMPL, typename ENTITY>
+  void CWebvizUserFunctions::RegisterWebvizUserFunction(
+    bool (USER_IMPL::*pt_function)(ENTITY&, nlohmann::json&)) {
+    m_cUpdateThunks.Add<ENTITY>(
+      &CWebvizUserFunctions::UpdateThunk<USER_IMPL, ENTITY>);
+    size_t unIdx = GetTag<ENTITY, CEntity>();
+    if (m_vecUpdateFunctionHolders.size() <= unIdx) {
+      m_vecUpdateFunctionHolders.resize(unIdx + 1, NULL);
+    }
+    delete m_vecUpdateFunctionHolders[unIdx];
+    m_vecUpdateFunctionHolders[unIdx] =
+      new CUpdateFunctionHolderImpl<USER_IMPL, ENTITY>(pt_function);
+  }
+
+  /****************************************/
+  /****************************************/
+
 }  // namespace argos
 
 /* Definitions useful for dynamic linking of user functions */
@@ -18,19 +18,38 @@ namespace argos {
     /****************************************/
 
     CWebServer::CWebServer(
-      argos::CWebviz *pc_my_webviz,
+      std::function<void(SClientCommand)> fn_command_handler,
       unsigned short un_port,
       unsigned short un_freq,
+      unsigned short un_keyframe_every,
       std::string &str_key_file,
       std::string &str_cert_file,
       std::string &str_dh_params_file,
       std::string &str_ca_file,
       std::string &str_cert_passphrase)
-        : m_pcMyWebviz(pc_my_webviz),
+        : m_fnCommandHandler(std::move(fn_command_handler)),
           /* Port to host the application on */
           m_unPort(un_port),
           /* Initialize broadcast Timer */
-          m_cBroadcastTimer(argos::Webviz::CTimer()) {
+          m_cBroadcastTimer(argos::Webviz::CTimer()),
+          m_bHasNewBroadcast(false),
+          /* Ask for a first state right away */
+          m_bBroadcastWanted(true),
+          /* Keyframes every N broadcasts, deltas in between */
+          m_cDeltaEncoder(un_keyframe_every),
+          /* Default limits, until SetLogLimits() */
+          m_pcLogRing(std::make_unique<CLogRing>()),
+          /* One server thread, until SetServerThreads() */
+          m_vecLoops(1),
+          m_unClients(0),
+          m_unFilteredClients(0),
+          m_unJSONSubscribers(0),
+          m_unMsgPackSubscribers(0),
+          m_unCBORSubscribers(0),
+          m_unDeflateSubscribers(0),
+          m_unClientsNeedingKeyframe(0),
+          m_unClientsNeedingFloor(0),
+          m_unPoseSubscribers(0) {
       /* We dont want to divide by zero or negative frequency */
       if (un_freq <= 0) {
         un_freq = 10;  // Defaults to 10 Hz
@@ -39,8 +58,6 @@ namespace argos {
       /* max allowed time for one broadcast cycle */
       m_cBroadcastDuration = std::chrono::milliseconds(1000 / un_freq);
 
-      m_strBroadcastString = "";
-
       /* SSL parameters */
       m_strKeyFile = str_key_file;
       m_strCertFile = str_cert_file;
@@ -48,7 +65,113 @@ namespace argos {
       m_strCAFile = str_ca_file;
       m_strPassphrase = str_cert_passphrase;
 
+      /* Sequences of another run must not be resumed */
+      std::random_device cRandom;
+      char pchSession[17];
+      std::snprintf(
+        pchSession, sizeof(pchSession), "%08x%08x", cRandom(), cRandom());
+      m_strSession = pchSession;
+
+      RegisterMetrics();
+
       LOG << "[INFO] Starting WebSockets Server on port " << m_unPort << '\n';
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::RegisterMetrics() {
+      m_pcCycleHistogram = &m_cMetrics.AddHistogram(
+        "webviz_broadcast_cycle_seconds",
+        "Time spent encoding one broadcast cycle, without publishing it");
+      m_pcDeltaHistogram = &m_cMetrics.AddHistogram(
+        "webviz_delta_encode_seconds",
+        "Time spent building a keyframe or a delta from a state");
+      m_pcSerializeHistogram = &m_cMetrics.AddHistogram(
+        "webviz_serialize_seconds",
+        "Time spent serializing a frame (dump, MessagePack, CBOR)");
+      m_pcCompressHistogram = &m_cMetrics.AddHistogram(
+        "webviz_compress_seconds", "Time spent deflating a frame");
+      m_pcPublishHistogram = &m_cMetrics.AddHistogram(
+        "webviz_publish_seconds",
+        "Time spent sending a broadcast cycle to the clients of one thread");
+      m_pcLogHistogram = &m_cMetrics.AddHistogram(
+        "webviz_log_pipeline_seconds",
+        "Time spent escaping and batching the log lines of a cycle");
+
+      m_cMetrics.AddGauge("webviz_clients", "Connected clients", [this]() {
+        return static_cast<double>(m_unClients);
+      });
+      m_cMetrics.AddGauge(
+        "process_resident_memory_bytes",
+        "Resident memory of the process",
+        []() { return static_cast<double>(CMetrics::GetResidentMemory()); });
+      m_cMetrics.AddGauge(
+        "webviz_clients_needing_keyframe",
+        "Clients waiting for a keyframe to resynchronize",
+        [this]() { return static_cast<double>(m_unClientsNeedingKeyframe); });
+      m_cMetrics.AddGauge(
+        "webviz_client_buffered_bytes",
+        "Bytes waiting to be sent to all the clients",
+        [this]() {
+          uint64_t unBytes = 0;
+          for (const auto &sLoop : m_vecLoops) {
+            unBytes += sLoop.m_unBufferedBytes;
+          }
+          return static_cast<double>(unBytes);
+        });
+      m_cMetrics.AddGauge(
+        "webviz_client_buffered_bytes_max",
+        "Bytes waiting to be sent to the most congested client",
+        [this]() {
+          uint64_t unBytes = 0;
+          for (const auto &sLoop : m_vecLoops) {
+            unBytes = std::max<uint64_t>(unBytes, sLoop.m_unMaxBufferedBytes);
+          }
+          return static_cast<double>(unBytes);
+        });
+      m_cMetrics.AddCounter(
+        "webviz_dropped_frames_total",
+        "Broadcasts not sent to congested or slowed down clients",
+        [this]() { return static_cast<double>(m_unDroppedFrames); });
+      m_cMetrics.AddCounter(
+        "webviz_cached_joins_total",
+        "Clients which got the cached keyframe as soon as they connected",
+        [this]() { return static_cast<double>(m_unCachedJoins); });
+      m_cMetrics.AddCounter(
+        "webviz_resumes_total",
+        "Clients which got only the deltas they missed when they reconnected",
+        [this]() { return static_cast<double>(m_unResumes); });
+      m_cMetrics.AddCounter(
+        "webviz_dropped_log_lines_total",
+        "Log lines dropped above the buffer size or the rate limit",
+        [this]() { return static_cast<double>(m_pcLogRing->GetDropped()); });
+      m_cMetrics.AddGauge(
+        "webviz_log_queue_depth",
+        "Log lines waiting for the next broadcast cycle",
+        [this]() { return static_cast<double>(m_pcLogRing->GetSize()); });
+      m_cMetrics.AddGauge(
+        "webviz_event_queue_depth",
+        "Events waiting for the next broadcast cycle",
+        [this]() {
+          std::lock_guard<std::mutex> guard(m_mutex4EventQueue);
+          return static_cast<double>(m_vecEvents.size());
+        });
+      m_cMetrics.AddGauge(
+        "webviz_floor_queue_depth",
+        "Floor updates waiting for the next broadcast cycle",
+        [this]() {
+          std::lock_guard<std::mutex> guard(m_mutex4Floor);
+          return static_cast<double>(m_vecFloorUpdates.size());
+        });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::CaptureLogs(std::function<uint64_t()> fn_get_steps) {
+      m_fnGetSteps = std::move(fn_get_steps);
+
       /* Write all the pending stuff */
       LOG.Flush();
       LOGERR.Flush();
@@ -60,13 +183,29 @@ namespace argos {
 
       /* Initialize the LOG streams from Execute thread */
 
-      new Webviz::CLogStream(LOG.GetStream(), [this](std::string str_logData) {
-        EmitLog("LOG", str_logData);
-      });
+      /* Lines are escaped later, by the broadcaster */
+      new Webviz::CLogStream(
+        LOG.GetStream(),
+        [this](std::string str_logData) {
+          EmitLog("LOG", std::move(str_logData));
+        },
+        false);
 
       new Webviz::CLogStream(
         LOGERR.GetStream(),
-        [this](std::string str_logData) { EmitLog("LOGERR", str_logData); });
+        [this](std::string str_logData) {
+          EmitLog("LOGERR", std::move(str_logData));
+        },
+        false);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetLogLimits(
+      size_t un_capacity, uint32_t un_lines_per_second) {
+      m_pcLogRing =
+        std::make_unique<CLogRing>(un_capacity, un_lines_per_second);
     }
 
     /****************************************/
@@ -96,12 +235,6 @@ namespace argos {
 
     template <bool SSL>
     void CWebServer::RunServer(std::atomic<bool> &b_IsServerRunning) {
-      /* Create a vector for list of all connected clients */
-      std::vector<SWebSocketClient<SSL>> vecWebSocketClients;
-
-      /* Mutex to protect access to vecWebSocketClients */
-      std::mutex mutex4VecWebClients;
-
       try {
         /* Set up thread-safe buffers for this new thread */
         LOG.AddThreadSafeBuffer();
@@ -141,319 +274,1830 @@ namespace argos {
           sSSLOptions.passphrase = nullptr;
         }
 
-        auto cMyApp = uWS::TemplatedApp<SSL>(sSSLOptions);
-
-        /* Setup WebSockets from the templated app */
-        cMyApp
-          .template ws<m_sPerSocketData>(
-            "/*",
-            {/* Settings */
-             .compression = uWS::DEDICATED_COMPRESSOR_8KB,
-             .maxPayloadLength = 1024 * 1024,
-             .idleTimeout = 10,
-             .maxBackpressure = 100 * 1024 * 1024,
-             /* Handlers */
-             /* new client is connected */
-             .open =
-               [&](uWS::WebSocket<SSL, true> *pc_ws, uWS::HttpRequest *pc_req) {
-                 /* Selectivly subscribe to different channels */
-                 if (pc_req->getQuery().size() > 0) {
-                   std::stringstream strStream(std::string(pc_req->getQuery()));
-                   std::string str_token;
-                   while (std::getline(strStream, str_token, ',')) {
-                     pc_ws->subscribe(str_token);
+        /* Other server threads, started once the first one listens, each
+         * with its own loop and its own clients */
+        std::vector<std::thread> vecServerThreads;
+        std::thread *tBroadcasterThread = nullptr;
+
+        RunLoop<SSL>(0, sSSLOptions, [&]() {
+          for (size_t i = 1; i < m_vecLoops.size(); ++i) {
+            vecServerThreads.emplace_back([&, i]() {
+              /* Set up thread-safe buffers for this new thread */
+              LOG.AddThreadSafeBuffer();
+              LOGERR.AddThreadSafeBuffer();
+              try {
+                RunLoop<SSL>(i, sSSLOptions, []() {});
+              } catch (CARGoSException &ex) {
+                /* Its clients go to the other threads */
+                LOGERR << "[ERROR] Webserver thread " << i
+                       << " stopped: " << ex.what() << '\n';
+                LOGERR.Flush();
+              }
+            });
+          }
+
+          tBroadcasterThread = new std::thread(
+            [&]() { BroadcasterThreadFunction(b_IsServerRunning); });
+        });
+
+        /* Join all the threads */
+        for (auto &tServerThread : vecServerThreads) {
+          tServerThread.join();
+        }
+        if (tBroadcasterThread != nullptr) {
+          tBroadcasterThread->join();
+        }
+      } catch (CARGoSException &ex) {
+        THROW_ARGOSEXCEPTION_NESTED("[ERROR] Error in the webserver:", ex);
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::RunLoop(
+      size_t un_loop,
+      us_socket_context_options_t s_ssl_options,
+      const std::function<void()> &fn_on_listen) {
+      /* Clients subscribed to broadcasts, only used from the loop thread */
+      std::unordered_set<uWS::WebSocket<SSL, true> *> setBroadcastClients;
+
+      /* Clients subscribed to the floor, only used from the loop thread */
+      std::unordered_set<uWS::WebSocket<SSL, true> *> setFloorClients;
+
+      /* Clients subscribed to the poses, only used from the loop thread */
+      std::unordered_set<uWS::WebSocket<SSL, true> *> setPoseClients;
+
+      /* Every client by id, to send acknowledgements, loop thread only */
+      std::unordered_map<uint64_t, uWS::WebSocket<SSL, true> *> mapClients;
+      uint64_t unLastClientId = 0;
+
+      /* Viewports and masks of the clients which set one, loop thread
+       * only */
+      std::unordered_map<uint64_t, SClientFilter> mapFilters;
+
+      /* What the broadcast clients of this loop want all together, from
+       * the loop thread each time a client or a filter changes */
+      auto fnUpdateWantedMask = [&]() {
+        SLoopWanted sWanted;
+        sWanted.m_bBroadcastClients = !setBroadcastClients.empty();
+        sWanted.m_bFloorClients = !setFloorClients.empty();
+        if (!mapFilters.empty()) {
+          sWanted.m_cMask = CBroadcastMask::None();
+          sWanted.m_cRays = CRayLOD::None();
+          for (auto *pcWS : setBroadcastClients) {
+            auto itFilter = mapFilters.find(
+              static_cast<m_sPerSocketData *>(pcWS->getUserData())
+                ->m_unClientId);
+            if (itFilter == mapFilters.end()) {
+              /* This one wants everything */
+              sWanted.m_cMask = CBroadcastMask();
+              sWanted.m_cRays = CRayLOD();
+              break;
+            }
+            sWanted.m_cMask.Merge(itFilter->second.m_cMask);
+            sWanted.m_cRays.Merge(itFilter->second.m_cRays);
+          }
+        }
+        SetWantedMask(un_loop, sWanted);
+      };
+
+      auto cMyApp = uWS::TemplatedApp<SSL>(s_ssl_options);
+
+      /* Setup WebSockets from the templated app */
+      cMyApp
+        .template ws<m_sPerSocketData>(
+          "/*",
+          {/* Settings */
+           /* One compressor shared by all sockets instead of one per
+            * socket, for the small messages only: broadcasts are sent
+            * uncompressed, or compressed once as "broadcasts.deflate" */
+           .compression = uWS::SHARED_COMPRESSOR,
+           .maxPayloadLength = 1024 * 1024,
+           .idleTimeout = 10,
+           /* Broadcasts are skipped way before this, see SendBroadcast */
+           .maxBackpressure = 16 * 1024 * 1024,
+           /* Handlers */
+           /* new client is connected */
+           .open =
+             [&](uWS::WebSocket<SSL, true> *pc_ws, uWS::HttpRequest *pc_req) {
+               /* Selectivly subscribe to different channels, "type:" and
+                * "field:" restrict the broadcasts */
+               SClientFilter sFilter;
+               sFilter.m_cRays = m_cDefaultRayLOD;
+               /* "resume:<session>.<sequence>" of the last broadcast it got */
+               std::string strResume;
+               if (pc_req->getQuery().size() > 0) {
+                 std::stringstream strStream(std::string(pc_req->getQuery()));
+                 std::string str_token;
+                 while (std::getline(strStream, str_token, ',')) {
+                   if (str_token.compare(0, 5, "type:") == 0) {
+                     sFilter.m_cMask.AddType(str_token.substr(5));
+                   } else if (str_token.compare(0, 6, "field:") == 0) {
+                     sFilter.m_cMask.AddField(str_token.substr(6));
+                   } else if (str_token.compare(0, 7, "resume:") == 0) {
+                     strResume = str_token.substr(7);
+                   } else {
+                     Subscribe(pc_ws, str_token);
                    }
-                 } else {
-                   /* making every connection subscribe to the "broadcast",
-                    * "events" and "logs" topics */
-                   pc_ws->subscribe("broadcasts");
-                   pc_ws->subscribe("events");
-                   pc_ws->subscribe("logs");
                  }
-
-                 /* Guard the mutex which locks vecWebSocketClients */
-                 std::lock_guard<std::mutex> guard(mutex4VecWebClients);
-
-                 /* Add to list of clients connected */
-                 vecWebSocketClients.push_back({pc_ws, uWS::Loop::get()});
-
-                 std::cout << "1 client connected (Total: "
-                           << vecWebSocketClients.size() << ")" << '\n';
-               },
-             /* Incoming message from client */
-             .message =
-               [&](
-                 uWS::WebSocket<SSL, true> *pc_ws,
-                 std::string_view strv_message,
-                 uWS::OpCode e_opCode) {
-                 try {
-                   std::string strIP = "unknown";
-
-                   /* Get client IP address */
-                   std::string_view strAddr = pc_ws->getRemoteAddress();
-
-                   /* If we can get IP (IP is not empty) */
-                   if (pc_ws->getRemoteAddress().length() > 0) {
-                     std::stringstream strStream;
-
-                     for (std::string::size_type i = 0; i < strAddr.size() - 1;
-                          i++) {
-                       strStream << std::to_string(strAddr[i]) << '.';
-                     }
-                     strStream << std::to_string(strAddr[strAddr.size() - 1]);
-
-                     strIP = strStream.str();
+               } else {
+                 /* making every connection subscribe to the "broadcast",
+                  * "events" and "logs" topics, "floor" is binary so it is
+                  * only sent when asked for */
+                 Subscribe(pc_ws, "broadcasts");
+                 Subscribe(pc_ws, "events");
+                 Subscribe(pc_ws, "logs");
+               }
+
+               auto *psData =
+                 static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+               /* Unique across the loops, and tells which loop it is on */
+               psData->m_unClientId =
+                 ++unLastClientId * m_vecLoops.size() + un_loop;
+               mapClients[psData->m_unClientId] = pc_ws;
+
+               /* New client needs the full state to start with */
+               bool bFiltered = !sFilter.IsEmpty();
+               if (psData->IsBroadcastClient()) {
+                 setBroadcastClients.insert(pc_ws);
+                 if (bFiltered) {
+                   StoreClientFilter(psData, std::move(sFilter), mapFilters);
+                 }
+               }
+
+               /* And the whole floor, before any patch */
+               if (psData->m_bFloor) {
+                 setFloorClients.insert(pc_ws);
+                 SetNeedsFloor(psData, true);
+               }
+
+               if (psData->m_bPoses) {
+                 setPoseClients.insert(pc_ws);
+               }
+
+               /* Before the cache is read, it is dropped if it misses what
+                * this client wants */
+               fnUpdateWantedMask();
+
+               /* Right away from the cache, or from the next cycle */
+               if (
+                 psData->IsBroadcastClient() && !bFiltered &&
+                 !SendResumeFrames(pc_ws, strResume)) {
+                 SetNeedsKeyframe(psData, true);
+               }
+
+               std::cout << "1 client connected (Total: " << ++m_unClients
+                         << ")" << '\n';
+             },
+           /* Incoming message from client */
+           .message =
+             [&](
+               uWS::WebSocket<SSL, true> *pc_ws,
+               std::string_view strv_message,
+               uWS::OpCode e_opCode) {
+               try {
+                 std::string strIP = "unknown";
+
+                 /* Get client IP address */
+                 std::string_view strAddr = pc_ws->getRemoteAddress();
+
+                 /* If we can get IP (IP is not empty) */
+                 if (pc_ws->getRemoteAddress().length() > 0) {
+                   std::stringstream strStream;
+
+                   for (std::string::size_type i = 0; i < strAddr.size() - 1;
+                        i++) {
+                     strStream << std::to_string(strAddr[i]) << '.';
                    }
+                   strStream << std::to_string(strAddr[strAddr.size() - 1]);
+
+                   strIP = strStream.str();
+                 }
 
-                   /* Try to parse the message as JSON and handle the command */
-                   m_pcMyWebviz->HandleCommandFromClient(
-                     strIP, nlohmann::json::parse(strv_message));
+                 /* Try to parse the message as JSON (or MessagePack for
+                  * binary messages) */
+                 SClientCommand sCommand;
+                 sCommand.m_unClientId =
+                   static_cast<m_sPerSocketData *>(pc_ws->getUserData())
+                     ->m_unClientId;
+                 sCommand.m_strIP = std::move(strIP);
+                 if (e_opCode == uWS::OpCode::BINARY) {
+                   sCommand.m_cCommand = nlohmann::json::from_msgpack(
+                     strv_message.begin(), strv_message.end());
+                 } else {
+                   sCommand.m_cCommand = nlohmann::json::parse(strv_message);
+                 }
 
-                 } catch (nlohmann::json::exception &ignored) {
-                   /* Error is ignored as we can not guarantee client to send
-                   json, also, we cannot reply back with error to the client */
-                   LOGERR << "[ERROR] " << ignored.what() << '\n';
+                 /* Viewports and masks only change what this socket
+                  * receives, no need to go through the simulation thread */
+                 std::string strCmd;
+                 if (sCommand.m_cCommand.is_object()) {
+                   strCmd = sCommand.m_cCommand.value("command", "");
                  }
-               },
-             .drain =
-               [](uWS::WebSocket<SSL, true> *ws) {
-                 //  LOG << "Drain: " << ws->getBufferedAmount() << '\n';
-               },
-             .ping =
-               [](uWS::WebSocket<SSL, true> *ws) { LOG << "Ping" << '\n'; },
-             .pong =
-               [](uWS::WebSocket<SSL, true> *ws) { LOG << "Pong" << '\n'; },
-             .close =
-               [&](
-                 uWS::WebSocket<SSL, true> *pc_ws,
-                 int n_code,
-                 std::string_view strv_message) {
-                 /* client automatically unsubscribe from any topic here */
-
-                 /* Guard the mutex which locks vecWebSocketClients */
-                 std::lock_guard<std::mutex> guard(mutex4VecWebClients);
-
-                 /* Remove from the list of all clients connected */
-                 for (size_t i = 0; i < vecWebSocketClients.size(); i++) {
-                   if (vecWebSocketClients[i].m_pcWS == pc_ws) {
-                     vecWebSocketClients.erase(vecWebSocketClients.begin() + i);
-                   }
+                 if (
+                   strCmd == "setViewport" || strCmd == "setFilter" ||
+                   strCmd == "setRays") {
+                   pc_ws->send(
+                     SetClientFilter(pc_ws, sCommand.m_cCommand, mapFilters)
+                       .dump(),
+                     uWS::OpCode::TEXT,
+                     true);
+                   fnUpdateWantedMask();
+                   return;
                  }
-                 std::cout << "1 client disconnected (Total: "
-                           << vecWebSocketClients.size() << ")" << '\n';
-               }})
-          /* HTML banner */
-          .get(
-            "/", /* Start with SSL */
-            [](auto *res, auto *req) {
-              res->cork([res]() {
-                std::stringstream strStream;
-                strStream << "Reached ARGoS-Webviz server\n\n";
-                strStream << "Webviz version: ";
-                strStream << ARGOS_WEBVIZ_VERSION;
-                strStream << '\n';
-                strStream << "ARGoS3 version: ";
-                strStream << ARGOS_VERSION;
-                strStream << '\n';
-                strStream << "ARGoS3 release: ";
-                strStream << ARGOS_RELEASE;
-                strStream << '\n';
-
-                res->end(strStream.str());
-              });
-            })
-          /* Start listening to Port */
-          .listen(m_unPort, [&](auto *pc_token) {
-            if (pc_token) {
-              LOG << "[INFO] ARGoS3-Webviz server listening on port "
-                  << m_unPort << '\n';
-            } else {
-              throw CARGoSException(
-                "[Error] CWebServer::Start() failed to listen on "
-                "port " +
-                std::to_string(m_unPort));
-              return;
-            }
-          });
 
-        std::thread *tBroadcasterThread = new std::thread([&]() {
-          /* Set up thread-safe buffers for this new thread */
-          LOG.AddThreadSafeBuffer();
-          LOGERR.AddThreadSafeBuffer();
-
-          /* Start broadcast timer */
-          m_cBroadcastTimer.Start();
-
-          /* copy strings to free up the locks */
-          /* Declaring local static here to help with lambda catching inside
-           */
-          static std::string strBroadcastString;
-          static std::string strEventString;
-          static std::string strLogString;
-
-          while (b_IsServerRunning) {
-            /* stop the timer now to get total time spent */
-            m_cBroadcastTimer.Stop();
-
-            /* If the elapsed time is lower than the tick length, wait */
-            if (m_cBroadcastTimer.Elapsed() < m_cBroadcastDuration) {
-              /* Sleep for the difference duration */
-              std::this_thread::sleep_for(
-                m_cBroadcastDuration - m_cBroadcastTimer.Elapsed());
-            } else {
-              LOGERR << "[WARNING] Broadcast tick took " << m_cBroadcastTimer
-                     << " milli-secs, more than the expected "
-                     << m_cBroadcastDuration.count() << " milli-secs. "
-                     << "Not able to reach all clients, Please reduce "
-                        "the \'broadcast_frequency\' in "
-                        "configuration file.\n";
-              break;
+                 /* Run by the simulation thread, which acknowledges it, so
+                  * a long step never blocks the network */
+                 m_fnCommandHandler(std::move(sCommand));
+
+               } catch (nlohmann::json::exception &ignored) {
+                 /* We can not guarantee client to send json, reply with
+                  * the error */
+                 LOGERR << "[ERROR] " << ignored.what() << '\n';
+                 nlohmann::json cAck = {
+                   {"type", "ack"}, {"ok", false}, {"error", ignored.what()}};
+                 pc_ws->send(cAck.dump(), uWS::OpCode::TEXT, true);
+               }
+             },
+           .drain =
+             [](uWS::WebSocket<SSL, true> *ws) {
+               //  LOG << "Drain: " << ws->getBufferedAmount() << '\n';
+             },
+           /* Relays ping to keep their connection up, uWS answers on
+            * its own */
+           .ping = [](uWS::WebSocket<SSL, true> *ws) {},
+           .pong = [](uWS::WebSocket<SSL, true> *ws) {},
+           .close =
+             [&](
+               uWS::WebSocket<SSL, true> *pc_ws,
+               int n_code,
+               std::string_view strv_message) {
+               /* client automatically unsubscribe from any topic here */
+               auto *psData =
+                 static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+               if (psData->m_bBroadcastJSON) {
+                 --m_unJSONSubscribers;
+               }
+               if (psData->m_bBroadcastMsgPack) {
+                 --m_unMsgPackSubscribers;
+               }
+               if (psData->m_bBroadcastCBOR) {
+                 --m_unCBORSubscribers;
+               }
+               if (psData->m_bBroadcastDeflate) {
+                 --m_unDeflateSubscribers;
+               }
+               SetNeedsKeyframe(psData, false);
+               setBroadcastClients.erase(pc_ws);
+               SetNeedsFloor(psData, false);
+               setFloorClients.erase(pc_ws);
+               if (psData->m_bPoses) {
+                 --m_unPoseSubscribers;
+               }
+               setPoseClients.erase(pc_ws);
+               mapClients.erase(psData->m_unClientId);
+               if (mapFilters.erase(psData->m_unClientId) > 0) {
+                 --m_unFilteredClients;
+               }
+               fnUpdateWantedMask();
+
+               std::cout << "1 client disconnected (Total: " << --m_unClients
+                         << ")" << '\n';
+             }})
+        /* Client if it is served, HTML banner otherwise */
+        .get(
+          "/", /* Start with SSL */
+          [this](auto *res, auto *req) {
+            if (SendAsset(res, req, "/")) {
+              return;
             }
-
-            /* Restart Timer */
-            m_cBroadcastTimer.Start();
-
-            /* Decouple the strings so a new broadcast message can be accepted
-             * while old are sending */
-            /* Mutex block for m_mutex4BroadcastString */
-            {
-              std::lock_guard<std::mutex> guard(m_mutex4BroadcastString);
-              strBroadcastString = m_strBroadcastString;
-            }  // End of mutex block: m_mutex4BroadcastString
-
-            /* Mutex block for m_mutex4EventQueue */
-            {
-              std::lock_guard<std::mutex> guard(m_mutex4EventQueue);
-
-              if (!m_cEventQueue.empty()) {
-                strEventString = m_cEventQueue.front();
-                m_cEventQueue.pop();
-              } else {
-                strEventString = "";
-              }
-            }  // End of mutex block: m_mutex4EventQueue
-
-            /* Initialize Log string */
-            strLogString = "";
-
-            /* Mutex block for m_mutex4LogQueue */
-            {
-              std::lock_guard<std::mutex> guard(m_mutex4LogQueue);
-
-              /* If logs are not empty */
-              if (!m_cLogQueue.empty()) {
-                /* Create a temp json aggregate object */
-                nlohmann::json jsonLogObject;
-                jsonLogObject["type"] = "log";
-                /* Added Unix Epoch in milliseconds */
-                jsonLogObject["timestamp"] =
-                  std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch())
-                    .count();
-
-                /* Get all log messages in one string with \n */
-                while (!m_cLogQueue.empty()) {
-                  jsonLogObject["messages"].push_back(m_cLogQueue.front());
-                  m_cLogQueue.pop();
+            res->cork([res]() {
+              std::stringstream strStream;
+              strStream << "Reached ARGoS-Webviz server\n\n";
+              strStream << "Webviz version: ";
+              strStream << ARGOS_WEBVIZ_VERSION;
+              strStream << '\n';
+              strStream << "ARGoS3 version: ";
+              strStream << ARGOS_VERSION;
+              strStream << '\n';
+              strStream << "ARGoS3 release: ";
+              strStream << ARGOS_RELEASE;
+              strStream << '\n';
+
+              res->end(strStream.str());
+            });
+          })
+        /* Stages and gauges, for Prometheus */
+        .get(
+          "/metrics",
+          [this](auto *res, auto *req) {
+            res->cork([this, res]() {
+              res->writeHeader(
+                "Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+              res->end(m_cMetrics.Render());
+            });
+          })
+        /* Latest state, for the clients which only poll */
+        .get(
+          "/state",
+          [this](auto *res, auto *req) {
+            SendRestSnapshot(res, req, [](SRestSnapshot &s_snapshot) {
+              std::call_once(s_snapshot.m_cStateOnce, [&s_snapshot]() {
+                s_snapshot.m_strState = s_snapshot.m_cState.dump();
+              });
+              return &s_snapshot.m_strState;
+            });
+          })
+        .get(
+          "/experiment",
+          [this](auto *res, auto *req) {
+            SendRestSnapshot(res, req, [](SRestSnapshot &s_snapshot) {
+              std::call_once(s_snapshot.m_cExperimentOnce, [&s_snapshot]() {
+                nlohmann::json cExperiment;
+                for (const char *pchKey :
+                     {"steps", "state", "arena", "timestamp", "sequence"}) {
+                  if (s_snapshot.m_cState.contains(pchKey)) {
+                    cExperiment[pchKey] = s_snapshot.m_cState.at(pchKey);
+                  }
                 }
-                strLogString = jsonLogObject.dump();
-              }
-            }  // End of mutex block: m_mutex4LogQueue
-
-            std::lock_guard<std::mutex> guard(mutex4VecWebClients);
-
-            /* Send the string to each client */
-            std::for_each(
-              vecWebSocketClients.begin(),
-              vecWebSocketClients.end(),
-              [](SWebSocketClient<SSL> wsStruct) {
-                wsStruct.m_pcLoop->defer([wsStruct]() {
-                  if (!strBroadcastString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "broadcasts",
-                      strBroadcastString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
+                s_snapshot.m_strExperiment = cExperiment.dump();
+              });
+              return &s_snapshot.m_strExperiment;
+            });
+          })
+        .get(
+          "/entities/:id",
+          [this](auto *res, auto *req) {
+            std::string strId(req->getParameter(0));
+            SendRestSnapshot(
+              res,
+              req,
+              [&strId](SRestSnapshot &s_snapshot) -> const std::string * {
+                /* Read by several threads, never through operator[] */
+                const nlohmann::json &cState = s_snapshot.m_cState;
+                if (!cState.contains("entities")) {
+                  return nullptr;
+                }
+                const nlohmann::json &cEntities = cState.at("entities");
+                std::call_once(s_snapshot.m_cIndexOnce, [&]() {
+                  for (size_t i = 0; i < cEntities.size(); ++i) {
+                    if (cEntities[i].contains("id")) {
+                      s_snapshot.m_mapIndex.emplace(
+                        cEntities[i].at("id").get<std::string>(), i);
+                    }
                   }
+                });
 
-                  if (!strEventString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "events",
-                      strEventString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
-                  }
+                auto itIndex = s_snapshot.m_mapIndex.find(strId);
+                if (itIndex == s_snapshot.m_mapIndex.end()) {
+                  return nullptr;
+                }
 
-                  if (!strLogString.empty()) {
-                    wsStruct.m_pcWS->publish(
-                      "logs",
-                      strLogString,
-                      uWS::OpCode::TEXT,
-                      true);  // Compress = true
-                  }
-                });
+                std::lock_guard<std::mutex> guard(s_snapshot.m_mutex4Entities);
+                auto itEntity = s_snapshot.m_mapEntities.find(strId);
+                if (itEntity == s_snapshot.m_mapEntities.end()) {
+                  itEntity =
+                    s_snapshot.m_mapEntities
+                      .emplace(strId, cEntities[itIndex->second].dump())
+                      .first;
+                }
+                return &itEntity->second;
               });
+          })
+        /* Files of the client, after all the other routes */
+        .get(
+          "/*",
+          [this](auto *res, auto *req) {
+            if (!SendAsset(res, req, req->getUrl())) {
+              SendJSONError(res, {{"error", "not found"}}, "404 Not Found");
+            }
+          })
+        /* Start listening to Port */
+        .listen(m_unPort, [&](auto *pc_token) {
+          if (pc_token) {
+            if (un_loop == 0) {
+              LOG << "[INFO] ARGoS3-Webviz server listening on port "
+                  << m_unPort;
+              if (m_vecLoops.size() > 1) {
+                LOG << " with " << m_vecLoops.size() << " threads";
+              }
+              LOG << '\n';
+            }
+          } else {
+            throw CARGoSException(
+              "[Error] CWebServer::Start() failed to listen on "
+              "port " +
+              std::to_string(m_unPort));
+            return;
           }
         });
 
-        cMyApp.run();  // Blocking the thread
+      SLoopHandle &sLoop = m_vecLoops[un_loop];
 
-        /* Join all the threads */
-        tBroadcasterThread->join();
-      } catch (CARGoSException &ex) {
-        THROW_ARGOSEXCEPTION_NESTED("[ERROR] Error in the webserver:", ex);
+      /* Messages to a single client, from the simulation thread */
+      sLoop.m_fnSendToClient = [&](
+                                 uint64_t un_client_id,
+                                 const std::string &str_message) {
+        auto itClient = mapClients.find(un_client_id);
+        if (itClient != mapClients.end()) {
+          itClient->second->send(str_message, uWS::OpCode::TEXT, true);
+        }
+      };
+
+      /* Messages of a broadcast cycle, to the clients of this loop */
+      sLoop.m_fnPublish = [&](const SOutgoingMessages &s_messages) {
+        CScopedTimer cTimer(*m_pcPublishHistogram);
+
+        /* Broadcasts are sent client by client, to skip slow ones */
+        for (auto *pcWS : setBroadcastClients) {
+          SClientFilter *psFilter = nullptr;
+          if (!mapFilters.empty()) {
+            auto itFilter = mapFilters.find(
+              static_cast<m_sPerSocketData *>(pcWS->getUserData())
+                ->m_unClientId);
+            if (itFilter != mapFilters.end()) {
+              psFilter = &itFilter->second;
+            }
+          }
+          SendBroadcast(pcWS, s_messages, psFilter);
+        }
+
+        /* Floor patches as well, to resend the whole floor to the
+         * clients which could not keep up */
+        for (auto *pcWS : setFloorClients) {
+          SendFloor(pcWS, s_messages);
+        }
+
+        for (auto *pcWS : setPoseClients) {
+          SendPoses(pcWS, s_messages);
+        }
+
+        /* One publish per topic and per cycle, uWS delivers it to every
+         * subscriber of the topic */
+        if (!s_messages.m_strEvent.empty()) {
+          cMyApp.publish(
+            "events",
+            s_messages.m_strEvent,
+            uWS::OpCode::TEXT,
+            true);  // Compress = true
+        }
+
+        if (!s_messages.m_strLog.empty()) {
+          cMyApp.publish(
+            "logs",
+            s_messages.m_strLog,
+            uWS::OpCode::TEXT,
+            true);  // Compress = true
+        }
+
+        /* What is left for the next cycles */
+        uint64_t unBufferedBytes = 0, unMaxBufferedBytes = 0;
+        for (const auto &cClient : mapClients) {
+          uint64_t unBuffered = cClient.second->getBufferedAmount();
+          unBufferedBytes += unBuffered;
+          unMaxBufferedBytes = std::max(unMaxBufferedBytes, unBuffered);
+        }
+        sLoop.m_unBufferedBytes = unBufferedBytes;
+        sLoop.m_unMaxBufferedBytes = unMaxBufferedBytes;
+      };
+
+      /* Nothing can be sent anymore once it returns (or throws), detached
+       * before the state of this function is destroyed */
+      struct SDetach {
+        SLoopHandle &m_sLoop;
+        ~SDetach() { m_sLoop.Detach(); }
+      } sDetach{sLoop};
+
+      /* Loop of this server thread, where its publishing happens */
+      {
+        std::lock_guard<std::mutex> guard(sLoop.m_mutex4Loop);
+        sLoop.m_pcLoop = uWS::Loop::get();
       }
+
+      fn_on_listen();
+
+      cMyApp.run();  // Blocking the thread
     }
 
     /****************************************/
     /****************************************/
 
-    void CWebServer::EmitEvent(
-      std::string str_event_name, argos::Webviz::EExperimentState e_state) {
-      nlohmann::json cMyJson;
-      cMyJson["type"] = "event";
-      cMyJson["event"] = str_event_name;
-      cMyJson["state"] = argos::Webviz::EExperimentStateToStr(e_state);
+    void CWebServer::BroadcasterThreadFunction(
+      const std::atomic<bool> &b_IsServerRunning) {
+      /* Set up thread-safe buffers for this new thread */
+      LOG.AddThreadSafeBuffer();
+      LOGERR.AddThreadSafeBuffer();
 
-      // Guard the mutex which locks m_mutex4EventQueue
-      std::lock_guard<std::mutex> guard(m_mutex4EventQueue);
+      /* Start broadcast timer */
+      m_cBroadcastTimer.Start();
+
+      /* Last encoded broadcast */
+      std::shared_ptr<const SEncodedFrame> psLastFrame;
+
+      /* Index of the last full state, while some clients set a
+       * viewport or a mask */
+      std::shared_ptr<const CViewportFilter> psLastViewportFilter;
+
+      /* Last encoded whole floor */
+      std::shared_ptr<const SFloorPatch> psLastFloorImage;
+
+      /* Ids of the last poses, serialized once per version */
+      std::shared_ptr<const std::string> psLastPoseIndex;
+      uint32_t unLastPoseIndexVersion = 0;
+
+      /* Snapshot being quantized, swapped with the latest one */
+      CPoseSnapshot cPoseSnapshot;
+
+      /* Dropped log lines the clients were told about */
+      uint64_t unReportedDroppedLogs = 0;
+
+      while (b_IsServerRunning) {
+        /* stop the timer now to get total time spent */
+        m_cBroadcastTimer.Stop();
+        m_pcCycleHistogram->Observe(m_cBroadcastTimer.ElapsedMicroseconds());
+
+        /* If the elapsed time is lower than the tick length, wait */
+        if (m_cBroadcastTimer.Elapsed() < m_cBroadcastDuration) {
+          /* Sleep for the difference duration */
+          std::this_thread::sleep_for(
+            m_cBroadcastDuration - m_cBroadcastTimer.Elapsed());
+        } else {
+          LOGERR << "[WARNING] Broadcast tick took " << m_cBroadcastTimer
+                 << " milli-secs, more than the expected "
+                 << m_cBroadcastDuration.count() << " milli-secs. "
+                 << "Not able to reach all clients, Please reduce "
+                    "the \'broadcast_frequency\' in "
+                    "configuration file.\n";
+        }
+
+        /* Restart Timer */
+        m_cBroadcastTimer.Start();
+
+        /* Take the latest state out, so a new broadcast message can be
+         * accepted while this one is encoded and sent */
+        nlohmann::json cBroadcastJson;
+        std::shared_ptr<nlohmann::json> psBroadcastJson;
+        std::vector<uint64_t> vecBroadcastVersions;
+        bool bHasNewBroadcast = false;
+
+        /* Mutex block for m_mutex4BroadcastJson */
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4BroadcastJson);
+          if (m_bHasNewBroadcast) {
+            psBroadcastJson = std::move(m_psBroadcastJson);
+            vecBroadcastVersions = std::move(m_vecBroadcastVersions);
+            m_vecBroadcastVersions.clear();
+            m_bLastFrameComplete = m_bBroadcastComplete;
+            m_bHasNewBroadcast = false;
+            bHasNewBroadcast = true;
+          }
+        }  // End of mutex block: m_mutex4BroadcastJson
+
+        /* Copied only if the recorder still holds it */
+        if (psBroadcastJson) {
+          if (psBroadcastJson.use_count() == 1) {
+            cBroadcastJson = std::move(*psBroadcastJson);
+          } else {
+            cBroadcastJson = *psBroadcastJson;
+          }
+          psBroadcastJson.reset();
+        }
+
+        /* Pull a fresh state for the next cycle */
+        m_bBroadcastWanted = true;
+
+        /* Everything to publish in this cycle, handed over to the loop */
+        auto psMessages = std::make_shared<SOutgoingMessages>();
+
+        /* Encode as a keyframe or a delta against the last sent state */
+        bool bKeyframe = false;
+        if (bHasNewBroadcast) {
+          /* Filtered clients need the full state as well */
+          nlohmann::json cFullState;
+          if (m_unFilteredClients > 0) {
+            cFullState = cBroadcastJson;
+          }
+
+          nlohmann::json cFrame;
+          {
+            CScopedTimer cTimer(*m_pcDeltaHistogram);
+            cFrame = m_cDeltaEncoder.Encode(
+              std::move(cBroadcastJson), vecBroadcastVersions);
+          }
+          bKeyframe = cFrame.value("keyframe", true);
+          if (bKeyframe) {
+            cFrame["session"] = m_strSession;
+          }
+
+          /* Kept with its encodings, for the REST routes */
+          auto psFrameJSON =
+            std::make_shared<const nlohmann::json>(std::move(cFrame));
+
+          if (m_unFilteredClients > 0) {
+            psLastViewportFilter = std::make_shared<CViewportFilter>(
+              std::move(cFullState), psFrameJSON->value("sequence", 0ull));
+            psMessages->m_psFrameJSON = psFrameJSON;
+            psMessages->m_psViewportFilter = psLastViewportFilter;
+          }
+
+          auto psFrame =
+            std::make_shared<SEncodedFrame>(EncodeFrame(*psFrameJSON));
+          psFrame->m_psJSON = std::move(psFrameJSON);
+          psFrame->m_bComplete = m_bLastFrameComplete;
+          psMessages->m_psFrame = std::move(psFrame);
+          psLastFrame = psMessages->m_psFrame;
+        }
+
+        /* Filtered per client in the loop */
+        if (m_unFilteredClients == 0) {
+          psLastViewportFilter.reset();
+        } else if (m_unClientsNeedingKeyframe > 0) {
+          psMessages->m_psViewportFilter = psLastViewportFilter;
+        }
+
+        /* Clients which skipped broadcasts (or just connected) need a
+         * keyframe, encoded once for all of them */
+        if (m_unClientsNeedingKeyframe > 0) {
+          if (bKeyframe) {
+            psMessages->m_psKeyframe = psMessages->m_psFrame;
+          } else {
+            psMessages->m_psKeyframe = MakeKeyframe();
+            if (!psMessages->m_psKeyframe) {
+              /* Without deltas, the last frame is a keyframe */
+              psMessages->m_psKeyframe = psLastFrame;
+            }
+          }
+        }
+
+        /* Before the loops get this cycle, so a client reading the cache
+         * misses nothing */
+        if (bHasNewBroadcast) {
+          m_cResumeCache.Add(
+            psMessages->m_psFrame,
+            bKeyframe,
+            psMessages->m_psKeyframe,
+            [this]() { return MakeKeyframe(); });
+        }
+
+        /* Take the floor updates out, they are encoded without the lock */
+        std::vector<SFloorUpdate> vecFloorUpdates;
+        std::shared_ptr<const CFloorTexture::SImage> psFloorImage;
+
+        /* Mutex block for m_mutex4Floor */
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4Floor);
+          vecFloorUpdates.swap(m_vecFloorUpdates);
+          psFloorImage = m_psFloorImage;
+        }  // End of mutex block: m_mutex4Floor
+
+        for (const auto &sUpdate : vecFloorUpdates) {
+          for (const auto &sRect : sUpdate.m_vecDirty) {
+            SFloorPatch sPatch{sUpdate.m_psImage->m_unVersion, ""};
+            if (CFloorTexture::EncodePatch(
+                  *sUpdate.m_psImage, sRect, &sPatch.m_strData)) {
+              psMessages->m_vecFloorPatches.push_back(std::move(sPatch));
+            }
+          }
+        }
+
+        /* Whole floor for new (or congested) clients, encoded once per
+         * version */
+        if (m_unClientsNeedingFloor > 0 && psFloorImage) {
+          if (
+            !psLastFloorImage ||
+            psLastFloorImage->m_unVersion != psFloorImage->m_unVersion) {
+            auto psPatch = std::make_shared<SFloorPatch>();
+            psPatch->m_unVersion = psFloorImage->m_unVersion;
+            if (CFloorTexture::EncodePatch(
+                  *psFloorImage,
+                  {0, 0, psFloorImage->m_unWidth, psFloorImage->m_unHeight},
+                  &psPatch->m_strData)) {
+              psLastFloorImage = std::move(psPatch);
+            }
+          }
+          psMessages->m_psFloorImage = psLastFloorImage;
+        }
+
+        /* Take the latest poses out, they are quantized without the lock */
+        bool bHasNewPoses = false;
+
+        /* Mutex block for m_mutex4Poses */
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4Poses);
+          if (m_bHasNewPoses) {
+            std::swap(cPoseSnapshot, m_cPoseSnapshot);
+            m_bHasNewPoses = false;
+            bHasNewPoses = true;
+          }
+        }  // End of mutex block: m_mutex4Poses
+
+        if (bHasNewPoses) {
+          cPoseSnapshot.Encode(&psMessages->m_strPoses);
+
+          const auto &psIndex = cPoseSnapshot.GetIndex();
+          if (
+            psIndex &&
+            (!psLastPoseIndex ||
+             psIndex->m_unVersion != unLastPoseIndexVersion)) {
+            nlohmann::json cIndex;
+            cIndex["type"] = "poses_index";
+            cIndex["index_version"] = psIndex->m_unVersion;
+            cIndex["ids"] = psIndex->m_vecIds;
+            psLastPoseIndex = std::make_shared<std::string>(cIndex.dump());
+            unLastPoseIndexVersion = psIndex->m_unVersion;
+          }
+          psMessages->m_psPoseIndex = psLastPoseIndex;
+          psMessages->m_unPoseIndexVersion = unLastPoseIndexVersion;
+        }
+
+        /* Take all the events out, they are serialized without the lock */
+        std::vector<nlohmann::json> vecEvents;
+
+        /* Mutex block for m_mutex4EventQueue */
+        {
+          std::lock_guard<std::mutex> guard(m_mutex4EventQueue);
+          vecEvents.swap(m_vecEvents);
+        }  // End of mutex block: m_mutex4EventQueue
+
+        if (!vecEvents.empty()) {
+          /* The events of this cycle are published after its frame, tag
+           * them with the last one sent so clients can order both */
+          uint64_t unSequence = m_cDeltaEncoder.GetSequence();
+          nlohmann::json cEvents = nlohmann::json::array();
+          for (auto &cEvent : vecEvents) {
+            cEvent["sequence"] = unSequence;
+            cEvents.push_back(std::move(cEvent));
+          }
+
+          nlohmann::json jsonEventObject;
+          jsonEventObject["type"] = "event";
+          /* Added Unix Epoch in milliseconds */
+          jsonEventObject["timestamp"] =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+          jsonEventObject["events"] = std::move(cEvents);
+          psMessages->m_strEvent = jsonEventObject.dump();
+        }
 
-      /* Add to the event queue */
-      m_cEventQueue.push(cMyJson.dump());
+        /* Lines written since the last cycle, escaped and serialized here
+         * rather than by the threads which wrote them */
+        CTimer cLogTimer;
+        cLogTimer.Start();
+        nlohmann::json cLogMessages = nlohmann::json::array();
+        CLogRing::SLine sLine;
+        while (m_pcLogRing->Pop(sLine)) {
+          if (!sLine.m_bEscaped) {
+            CLogStream::Escape(sLine.m_strText);
+          }
+          cLogMessages.push_back(
+            {{"log_type", sLine.m_bError ? "LOGERR" : "LOG"},
+             {"log_message", std::move(sLine.m_strText)},
+             {"step", sLine.m_unSteps}});
+        }
+
+        /* Tell the clients some lines are missing */
+        uint64_t unDroppedLogs = m_pcLogRing->GetDropped();
+        if (unDroppedLogs > unReportedDroppedLogs) {
+          cLogMessages.push_back(
+            {{"log_type", "LOGERR"},
+             {"log_message",
+              "[WARNING] " +
+                std::to_string(unDroppedLogs - unReportedDroppedLogs) +
+                " log lines dropped"},
+             {"step", m_fnGetSteps ? m_fnGetSteps() : 0}});
+          unReportedDroppedLogs = unDroppedLogs;
+        }
+
+        if (!cLogMessages.empty()) {
+          /* Create a temp json aggregate object */
+          nlohmann::json jsonLogObject;
+          jsonLogObject["type"] = "log";
+          /* Added Unix Epoch in milliseconds */
+          jsonLogObject["timestamp"] =
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count();
+          jsonLogObject["messages"] = std::move(cLogMessages);
+          psMessages->m_strLog = jsonLogObject.dump();
+          m_pcLogHistogram->Observe(cLogTimer.ElapsedMicroseconds());
+        }
+
+        if (psMessages->IsEmpty()) {
+          continue;
+        }
+
+        /* Encoded once, each server thread sends it to its clients */
+        for (auto &sLoop : m_vecLoops) {
+          sLoop.Defer([&sLoop, psMessages]() {
+            /* Empty if the loop stopped meanwhile */
+            if (sLoop.m_fnPublish) {
+              sLoop.m_fnPublish(*psMessages);
+            }
+          });
+        }
+      }
     }
 
     /****************************************/
     /****************************************/
 
-    void CWebServer::EmitLog(
-      const std::string &str_log_name, const std::string &str_log_data) {
-      /* if message is not empty */
-      if (!str_log_data.empty()) {
-        /* Build json object */
-        nlohmann::json cMyJson;
-        cMyJson["log_type"] = str_log_name;
-        cMyJson["log_message"] = str_log_data;
-        cMyJson["step"] =
-          CSimulator::GetInstance().GetSpace().GetSimulationClock();
+    template <bool SSL>
+    void CWebServer::Subscribe(
+      uWS::WebSocket<SSL, true> *pc_ws, const std::string &str_topic) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      /* Broadcasts are sent to each client by SendBroadcast, they are not
+       * uWS topics. Count each format once per client */
+      if (str_topic == "broadcasts") {
+        if (!psData->m_bBroadcastJSON) {
+          psData->m_bBroadcastJSON = true;
+          ++m_unJSONSubscribers;
+        }
+      } else if (str_topic == "broadcasts.msgpack") {
+        if (!psData->m_bBroadcastMsgPack) {
+          psData->m_bBroadcastMsgPack = true;
+          ++m_unMsgPackSubscribers;
+        }
+      } else if (str_topic == "broadcasts.cbor") {
+        if (!psData->m_bBroadcastCBOR) {
+          psData->m_bBroadcastCBOR = true;
+          ++m_unCBORSubscribers;
+        }
+      } else if (str_topic == "broadcasts.deflate") {
+        if (!psData->m_bBroadcastDeflate) {
+          psData->m_bBroadcastDeflate = true;
+          ++m_unDeflateSubscribers;
+        }
+      } else if (str_topic == "floor") {
+        /* Sent to each client by SendFloor */
+        psData->m_bFloor = true;
+      } else if (str_topic == "poses") {
+        /* Sent to each client by SendPoses */
+        if (!psData->m_bPoses) {
+          psData->m_bPoses = true;
+          ++m_unPoseSubscribers;
+        }
+      } else {
+        pc_ws->subscribe(str_topic);
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CWebServer::SEncodedFrame CWebServer::EncodeFrame(
+      const nlohmann::json &c_frame) {
+      /* Serialize only in the formats somebody subscribed to */
+      return EncodeFrame(
+        c_frame,
+        m_unJSONSubscribers > 0,
+        m_unMsgPackSubscribers > 0,
+        m_unCBORSubscribers > 0,
+        m_unDeflateSubscribers > 0);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    std::shared_ptr<const CWebServer::SEncodedFrame>
+    CWebServer::MakeKeyframe() {
+      auto psKeyframe =
+        std::make_shared<nlohmann::json>(m_cDeltaEncoder.GetKeyframe());
+      if (psKeyframe->is_null()) {
+        return nullptr;
+      }
+      (*psKeyframe)["session"] = m_strSession;
+
+      auto psFrame = std::make_shared<SEncodedFrame>(EncodeFrame(*psKeyframe));
+      psFrame->m_psJSON = std::move(psKeyframe);
+      psFrame->m_bComplete = m_bLastFrameComplete;
+      return psFrame;
+    }
+
+    /****************************************/
+    /****************************************/
 
-        // Guard the mutex which locks m_mutex4LogQueue
-        std::lock_guard<std::mutex> guard(m_mutex4LogQueue);
+    CWebServer::SEncodedFrame CWebServer::EncodeFrame(
+      const nlohmann::json &c_frame,
+      bool b_json,
+      bool b_msgpack,
+      bool b_cbor,
+      bool b_deflate) {
+      SEncodedFrame sFrame;
+      sFrame.m_unSequence = c_frame.value("sequence", 0ull);
+      CTimer cTimer;
+
+      cTimer.Start();
+      if (b_json || b_deflate) {
+        sFrame.m_strJSON = c_frame.dump();
+      }
+      cTimer.Stop();
+      std::chrono::microseconds cSerializeTime = cTimer.ElapsedMicroseconds();
+
+      /* Compressed once, and sent as it is to every subscriber */
+      if (b_deflate) {
+        CScopedTimer cCompressTimer(*m_pcCompressHistogram);
+        CDeflate::Compress(sFrame.m_strJSON, &sFrame.m_strDeflate);
+      }
+      if (!b_json) {
+        sFrame.m_strJSON.clear();
+      }
 
-        /* Add to the Log queue */
-        m_cLogQueue.push(cMyJson);
+      cTimer.Start();
+      if (b_msgpack) {
+        nlohmann::json::to_msgpack(c_frame, sFrame.m_strMsgPack);
       }
+      if (b_cbor) {
+        nlohmann::json::to_cbor(c_frame, sFrame.m_strCBOR);
+      }
+      cTimer.Stop();
+      if (b_json || b_deflate || b_msgpack || b_cbor) {
+        m_pcSerializeHistogram->Observe(
+          cSerializeTime + cTimer.ElapsedMicroseconds());
+      }
+      return sFrame;
     }
 
     /****************************************/
     /****************************************/
 
-    void CWebServer::Broadcast(nlohmann::json cMyJson) {
-      /* Guard the mutex which locks m_mutex4BroadcastString */
-      std::lock_guard<std::mutex> guard(m_mutex4BroadcastString);
-      /* Replaces the existing state, even if it was not sent
-       * This enables us to discard stale experiment state
-       */
-      m_strBroadcastString = cMyJson.dump();
+    void CWebServer::SetNeedsKeyframe(
+      m_sPerSocketData *ps_data, bool b_needs_keyframe) {
+      if (ps_data->m_bNeedsKeyframe != b_needs_keyframe) {
+        ps_data->m_bNeedsKeyframe = b_needs_keyframe;
+        if (b_needs_keyframe) {
+          ++m_unClientsNeedingKeyframe;
+        } else {
+          --m_unClientsNeedingKeyframe;
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    bool CWebServer::GetResumeFrames(
+      const std::string &str_resume,
+      const m_sPerSocketData &s_data,
+      std::vector<std::shared_ptr<const SEncodedFrame>> *vec_frames,
+      uint64_t *un_last_sequence) {
+      /* Sequences of another session are unrelated */
+      uint64_t unSequence = 0;
+      size_t unDot = str_resume.rfind('.');
+      bool bResume = unDot != std::string::npos &&
+                     str_resume.compare(0, unDot, m_strSession) == 0;
+      if (bResume) {
+        unSequence = std::strtoull(str_resume.c_str() + unDot + 1, nullptr, 10);
+      }
+
+      bool bResumed = false;
+      if (!m_cResumeCache.Get(
+            bResume, unSequence, vec_frames, un_last_sequence, &bResumed)) {
+        return false;
+      }
+
+      /* Encoded before somebody subscribed to its formats */
+      for (const auto &psFrame : *vec_frames) {
+        if (
+          (s_data.m_bBroadcastJSON && psFrame->m_strJSON.empty()) ||
+          (s_data.m_bBroadcastMsgPack && psFrame->m_strMsgPack.empty()) ||
+          (s_data.m_bBroadcastCBOR && psFrame->m_strCBOR.empty()) ||
+          (s_data.m_bBroadcastDeflate && psFrame->m_strDeflate.empty())) {
+          return false;
+        }
+      }
+
+      if (bResumed) {
+        ++m_unResumes;
+      } else {
+        ++m_unCachedJoins;
+      }
+      return true;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    bool CWebServer::SendResumeFrames(
+      uWS::WebSocket<SSL, true> *pc_ws, const std::string &str_resume) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      std::vector<std::shared_ptr<const SEncodedFrame>> vecFrames;
+      uint64_t unLastSequence = 0;
+      if (!GetResumeFrames(str_resume, *psData, &vecFrames, &unLastSequence)) {
+        return false;
+      }
+
+      for (const auto &psFrame : vecFrames) {
+        SendFrame(pc_ws, *psFrame);
+      }
+      psData->m_unLastSequence = unLastSequence;
+      return true;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendBroadcast(
+      uWS::WebSocket<SSL, true> *pc_ws,
+      const SOutgoingMessages &s_messages,
+      SClientFilter *ps_filter) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      /* Clients with a viewport or a mask get frames filtered for them */
+      bool bHasFrame, bHasKeyframe;
+      if (ps_filter != nullptr) {
+        bHasKeyframe = s_messages.m_psViewportFilter != nullptr;
+        bHasFrame = bHasKeyframe && s_messages.m_psFrameJSON;
+      } else {
+        bHasFrame = s_messages.m_psFrame != nullptr;
+        bHasKeyframe = s_messages.m_psKeyframe != nullptr;
+      }
+
+      /* Nothing new for this client */
+      if (!bHasFrame && !(psData->m_bNeedsKeyframe && bHasKeyframe)) {
+        return;
+      }
+
+      /* Already sent from the resume cache, when it connected */
+      if (ps_filter == nullptr) {
+        const SEncodedFrame &sFrame = psData->m_bNeedsKeyframe && bHasKeyframe
+                                        ? *s_messages.m_psKeyframe
+                                        : *s_messages.m_psFrame;
+        if (sFrame.m_unSequence <= psData->m_unLastSequence) {
+          SetNeedsKeyframe(psData, false);
+          return;
+        }
+      }
+
+      /* Congested, do not queue more, and slow down this client */
+      unsigned int unBuffered = pc_ws->getBufferedAmount();
+      if (unBuffered > MAX_BUFFERED_AMOUNT) {
+        psData->m_unSendEvery =
+          std::min(psData->m_unSendEvery * 2, MAX_SEND_EVERY);
+        psData->m_unCyclesSinceSent = 0;
+        SetNeedsKeyframe(psData, true);
+        ++m_unDroppedFrames;
+        return;
+      }
+
+      /* Reduced rate */
+      if (++psData->m_unCyclesSinceSent < psData->m_unSendEvery) {
+        if (bHasFrame) {
+          SetNeedsKeyframe(psData, true);
+          ++m_unDroppedFrames;
+        }
+        return;
+      }
+
+      /* Latest state only: a keyframe after skipped frames, never what was
+       * skipped */
+      if (psData->m_bNeedsKeyframe && !bHasKeyframe) {
+        return;
+      }
+
+      if (ps_filter != nullptr) {
+        SendFilteredFrame(
+          pc_ws, s_messages, *ps_filter, psData->m_bNeedsKeyframe);
+      } else if (psData->m_bNeedsKeyframe) {
+        SendFrame(pc_ws, *s_messages.m_psKeyframe);
+        psData->m_unLastSequence = s_messages.m_psKeyframe->m_unSequence;
+      } else {
+        SendFrame(pc_ws, *s_messages.m_psFrame);
+        psData->m_unLastSequence = s_messages.m_psFrame->m_unSequence;
+      }
+      psData->m_unCyclesSinceSent = 0;
+      SetNeedsKeyframe(psData, false);
+
+      /* Buffer drained, progressively restore the full rate */
+      if (unBuffered == 0 && psData->m_unSendEvery > 1) {
+        --psData->m_unSendEvery;
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendFilteredFrame(
+      uWS::WebSocket<SSL, true> *pc_ws,
+      const SOutgoingMessages &s_messages,
+      SClientFilter &s_filter,
+      bool b_keyframe) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      const CViewportFilter &cFilter = *s_messages.m_psViewportFilter;
+
+      /* Grid query, only the visible entities are copied */
+      CViewportFilter::TVisibleSet setVisible =
+        s_filter.m_bHasViewport ? cFilter.Query(s_filter.m_sRect)
+                                : cFilter.GetAll();
+
+      /* Types are looked up in the full state, deltas may not have them */
+      if (!s_filter.m_cMask.WantsAllTypes()) {
+        for (auto it = setVisible.begin(); it != setVisible.end();) {
+          const nlohmann::json *pcEntity = cFilter.Find(*it);
+          if (
+            pcEntity != nullptr &&
+            s_filter.m_cMask.WantsType(pcEntity->value("type", ""))) {
+            ++it;
+          } else {
+            it = setVisible.erase(it);
+          }
+        }
+      }
+
+      nlohmann::json cFrame;
+      if (b_keyframe) {
+        cFrame = cFilter.MakeKeyframe(setVisible);
+      } else {
+        cFrame = cFilter.MakeDelta(
+          *s_messages.m_psFrameJSON, setVisible, s_filter.m_setVisible);
+      }
+      s_filter.m_setVisible = std::move(setVisible);
+
+      ApplyRayLOD(cFrame, cFilter, s_filter, b_keyframe);
+
+      if (!s_filter.m_cMask.WantsAllFields()) {
+        for (auto &cEntity : cFrame["entities"]) {
+          s_filter.m_cMask.ApplyFields(cEntity);
+        }
+      }
+
+      SendFrame(
+        pc_ws,
+        EncodeFrame(
+          cFrame,
+          psData->m_bBroadcastJSON,
+          psData->m_bBroadcastMsgPack,
+          psData->m_bBroadcastCBOR,
+          psData->m_bBroadcastDeflate));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    nlohmann::json CWebServer::SetClientFilter(
+      uWS::WebSocket<SSL, true> *pc_ws,
+      const nlohmann::json &c_command,
+      std::unordered_map<uint64_t, SClientFilter> &map_filters) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+      std::string strCmd = c_command.value("command", "");
+
+      nlohmann::json cAck;
+      cAck["type"] = "ack";
+      cAck["command"] = strCmd;
+      cAck["ok"] = true;
+      if (c_command.contains("id")) {
+        cAck["id"] = c_command["id"];
+      }
+
+      /* Starts from the current filter, each command changes its part */
+      SClientFilter sFilter;
+      auto itFilter = map_filters.find(psData->m_unClientId);
+      if (itFilter != map_filters.end()) {
+        sFilter = itFilter->second;
+      }
+
+      try {
+        if (strCmd == "setViewport") {
+          /* No viewport (or null), back to the whole arena */
+          auto itViewport = c_command.find("viewport");
+          if (itViewport == c_command.end() || itViewport->is_null()) {
+            sFilter.m_bHasViewport = false;
+          } else {
+            const nlohmann::json &cMin = itViewport->at("min");
+            const nlohmann::json &cMax = itViewport->at("max");
+            sFilter.m_sRect = CViewportFilter::SRect{
+              cMin.at("x").get<double>(),
+              cMin.at("y").get<double>(),
+              cMax.at("x").get<double>(),
+              cMax.at("y").get<double>()};
+            sFilter.m_bHasViewport = true;
+          }
+        } else if (strCmd == "setRays") {
+          /* Only the given settings change */
+          sFilter.m_cRays.Update(c_command);
+        } else {
+          /* "setFilter", without lists back to everything */
+          sFilter.m_cMask = CBroadcastMask::FromJSON(c_command);
+        }
+      } catch (const std::exception &e) {
+        cAck["ok"] = false;
+        cAck["error"] = e.what();
+        return cAck;
+      }
+
+      /* Restarts from a keyframe of what it wants now */
+      StoreClientFilter(psData, std::move(sFilter), map_filters);
+      return cAck;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::StoreClientFilter(
+      m_sPerSocketData *ps_data,
+      SClientFilter s_filter,
+      std::unordered_map<uint64_t, SClientFilter> &map_filters) {
+      auto itFilter = map_filters.find(ps_data->m_unClientId);
+
+      if (s_filter.IsEmpty()) {
+        if (itFilter != map_filters.end()) {
+          map_filters.erase(itFilter);
+          --m_unFilteredClients;
+        }
+      } else if (itFilter != map_filters.end()) {
+        itFilter->second = std::move(s_filter);
+      } else {
+        map_filters.emplace(ps_data->m_unClientId, std::move(s_filter));
+        /* First filter, make sure there is a full state to filter */
+        if (m_unFilteredClients++ == 0) {
+          RequestKeyframe();
+        }
+      }
+
+      SetNeedsKeyframe(ps_data, true);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::ApplyRayLOD(
+      nlohmann::json &c_frame,
+      const CViewportFilter &c_filter,
+      const SClientFilter &s_filter,
+      bool b_keyframe) {
+      const CRayLOD &cLOD = s_filter.m_cRays;
+      if (
+        cLOD.IsFull() || !(s_filter.m_cMask.WantsField("rays") ||
+                           s_filter.m_cMask.WantsField("points"))) {
+        return;
+      }
+
+      bool bRayFrame =
+        b_keyframe || cLOD.IsRayFrame(c_frame.value("sequence", 0ull));
+      /* Rays were already subsampled by the serializers */
+      uint32_t unDecimate = std::max<uint32_t>(
+        1, cLOD.GetEveryRay() / m_cWantedRayLOD.GetEveryRay());
+      /* Rays may have changed in the frames skipped for this client */
+      bool bCopyFromState = !b_keyframe && cLOD.GetEveryFrame() > 1;
+
+      auto fnCopyRays = [&](
+                          nlohmann::json &c_entity, const std::string &str_id) {
+        const nlohmann::json *pcEntity = c_filter.Find(str_id);
+        if (pcEntity == nullptr) {
+          return;
+        }
+        for (const char *pchField : {"rays", "points"}) {
+          auto itField = pcEntity->find(pchField);
+          if (itField != pcEntity->end()) {
+            c_entity[pchField] = *itField;
+          }
+        }
+      };
+
+      auto fnDecimate = [&](nlohmann::json &c_entity) {
+        auto itRays = c_entity.find("rays");
+        if (itRays != c_entity.end()) {
+          CRayLOD::Decimate(*itRays, CEntityEncoding::RAY_STRIDE, unDecimate);
+        }
+        auto itPoints = c_entity.find("points");
+        if (itPoints != c_entity.end()) {
+          CRayLOD::Decimate(*itPoints, 3, unDecimate);
+        }
+      };
+
+      nlohmann::json &cEntities = c_frame["entities"];
+      std::unordered_set<std::string> setWithRays;
+      for (auto &cEntity : cEntities) {
+        std::string strId = cEntity.value("id", "");
+        if (!bRayFrame || !cLOD.WantsRaysOf(strId)) {
+          /* The client keeps the rays it has between two ray frames */
+          cEntity.erase("rays");
+          cEntity.erase("points");
+          continue;
+        }
+        if (bCopyFromState) {
+          fnCopyRays(cEntity, strId);
+        }
+        fnDecimate(cEntity);
+        setWithRays.insert(std::move(strId));
+      }
+
+      /* Entities which are not in the delta, but whose rays changed in the
+       * skipped frames */
+      if (bRayFrame && bCopyFromState) {
+        for (const auto &strId : s_filter.m_setVisible) {
+          if (setWithRays.count(strId) > 0 || !cLOD.WantsRaysOf(strId)) {
+            continue;
+          }
+          nlohmann::json cEntity = {{"id", strId}};
+          fnCopyRays(cEntity, strId);
+          if (cEntity.size() > 1) {
+            fnDecimate(cEntity);
+            cEntities.push_back(std::move(cEntity));
+          }
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetWantedMask(
+      size_t un_loop, const SLoopWanted &s_wanted) {
+      std::lock_guard<std::mutex> guard(m_mutex4WantedMask);
+      m_vecLoops[un_loop].m_sWanted = s_wanted;
+
+      /* Everything, until some broadcast clients are connected */
+      CBroadcastMask cMask;
+      CRayLOD cRays;
+      bool bBroadcastClients = false;
+      bool bFloorClients = false;
+      for (const auto &sLoop : m_vecLoops) {
+        bFloorClients = bFloorClients || sLoop.m_sWanted.m_bFloorClients;
+        if (!sLoop.m_sWanted.m_bBroadcastClients) {
+          continue;
+        }
+        if (!bBroadcastClients) {
+          cMask = CBroadcastMask::None();
+          cRays = CRayLOD::None();
+          bBroadcastClients = true;
+        }
+        cMask.Merge(sLoop.m_sWanted.m_cMask);
+        cRays.Merge(sLoop.m_sWanted.m_cRays);
+      }
+
+      /* The floor is rendered by its entity, for the "floor" topic */
+      if (bBroadcastClients && bFloorClients) {
+        CBroadcastMask cFloor = CBroadcastMask::None();
+        cFloor.AddType("floor");
+        cMask.Merge(cFloor);
+      }
+
+      if (m_cWantedMask != cMask || m_cWantedRayLOD != cRays) {
+        m_cWantedMask = cMask;
+        m_cWantedRayLOD = cRays;
+        /* The last state misses what is wanted now */
+        RequestKeyframe();
+        m_cResumeCache.Invalidate();
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CBroadcastMask CWebServer::GetWantedMask() {
+      /* Some REST poller needs what no websocket client wants */
+      if (m_cRestPolling.IsRequired()) {
+        return CBroadcastMask();
+      }
+      std::lock_guard<std::mutex> guard(m_mutex4WantedMask);
+      return m_cWantedMask;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    CRayLOD CWebServer::GetWantedRayLOD() {
+      if (m_cRestPolling.IsRequired()) {
+        return CRayLOD();
+      }
+      std::lock_guard<std::mutex> guard(m_mutex4WantedMask);
+      return m_cWantedRayLOD;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetNeedsFloor(
+      m_sPerSocketData *ps_data, bool b_needs_floor) {
+      if (ps_data->m_bNeedsFloor != b_needs_floor) {
+        ps_data->m_bNeedsFloor = b_needs_floor;
+        if (b_needs_floor) {
+          ++m_unClientsNeedingFloor;
+        } else {
+          --m_unClientsNeedingFloor;
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendFloor(
+      uWS::WebSocket<SSL, true> *pc_ws, const SOutgoingMessages &s_messages) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      /* Nothing new for this client */
+      if (
+        s_messages.m_vecFloorPatches.empty() &&
+        !(psData->m_bNeedsFloor && s_messages.m_psFloorImage)) {
+        return;
+      }
+
+      /* Congested, patches would pile up, send the whole floor later */
+      if (pc_ws->getBufferedAmount() > MAX_BUFFERED_AMOUNT) {
+        SetNeedsFloor(psData, true);
+        return;
+      }
+
+      if (psData->m_bNeedsFloor) {
+        /* Patches can not be applied without the whole floor */
+        if (!s_messages.m_psFloorImage) {
+          return;
+        }
+        /* Already compressed (PNG) */
+        pc_ws->send(
+          s_messages.m_psFloorImage->m_strData, uWS::OpCode::BINARY, false);
+        psData->m_unFloorVersion = s_messages.m_psFloorImage->m_unVersion;
+        SetNeedsFloor(psData, false);
+      }
+
+      /* Patches of versions the client does not have yet */
+      for (const auto &sPatch : s_messages.m_vecFloorPatches) {
+        if (sPatch.m_unVersion > psData->m_unFloorVersion) {
+          pc_ws->send(sPatch.m_strData, uWS::OpCode::BINARY, false);
+          psData->m_unFloorVersion = sPatch.m_unVersion;
+        }
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendPoses(
+      uWS::WebSocket<SSL, true> *pc_ws, const SOutgoingMessages &s_messages) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      if (s_messages.m_strPoses.empty()) {
+        return;
+      }
+
+      /* Congested, the next snapshot replaces this one anyway */
+      if (pc_ws->getBufferedAmount() > MAX_BUFFERED_AMOUNT) {
+        ++m_unDroppedFrames;
+        return;
+      }
+
+      /* The poses can not be read without their ids */
+      if (
+        s_messages.m_psPoseIndex &&
+        psData->m_unPoseIndexVersion != s_messages.m_unPoseIndexVersion) {
+        pc_ws->send(*s_messages.m_psPoseIndex, uWS::OpCode::TEXT, true);
+        psData->m_unPoseIndexVersion = s_messages.m_unPoseIndexVersion;
+      }
+
+      /* Already quantized, hardly compressible */
+      pc_ws->send(s_messages.m_strPoses, uWS::OpCode::BINARY, false);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendFrame(
+      uWS::WebSocket<SSL, true> *pc_ws, const SEncodedFrame &s_frame) {
+      auto *psData = static_cast<m_sPerSocketData *>(pc_ws->getUserData());
+
+      /* Shared by all the clients, never compressed again per connection
+       * (permessage-deflate would cost as much CPU as there are clients),
+       * "broadcasts.deflate" is compressed once for all of them */
+      if (psData->m_bBroadcastJSON && !s_frame.m_strJSON.empty()) {
+        pc_ws->send(s_frame.m_strJSON, uWS::OpCode::TEXT, false);
+      }
+      if (psData->m_bBroadcastMsgPack && !s_frame.m_strMsgPack.empty()) {
+        pc_ws->send(s_frame.m_strMsgPack, uWS::OpCode::BINARY, false);
+      }
+      if (psData->m_bBroadcastCBOR && !s_frame.m_strCBOR.empty()) {
+        pc_ws->send(s_frame.m_strCBOR, uWS::OpCode::BINARY, false);
+      }
+      if (psData->m_bBroadcastDeflate && !s_frame.m_strDeflate.empty()) {
+        /* Already compressed */
+        pc_ws->send(s_frame.m_strDeflate, uWS::OpCode::BINARY, false);
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::EmitEvent(
+      std::string str_event_name, argos::Webviz::EExperimentState e_state) {
+      nlohmann::json cMyJson;
+      cMyJson["event"] = str_event_name;
+      cMyJson["state"] = argos::Webviz::EExperimentStateToStr(e_state);
+
+      EmitEvent(std::move(cMyJson));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::EmitEvent(nlohmann::json c_event) {
+      /* Step of the experiment when it happened, unless it comes with
+       * one (from another webserver) */
+      if (!c_event.contains("step")) {
+        c_event["step"] = m_fnGetSteps ? m_fnGetSteps() : 0;
+      }
+
+      // Guard the mutex which locks m_mutex4EventQueue
+      std::lock_guard<std::mutex> guard(m_mutex4EventQueue);
+
+      /* Add to the event queue, sent with the next broadcast */
+      m_vecEvents.push_back(std::move(c_event));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::EmitLog(
+      const std::string &str_log_name, std::string str_log_data) {
+      /* if message is not empty */
+      if (!str_log_data.empty()) {
+        CLogRing::SLine sLine;
+        sLine.m_bError = str_log_name == "LOGERR";
+        sLine.m_unSteps = m_fnGetSteps ? m_fnGetSteps() : 0;
+        sLine.m_strText = std::move(str_log_data);
+
+        /* Dropped if the ring is full */
+        m_pcLogRing->Push(std::move(sLine));
+      }
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::EmitLog(nlohmann::json c_entry) {
+      CLogRing::SLine sLine;
+      sLine.m_bError = c_entry.value("log_type", "") == "LOGERR";
+      /* Escaped by the webserver which sent it */
+      sLine.m_bEscaped = true;
+      sLine.m_unSteps = c_entry.value("step", 0ull);
+      sLine.m_strText = c_entry.value("log_message", "");
+
+      m_pcLogRing->Push(std::move(sLine));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::Broadcast(
+      nlohmann::json cMyJson,
+      std::vector<uint64_t> vec_user_data_versions,
+      bool b_complete) {
+      Broadcast(
+        std::make_shared<nlohmann::json>(std::move(cMyJson)),
+        std::move(vec_user_data_versions),
+        b_complete);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::Broadcast(
+      std::shared_ptr<nlohmann::json> ps_json,
+      std::vector<uint64_t> vec_user_data_versions,
+      bool b_complete) {
+      /* Guard the mutex which locks m_mutex4BroadcastJson */
+      std::lock_guard<std::mutex> guard(m_mutex4BroadcastJson);
+      /* Replaces the existing state, even if it was not sent
+       * This enables us to discard stale experiment state, deltas are
+       * computed against what was actually sent
+       */
+      m_psBroadcastJson = std::move(ps_json);
+      m_vecBroadcastVersions = std::move(vec_user_data_versions);
+      m_bBroadcastComplete = b_complete;
+      m_bHasNewBroadcast = true;
+      m_bBroadcastWanted = false;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    bool CWebServer::IsBroadcastWanted() const { return m_bBroadcastWanted; }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SendToClient(
+      uint64_t un_client_id, std::string str_message) {
+      /* Ids tell the loop of the client */
+      SLoopHandle &sLoop = m_vecLoops[un_client_id % m_vecLoops.size()];
+      /* Sockets can only be used from their loop thread */
+      sLoop.Defer(
+        [&sLoop, un_client_id, strMessage = std::move(str_message)]() {
+          if (sLoop.m_fnSendToClient) {
+            sLoop.m_fnSendToClient(un_client_id, strMessage);
+          }
+        });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::SetServerThreads(unsigned short un_threads) {
+      m_vecLoops = std::vector<SLoopHandle>(std::max<size_t>(1, un_threads));
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::RequestKeyframe() { m_cDeltaEncoder.RequestKeyframe(); }
+
+    /****************************************/
+    /****************************************/
+
+    bool CWebServer::IsKeyframeRequested() const {
+      return m_cDeltaEncoder.IsKeyframeRequested();
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::UpdateFloor(
+      std::shared_ptr<const CFloorTexture::SImage> ps_image,
+      std::vector<CFloorTexture::SRect> vec_dirty) {
+      /* Guard the mutex which locks m_mutex4Floor */
+      std::lock_guard<std::mutex> guard(m_mutex4Floor);
+
+      /* Too many renderings in one cycle, the whole floor is smaller */
+      if (m_vecFloorUpdates.size() >= MAX_FLOOR_UPDATES) {
+        m_vecFloorUpdates.clear();
+        vec_dirty.assign(1, {0, 0, ps_image->m_unWidth, ps_image->m_unHeight});
+      }
+
+      m_vecFloorUpdates.push_back({ps_image, std::move(vec_dirty)});
+      m_psFloorImage = std::move(ps_image);
+    }
+
+    /****************************************/
+    /****************************************/
+
+    void CWebServer::BroadcastPoses(CPoseSnapshot &c_snapshot) {
+      /* Guard the mutex which locks m_mutex4Poses */
+      std::lock_guard<std::mutex> guard(m_mutex4Poses);
+      /* Replaces the previous snapshot, even if it was not sent */
+      std::swap(m_cPoseSnapshot, c_snapshot);
+      m_bHasNewPoses = true;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendJSON(
+      uWS::HttpResponse<SSL> *pc_res, nlohmann::json c_json) {
+      pc_res->cork([pc_res, &c_json]() {
+        pc_res->writeHeader("Content-Type", "application/json");
+        pc_res->end(c_json.dump());
+      });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendJSONError(
+      uWS::HttpResponse<SSL> *pc_res,
+      nlohmann::json c_json,
+      std::string str_status) {
+      pc_res->cork([pc_res, &c_json, &str_status]() {
+        pc_res->writeStatus(str_status);
+        pc_res->writeHeader("Content-Type", "application/json");
+        pc_res->end(c_json.dump());
+      });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    std::shared_ptr<CWebServer::SRestSnapshot> CWebServer::GetRestSnapshot() {
+      std::vector<std::shared_ptr<const SEncodedFrame>> vecFrames;
+      uint64_t unSequence = 0;
+      if (!m_cResumeCache.GetLatest(&vecFrames, &unSequence)) {
+        return nullptr;
+      }
+
+      std::lock_guard<std::mutex> guard(m_mutex4RestSnapshot);
+      if (m_psRestSnapshot && m_psRestSnapshot->m_unSequence == unSequence) {
+        return m_psRestSnapshot;
+      }
+
+      /* The cached keyframe, brought to the latest broadcast */
+      auto psSnapshot = std::make_shared<SRestSnapshot>();
+      psSnapshot->m_unSequence = unSequence;
+      psSnapshot->m_bComplete =
+        CRestPolling::Rebuild(vecFrames, &psSnapshot->m_cState);
+      psSnapshot->m_strETag =
+        "\"" + std::to_string(psSnapshot->m_cState.value("steps", 0ull)) +
+        "." + std::to_string(unSequence) + "\"";
+
+      m_psRestSnapshot = psSnapshot;
+      return psSnapshot;
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    void CWebServer::SendRestSnapshot(
+      uWS::HttpResponse<SSL> *pc_res,
+      uWS::HttpRequest *pc_req,
+      const std::function<const std::string *(SRestSnapshot &)> &fn_body) {
+      std::shared_ptr<SRestSnapshot> psSnapshot = GetRestSnapshot();
+
+      /* Right after starting, before the first broadcast, or when the
+       * websocket clients filtered out what REST serves */
+      bool bComplete = psSnapshot && psSnapshot->m_bComplete;
+      if (!m_cRestPolling.OnRequest(bComplete)) {
+        std::string strError =
+          psSnapshot ? "state is incomplete, generating everything"
+                     : "no state yet";
+        pc_res->cork([pc_res, &strError]() {
+          pc_res->writeStatus("503 Service Unavailable");
+          pc_res->writeHeader("Retry-After", "1");
+          pc_res->writeHeader("Content-Type", "application/json");
+          pc_res->end(nlohmann::json({{"error", strError}}).dump());
+        });
+        return;
+      }
+
+      if (pc_req->getHeader("if-none-match") == psSnapshot->m_strETag) {
+        pc_res->cork([pc_res, &psSnapshot]() {
+          pc_res->writeStatus("304 Not Modified");
+          pc_res->writeHeader("ETag", psSnapshot->m_strETag);
+          pc_res->end();
+        });
+        return;
+      }
+
+      const std::string *pstrBody = fn_body(*psSnapshot);
+      if (pstrBody == nullptr) {
+        SendJSONError(pc_res, {{"error", "not found"}}, "404 Not Found");
+        return;
+      }
+
+      pc_res->cork([pc_res, &psSnapshot, pstrBody]() {
+        pc_res->writeHeader("Content-Type", "application/json");
+        pc_res->writeHeader("ETag", psSnapshot->m_strETag);
+        pc_res->writeHeader("Cache-Control", "no-cache");
+        pc_res->end(*pstrBody);
+      });
+    }
+
+    /****************************************/
+    /****************************************/
+
+    template <bool SSL>
+    bool CWebServer::SendAsset(
+      uWS::HttpResponse<SSL> *pc_res,
+      uWS::HttpRequest *pc_req,
+      std::string_view str_path) {
+      if (!m_psStaticAssets) {
+        return false;
+      }
+      const CStaticAssets::SAsset *psAsset = m_psStaticAssets->Find(str_path);
+      if (psAsset == nullptr) {
+        return false;
+      }
+
+      if (pc_req->getHeader("if-none-match") == psAsset->m_strETag) {
+        pc_res->cork([pc_res, psAsset]() {
+          pc_res->writeStatus("304 Not Modified");
+          pc_res->writeHeader("ETag", psAsset->m_strETag);
+          pc_res->end();
+        });
+        return true;
+      }
+
+      bool bGzip =
+        !psAsset->m_strGzip.empty() &&
+        pc_req->getHeader("accept-encoding").find("gzip") !=
+          std::string_view::npos;
+
+      pc_res->cork([pc_res, psAsset, bGzip]() {
+        pc_res->writeHeader("Content-Type", psAsset->m_strContentType);
+        pc_res->writeHeader("ETag", psAsset->m_strETag);
+        pc_res->writeHeader("Cache-Control", "no-cache");
+        if (!psAsset->m_strGzip.empty()) {
+          pc_res->writeHeader("Vary", "Accept-Encoding");
+        }
+        if (bGzip) {
+          pc_res->writeHeader("Content-Encoding", "gzip");
+          pc_res->end(psAsset->m_strGzip);
+        } else {
+          pc_res->end(psAsset->m_strBody);
+        }
+      });
+      return true;
     }
   }  // namespace Webviz
-}  // namespace argos
\ No newline at end of file
+}  // namespace argos
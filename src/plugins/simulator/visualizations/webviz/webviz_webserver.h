@@ -13,8 +13,6 @@
 #define ARGOS_WEBVIZ_WEBSERVER_H
 
 namespace argos {
-  class CWebviz;
-
   namespace Webviz {
     class CWebServer;
     class CTimer;
@@ -22,17 +20,49 @@ namespace argos {
   }  // namespace Webviz
 }  // namespace argos
 
+#include <argos3/core/config.h>
+#include <argos3/core/utility/configuration/argos_exception.h>
+#include <argos3/core/utility/logging/argos_log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <queue>
+#include <random>
+#include <sstream>
+#include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "App.h"  // uWebSockets
 #include "config.h"
+#include "utility/BroadcastMask.h"
 #include "utility/CTimer.h"
+#include "utility/ClientCommand.h"
+#include "utility/Deflate.h"
+#include "utility/DeltaEncoder.h"
 #include "utility/EExperimentState.h"
-#include "webviz.h"
+#include "utility/EntityEncoding.h"
+#include "utility/FloorTexture.h"
+#include "utility/LogRing.h"
+#include "utility/LogStream.h"
+#include "utility/Metrics.h"
+#include "utility/PoseSnapshot.h"
+#include "utility/RayLOD.h"
+#include "utility/ResumeCache.h"
+#include "utility/RestPolling.h"
+#include "utility/StaticAssets.h"
+#include "utility/ViewportFilter.h"
 
 namespace argos {
   namespace Webviz {
@@ -40,8 +70,14 @@ namespace argos {
     /* Disable subclassing using final */
     class CWebServer final {
      public:
+      /**
+       * @param fn_command_handler runs the commands of the clients (except
+       * the filters, handled by the webserver), called from the server
+       * thread. The acknowledgement is sent with SendToClient()
+       */
       CWebServer(
-        CWebviz*,
+        std::function<void(SClientCommand)> fn_command_handler,
+        unsigned short,
         unsigned short,
         unsigned short,
         std::string&,
@@ -68,20 +104,183 @@ namespace argos {
        */
       void EmitEvent(std::string str_event_name, EExperimentState e_state);
 
+      /**
+       * @brief Broadcasts an event as it is, like one from another webserver
+       *
+       * All the events of a cycle are sent together, after its frame. Each
+       * gets the current step (unless it has one) and the sequence of that
+       * frame.
+       */
+      void EmitEvent(nlohmann::json c_event);
+
       /**
        * @brief Broadcasts on log channels to all the connected clients
        *
        * @param log_type either LOG or LOGERR
        * @param message log message
        */
-      void EmitLog(const std::string& log_type, const std::string& message);
+      void EmitLog(const std::string& log_type, std::string message);
+
+      /**
+       * @brief Broadcasts a log entry as it is, like one from another
+       * webserver
+       *
+       * @param c_entry object with "log_type", "log_message" and "step"
+       */
+      void EmitLog(nlohmann::json c_entry);
+
+      /**
+       * @brief Sends everything written to LOG and LOGERR to the clients, on
+       * the log channel, instead of the terminal
+       *
+       * @param fn_get_steps simulation steps the log entries are tagged with
+       */
+      void CaptureLogs(std::function<uint64_t()> fn_get_steps);
+
+      /**
+       * @brief Bounds the lines waiting for the next broadcast cycle, before
+       * CaptureLogs() and Start()
+       *
+       * Lines are dropped (and counted) above these limits, the clients are
+       * told how many in the next cycle.
+       *
+       * @param un_capacity lines kept between two broadcast cycles
+       * @param un_lines_per_second lines accepted per second, 0 for no limit
+       */
+      void SetLogLimits(size_t un_capacity, uint32_t un_lines_per_second);
+
+      /** Number of log lines dropped so far */
+      uint64_t GetDroppedLogs() const { return m_pcLogRing->GetDropped(); }
+
+      /**
+       * @brief Metrics served on "GET /metrics", in the Prometheus format
+       *
+       * The webserver registers its own stages and gauges, the simulation
+       * can add its own stages before Start().
+       */
+      CMetrics& GetMetrics() { return m_cMetrics; }
+
+      /**
+       * @brief Broadcasts JSON to all the connected clients
+       *
+       * The full experiment state is kept until the next broadcast cycle,
+       * where it is encoded as a keyframe or as a delta against the
+       * previously sent state.
+       *
+       * @param vec_user_data_versions versions of the "user_data" of the
+       * entities, in their order, to not compare them in the delta when
+       * they did not change
+       * @param b_complete false if it was generated with a mask or rays
+       * which leave something out (see GetWantedMask)
+       * @see CDeltaEncoder::Encode
+       */
+      void Broadcast(
+        nlohmann::json,
+        std::vector<uint64_t> vec_user_data_versions = {},
+        bool b_complete = true);
+
+      /**
+       * @brief Broadcasts a state shared with somebody else (the recorder),
+       * it is only copied if still shared when it is encoded
+       */
+      void Broadcast(
+        std::shared_ptr<nlohmann::json>,
+        std::vector<uint64_t> vec_user_data_versions = {},
+        bool b_complete = true);
+
+      /**
+       * @brief Returns true if the broadcaster is waiting for a new state
+       *
+       * States are pulled: the simulation thread should only build one when
+       * this is true, at most once per broadcast cycle.
+       */
+      bool IsBroadcastWanted() const;
+
+      /**
+       * @brief Sends a message to one client, from any thread
+       *
+       * Dropped if the client disconnected in the meantime.
+       *
+       * @param un_client_id m_unClientId of the SClientCommand
+       * @param str_message text message
+       */
+      void SendToClient(uint64_t un_client_id, std::string str_message);
+
+      /** Forces the next broadcast to be a keyframe */
+      void RequestKeyframe();
+
+      /** True if a keyframe was asked for and not sent yet */
+      bool IsKeyframeRequested() const;
+
+      /**
+       * @brief What the clients want in the broadcasts, all together
+       *
+       * Everything which is not wanted by any client does not need to be
+       * generated. Everything is wanted while the REST routes are polled and
+       * found a state missing some of it (see CRestPolling).
+       */
+      CBroadcastMask GetWantedMask();
+
+      /** Rays the clients want, all together, like GetWantedMask() */
+      CRayLOD GetWantedRayLOD();
+
+      /**
+       * @brief Number of threads serving the clients, before Start()
+       *
+       * Each thread has its own loop listening on the same port, the kernel
+       * spreads the connections between them. Broadcasts are still encoded
+       * once per cycle, each thread only sends them to its own clients.
+       */
+      void SetServerThreads(unsigned short un_threads);
+
+      /** Ray LOD of the clients which did not set one, before Start() */
+      void SetDefaultRayLOD(const CRayLOD& c_lod) { m_cDefaultRayLOD = c_lod; }
+
+      /**
+       * @brief Files served over HTTP on the same port, before Start()
+       *
+       * "/" serves their "index.html" instead of the banner, and any other
+       * path which is not a route serves the file at that path.
+       */
+      void SetStaticAssets(std::shared_ptr<const CStaticAssets> ps_assets) {
+        m_psStaticAssets = std::move(ps_assets);
+      }
+
+      /**
+       * @brief Sends the regions of the floor which changed to the clients
+       * subscribed to "floor"
+       *
+       * Patches are encoded in the next broadcast cycle, out of the
+       * simulation thread.
+       *
+       * @param ps_image new rendering of the floor
+       * @param vec_dirty regions which changed since the previous rendering
+       */
+      void UpdateFloor(
+        std::shared_ptr<const CFloorTexture::SImage> ps_image,
+        std::vector<CFloorTexture::SRect> vec_dirty);
 
-      /** Broadcasts JSON to all the connected clients */
-      void Broadcast(nlohmann::json);
+      /** True if some clients are subscribed to "poses" */
+      bool HasPoseClients() const { return m_unPoseSubscribers > 0; }
+
+      /**
+       * @brief Sends the poses of the entities to the clients subscribed to
+       * "poses"
+       *
+       * Like the broadcasts, only the latest snapshot is kept until the next
+       * cycle, where it is quantized out of the simulation thread.
+       *
+       * @param c_snapshot swapped with the previous snapshot, so its arrays
+       * can be reused
+       */
+      void BroadcastPoses(CPoseSnapshot& c_snapshot);
 
      private:
-      /** Reference to CWebviz object to call function over it */
-      CWebviz* m_pcMyWebviz;
+      /** Runs the commands of the clients */
+      std::function<void(SClientCommand)> m_fnCommandHandler;
+
+      /** Steps of the log entries, set by CaptureLogs() */
+      std::function<uint64_t()> m_fnGetSteps;
 
       /** HTTP Port to Listen to */
       unsigned short m_unPort;
@@ -92,30 +291,238 @@ namespace argos {
       /** max time for one broadcast cycle */
       std::chrono::milliseconds m_cBroadcastDuration;
 
-      /** mutexed string using m_mutex4BroadcastString to broadcast */
-      std::string m_strBroadcastString;
+      /** latest experiment state, protected by m_mutex4BroadcastJson */
+      std::shared_ptr<nlohmann::json> m_psBroadcastJson;
 
-      /** A Queue to push events to client */
-      std::queue<std::string> m_cEventQueue;
+      /** "user_data" versions of m_psBroadcastJson, same protection */
+      std::vector<uint64_t> m_vecBroadcastVersions;
 
-      /** A Queue to push logs to client */
-      std::queue<nlohmann::json> m_cLogQueue;
+      /** false if m_psBroadcastJson misses some types or fields, same
+       * protection */
+      bool m_bBroadcastComplete = true;
 
-      /** Struct to hold websocket with its loop thread */
-      template <bool SSL>
-      struct SWebSocketClient {
-        uWS::WebSocket<SSL, true>* m_pcWS;
-        struct uWS::Loop* m_pcLoop;
+      /** If the last encoded frame was complete, broadcaster thread only */
+      bool m_bLastFrameComplete = true;
+
+      /** true if m_psBroadcastJson was not encoded yet */
+      bool m_bHasNewBroadcast;
+
+      /** Set by the broadcaster once per cycle, cleared by Broadcast() */
+      std::atomic<bool> m_bBroadcastWanted;
+
+      /** Builds keyframes and deltas from full experiment states */
+      CDeltaEncoder m_cDeltaEncoder;
+
+      /** Events to send with the next broadcast */
+      std::vector<nlohmann::json> m_vecEvents;
+
+      /** Log lines, escaped and batched by the broadcaster */
+      std::unique_ptr<CLogRing> m_pcLogRing;
+
+      /** Floor rendering waiting to be encoded as patches */
+      struct SFloorUpdate {
+        std::shared_ptr<const CFloorTexture::SImage> m_psImage;
+        std::vector<CFloorTexture::SRect> m_vecDirty;
+      };
+
+      /** Floor updates of this cycle, protected by m_mutex4Floor */
+      std::vector<SFloorUpdate> m_vecFloorUpdates;
+
+      /** Latest floor rendering, protected by m_mutex4Floor */
+      std::shared_ptr<const CFloorTexture::SImage> m_psFloorImage;
+
+      /** Above this, pending updates are replaced by the whole floor */
+      static constexpr size_t MAX_FLOOR_UPDATES = 8;
+
+      /** One encoded floor patch */
+      struct SFloorPatch {
+        uint32_t m_unVersion;
+        std::string m_strData;
+      };
+
+      /** One broadcast, in the formats somebody subscribed to */
+      struct SEncodedFrame {
+        /** "sequence" of the frame */
+        uint64_t m_unSequence = 0;
+
+        /** Frame before encoding, to rebuild the state for the REST routes */
+        std::shared_ptr<const nlohmann::json> m_psJSON;
+
+        /** false if some types or fields were not generated for it */
+        bool m_bComplete = true;
+
+        std::string m_strJSON;
+        std::string m_strMsgPack;
+        std::string m_strCBOR;
+        std::string m_strDeflate;
+      };
+
+      /** Messages encoded in one broadcast cycle, sent from the loop */
+      struct SOutgoingMessages {
+        /** New broadcast of this cycle, if any */
+        std::shared_ptr<const SEncodedFrame> m_psFrame;
+
+        /** Keyframe for clients which have to resynchronize, can be the
+         * same as m_psFrame */
+        std::shared_ptr<const SEncodedFrame> m_psKeyframe;
+
+        /** New broadcast of this cycle before encoding, and the index of
+         * its full state, only if some clients set a viewport or a mask */
+        std::shared_ptr<const nlohmann::json> m_psFrameJSON;
+        std::shared_ptr<const CViewportFilter> m_psViewportFilter;
+
+        std::string m_strEvent;
+        std::string m_strLog;
+
+        /** Floor patches of this cycle, in order */
+        std::vector<SFloorPatch> m_vecFloorPatches;
+
+        /** Whole floor for clients which have to resynchronize */
+        std::shared_ptr<const SFloorPatch> m_psFloorImage;
+
+        /** Quantized poses of this cycle, if any */
+        std::string m_strPoses;
+
+        /** Ids of these poses, sent before them to the clients which do not
+         * have this version */
+        std::shared_ptr<const std::string> m_psPoseIndex;
+        uint32_t m_unPoseIndexVersion = 0;
+
+        bool IsEmpty() const {
+          return !m_psFrame && !m_psKeyframe && !m_psViewportFilter &&
+                 m_strEvent.empty() && m_strLog.empty() &&
+                 m_vecFloorPatches.empty() && !m_psFloorImage &&
+                 m_strPoses.empty();
+        }
+      };
+
+      /** What the broadcast clients of one loop want all together */
+      struct SLoopWanted {
+        bool m_bBroadcastClients = false;
+        bool m_bFloorClients = false;
+        CBroadcastMask m_cMask;
+        CRayLOD m_cRays;
+      };
+
+      /** One server thread, with its own loop and its own clients */
+      struct SLoopHandle {
+        /** Loop of the thread, null unless it runs, protected by
+         * m_mutex4Loop */
+        uWS::Loop* m_pcLoop = nullptr;
+        std::mutex m_mutex4Loop;
+
+        /** Sends a message to a client by id, only called from the loop,
+         * empty unless it runs */
+        std::function<void(uint64_t, const std::string&)> m_fnSendToClient;
+
+        /** Sends the messages of a broadcast cycle to the clients of the
+         * loop, only called from the loop, empty unless it runs */
+        std::function<void(const SOutgoingMessages&)> m_fnPublish;
+
+        /** Protected by m_mutex4WantedMask */
+        SLoopWanted m_sWanted;
+
+        /** Bytes waiting to be sent to the clients of the loop, in total
+         * and for the most congested one, after the last publish */
+        std::atomic<uint64_t> m_unBufferedBytes{0};
+        std::atomic<uint64_t> m_unMaxBufferedBytes{0};
+
+        /**
+         * @brief Runs a function in the loop thread, from any thread
+         *
+         * @return false if the loop is not running, fn_task is dropped
+         */
+        template <class TASK>
+        bool Defer(TASK&& fn_task) {
+          std::lock_guard<std::mutex> guard(m_mutex4Loop);
+          if (m_pcLoop == nullptr) {
+            return false;
+          }
+          m_pcLoop->defer(std::forward<TASK>(fn_task));
+          return true;
+        }
+
+        /**
+         * @brief Stops deferring to the loop, and drops the functions
+         *
+         * Called from the loop thread once it stops, before the state the
+         * functions use is destroyed. Tasks deferred before and not run
+         * yet find them empty.
+         */
+        void Detach() {
+          std::lock_guard<std::mutex> guard(m_mutex4Loop);
+          m_pcLoop = nullptr;
+          m_fnSendToClient = nullptr;
+          m_fnPublish = nullptr;
+        }
       };
 
-      /** Mutex to protect access to m_mutex4BroadcastString */
-      std::mutex m_mutex4BroadcastString;
+      /** Server threads, sized before Start() and never resized after */
+      std::vector<SLoopHandle> m_vecLoops;
 
-      /** Mutex to protect access to m_cEventQueue */
+      /** Connected clients, on all the loops */
+      std::atomic<unsigned int> m_unClients;
+
+      /** Served on "GET /metrics" */
+      CMetrics m_cMetrics;
+
+      /** Time spent in each stage of the broadcast cycle, owned by
+       * m_cMetrics */
+      CHistogram* m_pcCycleHistogram = nullptr;
+      CHistogram* m_pcDeltaHistogram = nullptr;
+      CHistogram* m_pcSerializeHistogram = nullptr;
+      CHistogram* m_pcCompressHistogram = nullptr;
+      CHistogram* m_pcPublishHistogram = nullptr;
+      CHistogram* m_pcLogHistogram = nullptr;
+
+      /** Broadcasts not sent to congested or slowed down clients */
+      std::atomic<uint64_t> m_unDroppedFrames{0};
+
+      /** Clients which got the state from the resume cache, when they
+       * connected, with the keyframe or only the deltas they missed */
+      std::atomic<uint64_t> m_unCachedJoins{0};
+      std::atomic<uint64_t> m_unResumes{0};
+
+      /** Broadcasts are skipped for clients with more bytes than this
+       * waiting to be sent */
+      static constexpr unsigned int MAX_BUFFERED_AMOUNT = 1024 * 1024;
+
+      /** Slowest rate of congested clients: one broadcast every N cycles */
+      static constexpr unsigned int MAX_SEND_EVERY = 16;
+
+      /** Mutex to protect access to m_psBroadcastJson */
+      std::mutex m_mutex4BroadcastJson;
+
+      /** Mutex to protect access to m_vecEvents */
       std::mutex m_mutex4EventQueue;
 
-      /** Mutex to protect access to m_cLogQueue */
-      std::mutex m_mutex4LogQueue;
+      /** Mutex to protect access to m_vecFloorUpdates and m_psFloorImage */
+      std::mutex m_mutex4Floor;
+
+      /** Latest poses, protected by m_mutex4Poses */
+      CPoseSnapshot m_cPoseSnapshot;
+
+      /** true if m_cPoseSnapshot was not encoded yet */
+      bool m_bHasNewPoses = false;
+
+      /** Mutex to protect access to m_cPoseSnapshot */
+      std::mutex m_mutex4Poses;
+
+      /** Mutex to protect access to m_cWantedMask and m_cWantedRayLOD */
+      std::mutex m_mutex4WantedMask;
+
+      /** Union of the masks of the broadcast clients */
+      CBroadcastMask m_cWantedMask;
+
+      /** Union of the ray LODs of the broadcast clients, only written by the
+       * loop thread */
+      CRayLOD m_cWantedRayLOD;
+
+      /** Ray LOD of new clients */
+      CRayLOD m_cDefaultRayLOD;
+
+      /** Files of the client, null to only serve the banner */
+      std::shared_ptr<const CStaticAssets> m_psStaticAssets;
 
       /** SSL options */
       std::string m_strKeyFile;
@@ -125,7 +532,244 @@ namespace argos {
       std::string m_strPassphrase;
 
       /** Data attached to each socket, ws->getUserData returns one of these */
-      struct m_sPerSocketData {};
+      struct m_sPerSocketData {
+        /** Identifies the connection in acknowledgements */
+        uint64_t m_unClientId = 0;
+
+        /** Formats in which this client receives broadcasts */
+        bool m_bBroadcastJSON = false;
+        bool m_bBroadcastMsgPack = false;
+        bool m_bBroadcastCBOR = false;
+        bool m_bBroadcastDeflate = false;
+
+        /** Skipped some broadcasts, the next one must be a keyframe */
+        bool m_bNeedsKeyframe = false;
+
+        /** Sequence of the last unfiltered broadcast sent, the ones it got
+         * from the resume cache are not sent again */
+        uint64_t m_unLastSequence = 0;
+
+        /** Adaptive rate: this client gets one broadcast every N cycles */
+        unsigned int m_unSendEvery = 1;
+
+        /** Cycles since the last broadcast sent to this client */
+        unsigned int m_unCyclesSinceSent = 0;
+
+        /** Receives floor patches */
+        bool m_bFloor = false;
+
+        /** Needs the whole floor before any patch */
+        bool m_bNeedsFloor = false;
+
+        /** Version of the floor this client has */
+        uint32_t m_unFloorVersion = 0;
+
+        /** Receives the poses, and the version of their ids it has */
+        bool m_bPoses = false;
+        uint32_t m_unPoseIndexVersion = 0;
+
+        bool IsBroadcastClient() const {
+          return m_bBroadcastJSON || m_bBroadcastMsgPack ||
+                 m_bBroadcastCBOR || m_bBroadcastDeflate;
+        }
+      };
+
+      /** Viewport and mask of a client, only used from the loop thread */
+      struct SClientFilter {
+        bool m_bHasViewport = false;
+        CViewportFilter::SRect m_sRect;
+
+        /** Entity types and fields this client wants */
+        CBroadcastMask m_cMask;
+
+        /** Rays this client wants */
+        CRayLOD m_cRays;
+
+        /** Entities this client has */
+        CViewportFilter::TVisibleSet m_setVisible;
+
+        bool IsEmpty() const {
+          return !m_bHasViewport && m_cMask.IsEmpty() && m_cRays.IsFull();
+        }
+      };
+
+      /** Number of clients with a viewport or a mask */
+      std::atomic<unsigned int> m_unFilteredClients;
+
+      /** Number of clients subscribed to each broadcast format, used to
+       * encode only the formats somebody is listening to */
+      std::atomic<unsigned int> m_unJSONSubscribers;
+      std::atomic<unsigned int> m_unMsgPackSubscribers;
+      std::atomic<unsigned int> m_unCBORSubscribers;
+      std::atomic<unsigned int> m_unDeflateSubscribers;
+
+      /** Number of clients waiting for a keyframe to resynchronize */
+      std::atomic<unsigned int> m_unClientsNeedingKeyframe;
+
+      /** Number of clients waiting for the whole floor */
+      std::atomic<unsigned int> m_unClientsNeedingFloor;
+
+      /** Number of clients subscribed to "poses" */
+      std::atomic<unsigned int> m_unPoseSubscribers;
+
+      /** Adds the stages and gauges of the webserver to m_cMetrics */
+      void RegisterMetrics();
+
+      /**
+       * @brief Encodes a broadcast in every format somebody subscribed to
+       */
+      SEncodedFrame EncodeFrame(const nlohmann::json&);
+
+      /** Encodes a broadcast in the given formats */
+      SEncodedFrame EncodeFrame(
+        const nlohmann::json&, bool b_json, bool b_msgpack, bool b_cbor,
+        bool b_deflate);
+
+      /**
+       * @brief Encodes the last encoded state as a keyframe, with the session
+       *
+       * @return null if deltas are disabled, all frames are keyframes
+       */
+      std::shared_ptr<const SEncodedFrame> MakeKeyframe();
+
+      /** Sets m_bNeedsKeyframe of a client, keeping the count in sync */
+      void SetNeedsKeyframe(m_sPerSocketData*, bool);
+
+      /** Deltas kept for the clients which resume */
+      static constexpr size_t RESUME_DELTAS = 64;
+
+      /** Latest keyframe and the last deltas, for new clients and the ones
+       * which resume */
+      CResumeCache<SEncodedFrame> m_cResumeCache{RESUME_DELTAS};
+
+      /** Random, in the keyframes, clients of another run can't resume */
+      std::string m_strSession;
+
+      /**
+       * @brief Frames bringing a client to the latest broadcast, from
+       * m_cResumeCache
+       *
+       * Only the deltas after str_resume ("<session>.<sequence>", as sent by
+       * the client) if they are all cached, the keyframe and the deltas
+       * after it otherwise.
+       *
+       * @param vec_frames frames to send in order, empty if it is up to date
+       * @param un_last_sequence sequence the client is at after them
+       * @return false if the cache can't serve this client (nothing cached
+       * yet, or not in its formats), it waits for a keyframe then
+       */
+      bool GetResumeFrames(
+        const std::string& str_resume,
+        const m_sPerSocketData& s_data,
+        std::vector<std::shared_ptr<const SEncodedFrame>>* vec_frames,
+        uint64_t* un_last_sequence);
+
+      /**
+       * @brief Sends the resume frames to a client which just connected
+       *
+       * @return false if it has to wait for a keyframe
+       */
+      template <bool SSL>
+      bool SendResumeFrames(
+        uWS::WebSocket<SSL, true>*, const std::string& str_resume);
+
+      /**
+       * @brief Sends the broadcast of this cycle to one client
+       *
+       * Nothing is queued for clients which are congested (or on a reduced
+       * rate), they get a keyframe when they catch up, so they never receive
+       * stale frames. Congested clients have their rate reduced and
+       * progressively restored once their buffer is drained.
+       */
+      template <bool SSL>
+      void SendBroadcast(
+        uWS::WebSocket<SSL, true>*,
+        const SOutgoingMessages&,
+        SClientFilter*);
+
+      /**
+       * @brief Sends the broadcast of this cycle filtered down to the
+       * viewport and the mask of a client
+       *
+       * @param b_keyframe true to send a keyframe, otherwise a delta against
+       * what the client has
+       */
+      template <bool SSL>
+      void SendFilteredFrame(
+        uWS::WebSocket<SSL, true>*,
+        const SOutgoingMessages&,
+        SClientFilter&,
+        bool b_keyframe);
+
+      /**
+       * @brief Handles the "setViewport", "setFilter" and "setRays"
+       * commands, from the loop thread
+       *
+       * @return nlohmann::json acknowledgement
+       */
+      template <bool SSL>
+      nlohmann::json SetClientFilter(
+        uWS::WebSocket<SSL, true>*,
+        const nlohmann::json&,
+        std::unordered_map<uint64_t, SClientFilter>&);
+
+      /**
+       * @brief Stores the filter of a client (removes it if it is empty),
+       * keeping the count in sync, the client restarts from a keyframe
+       */
+      void StoreClientFilter(
+        m_sPerSocketData*,
+        SClientFilter,
+        std::unordered_map<uint64_t, SClientFilter>&);
+
+      /**
+       * @brief Applies the ray LOD of a client to a filtered frame
+       *
+       * Rays are removed from the frames between two ray frames, so the
+       * client keeps the ones it has, and are copied from the full state on
+       * ray frames, to include what changed in between.
+       */
+      void ApplyRayLOD(
+        nlohmann::json& c_frame,
+        const CViewportFilter&,
+        const SClientFilter&,
+        bool b_keyframe);
+
+      /**
+       * @brief Sets what the clients of one loop want, the next broadcast is
+       * a keyframe if the union of all the loops changed
+       */
+      void SetWantedMask(size_t un_loop, const SLoopWanted&);
+
+      /** Sets m_bNeedsFloor of a client, keeping the count in sync */
+      void SetNeedsFloor(m_sPerSocketData*, bool);
+
+      /**
+       * @brief Sends the floor patches of this cycle to one client, or the
+       * whole floor if it just subscribed or was congested
+       */
+      template <bool SSL>
+      void SendFloor(uWS::WebSocket<SSL, true>*, const SOutgoingMessages&);
+
+      /**
+       * @brief Sends the poses of this cycle to one client, after their ids
+       * if it does not have them
+       *
+       * Skipped for congested clients, the next snapshot is complete.
+       */
+      template <bool SSL>
+      void SendPoses(uWS::WebSocket<SSL, true>*, const SOutgoingMessages&);
+
+      /** Sends a frame in the formats the client subscribed to */
+      template <bool SSL>
+      void SendFrame(uWS::WebSocket<SSL, true>*, const SEncodedFrame&);
+
+      /**
+       * @brief Subscribes a client to a topic, and keeps track of the
+       * broadcast formats it asked for
+       */
+      template <bool SSL>
+      void Subscribe(uWS::WebSocket<SSL, true>*, const std::string&);
 
       /**
        * @brief Function to run server depending on SSL
@@ -136,6 +780,25 @@ namespace argos {
       template <bool SSL>
       void RunServer(std::atomic<bool>& b_IsServerRunning);
 
+      /**
+       * @brief Runs one server thread, listening on the same port as the
+       * others, until the server stops
+       *
+       * @param un_loop index of the thread in m_vecLoops
+       * @param fn_on_listen called once listening, before running the loop
+       */
+      template <bool SSL>
+      void RunLoop(
+        size_t un_loop,
+        us_socket_context_options_t s_ssl_options,
+        const std::function<void()>& fn_on_listen);
+
+      /**
+       * @brief Encodes the broadcasts, events, logs and floor patches once
+       * per cycle, and hands them to every server thread
+       */
+      void BroadcasterThreadFunction(const std::atomic<bool>&);
+
       /** Function to send JSON over HttpResponse */
       template <bool SSL>
       void SendJSON(uWS::HttpResponse<SSL>*, nlohmann::json);
@@ -146,6 +809,80 @@ namespace argos {
         uWS::HttpResponse<SSL>*,
         nlohmann::json,
         std::string = "400 Bad Request");
+
+      /**
+       * @brief Latest full state for "GET /state", "/experiment" and
+       * "/entities/<id>", with its bodies encoded on the first request and
+       * shared by all the pollers
+       */
+      struct SRestSnapshot {
+        /** Sequence of the last broadcast in the state */
+        uint64_t m_unSequence = 0;
+
+        /** false if the state misses some types or fields */
+        bool m_bComplete = false;
+
+        /** Steps and sequence of the state, as "steps.sequence" */
+        std::string m_strETag;
+        nlohmann::json m_cState;
+
+        std::once_flag m_cStateOnce;
+        std::string m_strState;
+
+        std::once_flag m_cExperimentOnce;
+        std::string m_strExperiment;
+
+        /** Index of each entity in m_cState, by id */
+        std::once_flag m_cIndexOnce;
+        std::unordered_map<std::string, size_t> m_mapIndex;
+
+        /** Bodies of the entities requested so far, by id */
+        std::mutex m_mutex4Entities;
+        std::unordered_map<std::string, std::string> m_mapEntities;
+      };
+
+      /** Protected by m_mutex4RestSnapshot, null until first requested */
+      std::shared_ptr<SRestSnapshot> m_psRestSnapshot;
+      std::mutex m_mutex4RestSnapshot;
+
+      /** Makes everything generated while the REST routes need it */
+      CRestPolling m_cRestPolling;
+
+      /**
+       * @brief Snapshot of the latest broadcast, rebuilt from the frames of
+       * m_cResumeCache the first time it is requested
+       *
+       * @return null before the first broadcast
+       */
+      std::shared_ptr<SRestSnapshot> GetRestSnapshot();
+
+      /**
+       * @brief Answers a REST route from the latest snapshot
+       *
+       * 304 if the "If-None-Match" of the request is its ETag, 503 before
+       * the first broadcast, or while the latest one misses some types or
+       * fields (the next ones are generated with everything).
+       *
+       * @param fn_body body of the route, null for a 404
+       */
+      template <bool SSL>
+      void SendRestSnapshot(
+        uWS::HttpResponse<SSL>*,
+        uWS::HttpRequest*,
+        const std::function<const std::string*(SRestSnapshot&)>& fn_body);
+
+      /**
+       * @brief Answers with a file of m_psStaticAssets
+       *
+       * Gzipped if the client accepts it, 304 if the "If-None-Match" of the
+       * request is its ETag. The files are not fingerprinted, so they are
+       * revalidated at each load.
+       *
+       * @return false if there is no such file
+       */
+      template <bool SSL>
+      bool SendAsset(
+        uWS::HttpResponse<SSL>*, uWS::HttpRequest*, std::string_view str_path);
     };
   }  // namespace Webviz
 }  // namespace argos
@@ -0,0 +1,121 @@
+#include "plugins/simulator/visualizations/webviz/utility/Batch.h"
+
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CBatch;
+
+TEST(UtilityBatch, ParseOperations) {
+  CBatch::SOperation sOperation;
+  std::string strError;
+
+  /* "move" is the default, orientation is optional */
+  ASSERT_TRUE(CBatch::Parse(
+    R"({"id": "fb0", "position": {"x": 1, "y": 2, "z": 0}})"_json,
+    &sOperation,
+    &strError));
+  EXPECT_EQ(CBatch::EOp::MOVE, sOperation.m_eOp);
+  EXPECT_EQ("fb0", sOperation.m_strId);
+  EXPECT_EQ(2, sOperation.m_pfPosition[1]);
+  EXPECT_FALSE(sOperation.m_bOrientation);
+
+  ASSERT_TRUE(CBatch::Parse(
+    R"({"op": "move", "id": "fb0", "position": {"x": 1, "y": 2, "z": 0},
+        "orientation": {"w": 0.5, "x": 0, "y": 0, "z": 1}})"_json,
+    &sOperation,
+    &strError));
+  EXPECT_TRUE(sOperation.m_bOrientation);
+  EXPECT_EQ(0.5, sOperation.m_pfOrientation[0]);
+  EXPECT_EQ(1, sOperation.m_pfOrientation[3]);
+
+  ASSERT_TRUE(CBatch::Parse(
+    R"({"op": "add", "xml": "<box id=\"b0\" />"})"_json,
+    &sOperation,
+    &strError));
+  EXPECT_EQ(CBatch::EOp::ADD, sOperation.m_eOp);
+  EXPECT_EQ("<box id=\"b0\" />", sOperation.m_strXML);
+
+  ASSERT_TRUE(CBatch::Parse(
+    R"({"op": "remove", "id": "fb1"})"_json, &sOperation, &strError));
+  EXPECT_EQ(CBatch::EOp::REMOVE, sOperation.m_eOp);
+  EXPECT_EQ("fb1", sOperation.m_strId);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBatch, ParseErrors) {
+  CBatch::SOperation sOperation;
+  std::string strError;
+
+  EXPECT_FALSE(CBatch::Parse(
+    R"({"op": "move", "id": "fb0"})"_json, &sOperation, &strError));
+  EXPECT_FALSE(strError.empty());
+
+  EXPECT_FALSE(CBatch::Parse(
+    R"({"op": "move", "id": "fb0", "position": {"x": 1, "y": 2}})"_json,
+    &sOperation,
+    &strError));
+
+  EXPECT_FALSE(CBatch::Parse(R"({"op": "add"})"_json, &sOperation, &strError));
+
+  EXPECT_FALSE(CBatch::Parse(
+    R"({"op": "paint", "id": "fb0"})"_json, &sOperation, &strError));
+  EXPECT_EQ("unknown op \"paint\"", strError);
+
+  EXPECT_FALSE(CBatch::Parse(R"(42)"_json, &sOperation, &strError));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBatch, IdsFollowTheOperations) {
+  std::set<std::string> setSpace = {"fb0", "fb1"};
+  CBatch::CIds cIds(
+    [&setSpace](const std::string& str_id) { return setSpace.count(str_id); });
+
+  EXPECT_TRUE(cIds.Exists("fb0"));
+  EXPECT_FALSE(cIds.Exists("fb9"));
+  EXPECT_FALSE(cIds.IsTaken("fb9"));
+
+  /* Added entities can be moved and removed by the next operations */
+  cIds.Add("fb9");
+  EXPECT_TRUE(cIds.Exists("fb9"));
+  EXPECT_TRUE(cIds.IsTaken("fb9"));
+
+  /* Removed ones are gone, but keep their id until the end */
+  cIds.Remove("fb1");
+  EXPECT_FALSE(cIds.Exists("fb1"));
+  EXPECT_TRUE(cIds.IsTaken("fb1"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBatch, UndoLogRollsBackInReverse) {
+  std::vector<int> vecUndone;
+  {
+    CBatch::CUndoLog cUndo;
+    cUndo.Push([&vecUndone]() { vecUndone.push_back(1); });
+    cUndo.Push([&vecUndone]() { vecUndone.push_back(2); });
+    EXPECT_EQ(2u, cUndo.GetSize());
+
+    cUndo.Rollback();
+    EXPECT_EQ((std::vector<int>{2, 1}), vecUndone);
+    EXPECT_EQ(0u, cUndo.GetSize());
+
+    /* Committed operations are kept */
+    cUndo.Push([&vecUndone]() { vecUndone.push_back(3); });
+    cUndo.Commit();
+  }
+  EXPECT_EQ((std::vector<int>{2, 1}), vecUndone);
+
+  /* Not committed, undone when it goes away (like on an exception) */
+  {
+    CBatch::CUndoLog cUndo;
+    cUndo.Push([&vecUndone]() { vecUndone.push_back(4); });
+  }
+  EXPECT_EQ((std::vector<int>{2, 1, 4}), vecUndone);
+};
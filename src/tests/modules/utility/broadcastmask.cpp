@@ -0,0 +1,102 @@
+#include "plugins/simulator/visualizations/webviz/utility/BroadcastMask.h"
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CBroadcastMask;
+using nlohmann::json;
+
+TEST(UtilityBroadcastMask, DefaultWantsEverything) {
+  CBroadcastMask cMask;
+
+  EXPECT_TRUE(cMask.IsEmpty());
+  EXPECT_TRUE(cMask.WantsType("foot-bot"));
+  EXPECT_TRUE(cMask.WantsField("rays"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastMask, FromJSON) {
+  CBroadcastMask cMask = CBroadcastMask::FromJSON(
+    {{"types", {"foot-bot"}}, {"fields", {"position", "orientation"}}});
+
+  EXPECT_FALSE(cMask.IsEmpty());
+  EXPECT_TRUE(cMask.WantsType("foot-bot"));
+  EXPECT_FALSE(cMask.WantsType("box"));
+  EXPECT_TRUE(cMask.WantsField("position"));
+  EXPECT_TRUE(cMask.WantsField("id"));
+  EXPECT_TRUE(cMask.WantsField("type"));
+  EXPECT_FALSE(cMask.WantsField("rays"));
+
+  /* Only fields */
+  cMask = CBroadcastMask::FromJSON({{"fields", {"position"}}});
+  EXPECT_TRUE(cMask.WantsAllTypes());
+  EXPECT_FALSE(cMask.WantsAllFields());
+
+  EXPECT_THROW(
+    CBroadcastMask::FromJSON({{"types", "foot-bot"}}), json::exception);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastMask, ApplyFields) {
+  CBroadcastMask cMask;
+  cMask.AddField("position");
+
+  json cEntity = {
+    {"id", "fb0"},
+    {"type", "foot-bot"},
+    {"position", {{"x", 1}}},
+    {"rays", {1, 2, 3}},
+    {"user_data", 4}};
+  cMask.ApplyFields(cEntity);
+
+  EXPECT_EQ(
+    json({{"id", "fb0"}, {"type", "foot-bot"}, {"position", {{"x", 1}}}}),
+    cEntity);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastMask, Merge) {
+  CBroadcastMask cPoses;
+  cPoses.AddType("foot-bot");
+  cPoses.AddField("position");
+
+  CBroadcastMask cLights;
+  cLights.AddType("light");
+  cLights.AddField("color");
+
+  CBroadcastMask cWanted = CBroadcastMask::None();
+  EXPECT_FALSE(cWanted.WantsType("foot-bot"));
+  EXPECT_FALSE(cWanted.WantsField("position"));
+
+  cWanted.Merge(cPoses);
+  cWanted.Merge(cLights);
+  EXPECT_TRUE(cWanted.WantsType("foot-bot"));
+  EXPECT_TRUE(cWanted.WantsType("light"));
+  EXPECT_FALSE(cWanted.WantsType("box"));
+  EXPECT_TRUE(cWanted.WantsField("color"));
+  EXPECT_FALSE(cWanted.WantsField("rays"));
+
+  /* A client wanting everything */
+  cWanted.Merge(CBroadcastMask());
+  EXPECT_TRUE(cWanted.IsEmpty());
+  EXPECT_TRUE(cWanted == CBroadcastMask());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityBroadcastMask, ToJSON) {
+  CBroadcastMask cMask = CBroadcastMask::FromJSON({{"types", {"foot-bot"}}});
+
+  json cJson = cMask.ToJSON();
+  EXPECT_EQ(json({"foot-bot"}), cJson["types"]);
+  EXPECT_TRUE(cJson["fields"].is_null());
+  EXPECT_TRUE(cMask == CBroadcastMask::FromJSON(cJson));
+  EXPECT_TRUE(CBroadcastMask() == CBroadcastMask::FromJSON(
+                                    CBroadcastMask().ToJSON()));
+};
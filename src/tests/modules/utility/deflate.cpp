@@ -0,0 +1,62 @@
+#include "plugins/simulator/visualizations/webviz/utility/Deflate.h"
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeflate;
+
+TEST(UtilityDeflate, RoundTrip) {
+  std::string strIn;
+  for (int i = 0; i < 10000; i++) {
+    strIn += "{\"id\":\"fb" + std::to_string(i) + "\",\"type\":\"foot-bot\"}";
+  }
+  std::string strCompressed;
+  std::string strOut;
+
+  ASSERT_TRUE(CDeflate::Compress(strIn, &strCompressed));
+  EXPECT_LT(strCompressed.size(), strIn.size());
+
+  ASSERT_TRUE(CDeflate::Inflate(strCompressed, &strOut));
+  EXPECT_EQ(strIn, strOut);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeflate, ZlibHeader) {
+  std::string strCompressed;
+
+  ASSERT_TRUE(CDeflate::Compress("ABCD", &strCompressed));
+  /* CMF byte of a zlib stream with a 32K window */
+  EXPECT_EQ(0x78, static_cast<unsigned char>(strCompressed[0]));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeflate, InvalidInput) {
+  std::string strOut;
+
+  EXPECT_FALSE(CDeflate::Inflate("not compressed", &strOut));
+  EXPECT_TRUE(strOut.empty());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeflate, GzipRoundTrip) {
+  std::string strIn;
+  for (int i = 0; i < 1000; ++i) {
+    strIn += "<div class=\"entity\">" + std::to_string(i) + "</div>\n";
+  }
+  std::string strGzip;
+  std::string strOut;
+
+  ASSERT_TRUE(CDeflate::Gzip(strIn, &strGzip));
+  EXPECT_LT(strGzip.size(), strIn.size());
+  /* Magic bytes of a gzip stream */
+  EXPECT_EQ(0x1f, static_cast<unsigned char>(strGzip[0]));
+  EXPECT_EQ(0x8b, static_cast<unsigned char>(strGzip[1]));
+
+  ASSERT_TRUE(CDeflate::Inflate(strGzip, &strOut));
+  EXPECT_EQ(strIn, strOut);
+};
@@ -0,0 +1,192 @@
+#include "plugins/simulator/visualizations/webviz/utility/DeltaEncoder.h"
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeltaEncoder;
+
+static nlohmann::json MakeFrame(double f_x, bool b_with_box = true) {
+  nlohmann::json cFrame;
+  cFrame["type"] = "broadcast";
+  cFrame["state"] = "EXPERIMENT_PLAYING";
+  cFrame["steps"] = 1;
+  cFrame["arena"]["size"]["x"] = 5;
+
+  nlohmann::json cRobot;
+  cRobot["id"] = "fb0";
+  cRobot["type"] = "foot-bot";
+  cRobot["position"]["x"] = f_x;
+  cRobot["leds"] = {1, 2, 3};
+  cFrame["entities"].push_back(cRobot);
+
+  if (b_with_box) {
+    nlohmann::json cBox;
+    cBox["id"] = "box0";
+    cBox["type"] = "box";
+    cBox["scale"]["x"] = 1;
+    cFrame["entities"].push_back(cBox);
+  }
+  return cFrame;
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, EveryFrameIsKeyframeByDefault) {
+  CDeltaEncoder cEncoder;
+
+  nlohmann::json cFirst = cEncoder.Encode(MakeFrame(0));
+  nlohmann::json cSecond = cEncoder.Encode(MakeFrame(1));
+
+  EXPECT_TRUE(cFirst["keyframe"].get<bool>());
+  EXPECT_TRUE(cSecond["keyframe"].get<bool>());
+  EXPECT_EQ(1, cFirst["sequence"].get<int>());
+  EXPECT_EQ(2, cSecond["sequence"].get<int>());
+  EXPECT_EQ(2u, cSecond["entities"].size());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, DeltaContainsOnlyChangedFields) {
+  CDeltaEncoder cEncoder(10);
+
+  nlohmann::json cKey = cEncoder.Encode(MakeFrame(0));
+  nlohmann::json cDelta = cEncoder.Encode(MakeFrame(1));
+
+  EXPECT_TRUE(cKey["keyframe"].get<bool>());
+  EXPECT_FALSE(cDelta["keyframe"].get<bool>());
+
+  /* Unchanged arena is not sent again */
+  EXPECT_FALSE(cDelta.contains("arena"));
+  EXPECT_TRUE(cDelta.contains("steps"));
+
+  /* Only the robot moved, and only its position changed */
+  ASSERT_EQ(1u, cDelta["entities"].size());
+  EXPECT_EQ("fb0", cDelta["entities"][0]["id"]);
+  EXPECT_EQ(1, cDelta["entities"][0]["position"]["x"].get<double>());
+  EXPECT_FALSE(cDelta["entities"][0].contains("leds"));
+  EXPECT_FALSE(cDelta["entities"][0].contains("type"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, RemovedEntitiesAreListed) {
+  CDeltaEncoder cEncoder(10);
+
+  cEncoder.Encode(MakeFrame(0));
+  nlohmann::json cDelta = cEncoder.Encode(MakeFrame(0, false));
+
+  ASSERT_TRUE(cDelta.contains("removed"));
+  EXPECT_EQ("box0", cDelta["removed"][0]);
+  EXPECT_EQ(0u, cDelta["entities"].size());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, PeriodicAndRequestedKeyframes) {
+  CDeltaEncoder cEncoder(3);
+
+  EXPECT_TRUE(cEncoder.Encode(MakeFrame(0))["keyframe"].get<bool>());
+  EXPECT_FALSE(cEncoder.Encode(MakeFrame(1))["keyframe"].get<bool>());
+  EXPECT_FALSE(cEncoder.Encode(MakeFrame(2))["keyframe"].get<bool>());
+  EXPECT_TRUE(cEncoder.Encode(MakeFrame(3))["keyframe"].get<bool>());
+
+  cEncoder.RequestKeyframe();
+  EXPECT_TRUE(cEncoder.Encode(MakeFrame(4))["keyframe"].get<bool>());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, ApplyRebuildsFullFrame) {
+  CDeltaEncoder cEncoder(10);
+  nlohmann::json cState;
+
+  CDeltaEncoder::Apply(cState, cEncoder.Encode(MakeFrame(0)));
+  CDeltaEncoder::Apply(cState, cEncoder.Encode(MakeFrame(2)));
+  CDeltaEncoder::Apply(cState, cEncoder.Encode(MakeFrame(2, false)));
+
+  nlohmann::json cExpected = MakeFrame(2, false);
+  ASSERT_EQ(1u, cState["entities"].size());
+  EXPECT_EQ(cExpected["entities"][0], cState["entities"][0]);
+  EXPECT_EQ(cExpected["arena"], cState["arena"]);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, GetKeyframeResynchronizes) {
+  CDeltaEncoder cEncoder(10);
+  EXPECT_TRUE(cEncoder.GetKeyframe().is_null());
+
+  cEncoder.Encode(MakeFrame(0));
+  cEncoder.Encode(MakeFrame(1));
+
+  /* Keyframe of the current state, with the current sequence */
+  nlohmann::json cState = cEncoder.GetKeyframe();
+  EXPECT_TRUE(cState["keyframe"].get<bool>());
+  EXPECT_EQ(2, cState["sequence"].get<int>());
+
+  /* Next delta applies on top of it */
+  CDeltaEncoder::Apply(cState, cEncoder.Encode(MakeFrame(3, false)));
+  ASSERT_EQ(1u, cState["entities"].size());
+  EXPECT_EQ(MakeFrame(3, false)["entities"][0], cState["entities"][0]);
+
+  /* Without deltas, frames are keyframes already */
+  CDeltaEncoder cPlain;
+  cPlain.Encode(MakeFrame(0));
+  EXPECT_TRUE(cPlain.GetKeyframe().is_null());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, UserDataVersionsSkipComparing) {
+  CDeltaEncoder cEncoder(10);
+  auto fnFrame = [](int n_a, int n_b) {
+    nlohmann::json cFrame;
+    cFrame["entities"] = {
+      {{"id", "a"}, {"user_data", {{"n", n_a}}}},
+      {{"id", "b"}, {"user_data", {{"n", n_b}}}}};
+    return cFrame;
+  };
+  cEncoder.Encode(fnFrame(0, 0), {1, 2});
+
+  /* Same version is trusted as unchanged, a new one is compared */
+  nlohmann::json cDelta = cEncoder.Encode(fnFrame(5, 5), {1, 3});
+  ASSERT_EQ(1u, cDelta["entities"].size());
+  EXPECT_EQ("b", cDelta["entities"][0]["id"]);
+  EXPECT_EQ(5, cDelta["entities"][0]["user_data"]["n"].get<int>());
+
+  /* Unknown versions, or not matching the entities, are compared */
+  cDelta = cEncoder.Encode(fnFrame(6, 5), {1});
+  ASSERT_EQ(1u, cDelta["entities"].size());
+  EXPECT_EQ("a", cDelta["entities"][0]["id"]);
+
+  /* Kept for the keyframes */
+  nlohmann::json cKeyframe = cEncoder.GetKeyframe();
+  ASSERT_EQ(2u, cKeyframe["entities"].size());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityDeltaEncoder, GetKeyframeKeepsOrder) {
+  CDeltaEncoder cEncoder(10);
+  nlohmann::json cFrame = MakeFrame(0, false);
+  for (int i = 0; i < 20; ++i) {
+    nlohmann::json cBox;
+    cBox["id"] = "box" + std::to_string(i);
+    cBox["type"] = "box";
+    cFrame["entities"].push_back(cBox);
+  }
+  cEncoder.Encode(cFrame);
+
+  /* Same order as encoded, after keyframes and deltas */
+  EXPECT_EQ(cFrame["entities"], cEncoder.GetKeyframe()["entities"]);
+  cFrame["entities"][3]["type"] = "cylinder";
+  cEncoder.Encode(cFrame);
+  EXPECT_EQ(cFrame["entities"], cEncoder.GetKeyframe()["entities"]);
+};
@@ -0,0 +1,101 @@
+#include "plugins/simulator/visualizations/webviz/utility/EntityEncoding.h"
+
+#include "gtest/gtest.h"
+
+using argos::CColor;
+using argos::CQuaternion;
+using argos::CRay3;
+using argos::CVector3;
+using argos::Webviz::CEntityEncoding;
+
+struct SFakeLED {
+  CColor m_cColor;
+  const CColor& GetColor() const { return m_cColor; }
+};
+
+struct SFakeLEDs {
+  std::vector<SFakeLED> m_vecLEDs;
+  SFakeLED& GetLED(uint32_t un_index) { return m_vecLEDs[un_index]; }
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityEntityEncoding, PackColor) {
+  EXPECT_EQ(0xff8000u, CEntityEncoding::PackColor(CColor(255, 128, 0)));
+  EXPECT_EQ(0x000000u, CEntityEncoding::PackColor(CColor(0, 0, 0)));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityEntityEncoding, LEDsAsIntegers) {
+  SFakeLEDs sLEDs;
+  sLEDs.m_vecLEDs = {{CColor(255, 0, 0)}, {CColor(0, 0, 255)}};
+  nlohmann::json cJson;
+
+  CEntityEncoding::EncodeLEDs(sLEDs, 2, cJson);
+
+  ASSERT_EQ(2u, cJson.size());
+  EXPECT_EQ(0xff0000u, cJson[0].get<uint32_t>());
+  EXPECT_EQ(0x0000ffu, cJson[1].get<uint32_t>());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityEntityEncoding, RaysRelativeToRobot) {
+  std::vector<std::pair<bool, CRay3>> vecRays = {
+    {true, CRay3(CVector3(1, 2, 0), CVector3(1, 3, 0))},
+    {false, CRay3(CVector3(1, 2, 0), CVector3(2, 2, 0))}};
+  std::vector<CVector3> vecPoints = {CVector3(1, 2.5, 0)};
+  nlohmann::json cRays;
+  nlohmann::json cPoints;
+
+  CEntityEncoding::EncodeRays(
+    vecRays,
+    vecPoints,
+    CVector3(1, 2, 0),
+    CQuaternion(1, 0, 0, 0),
+    cRays,
+    cPoints);
+
+  ASSERT_EQ(2 * CEntityEncoding::RAY_STRIDE, cRays.size());
+  EXPECT_EQ(1, cRays[0].get<int>());
+  EXPECT_DOUBLE_EQ(0, cRays[1].get<double>());
+  EXPECT_DOUBLE_EQ(1, cRays[5].get<double>());
+  EXPECT_EQ(0, cRays[7].get<int>());
+  EXPECT_DOUBLE_EQ(1, cRays[11].get<double>());
+
+  ASSERT_EQ(3u, cPoints.size());
+  EXPECT_DOUBLE_EQ(0.5, cPoints[1].get<double>());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityEntityEncoding, RaysSubsampled) {
+  std::vector<std::pair<bool, CRay3>> vecRays;
+  std::vector<CVector3> vecPoints;
+  for (int i = 0; i < 5; ++i) {
+    vecRays.push_back({false, CRay3(CVector3(0, 0, 0), CVector3(i, 0, 0))});
+    vecPoints.push_back(CVector3(i, 0, 0));
+  }
+  nlohmann::json cRays;
+  nlohmann::json cPoints;
+
+  CEntityEncoding::EncodeRays(
+    vecRays,
+    vecPoints,
+    CVector3(0, 0, 0),
+    CQuaternion(1, 0, 0, 0),
+    cRays,
+    cPoints,
+    2);
+
+  /* Rays and points 0, 2 and 4 */
+  ASSERT_EQ(3 * CEntityEncoding::RAY_STRIDE, cRays.size());
+  EXPECT_DOUBLE_EQ(2, cRays[CEntityEncoding::RAY_STRIDE + 4].get<double>());
+  ASSERT_EQ(9u, cPoints.size());
+  EXPECT_DOUBLE_EQ(4, cPoints[6].get<double>());
+};
@@ -0,0 +1,80 @@
+#include "plugins/simulator/visualizations/webviz/utility/FloorTexture.h"
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CFloorTexture;
+
+static std::vector<uint8_t> MakePixels(uint32_t un_width, uint32_t un_height) {
+  return std::vector<uint8_t>(un_width * un_height * 3, 0);
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFloorTexture, FirstUpdateIsFull) {
+  CFloorTexture cTexture(4);
+
+  auto vecDirty = cTexture.Update(16, 8, MakePixels(16, 8));
+
+  ASSERT_EQ(1u, vecDirty.size());
+  EXPECT_EQ(16u, vecDirty[0].m_unWidth);
+  EXPECT_EQ(8u, vecDirty[0].m_unHeight);
+  EXPECT_EQ(1u, cTexture.GetImage()->m_unVersion);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFloorTexture, OnlyChangedTiles) {
+  CFloorTexture cTexture(4);
+  cTexture.Update(16, 8, MakePixels(16, 8));
+
+  /* Unchanged, no patch and same version */
+  EXPECT_TRUE(cTexture.Update(16, 8, MakePixels(16, 8)).empty());
+  EXPECT_EQ(1u, cTexture.GetImage()->m_unVersion);
+
+  /* Pixels (5, 1) and (8, 1): two adjacent tiles of the first row */
+  std::vector<uint8_t> vecPixels = MakePixels(16, 8);
+  vecPixels[(1 * 16 + 5) * 3] = 255;
+  vecPixels[(1 * 16 + 8) * 3 + 2] = 255;
+  auto vecDirty = cTexture.Update(16, 8, std::move(vecPixels));
+
+  ASSERT_EQ(1u, vecDirty.size());
+  EXPECT_EQ(4u, vecDirty[0].m_unX);
+  EXPECT_EQ(0u, vecDirty[0].m_unY);
+  EXPECT_EQ(8u, vecDirty[0].m_unWidth);
+  EXPECT_EQ(4u, vecDirty[0].m_unHeight);
+  EXPECT_EQ(2u, cTexture.GetImage()->m_unVersion);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFloorTexture, PatchHeader) {
+  CFloorTexture cTexture(4);
+  cTexture.Update(16, 8, MakePixels(16, 8));
+  std::string strPatch;
+
+  ASSERT_TRUE(CFloorTexture::EncodePatch(
+    *cTexture.GetImage(), {4, 2, 8, 4}, &strPatch));
+
+  ASSERT_GT(strPatch.size(), CFloorTexture::HEADER_SIZE);
+  EXPECT_EQ(1, strPatch[0]);
+  EXPECT_EQ(4, strPatch[4]);
+  EXPECT_EQ(2, strPatch[6]);
+  EXPECT_EQ(8, strPatch[8]);
+  EXPECT_EQ(4, strPatch[10]);
+  EXPECT_EQ(16, strPatch[12]);
+  EXPECT_EQ(8, strPatch[14]);
+  EXPECT_EQ("PNG", strPatch.substr(CFloorTexture::HEADER_SIZE + 1, 3));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityFloorTexture, FitPixelsPerMeter) {
+  EXPECT_EQ(100u, CFloorTexture::FitPixelsPerMeter(10, 5, 100));
+  EXPECT_EQ(100u, CFloorTexture::FitPixelsPerMeter(1, 40.96, 100));
+  EXPECT_EQ(40u, CFloorTexture::FitPixelsPerMeter(50, 100, 1000));
+  EXPECT_EQ(1u, CFloorTexture::FitPixelsPerMeter(10000, 10, 100));
+};
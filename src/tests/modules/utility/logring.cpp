@@ -0,0 +1,138 @@
+#include "plugins/simulator/visualizations/webviz/utility/LogRing.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CLogRing;
+
+static CLogRing::SLine MakeLine(const std::string& str_text) {
+  CLogRing::SLine sLine;
+  sLine.m_strText = str_text;
+  return sLine;
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLogRing, FirstInFirstOut) {
+  CLogRing cRing(4);
+  CLogRing::SLine sLine;
+
+  EXPECT_FALSE(cRing.Pop(sLine));
+
+  CLogRing::SLine sError = MakeLine("<collision>");
+  sError.m_bError = true;
+  sError.m_unSteps = 42;
+  EXPECT_TRUE(cRing.Push(sError));
+  EXPECT_TRUE(cRing.Push(MakeLine("second")));
+
+  ASSERT_TRUE(cRing.Pop(sLine));
+  EXPECT_TRUE(sLine.m_bError);
+  EXPECT_EQ(42u, sLine.m_unSteps);
+  /* Kept raw */
+  EXPECT_EQ("<collision>", sLine.m_strText);
+  ASSERT_TRUE(cRing.Pop(sLine));
+  EXPECT_EQ("second", sLine.m_strText);
+  EXPECT_FALSE(cRing.Pop(sLine));
+  EXPECT_EQ(0u, cRing.GetDropped());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLogRing, DropsWhenFull) {
+  CLogRing cRing(3);
+  EXPECT_EQ(4u, cRing.GetCapacity());
+
+  for (int i = 0; i < 6; ++i) {
+    cRing.Push(MakeLine(std::to_string(i)));
+  }
+  EXPECT_EQ(2u, cRing.GetDropped());
+  EXPECT_EQ(4u, cRing.GetSize());
+
+  /* The oldest lines are kept, and the ring is usable again */
+  CLogRing::SLine sLine;
+  ASSERT_TRUE(cRing.Pop(sLine));
+  EXPECT_EQ("0", sLine.m_strText);
+  EXPECT_EQ(3u, cRing.GetSize());
+  EXPECT_TRUE(cRing.Push(MakeLine("6")));
+  for (const char* pchExpected : {"1", "2", "3", "6"}) {
+    ASSERT_TRUE(cRing.Pop(sLine));
+    EXPECT_EQ(pchExpected, sLine.m_strText);
+  }
+  EXPECT_FALSE(cRing.Pop(sLine));
+  EXPECT_EQ(0u, cRing.GetSize());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLogRing, RateLimit) {
+  CLogRing cRing(64, 3);
+
+  for (int i = 0; i < 5; ++i) {
+    cRing.Push(MakeLine("a"), 10);
+  }
+  EXPECT_EQ(2u, cRing.GetDropped());
+
+  /* Next second */
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(cRing.Push(MakeLine("b"), 11));
+  }
+  EXPECT_EQ(2u, cRing.GetDropped());
+
+  int nLines = 0;
+  CLogRing::SLine sLine;
+  while (cRing.Pop(sLine)) {
+    ++nLines;
+  }
+  EXPECT_EQ(5, nLines);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityLogRing, ManyProducers) {
+  const int nProducers = 4;
+  const int nLines = 2000;
+  CLogRing cRing(1024);
+
+  std::vector<std::thread> vecThreads;
+  for (int p = 0; p < nProducers; ++p) {
+    vecThreads.emplace_back([&cRing, p]() {
+      for (int i = 0; i < nLines; ++i) {
+        CLogRing::SLine sLine = MakeLine(std::to_string(i));
+        sLine.m_unSteps = p;
+        cRing.Push(std::move(sLine));
+      }
+    });
+  }
+
+  /* Consumed while produced, lines of a producer stay in order */
+  std::vector<int> vecLast(nProducers, -1);
+  uint64_t unReceived = 0;
+  CLogRing::SLine sLine;
+  auto fnDrain = [&]() {
+    while (cRing.Pop(sLine)) {
+      int nValue = std::stoi(sLine.m_strText);
+      EXPECT_GT(nValue, vecLast[sLine.m_unSteps]);
+      vecLast[sLine.m_unSteps] = nValue;
+      ++unReceived;
+    }
+  };
+  for (int i = 0; i < 1000; ++i) {
+    fnDrain();
+    std::this_thread::yield();
+  }
+  for (auto& cThread : vecThreads) {
+    cThread.join();
+  }
+  fnDrain();
+
+  EXPECT_EQ(
+    static_cast<uint64_t>(nProducers * nLines),
+    unReceived + cRing.GetDropped());
+};
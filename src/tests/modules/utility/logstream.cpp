@@ -1,6 +1,8 @@
 #include "plugins/simulator/visualizations/webviz/utility/LogStream.h"
 
 #include <sstream>  // std::stringstream
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -52,4 +54,32 @@ TEST(UtilityLogStream, OverflowFunction) {
   log->overflow('\n');
 
   delete log;
-};
\ No newline at end of file
+};
+/****************************************/
+/****************************************/
+
+TEST(UtilityLogStream, RawLines) {
+  std::stringstream ss;
+  std::vector<std::string> vecLines;
+
+  auto log = new argos::Webviz::CLogStream(
+    ss,
+    [&vecLines](std::string str_logData) {
+      vecLines.push_back(std::move(str_logData));
+    },
+    false);
+
+  /* Several lines in one write, and one across two writes */
+  ss << "<a>\nb\nc";
+  ss << "d\n";
+  delete log;
+
+  ASSERT_EQ(3u, vecLines.size());
+  EXPECT_EQ("<a>", vecLines[0]);
+  EXPECT_EQ("b", vecLines[1]);
+  EXPECT_EQ("cd", vecLines[2]);
+
+  std::string strLine = vecLines[0];
+  argos::Webviz::CLogStream::Escape(strLine);
+  EXPECT_EQ("&lt;a&gt;", strLine);
+};
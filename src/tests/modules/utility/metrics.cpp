@@ -0,0 +1,120 @@
+#include "plugins/simulator/visualizations/webviz/utility/Metrics.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CHistogram;
+using argos::Webviz::CMetrics;
+using argos::Webviz::CScopedTimer;
+
+TEST(UtilityMetrics, HistogramBuckets) {
+  CHistogram cHistogram;
+  cHistogram.Observe(0);
+  cHistogram.Observe(1);
+  cHistogram.Observe(2);
+  cHistogram.Observe(std::chrono::milliseconds(3));
+  cHistogram.Observe(std::chrono::seconds(60));
+
+  /* Upper bounds are inclusive */
+  EXPECT_EQ(2u, cHistogram.GetBucket(0));
+  EXPECT_EQ(1u, cHistogram.GetBucket(1));
+  /* 3000 micro-secs, in the 5000 one */
+  EXPECT_EQ(1u, cHistogram.GetBucket(10));
+  EXPECT_EQ(1u, cHistogram.GetBucket(CHistogram::BUCKETS));
+
+  EXPECT_EQ(5u, cHistogram.GetCount());
+  EXPECT_EQ(3u + 3000u + 60000000u, cHistogram.GetSum());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMetrics, ScopedTimer) {
+  CHistogram cHistogram;
+  {
+    CScopedTimer cTimer(cHistogram);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  EXPECT_EQ(1u, cHistogram.GetCount());
+  EXPECT_GE(cHistogram.GetSum(), 2000u);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMetrics, RenderPrometheus) {
+  CMetrics cMetrics;
+  CHistogram& cHistogram = cMetrics.AddHistogram("stage_seconds", "A stage");
+  cHistogram.Observe(4);
+  cHistogram.Observe(2000);
+
+  double fClients = 3;
+  cMetrics.AddGauge("clients", "Clients", [&]() { return fClients; });
+  cMetrics.AddCounter("dropped_total", "Dropped", []() { return 7.0; });
+
+  /* Same histogram for the same name */
+  EXPECT_EQ(&cHistogram, &cMetrics.AddHistogram("stage_seconds", "Again"));
+
+  std::string strText = cMetrics.Render();
+  auto fnHas = [&](const std::string& str_line) {
+    return strText.find(str_line) != std::string::npos;
+  };
+  EXPECT_TRUE(fnHas("# HELP stage_seconds A stage\n"));
+  EXPECT_TRUE(fnHas("# TYPE stage_seconds histogram\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_bucket{le=\"1e-06\"} 0\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_bucket{le=\"5e-06\"} 1\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_bucket{le=\"0.001\"} 1\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_bucket{le=\"0.0025\"} 2\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_bucket{le=\"+Inf\"} 2\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_sum 0.002004\n"));
+  EXPECT_TRUE(fnHas("stage_seconds_count 2\n"));
+
+  EXPECT_TRUE(fnHas("# TYPE clients gauge\nclients 3\n"));
+  EXPECT_TRUE(fnHas("# TYPE dropped_total counter\ndropped_total 7\n"));
+
+  /* Gauges are read when rendering */
+  fClients = 1;
+  EXPECT_NE(std::string::npos, cMetrics.Render().find("clients 1\n"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMetrics, ConcurrentObserve) {
+  CMetrics cMetrics;
+  CHistogram& cHistogram = cMetrics.AddHistogram("stage_seconds", "A stage");
+
+  std::vector<std::thread> vecThreads;
+  for (int i = 0; i < 4; ++i) {
+    vecThreads.emplace_back([&]() {
+      for (int j = 0; j < 10000; ++j) {
+        cHistogram.Observe(j % 100);
+      }
+    });
+  }
+  /* Rendering while observing */
+  for (int i = 0; i < 10; ++i) {
+    cMetrics.Render();
+  }
+  for (auto& tThread : vecThreads) {
+    tThread.join();
+  }
+
+  EXPECT_EQ(40000u, cHistogram.GetCount());
+  EXPECT_NE(
+    std::string::npos,
+    cMetrics.Render().find("stage_seconds_bucket{le=\"+Inf\"} 40000\n"));
+};
+
+TEST(UtilityMetrics, ResidentMemory) {
+  uint64_t unBefore = CMetrics::GetResidentMemory();
+  EXPECT_GT(unBefore, 0u);
+
+  /* Touched, so it is resident */
+  std::vector<char> vecBuffer(64 * 1024 * 1024, 1);
+  EXPECT_GE(CMetrics::GetResidentMemory(), unBefore + vecBuffer.size() / 2);
+};
@@ -0,0 +1,102 @@
+#include "plugins/simulator/visualizations/webviz/utility/MPSCQueue.h"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CMPSCQueue;
+
+TEST(UtilityMPSCQueue, FirstInFirstOut) {
+  CMPSCQueue<std::string> cQueue;
+  std::string strValue;
+
+  EXPECT_TRUE(cQueue.IsEmpty());
+  EXPECT_FALSE(cQueue.Pop(strValue));
+
+  cQueue.Push("play");
+  cQueue.Push("pause");
+
+  EXPECT_FALSE(cQueue.IsEmpty());
+  ASSERT_TRUE(cQueue.Pop(strValue));
+  EXPECT_EQ("play", strValue);
+  ASSERT_TRUE(cQueue.Pop(strValue));
+  EXPECT_EQ("pause", strValue);
+  EXPECT_FALSE(cQueue.Pop(strValue));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMPSCQueue, MoveOnlyAndLeftovers) {
+  /* Elements still queued are destroyed with the queue */
+  auto psShared = std::make_shared<int>(42);
+  {
+    CMPSCQueue<std::shared_ptr<int>> cQueue;
+    cQueue.Push(psShared);
+    cQueue.Push(psShared);
+    EXPECT_EQ(3, psShared.use_count());
+  }
+  EXPECT_EQ(1, psShared.use_count());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMPSCQueue, ManyProducers) {
+  const int nProducers = 4;
+  const int nPerProducer = 10000;
+  CMPSCQueue<std::pair<int, int>> cQueue;
+
+  std::vector<std::thread> vecProducers;
+  for (int p = 0; p < nProducers; ++p) {
+    vecProducers.emplace_back([&cQueue, p]() {
+      for (int i = 0; i < nPerProducer; ++i) {
+        cQueue.Push({p, i});
+      }
+    });
+  }
+
+  /* Order is kept for each producer */
+  std::vector<int> vecNext(nProducers, 0);
+  int nReceived = 0;
+  std::pair<int, int> cValue;
+  while (nReceived < nProducers * nPerProducer) {
+    if (cQueue.Pop(cValue)) {
+      EXPECT_EQ(vecNext[cValue.first], cValue.second);
+      vecNext[cValue.first] = cValue.second + 1;
+      ++nReceived;
+    } else {
+      cQueue.WaitFor(std::chrono::milliseconds(1));
+    }
+  }
+
+  for (auto& tProducer : vecProducers) {
+    tProducer.join();
+  }
+  EXPECT_TRUE(cQueue.IsEmpty());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityMPSCQueue, WaitForIsWokenUp) {
+  CMPSCQueue<int> cQueue;
+
+  /* Times out when nothing is pushed */
+  EXPECT_FALSE(cQueue.WaitFor(std::chrono::milliseconds(10)));
+
+  std::thread tProducer([&cQueue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    cQueue.Push(1);
+  });
+
+  auto tStart = std::chrono::steady_clock::now();
+  EXPECT_TRUE(cQueue.WaitFor(std::chrono::seconds(10)));
+  EXPECT_LT(std::chrono::steady_clock::now() - tStart, std::chrono::seconds(5));
+
+  tProducer.join();
+};
@@ -0,0 +1,56 @@
+#include "plugins/simulator/visualizations/webviz/utility/PNGEncoder.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeflate;
+using argos::Webviz::CPNGEncoder;
+
+static uint32_t ReadUInt32(const std::string& str_in, size_t un_offset) {
+  return static_cast<uint32_t>(static_cast<uint8_t>(str_in[un_offset])) << 24 |
+         static_cast<uint32_t>(static_cast<uint8_t>(str_in[un_offset + 1]))
+           << 16 |
+         static_cast<uint32_t>(static_cast<uint8_t>(str_in[un_offset + 2]))
+           << 8 |
+         static_cast<uint32_t>(static_cast<uint8_t>(str_in[un_offset + 3]));
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPNGEncoder, SignatureAndHeader) {
+  std::vector<uint8_t> vecPixels(3 * 4 * 2, 0x7f);
+  std::string strPNG;
+
+  ASSERT_TRUE(CPNGEncoder::Encode(vecPixels.data(), 4, 2, 12, &strPNG));
+
+  EXPECT_EQ(std::string("\x89PNG\r\n\x1a\n", 8), strPNG.substr(0, 8));
+  EXPECT_EQ(13u, ReadUInt32(strPNG, 8));
+  EXPECT_EQ("IHDR", strPNG.substr(12, 4));
+  EXPECT_EQ(4u, ReadUInt32(strPNG, 16));
+  EXPECT_EQ(2u, ReadUInt32(strPNG, 20));
+  EXPECT_EQ("IEND", strPNG.substr(strPNG.size() - 8, 4));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPNGEncoder, RegionOfALargerImage) {
+  /* 3x2 image, encode the right 2x2 region */
+  std::vector<uint8_t> vecPixels = {
+    1, 1, 1, 2, 2, 2, 3, 3, 3,  //
+    4, 4, 4, 5, 5, 5, 6, 6, 6};
+  std::string strPNG;
+
+  ASSERT_TRUE(CPNGEncoder::Encode(vecPixels.data() + 3, 2, 2, 9, &strPNG));
+
+  /* IDAT right after the 8 bytes signature and 25 bytes IHDR chunk */
+  uint32_t unLength = ReadUInt32(strPNG, 33);
+  EXPECT_EQ("IDAT", strPNG.substr(37, 4));
+
+  std::string strRaw;
+  ASSERT_TRUE(CDeflate::Inflate(strPNG.substr(41, unLength), &strRaw));
+  EXPECT_EQ(
+    std::string("\0\2\2\2\3\3\3\0\5\5\5\6\6\6", 14), strRaw);
+};
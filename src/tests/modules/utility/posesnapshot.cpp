@@ -0,0 +1,113 @@
+#include "plugins/simulator/visualizations/webviz/utility/PoseSnapshot.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+using argos::CQuaternion;
+using argos::CVector3;
+using argos::Webviz::CPoseSnapshot;
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPoseSnapshot, RoundTrip) {
+  CPoseSnapshot cSnapshot;
+  cSnapshot.SetArena(CVector3(0, 0, 1), CVector3(10, 20, 2));
+  cSnapshot.SetIndex(std::make_shared<CPoseSnapshot::SIndex>(
+    CPoseSnapshot::SIndex{7, {"fb0", "fb1"}}));
+  cSnapshot.SetSteps(42);
+  cSnapshot.Add(CVector3(1.25, -3.5, 0.5), CQuaternion(0.5, 0.5, 0.5, 0.5));
+  /* w, x, y, z */
+  cSnapshot.Add(CVector3(-4.9, 9.9, 1.5), CQuaternion(0.43589, -0.9, 0, 0));
+
+  std::string strData;
+  cSnapshot.Encode(&strData);
+  EXPECT_EQ(CPoseSnapshot::HEADER_SIZE + 2 * 10, strData.size());
+
+  std::vector<CPoseSnapshot::SPose> vecPoses;
+  uint32_t unIndexVersion = 0;
+  uint64_t unSteps = 0;
+  ASSERT_TRUE(
+    CPoseSnapshot::Decode(strData, &vecPoses, &unIndexVersion, &unSteps));
+  EXPECT_EQ(7u, unIndexVersion);
+  EXPECT_EQ(42u, unSteps);
+  ASSERT_EQ(2u, vecPoses.size());
+
+  /* A 20m range in 16 bits */
+  EXPECT_NEAR(1.25, vecPoses[0].m_fX, 1e-3);
+  EXPECT_NEAR(-3.5, vecPoses[0].m_fY, 1e-3);
+  EXPECT_NEAR(0.5, vecPoses[0].m_fZ, 1e-3);
+  EXPECT_NEAR(-4.9, vecPoses[1].m_fX, 1e-3);
+  EXPECT_NEAR(9.9, vecPoses[1].m_fY, 1e-3);
+  EXPECT_NEAR(1.5, vecPoses[1].m_fZ, 1e-3);
+
+  EXPECT_NEAR(0.5, vecPoses[0].m_fQX, 2e-3);
+  EXPECT_NEAR(0.5, vecPoses[0].m_fQW, 2e-3);
+
+  /* Negated, for the largest component (x) to be positive */
+  EXPECT_NEAR(0.9, vecPoses[1].m_fQX, 2e-3);
+  EXPECT_NEAR(0.0, vecPoses[1].m_fQY, 2e-3);
+  EXPECT_NEAR(0.43589, -vecPoses[1].m_fQW, 2e-3);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPoseSnapshot, PlanarSwarm) {
+  CPoseSnapshot cSnapshot;
+  cSnapshot.SetArena(CVector3(0, 0, 1), CVector3(100, 100, 2));
+
+  /* 10k ground robots */
+  cSnapshot.Reserve(10000);
+  for (int i = 0; i < 10000; ++i) {
+    cSnapshot.Add(
+      CVector3(i % 100 - 49.5, i / 100 - 49.5, 0),
+      CQuaternion(std::cos(i * 0.01), 0, 0, std::sin(i * 0.01)));
+  }
+
+  std::string strData;
+  cSnapshot.Encode(&strData);
+  EXPECT_EQ(CPoseSnapshot::HEADER_SIZE + 10000 * 8, strData.size());
+  EXPECT_LT(strData.size(), 100u * 1000);
+
+  std::vector<CPoseSnapshot::SPose> vecPoses;
+  ASSERT_TRUE(CPoseSnapshot::Decode(strData, &vecPoses));
+  ASSERT_EQ(10000u, vecPoses.size());
+  EXPECT_FLOAT_EQ(0.0f, vecPoses[1234].m_fZ);
+  EXPECT_NEAR(34 - 49.5, vecPoses[1234].m_fX, 2e-3);
+  EXPECT_NEAR(12 - 49.5, vecPoses[1234].m_fY, 2e-3);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPoseSnapshot, OutsideArenaIsClamped) {
+  CPoseSnapshot cSnapshot;
+  cSnapshot.SetArena(CVector3(0, 0, 0), CVector3(2, 2, 2));
+  cSnapshot.Add(CVector3(5, -5, 0), CQuaternion());
+
+  std::string strData;
+  cSnapshot.Encode(&strData);
+
+  std::vector<CPoseSnapshot::SPose> vecPoses;
+  ASSERT_TRUE(CPoseSnapshot::Decode(strData, &vecPoses));
+  EXPECT_NEAR(1.0, vecPoses[0].m_fX, 1e-4);
+  EXPECT_NEAR(-1.0, vecPoses[0].m_fY, 1e-4);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityPoseSnapshot, RejectsTruncated) {
+  CPoseSnapshot cSnapshot;
+  cSnapshot.Add(CVector3(), CQuaternion());
+
+  std::string strData;
+  cSnapshot.Encode(&strData);
+  strData.pop_back();
+
+  std::vector<CPoseSnapshot::SPose> vecPoses;
+  EXPECT_FALSE(CPoseSnapshot::Decode(strData, &vecPoses));
+  EXPECT_FALSE(CPoseSnapshot::Decode("POSE", &vecPoses));
+};
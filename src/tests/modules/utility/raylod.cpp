@@ -0,0 +1,99 @@
+#include "plugins/simulator/visualizations/webviz/utility/RayLOD.h"
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CRayLOD;
+using nlohmann::json;
+
+TEST(UtilityRayLOD, DefaultIsFull) {
+  CRayLOD cLOD;
+
+  EXPECT_TRUE(cLOD.IsFull());
+  EXPECT_TRUE(cLOD.WantsRaysOf("fb0"));
+  EXPECT_TRUE(cLOD.IsRayFrame(3));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRayLOD, Update) {
+  CRayLOD cLOD;
+  cLOD.Update({{"ids", {"fb0"}}, {"every_frame", 3}});
+
+  EXPECT_FALSE(cLOD.IsFull());
+  EXPECT_TRUE(cLOD.WantsRaysOf("fb0"));
+  EXPECT_FALSE(cLOD.WantsRaysOf("fb1"));
+  EXPECT_TRUE(cLOD.IsRayFrame(6));
+  EXPECT_FALSE(cLOD.IsRayFrame(7));
+
+  /* Other settings are kept */
+  cLOD.Update({{"enabled", false}});
+  EXPECT_FALSE(cLOD.WantsRaysOf("fb0"));
+  EXPECT_EQ(3u, cLOD.GetEveryFrame());
+
+  cLOD.Update({{"enabled", true}, {"ids", nullptr}, {"every_frame", 1}});
+  EXPECT_TRUE(cLOD.IsFull());
+
+  /* Invalid settings leave it untouched */
+  EXPECT_THROW(
+    cLOD.Update({{"enabled", false}, {"every_ray", 0}}), std::out_of_range);
+  EXPECT_THROW(cLOD.Update({{"ids", "fb0"}}), json::exception);
+  EXPECT_TRUE(cLOD.IsFull());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRayLOD, Merge) {
+  CRayLOD cFirst;
+  cFirst.Update({{"ids", {"fb0"}}, {"every_frame", 2}, {"every_ray", 4}});
+  CRayLOD cSecond;
+  cSecond.Update({{"ids", {"fb1"}}, {"every_ray", 6}});
+
+  CRayLOD cWanted = CRayLOD::None();
+  EXPECT_FALSE(cWanted.WantsRaysOf("fb0"));
+
+  cWanted.Merge(cFirst);
+  cWanted.Merge(cSecond);
+  cWanted.Merge(CRayLOD::None());
+  EXPECT_TRUE(cWanted.WantsRaysOf("fb0"));
+  EXPECT_TRUE(cWanted.WantsRaysOf("fb1"));
+  EXPECT_FALSE(cWanted.WantsRaysOf("fb2"));
+  EXPECT_EQ(1u, cWanted.GetEveryFrame());
+  EXPECT_EQ(2u, cWanted.GetEveryRay());
+
+  cWanted.Merge(CRayLOD());
+  EXPECT_TRUE(cWanted.WantsRaysOf("fb2"));
+  EXPECT_EQ(1u, cWanted.GetEveryRay());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRayLOD, Decimate) {
+  json cPoints = {0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4};
+
+  CRayLOD::Decimate(cPoints, 3, 2);
+
+  EXPECT_EQ(json({0, 0, 0, 2, 2, 2, 4, 4, 4}), cPoints);
+
+  CRayLOD::Decimate(cPoints, 3, 1);
+  EXPECT_EQ(9u, cPoints.size());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRayLOD, ToJSON) {
+  CRayLOD cLOD;
+  cLOD.Update({{"ids", {"fb0"}}, {"every_ray", 4}});
+
+  CRayLOD cRead = CRayLOD::None();
+  cRead.Update(cLOD.ToJSON());
+  EXPECT_TRUE(cLOD == cRead);
+
+  cRead.Update(CRayLOD().ToJSON());
+  EXPECT_TRUE(cRead.IsFull());
+};
@@ -0,0 +1,57 @@
+#include "plugins/simulator/visualizations/webviz/utility/Recorder.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CRecorder;
+using argos::Webviz::CRecordingWriter;
+using nlohmann::json;
+
+static CRecorder::TState MakeState(int n_steps) {
+  return std::make_shared<const json>(json{
+    {"type", "broadcast"},
+    {"steps", n_steps},
+    {"entities", {{{"id", "fb0"}, {"x", n_steps}}}}});
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecorder, WritesEveryPushedState) {
+  std::string strPath = testing::TempDir() + "webviz_recorder.wvzr";
+
+  CRecorder cRecorder(4);
+  ASSERT_TRUE(cRecorder.Start(strPath));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(cRecorder.Push(MakeState(i)));
+  }
+  cRecorder.Stop();
+
+  EXPECT_EQ(10u, cRecorder.GetWritten());
+  EXPECT_EQ(0u, cRecorder.GetDropped());
+  EXPECT_FALSE(cRecorder.HasFailed());
+
+  /* Nothing is accepted once stopped */
+  EXPECT_FALSE(cRecorder.Push(MakeState(10)));
+  EXPECT_EQ(1u, cRecorder.GetDropped());
+  std::remove(strPath.c_str());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecorder, DropsWhenTooFarBehind) {
+  std::string strPath = testing::TempDir() + "webviz_recorder_drop.wvzr";
+
+  CRecorder cRecorder(4, 0);
+  ASSERT_TRUE(cRecorder.Start(strPath));
+  EXPECT_FALSE(cRecorder.Push(MakeState(0)));
+  cRecorder.Stop();
+
+  EXPECT_EQ(0u, cRecorder.GetWritten());
+  EXPECT_EQ(1u, cRecorder.GetDropped());
+  std::remove(strPath.c_str());
+};
@@ -0,0 +1,172 @@
+#include "plugins/simulator/visualizations/webviz/utility/Recording.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeflate;
+using argos::Webviz::CRecordingFormat;
+using argos::Webviz::CRecordingReader;
+using argos::Webviz::CRecordingWriter;
+using nlohmann::json;
+
+static std::string ReadFile(const std::string& str_path) {
+  std::ifstream cFile(str_path, std::ios::binary);
+  return std::string(
+    std::istreambuf_iterator<char>(cFile), std::istreambuf_iterator<char>());
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, LittleEndian) {
+  char pchBuffer[8];
+
+  CRecordingFormat::Put32(pchBuffer, 0x01020304u);
+  EXPECT_EQ(0x04, pchBuffer[0]);
+  EXPECT_EQ(0x01020304u, CRecordingFormat::Get32(pchBuffer));
+
+  CRecordingFormat::Put64(pchBuffer, 0xf102030405060708ull);
+  EXPECT_EQ(0xf102030405060708ull, CRecordingFormat::Get64(pchBuffer));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, WritesRecordsAndIndex) {
+  std::string strPath = testing::TempDir() + "webviz_recording.wvzr";
+  json cKeyframe = {
+    {"keyframe", true}, {"sequence", 1}, {"steps", 10}, {"entities", {}}};
+  json cDelta = {{"keyframe", false}, {"sequence", 2}, {"steps", 11}};
+
+  CRecordingWriter cWriter;
+  ASSERT_TRUE(cWriter.Open(strPath));
+  ASSERT_TRUE(cWriter.Append(cKeyframe));
+  ASSERT_TRUE(cWriter.Append(cDelta));
+  ASSERT_EQ(1u, cWriter.GetIndex().size());
+  ASSERT_TRUE(cWriter.Close());
+
+  std::string strFile = ReadFile(strPath);
+  std::remove(strPath.c_str());
+  ASSERT_GT(strFile.size(), CRecordingFormat::FILE_HEADER_SIZE);
+  EXPECT_EQ("WVZREC01", strFile.substr(0, 8));
+
+  /* First record */
+  const char* pchRecord = strFile.data() + CRecordingFormat::FILE_HEADER_SIZE;
+  auto sHeader = CRecordingFormat::GetRecordHeader(pchRecord);
+  EXPECT_EQ(1u, sHeader.m_unSequence);
+  EXPECT_EQ(10u, sHeader.m_unSteps);
+  EXPECT_EQ(CRecordingFormat::FLAG_KEYFRAME, sHeader.m_unFlags);
+
+  std::string strRaw;
+  ASSERT_TRUE(CDeflate::Inflate(
+    std::string(
+      pchRecord + CRecordingFormat::RECORD_HEADER_SIZE, sHeader.m_unSize),
+    &strRaw));
+  EXPECT_EQ(sHeader.m_unRawSize, strRaw.size());
+  EXPECT_EQ(cKeyframe, json::from_msgpack(strRaw));
+
+  /* Second record is a delta */
+  pchRecord += CRecordingFormat::RECORD_HEADER_SIZE + sHeader.m_unSize;
+  EXPECT_EQ(0u, CRecordingFormat::GetRecordHeader(pchRecord).m_unFlags);
+
+  /* Trailer points to the index of the only keyframe */
+  const char* pchTrailer =
+    strFile.data() + strFile.size() - CRecordingFormat::TRAILER_SIZE;
+  EXPECT_EQ("WVZRIDX1", std::string(pchTrailer + 16, 8));
+  EXPECT_EQ(1u, CRecordingFormat::Get64(pchTrailer));
+  const char* pchIndex =
+    strFile.data() + CRecordingFormat::Get64(pchTrailer + 8);
+  EXPECT_EQ(
+    CRecordingFormat::FILE_HEADER_SIZE, CRecordingFormat::Get64(pchIndex));
+  EXPECT_EQ(1u, CRecordingFormat::Get64(pchIndex + 8));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, OpenFails) {
+  CRecordingWriter cWriter;
+
+  EXPECT_FALSE(cWriter.Open("/nonexistent/directory/recording.wvzr"));
+  EXPECT_FALSE(cWriter.Append(json::object()));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, ReadsRecordsThroughIndex) {
+  std::string strPath = testing::TempDir() + "webviz_recording_read.wvzr";
+  json cKeyframe = {
+    {"keyframe", true}, {"sequence", 1}, {"steps", 10}, {"entities", {}}};
+  json cDelta = {{"keyframe", false}, {"sequence", 2}, {"steps", 11}};
+  {
+    CRecordingWriter cWriter;
+    ASSERT_TRUE(cWriter.Open(strPath));
+    ASSERT_TRUE(cWriter.Append(cKeyframe));
+    ASSERT_TRUE(cWriter.Append(cDelta));
+  }
+
+  CRecordingReader cReader;
+  ASSERT_TRUE(cReader.Open(strPath));
+  std::remove(strPath.c_str());
+  EXPECT_TRUE(cReader.HasIndex());
+  ASSERT_EQ(1u, cReader.GetIndex().size());
+  EXPECT_EQ(11u, cReader.GetLastSteps());
+
+  CRecordingFormat::SRecordHeader sHeader;
+  json cFrame;
+  uint64_t unNext =
+    cReader.ReadRecord(cReader.GetIndex()[0].m_unOffset, &sHeader, &cFrame);
+  ASSERT_NE(0u, unNext);
+  EXPECT_EQ(cKeyframe, cFrame);
+  unNext = cReader.ReadRecord(unNext, &sHeader, &cFrame);
+  EXPECT_EQ(cDelta, cFrame);
+  EXPECT_EQ(cReader.GetEnd(), unNext);
+  EXPECT_EQ(0u, cReader.ReadRecord(unNext, &sHeader, &cFrame));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, ScansUnclosedRecording) {
+  std::string strPath = testing::TempDir() + "webviz_recording_scan.wvzr";
+  std::string strFile;
+  {
+    CRecordingWriter cWriter;
+    ASSERT_TRUE(cWriter.Open(strPath));
+    ASSERT_TRUE(cWriter.Append({{"keyframe", true}, {"steps", 1}}));
+    ASSERT_TRUE(cWriter.Append({{"keyframe", false}, {"steps", 2}}));
+    ASSERT_TRUE(cWriter.Append({{"keyframe", true}, {"steps", 3}}));
+  }
+  strFile = ReadFile(strPath);
+
+  /* No trailer, and the last record cut in the middle */
+  size_t unIndexSize =
+    2 * CRecordingFormat::INDEX_ENTRY_SIZE + CRecordingFormat::TRAILER_SIZE;
+  std::ofstream(strPath, std::ios::binary | std::ios::trunc)
+    << strFile.substr(0, strFile.size() - unIndexSize - 3);
+
+  CRecordingReader cReader;
+  ASSERT_TRUE(cReader.Open(strPath));
+  std::remove(strPath.c_str());
+  EXPECT_FALSE(cReader.HasIndex());
+  ASSERT_EQ(1u, cReader.GetIndex().size());
+  EXPECT_EQ(2u, cReader.GetLastSteps());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRecording, ReadFails) {
+  std::string strPath = testing::TempDir() + "webviz_recording_bad.wvzr";
+  std::ofstream(strPath, std::ios::binary) << "not a recording at all";
+
+  CRecordingReader cReader;
+  EXPECT_FALSE(cReader.Open(strPath));
+  EXPECT_FALSE(cReader.Open("/nonexistent/recording.wvzr"));
+  std::remove(strPath.c_str());
+};
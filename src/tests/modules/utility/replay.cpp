@@ -0,0 +1,141 @@
+#include "plugins/simulator/visualizations/webviz/utility/Replay.h"
+
+#include <cstdio>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeltaEncoder;
+using argos::Webviz::CRecordingWriter;
+using argos::Webviz::CReplay;
+using nlohmann::json;
+
+/** Recording of one entity moving by 1 every 10 steps, up to 200 steps */
+static std::string WriteRecording(const std::string& str_name) {
+  std::string strPath = testing::TempDir() + str_name;
+  CDeltaEncoder cEncoder(5);
+  CRecordingWriter cWriter;
+  EXPECT_TRUE(cWriter.Open(strPath));
+  for (int i = 0; i <= 20; ++i) {
+    json cState = {
+      {"steps", i * 10},
+      {"entities", {{{"id", "fb0"}, {"position", {{"x", i}}}}}}};
+    EXPECT_TRUE(cWriter.Append(cEncoder.Encode(cState)));
+  }
+  return strPath;
+}
+
+static int GetX(const CReplay& c_replay) {
+  return c_replay.GetState()["entities"][0]["position"]["x"].get<int>();
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityReplay, StepsThroughFrames) {
+  std::string strPath = WriteRecording("webviz_replay_step.wvzr");
+  CReplay cReplay;
+  ASSERT_TRUE(cReplay.Open(strPath));
+  std::remove(strPath.c_str());
+
+  EXPECT_EQ(0u, cReplay.GetFirstSteps());
+  EXPECT_EQ(200u, cReplay.GetLastSteps());
+  EXPECT_EQ(0, GetX(cReplay));
+
+  for (int i = 1; i <= 20; ++i) {
+    ASSERT_TRUE(cReplay.Step());
+    EXPECT_EQ(i, GetX(cReplay));
+  }
+  EXPECT_TRUE(cReplay.IsAtEnd());
+  EXPECT_FALSE(cReplay.Step());
+
+  ASSERT_TRUE(cReplay.Rewind());
+  EXPECT_EQ(0, GetX(cReplay));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityReplay, AdvancesWithTheClock) {
+  std::string strPath = WriteRecording("webviz_replay_advance.wvzr");
+  CReplay cReplay;
+  ASSERT_TRUE(cReplay.Open(strPath));
+  std::remove(strPath.c_str());
+
+  /* Frame 10 steps apart: the state holds between them */
+  EXPECT_EQ(0u, cReplay.Advance(9));
+  EXPECT_EQ(0, GetX(cReplay));
+  EXPECT_EQ(1u, cReplay.Advance(1));
+  EXPECT_EQ(1, GetX(cReplay));
+  EXPECT_EQ(3u, cReplay.Advance(35));
+  EXPECT_EQ(4, GetX(cReplay));
+  EXPECT_EQ(45u, cReplay.GetClock());
+  EXPECT_EQ(40u, cReplay.GetFrameSteps());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityReplay, SeeksFromKeyframes) {
+  std::string strPath = WriteRecording("webviz_replay_seek.wvzr");
+  CReplay cReplay;
+  ASSERT_TRUE(cReplay.Open(strPath));
+  std::remove(strPath.c_str());
+
+  /* Keyframes every 5 frames, this one is between two of them */
+  ASSERT_TRUE(cReplay.Seek(137));
+  EXPECT_EQ(13, GetX(cReplay));
+  EXPECT_EQ(130u, cReplay.GetFrameSteps());
+
+  /* Backwards, and after the end */
+  ASSERT_TRUE(cReplay.Seek(20));
+  EXPECT_EQ(2, GetX(cReplay));
+  ASSERT_TRUE(cReplay.Seek(1000));
+  EXPECT_EQ(20, GetX(cReplay));
+  EXPECT_TRUE(cReplay.IsAtEnd());
+
+  /* Same state as going through every frame */
+  ASSERT_TRUE(cReplay.Seek(60));
+  json cSeeked = cReplay.GetState();
+  ASSERT_TRUE(cReplay.Rewind());
+  cReplay.Advance(60);
+  EXPECT_EQ(cSeeked, cReplay.GetState());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityReplay, OpenFails) {
+  CReplay cReplay;
+
+  EXPECT_FALSE(cReplay.Open("/nonexistent/recording.wvzr"));
+  EXPECT_FALSE(cReplay.Seek(0));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityReplay, RefusesChanges) {
+  json cAck = {{"type", "ack"}, {"ok", true}};
+
+  EXPECT_TRUE(CReplay::RefuseCommand(
+    {{"command", "moveEntity"},
+     {"entity_id", "fb0"},
+     {"position", {{"x", 0}, {"y", 0}, {"z", 0}}}},
+    cAck));
+  EXPECT_FALSE(cAck["ok"].get<bool>());
+  EXPECT_TRUE(cAck.contains("error"));
+
+  cAck = {{"type", "ack"}, {"ok", true}};
+  EXPECT_TRUE(CReplay::RefuseCommand(
+    {{"command", "batch"}, {"operations", json::array()}}, cAck));
+  EXPECT_FALSE(cAck["ok"].get<bool>());
+
+  /* Controls of the replay itself, and user commands */
+  for (const char* pchCommand : {"play", "pause", "seek", "requestKeyframe"}) {
+    cAck = {{"type", "ack"}, {"ok", true}};
+    EXPECT_FALSE(CReplay::RefuseCommand({{"command", pchCommand}}, cAck));
+    EXPECT_TRUE(cAck["ok"].get<bool>());
+  }
+  EXPECT_FALSE(CReplay::RefuseCommand({{"custom", 1}}, cAck));
+};
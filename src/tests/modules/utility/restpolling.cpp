@@ -0,0 +1,126 @@
+#include "plugins/simulator/visualizations/webviz/utility/RestPolling.h"
+
+#include "gtest/gtest.h"
+#include "plugins/simulator/visualizations/webviz/utility/BroadcastMask.h"
+#include "plugins/simulator/visualizations/webviz/utility/ResumeCache.h"
+
+using argos::Webviz::CBroadcastMask;
+using argos::Webviz::CDeltaEncoder;
+using argos::Webviz::CRestPolling;
+using argos::Webviz::CResumeCache;
+
+namespace {
+  /* Like the frames of the webserver */
+  struct SFrame {
+    uint64_t m_unSequence;
+    std::shared_ptr<const nlohmann::json> m_psJSON;
+    bool m_bComplete;
+  };
+
+  /* State of the simulation, with the fields a mask can leave out */
+  nlohmann::json MakeState(int n_steps, bool b_complete) {
+    nlohmann::json cRobot;
+    cRobot["id"] = "fb0";
+    cRobot["type"] = "foot-bot";
+    cRobot["position"]["x"] = n_steps;
+    if (b_complete) {
+      cRobot["leds"] = {n_steps, 2, 3};
+    }
+
+    nlohmann::json cState;
+    cState["type"] = "broadcast";
+    cState["steps"] = n_steps;
+    cState["entities"].push_back(cRobot);
+    return cState;
+  }
+
+  /* Encodes and caches a state, as the broadcaster does */
+  void Broadcast(
+    CDeltaEncoder& c_encoder,
+    CResumeCache<SFrame>& c_cache,
+    int n_steps,
+    bool b_complete) {
+    auto psJSON = std::make_shared<const nlohmann::json>(
+      c_encoder.Encode(MakeState(n_steps, b_complete)));
+    bool bKeyframe = psJSON->value("keyframe", true);
+    auto psFrame = std::make_shared<SFrame>(
+      SFrame{psJSON->value("sequence", 0ull), psJSON, b_complete});
+    c_cache.Add(psFrame, bKeyframe, nullptr, [&]() {
+      auto psKeyframe =
+        std::make_shared<const nlohmann::json>(c_encoder.GetKeyframe());
+      return std::make_shared<SFrame>(SFrame{
+        psKeyframe->value("sequence", 0ull), psKeyframe, b_complete});
+    });
+  }
+
+  /* What a REST request reads */
+  bool Read(const CResumeCache<SFrame>& c_cache, nlohmann::json* c_state) {
+    std::vector<std::shared_ptr<const SFrame>> vecFrames;
+    uint64_t unSequence;
+    if (!c_cache.GetLatest(&vecFrames, &unSequence)) {
+      return false;
+    }
+    return CRestPolling::Rebuild(vecFrames, c_state);
+  }
+}  // namespace
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRestPolling, CompleteStatesAreServed) {
+  CRestPolling cPolling;
+  auto cNow = CRestPolling::TClock::now();
+
+  /* Nobody filters, nothing more is generated */
+  EXPECT_TRUE(cPolling.OnRequest(true, cNow));
+  EXPECT_FALSE(cPolling.IsRequired(cNow));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRestPolling, RequiredWhilePolled) {
+  CRestPolling cPolling(std::chrono::milliseconds(100));
+  auto cNow = CRestPolling::TClock::now();
+
+  EXPECT_FALSE(cPolling.OnRequest(false, cNow));
+  EXPECT_TRUE(cPolling.IsRequired(cNow));
+
+  /* Complete states keep it required while polled */
+  cNow += std::chrono::milliseconds(80);
+  EXPECT_TRUE(cPolling.OnRequest(true, cNow));
+  cNow += std::chrono::milliseconds(80);
+  EXPECT_TRUE(cPolling.IsRequired(cNow));
+
+  /* Back to what the websocket clients want */
+  cNow += std::chrono::milliseconds(30);
+  EXPECT_FALSE(cPolling.IsRequired(cNow));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityRestPolling, ReadWhileAMaskedClientIsConnected) {
+  CDeltaEncoder cEncoder(10);
+  CResumeCache<SFrame> cCache;
+  CRestPolling cPolling;
+  nlohmann::json cState;
+
+  /* The only websocket client does not want the leds */
+  CBroadcastMask cMask = CBroadcastMask::FromJSON(
+    R"({"types": ["foot-bot"], "fields": ["position"]})"_json);
+  Broadcast(cEncoder, cCache, 1, cMask.IsEmpty());
+  Broadcast(cEncoder, cCache, 2, cMask.IsEmpty());
+
+  /* Not served without the leds, everything is generated next */
+  EXPECT_FALSE(cPolling.OnRequest(Read(cCache, &cState)));
+  EXPECT_FALSE(cState["entities"][0].contains("leds"));
+  EXPECT_TRUE(cPolling.IsRequired());
+
+  /* A delta with everything completes the state */
+  Broadcast(cEncoder, cCache, 3, CBroadcastMask().IsEmpty());
+  EXPECT_TRUE(cPolling.OnRequest(Read(cCache, &cState)));
+  EXPECT_EQ(3, cState["steps"].get<int>());
+  EXPECT_EQ(3, cState["entities"][0]["leds"][0].get<int>());
+  EXPECT_FALSE(cState.contains("keyframe"));
+};
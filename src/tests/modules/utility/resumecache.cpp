@@ -0,0 +1,161 @@
+#include "plugins/simulator/visualizations/webviz/utility/ResumeCache.h"
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CResumeCache;
+
+namespace {
+  struct SFrame {
+    uint64_t m_unSequence;
+  };
+
+  using TCache = CResumeCache<SFrame>;
+
+  TCache::TFrame MakeFrame(uint64_t un_sequence) {
+    return std::make_shared<const SFrame>(SFrame{un_sequence});
+  }
+
+  /** Sequences of the frames a client gets */
+  std::vector<uint64_t> GetSequences(
+    const TCache& c_cache, bool b_resume, uint64_t un_sequence) {
+    std::vector<TCache::TFrame> vecFrames;
+    uint64_t unLast = 0;
+    std::vector<uint64_t> vecSequences;
+    if (c_cache.Get(b_resume, un_sequence, &vecFrames, &unLast)) {
+      for (const auto& psFrame : vecFrames) {
+        vecSequences.push_back(psFrame->m_unSequence);
+      }
+    }
+    return vecSequences;
+  }
+}  // namespace
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityResumeCache, WaitsForKeyframe) {
+  TCache cCache(4);
+  std::vector<TCache::TFrame> vecFrames;
+  uint64_t unLast = 0;
+
+  EXPECT_FALSE(cCache.Get(false, 0, &vecFrames, &unLast));
+
+  /* Deltas without a keyframe are ignored */
+  cCache.Add(MakeFrame(1), false, nullptr, []() { return nullptr; });
+  EXPECT_FALSE(cCache.Get(false, 0, &vecFrames, &unLast));
+
+  cCache.Add(MakeFrame(2), true, nullptr, []() { return nullptr; });
+  cCache.Add(MakeFrame(3), false, nullptr, []() { return nullptr; });
+  ASSERT_TRUE(cCache.Get(false, 0, &vecFrames, &unLast));
+  EXPECT_EQ(3u, unLast);
+  EXPECT_EQ(std::vector<uint64_t>({2, 3}), GetSequences(cCache, false, 0));
+
+  cCache.Invalidate();
+  EXPECT_FALSE(cCache.Get(false, 0, &vecFrames, &unLast));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityResumeCache, Invalidate) {
+  TCache cCache(4);
+  std::vector<TCache::TFrame> vecFrames;
+  uint64_t unLast = 0;
+  EXPECT_FALSE(cCache.GetLatest(&vecFrames, &unLast));
+
+  cCache.Add(MakeFrame(1), true, nullptr, []() { return nullptr; });
+  cCache.Add(MakeFrame(2), false, nullptr, []() { return nullptr; });
+  cCache.Invalidate();
+
+  /* Until the next keyframe, even with more deltas */
+  cCache.Add(MakeFrame(3), false, nullptr, []() { return nullptr; });
+  EXPECT_FALSE(cCache.Get(true, 2, &vecFrames, &unLast));
+
+  /* Still the latest state */
+  ASSERT_TRUE(cCache.GetLatest(&vecFrames, &unLast));
+  EXPECT_EQ(3u, unLast);
+  ASSERT_EQ(3u, vecFrames.size());
+  EXPECT_EQ(1u, vecFrames.front()->m_unSequence);
+  EXPECT_EQ(3u, vecFrames.back()->m_unSequence);
+
+  cCache.Add(MakeFrame(4), true, nullptr, []() { return nullptr; });
+  EXPECT_EQ(std::vector<uint64_t>({4}), GetSequences(cCache, false, 0));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityResumeCache, Resume) {
+  TCache cCache(4);
+  cCache.Add(MakeFrame(1), true, nullptr, []() { return nullptr; });
+  for (uint64_t i = 2; i <= 4; ++i) {
+    cCache.Add(MakeFrame(i), false, nullptr, []() { return nullptr; });
+  }
+
+  /* Only what it missed */
+  EXPECT_EQ(std::vector<uint64_t>({3, 4}), GetSequences(cCache, true, 2));
+  EXPECT_EQ(std::vector<uint64_t>({2, 3, 4}), GetSequences(cCache, true, 1));
+
+  /* Up to date */
+  std::vector<TCache::TFrame> vecFrames;
+  uint64_t unLast = 0;
+  bool bResumed = false;
+  ASSERT_TRUE(cCache.Get(true, 4, &vecFrames, &unLast, &bResumed));
+  EXPECT_TRUE(vecFrames.empty());
+  EXPECT_TRUE(bResumed);
+  EXPECT_EQ(4u, unLast);
+
+  /* Ahead of the cache, from another run */
+  ASSERT_TRUE(cCache.Get(true, 9, &vecFrames, &unLast, &bResumed));
+  EXPECT_FALSE(bResumed);
+  EXPECT_EQ(
+    std::vector<uint64_t>({1, 2, 3, 4}), GetSequences(cCache, true, 9));
+
+  /* A keyframe starts over */
+  cCache.Add(MakeFrame(5), true, nullptr, []() { return nullptr; });
+  EXPECT_EQ(std::vector<uint64_t>({5}), GetSequences(cCache, true, 3));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityResumeCache, KeepsDeltasAfterKeyframe) {
+  TCache cCache(3);
+  unsigned int unMade = 0;
+  auto fnMakeKeyframe = [&unMade]() {
+    ++unMade;
+    /* Same state as the frame just added */
+    return MakeFrame(0);
+  };
+
+  cCache.Add(MakeFrame(1), true, nullptr, fnMakeKeyframe);
+  for (uint64_t i = 2; i <= 4; ++i) {
+    cCache.Add(MakeFrame(i), false, nullptr, fnMakeKeyframe);
+  }
+  EXPECT_EQ(0u, unMade);
+
+  /* Delta 2 would be dropped, a keyframe of 5 is made */
+  unMade = 0;
+  cCache.Add(MakeFrame(5), false, nullptr, [&unMade]() {
+    ++unMade;
+    return MakeFrame(5);
+  });
+  EXPECT_EQ(1u, unMade);
+  EXPECT_EQ(std::vector<uint64_t>({5}), GetSequences(cCache, false, 0));
+  /* Older deltas are still kept for the clients which resume */
+  EXPECT_EQ(std::vector<uint64_t>({4, 5}), GetSequences(cCache, true, 3));
+  EXPECT_EQ(std::vector<uint64_t>({5}), GetSequences(cCache, true, 1));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityResumeCache, NewerKeyframe) {
+  TCache cCache(8);
+  cCache.Add(MakeFrame(1), true, nullptr, []() { return nullptr; });
+  cCache.Add(MakeFrame(2), false, nullptr, []() { return nullptr; });
+  cCache.Add(MakeFrame(3), false, MakeFrame(3), []() { return nullptr; });
+
+  EXPECT_EQ(std::vector<uint64_t>({3}), GetSequences(cCache, false, 0));
+  EXPECT_EQ(std::vector<uint64_t>({2, 3}), GetSequences(cCache, true, 1));
+};
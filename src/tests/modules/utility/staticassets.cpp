@@ -0,0 +1,93 @@
+#include "plugins/simulator/visualizations/webviz/utility/StaticAssets.h"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CDeflate;
+using argos::Webviz::CStaticAssets;
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityStaticAssets, Load) {
+  std::filesystem::path cDir = std::filesystem::temp_directory_path() /
+                               ("webviz_assets_" + std::to_string(getpid()));
+  std::filesystem::create_directories(cDir / "js");
+  std::string strScript;
+  for (int i = 0; i < 100; i++) {
+    strScript += "console.log(" + std::to_string(i) + ");\n";
+  }
+  std::ofstream(cDir / "index.html") << "<html></html>";
+  std::ofstream(cDir / "js" / "main.js") << strScript;
+
+  CStaticAssets cAssets;
+  ASSERT_TRUE(cAssets.Load(cDir.string()));
+  std::filesystem::remove_all(cDir);
+  EXPECT_EQ(2u, cAssets.GetCount());
+
+  const CStaticAssets::SAsset* psIndex = cAssets.Find("/");
+  ASSERT_NE(nullptr, psIndex);
+  EXPECT_EQ("<html></html>", psIndex->m_strBody);
+  EXPECT_EQ("text/html; charset=utf-8", psIndex->m_strContentType);
+  EXPECT_EQ(psIndex, cAssets.Find("/index.html"));
+
+  const CStaticAssets::SAsset* psScript = cAssets.Find("/js/main.js");
+  ASSERT_NE(nullptr, psScript);
+  EXPECT_EQ(strScript, psScript->m_strBody);
+  EXPECT_EQ(
+    "application/javascript; charset=utf-8", psScript->m_strContentType);
+
+  /* Compressed when it is worth it */
+  ASSERT_FALSE(psScript->m_strGzip.empty());
+  std::string strInflated;
+  ASSERT_TRUE(CDeflate::Inflate(psScript->m_strGzip, &strInflated));
+  EXPECT_EQ(strScript, strInflated);
+
+  EXPECT_EQ(nullptr, cAssets.Find("/js/missing.js"));
+  EXPECT_EQ(nullptr, cAssets.Find("/js/"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityStaticAssets, MissingDirectory) {
+  CStaticAssets cAssets;
+  EXPECT_FALSE(cAssets.Load("/nonexistent/webviz/client"));
+  EXPECT_EQ(0u, cAssets.GetCount());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityStaticAssets, ETag) {
+  CStaticAssets cAssets;
+  cAssets.Add("/a.css", "body {}");
+  cAssets.Add("/b.css", "body {}");
+  cAssets.Add("/c.css", "body { color: red; }");
+
+  const std::string& strETag = cAssets.Find("/a.css")->m_strETag;
+  EXPECT_EQ(18u, strETag.size());
+  EXPECT_EQ('"', strETag.front());
+  EXPECT_EQ('"', strETag.back());
+  EXPECT_EQ(strETag, cAssets.Find("/b.css")->m_strETag);
+  EXPECT_NE(strETag, cAssets.Find("/c.css")->m_strETag);
+
+  /* Too small to gain anything */
+  EXPECT_TRUE(cAssets.Find("/a.css")->m_strGzip.empty());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityStaticAssets, ContentType) {
+  EXPECT_EQ("image/png", CStaticAssets::GetContentType("/images/logo.png"));
+  EXPECT_EQ("font/woff2", CStaticAssets::GetContentType("/fonts/a.woff2"));
+  EXPECT_EQ(
+    "application/octet-stream", CStaticAssets::GetContentType("/models/a"));
+  EXPECT_EQ(
+    "application/octet-stream", CStaticAssets::GetContentType("/a.b/model"));
+};
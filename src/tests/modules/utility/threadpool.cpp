@@ -0,0 +1,92 @@
+#include "plugins/simulator/visualizations/webviz/utility/ThreadPool.h"
+
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CThreadPool;
+
+TEST(UtilityThreadPool, RunsEveryTaskOnce) {
+  CThreadPool cPool(4);
+  std::vector<int> vecCount(1000, 0);
+
+  cPool.ParallelFor(
+    vecCount.size(), [&vecCount](size_t un_index) { ++vecCount[un_index]; });
+
+  for (int nCount : vecCount) {
+    EXPECT_EQ(1, nCount);
+  }
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityThreadPool, ReusedManyTimes) {
+  CThreadPool cPool(3);
+  std::atomic<size_t> unSum(0);
+
+  for (size_t i = 0; i < 200; ++i) {
+    cPool.ParallelFor(10, [&unSum](size_t un_index) { unSum += un_index; });
+  }
+  EXPECT_EQ(200u * 45u, unSum);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityThreadPool, WithoutWorkers) {
+  CThreadPool cPool(0);
+  size_t unSum = 0;
+
+  cPool.ParallelFor(5, [&unSum](size_t un_index) { unSum += un_index; });
+  EXPECT_EQ(10u, unSum);
+  EXPECT_EQ(0u, cPool.GetSize());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityThreadPool, ThreadInitAndExceptions) {
+  std::atomic<int> nInitialized(0);
+  std::atomic<int> nRan(0);
+  {
+    CThreadPool cPool(2, [&nInitialized]() { ++nInitialized; });
+
+    EXPECT_THROW(
+      cPool.ParallelFor(
+        8,
+        [](size_t un_index) {
+          if (un_index == 3) {
+            throw std::runtime_error("task failed");
+          }
+        }),
+      std::runtime_error);
+
+    /* Still usable afterwards */
+    cPool.ParallelFor(8, [&nRan](size_t) { ++nRan; });
+  }
+  EXPECT_EQ(8, nRan);
+  /* Workers are joined, each one ran its init function */
+  EXPECT_EQ(2, nInitialized);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityThreadPool, ShortCallsInARow) {
+  CThreadPool cPool(4);
+  std::vector<std::atomic<int>> vecCount(8);
+
+  /* Workers waking late must not run the tasks of the next call */
+  for (size_t i = 0; i < 20000; ++i) {
+    size_t unTasks = 1 + i % vecCount.size();
+    for (size_t j = 0; j < unTasks; ++j) {
+      vecCount[j] = 0;
+    }
+    cPool.ParallelFor(
+      unTasks, [&vecCount](size_t un_index) { ++vecCount[un_index]; });
+    for (size_t j = 0; j < unTasks; ++j) {
+      ASSERT_EQ(1, vecCount[j]) << "call " << i << ", task " << j;
+    }
+  }
+};
@@ -0,0 +1,59 @@
+#include "plugins/simulator/visualizations/webviz/utility/TickScheduler.h"
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CTickScheduler;
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+
+TEST(UtilityTickScheduler, SetPeriodMicroseconds) {
+  CTickScheduler cScheduler;
+
+  cScheduler.SetPeriod(0.0005);
+  EXPECT_EQ(500, cScheduler.GetPeriod().count());
+
+  cScheduler.SetPeriod(1.0 / 3);
+  EXPECT_EQ(333333, cScheduler.GetPeriod().count());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityTickScheduler, CompensatesWorkInTheLoop) {
+  CTickScheduler cScheduler(microseconds(2000));
+  auto tStart = steady_clock::now();
+
+  cScheduler.Start();
+  for (int i = 0; i < 50; ++i) {
+    /* Work shorter than a period does not delay the schedule */
+    std::this_thread::sleep_for(microseconds(500));
+    EXPECT_TRUE(cScheduler.WaitNextTick());
+  }
+
+  auto cElapsed = steady_clock::now() - tStart;
+  EXPECT_GE(cElapsed, milliseconds(100));
+  EXPECT_LT(cElapsed, milliseconds(150));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityTickScheduler, DropsMissedTicks) {
+  CTickScheduler cScheduler(microseconds(1000));
+
+  cScheduler.Start();
+  std::this_thread::sleep_for(milliseconds(10));
+
+  EXPECT_FALSE(cScheduler.WaitNextTick());
+  EXPECT_GE(cScheduler.GetLag(), milliseconds(8));
+
+  /* Back on schedule from there, no burst of ticks */
+  auto tStart = steady_clock::now();
+  EXPECT_TRUE(cScheduler.WaitNextTick());
+  EXPECT_GE(steady_clock::now() - tStart, microseconds(500));
+  EXPECT_EQ(0, cScheduler.GetLag().count());
+};
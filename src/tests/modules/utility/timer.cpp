@@ -62,6 +62,27 @@ TEST(UtilityTimer, FunctionStop) {
   delete timer;
 };
 
+/****************************************/
+/****************************************/
+
+TEST(UtilityTimer, FunctionElapsedMicroseconds) {
+  auto timer = argos::Webviz::CTimer();
+
+  EXPECT_EQ(0, timer.ElapsedMicroseconds().count());
+
+  timer.Start();
+  std::this_thread::sleep_for(std::chrono::microseconds(1500));
+  timer.Stop();
+
+  /* Not truncated to milliseconds */
+  EXPECT_GE(timer.ElapsedMicroseconds().count(), 1500);
+  EXPECT_EQ(
+    timer.Elapsed().count(), timer.ElapsedMicroseconds().count() / 1000);
+  EXPECT_EQ(
+    timer.ElapsedMicroseconds().count(),
+    timer.ElapsedNanoseconds().count() / 1000);
+};
+
 // /****************************************/
 // /****************************************/
 
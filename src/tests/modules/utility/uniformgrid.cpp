@@ -0,0 +1,65 @@
+#include "plugins/simulator/visualizations/webviz/utility/UniformGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CUniformGrid;
+
+TEST(UtilityUniformGrid, EmptyGrid) {
+  CUniformGrid cGrid;
+  std::vector<size_t> vecFound;
+
+  cGrid.Query(-10, -10, 10, 10, vecFound);
+  EXPECT_TRUE(vecFound.empty());
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityUniformGrid, SameAsBruteForce) {
+  std::vector<CUniformGrid::SPoint> vecPoints;
+  for (int i = 0; i < 1000; ++i) {
+    /* Deterministic spread over [-5, 5] */
+    vecPoints.push_back(
+      {(i * 37 % 1000) / 100.0 - 5, (i * 91 % 1000) / 100.0 - 5});
+  }
+
+  CUniformGrid cGrid;
+  cGrid.Build(vecPoints, -5, -5, 5, 5);
+  EXPECT_GT(cGrid.GetNumCells(), 1u);
+
+  std::vector<size_t> vecFound;
+  cGrid.Query(-1.5, 0.25, 2, 3, vecFound);
+  std::sort(vecFound.begin(), vecFound.end());
+
+  std::vector<size_t> vecExpected;
+  for (size_t i = 0; i < vecPoints.size(); ++i) {
+    if (
+      -1.5 <= vecPoints[i].m_fX && vecPoints[i].m_fX <= 2 &&
+      0.25 <= vecPoints[i].m_fY && vecPoints[i].m_fY <= 3) {
+      vecExpected.push_back(i);
+    }
+  }
+  EXPECT_FALSE(vecExpected.empty());
+  EXPECT_EQ(vecExpected, vecFound);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityUniformGrid, PointsOutsideBounds) {
+  CUniformGrid cGrid;
+  cGrid.Build({{-100, 0}, {0, 0}, {100, 100}}, -1, -1, 1, 1, 4);
+
+  std::vector<size_t> vecFound;
+  cGrid.Query(50, 50, 200, 200, vecFound);
+  ASSERT_EQ(1u, vecFound.size());
+  EXPECT_EQ(2u, vecFound[0]);
+
+  /* Inverted rectangle */
+  vecFound.clear();
+  cGrid.Query(1, 1, -1, -1, vecFound);
+  EXPECT_TRUE(vecFound.empty());
+};
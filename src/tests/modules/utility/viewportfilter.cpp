@@ -0,0 +1,98 @@
+#include "plugins/simulator/visualizations/webviz/utility/ViewportFilter.h"
+
+#include <set>
+#include <string>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CViewportFilter;
+using nlohmann::json;
+
+static json MakeState() {
+  json cState;
+  cState["type"] = "broadcast";
+  cState["steps"] = 10;
+  cState["entities"] = {
+    {{"id", "floor"}, {"type", "floor"}},
+    {{"id", "fb0"}, {"position", {{"x", -1}, {"y", -1}, {"z", 0}}}},
+    {{"id", "fb1"}, {"position", {{"x", 1}, {"y", 1}, {"z", 0}}}},
+    {{"id", "fb2"}, {"position", {{"x", 1.5}, {"y", 0.5}, {"z", 0}}}}};
+  return cState;
+}
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityViewportFilter, QueryKeepsEntitiesWithoutPosition) {
+  CViewportFilter cFilter(MakeState(), 7);
+
+  auto setVisible = cFilter.Query({0, 0, 2, 2});
+
+  EXPECT_EQ(3u, setVisible.size());
+  EXPECT_EQ(1u, setVisible.count("floor"));
+  EXPECT_EQ(1u, setVisible.count("fb1"));
+  EXPECT_EQ(1u, setVisible.count("fb2"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityViewportFilter, Keyframe) {
+  CViewportFilter cFilter(MakeState(), 7);
+
+  json cFrame = cFilter.MakeKeyframe(cFilter.Query({-2, -2, 0, 0}));
+
+  EXPECT_TRUE(cFrame["keyframe"].get<bool>());
+  EXPECT_EQ(7u, cFrame["sequence"].get<uint64_t>());
+  EXPECT_EQ(10, cFrame["steps"].get<int>());
+  ASSERT_EQ(2u, cFrame["entities"].size());
+  EXPECT_EQ("floor", cFrame["entities"][0]["id"]);
+  EXPECT_EQ("fb0", cFrame["entities"][1]["id"]);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityViewportFilter, DeltaWithEnteringAndLeaving) {
+  CViewportFilter cFilter(MakeState(), 8);
+
+  /* Delta of the broadcast: fb0 and fb1 moved, fb3 left the experiment */
+  json cDelta;
+  cDelta["type"] = "broadcast";
+  cDelta["keyframe"] = false;
+  cDelta["sequence"] = 8;
+  cDelta["entities"] = {
+    {{"id", "fb0"}, {"position", {{"x", -1}, {"y", -1}, {"z", 0}}}},
+    {{"id", "fb1"}, {"position", {{"x", 1}, {"y", 1}, {"z", 0}}}}};
+  cDelta["removed"] = {"fb3"};
+
+  /* The client had fb0, fb1 and fb3, now looks at fb1 and fb2 */
+  json cFrame = cFilter.MakeDelta(
+    cDelta, cFilter.Query({0, 0, 2, 2}), {"floor", "fb0", "fb1", "fb3"});
+
+  EXPECT_FALSE(cFrame["keyframe"].get<bool>());
+  EXPECT_EQ(8u, cFrame["sequence"].get<uint64_t>());
+
+  std::set<std::string> setEntities, setRemoved;
+  for (const auto& cEntity : cFrame["entities"]) {
+    setEntities.insert(cEntity["id"].get<std::string>());
+  }
+  for (const auto& cId : cFrame["removed"]) {
+    setRemoved.insert(cId.get<std::string>());
+  }
+  /* fb1 changed, fb2 entered whole */
+  EXPECT_EQ((std::set<std::string>{"fb1", "fb2"}), setEntities);
+  EXPECT_EQ((std::set<std::string>{"fb0", "fb3"}), setRemoved);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityViewportFilter, GetAllAndFind) {
+  CViewportFilter cFilter(MakeState(), 7);
+
+  EXPECT_EQ(4u, cFilter.GetAll().size());
+  ASSERT_NE(nullptr, cFilter.Find("floor"));
+  EXPECT_EQ("floor", (*cFilter.Find("floor"))["type"]);
+  EXPECT_EQ(nullptr, cFilter.Find("fb42"));
+};
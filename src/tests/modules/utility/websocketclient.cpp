@@ -0,0 +1,182 @@
+#include "plugins/simulator/visualizations/webviz/utility/WebSocketClient.h"
+
+#include <arpa/inet.h>
+
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using argos::Webviz::CWebSocketClient;
+using EOpCode = CWebSocketClient::EOpCode;
+
+TEST(UtilityWebSocketClient, ParseURL) {
+  std::string strHost, strPath;
+  uint16_t unPort;
+
+  ASSERT_TRUE(CWebSocketClient::ParseURL(
+    "ws://sim-node:3000/?broadcasts", &strHost, &unPort, &strPath));
+  EXPECT_EQ("sim-node", strHost);
+  EXPECT_EQ(3000, unPort);
+  EXPECT_EQ("/?broadcasts", strPath);
+
+  ASSERT_TRUE(
+    CWebSocketClient::ParseURL("ws://localhost", &strHost, &unPort, &strPath));
+  EXPECT_EQ(80, unPort);
+  EXPECT_EQ("/", strPath);
+
+  ASSERT_TRUE(CWebSocketClient::ParseURL(
+    "ws://localhost:3000?logs", &strHost, &unPort, &strPath));
+  EXPECT_EQ("/?logs", strPath);
+
+  EXPECT_FALSE(CWebSocketClient::ParseURL(
+    "wss://localhost:3000", &strHost, &unPort, &strPath));
+  EXPECT_FALSE(CWebSocketClient::ParseURL(
+    "ws://localhost:99999", &strHost, &unPort, &strPath));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityWebSocketClient, Frames) {
+  CWebSocketClient::SFrame sFrame;
+
+  /* All three length encodings, masked and not */
+  for (size_t unSize : {5u, 300u, 70000u}) {
+    std::string strPayload(unSize, 'a');
+    strPayload[0] = 'b';
+    for (bool bMasked : {true, false}) {
+      std::string strFrame = CWebSocketClient::EncodeFrame(
+        EOpCode::BINARY, strPayload, bMasked, 0x12345678);
+      EXPECT_EQ(0u, CWebSocketClient::DecodeFrame(strFrame.data(), 1, &sFrame));
+      EXPECT_EQ(
+        0u,
+        CWebSocketClient::DecodeFrame(
+          strFrame.data(), strFrame.size() - 1, &sFrame));
+      ASSERT_EQ(
+        strFrame.size(),
+        CWebSocketClient::DecodeFrame(
+          strFrame.data(), strFrame.size(), &sFrame));
+      EXPECT_TRUE(sFrame.m_bFin);
+      EXPECT_EQ(EOpCode::BINARY, sFrame.m_eOpCode);
+      EXPECT_EQ(strPayload, sFrame.m_strPayload);
+    }
+  }
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityWebSocketClient, UpgradeRequest) {
+  std::string strRequest = CWebSocketClient::EncodeUpgradeRequest(
+    "sim-node", 3000, "/?broadcasts.deflate", "dGhlIHNhbXBsZSBub25jZQ==");
+
+  EXPECT_EQ(0u, strRequest.find("GET /?broadcasts.deflate HTTP/1.1\r\n"));
+  EXPECT_NE(std::string::npos, strRequest.find("Host: sim-node:3000\r\n"));
+  EXPECT_NE(
+    std::string::npos,
+    strRequest.find("Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"));
+  EXPECT_EQ(strRequest.size() - 4, strRequest.find("\r\n\r\n"));
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityWebSocketClient, Loopback) {
+  int nListen = socket(AF_INET, SOCK_STREAM, 0);
+  ASSERT_GE(nListen, 0);
+  struct sockaddr_in sAddress = {};
+  sAddress.sin_family = AF_INET;
+  sAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_EQ(
+    0, bind(nListen, reinterpret_cast<sockaddr*>(&sAddress), sizeof(sAddress)));
+  socklen_t unLength = sizeof(sAddress);
+  getsockname(nListen, reinterpret_cast<sockaddr*>(&sAddress), &unLength);
+  ASSERT_EQ(0, listen(nListen, 1));
+
+  /* Server: upgrade, a ping, a fragmented message, then echo one frame */
+  std::string strRequest, strEchoed;
+  std::thread cServer([&]() {
+    int nClient = accept(nListen, nullptr, nullptr);
+    char pchBuffer[4096];
+    while (strRequest.find("\r\n\r\n") == std::string::npos) {
+      ssize_t nRead = recv(nClient, pchBuffer, sizeof(pchBuffer), 0);
+      if (nRead <= 0) {
+        break;
+      }
+      strRequest.append(pchBuffer, nRead);
+    }
+    std::string strAnswer =
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\nConnection: Upgrade\r\n\r\n";
+    strAnswer += CWebSocketClient::EncodeFrame(EOpCode::PING, "p", false);
+    std::string strFirst =
+      CWebSocketClient::EncodeFrame(EOpCode::TEXT, "hel", false);
+    strFirst[0] &= 0x7F;
+    strAnswer += strFirst;
+    strAnswer +=
+      CWebSocketClient::EncodeFrame(EOpCode::CONTINUATION, "lo", false);
+    send(nClient, strAnswer.data(), strAnswer.size(), 0);
+
+    /* The pong, then the message */
+    std::string strReceived;
+    CWebSocketClient::SFrame sFrame;
+    int nFrames = 0;
+    while (nFrames < 2) {
+      ssize_t nRead = recv(nClient, pchBuffer, sizeof(pchBuffer), 0);
+      if (nRead <= 0) {
+        break;
+      }
+      strReceived.append(pchBuffer, nRead);
+      size_t unUsed;
+      while ((unUsed = CWebSocketClient::DecodeFrame(
+                strReceived.data(), strReceived.size(), &sFrame)) > 0) {
+        strReceived.erase(0, unUsed);
+        if (sFrame.m_eOpCode == EOpCode::TEXT) {
+          strEchoed = sFrame.m_strPayload;
+        }
+        ++nFrames;
+      }
+    }
+    close(nClient);
+  });
+
+  CWebSocketClient cClient;
+  std::string strError;
+  ASSERT_TRUE(cClient.Connect(
+    "127.0.0.1", ntohs(sAddress.sin_port), "/?broadcasts", &strError, 4096))
+    << strError;
+
+  std::string strMessage;
+  bool bBinary = true;
+  ASSERT_EQ(
+    CWebSocketClient::EReceived::MESSAGE,
+    cClient.Receive(&strMessage, &bBinary, std::chrono::milliseconds(2000)));
+  EXPECT_EQ("hello", strMessage);
+  EXPECT_FALSE(bBinary);
+  EXPECT_TRUE(cClient.Send(EOpCode::TEXT, "{\"command\":\"play\"}"));
+
+  /* Server closes */
+  EXPECT_EQ(
+    CWebSocketClient::EReceived::CLOSED,
+    cClient.Receive(&strMessage, &bBinary, std::chrono::milliseconds(2000)));
+  EXPECT_FALSE(cClient.IsConnected());
+
+  cServer.join();
+  close(nListen);
+  EXPECT_EQ(0u, strRequest.find("GET /?broadcasts HTTP/1.1\r\n"));
+  EXPECT_NE(std::string::npos, strRequest.find("Sec-WebSocket-Key: "));
+  EXPECT_EQ("{\"command\":\"play\"}", strEchoed);
+};
+
+/****************************************/
+/****************************************/
+
+TEST(UtilityWebSocketClient, ConnectFails) {
+  CWebSocketClient cClient;
+  std::string strError;
+
+  EXPECT_FALSE(cClient.Connect("127.0.0.1", 1, "/", &strError));
+  EXPECT_FALSE(strError.empty());
+  EXPECT_FALSE(cClient.Send(EOpCode::TEXT, "nobody"));
+};